@@ -96,7 +96,7 @@ int extractCommand(const std::string& hpiPath, const std::string& filePath, cons
 
     std::cout << "Extracting..." << std::endl;
     auto buf = std::make_unique<char[]>(entry->get().size);
-    archive.extract(*entry, buf.get());
+    archive.extract(file, *entry, buf.get());
 
     std::cout << "Writing..." << std::endl;
     std::ofstream out(destinationPath, std::ios::binary);
@@ -4,14 +4,19 @@
 #include <memory>
 #include <rwe/AudioService.h>
 #include <rwe/ColorPalette.h>
+#include <rwe/CompiledUnitDatabase.h>
+#include <rwe/GameParameters.h>
 #include <rwe/GraphicsContext.h>
 #include <rwe/LoadingScene.h>
 #include <rwe/MainMenuScene.h>
+#include <rwe/MapCatalogService.h>
 #include <rwe/OpenGlVersion.h>
+#include <rwe/Replay.h>
 #include <rwe/Result.h>
 #include <rwe/SceneManager.h>
 #include <rwe/SdlContextManager.h>
 #include <rwe/ShaderService.h>
+#include <rwe/ThreadPool.h>
 #include <rwe/ViewportService.h>
 #include <rwe/config.h>
 #include <rwe/gui.h>
@@ -20,6 +25,8 @@
 #include <rwe/util.h>
 #include <rwe/vfs/CompositeVirtualFileSystem.h>
 #include <spdlog/spdlog.h>
+#include <string>
+#include <vector>
 
 namespace fs = boost::filesystem;
 
@@ -109,7 +116,12 @@ namespace rwe
         return Ok(std::move(glContext));
     };
 
-    int run(spdlog::logger& logger, const fs::path& localDataPath, const std::optional<std::string>& mapName)
+    int run(
+        spdlog::logger& logger,
+        const fs::path& localDataPath,
+        const std::optional<std::string>& mapName,
+        const std::optional<std::string>& replayPath,
+        const std::optional<NetworkParameters>& network)
     {
         logger.info(ProjectNameVersion);
         logger.info("Current directory: {0}", fs::current_path().string());
@@ -239,7 +251,7 @@ namespace rwe
             throw std::runtime_error("Missing side data");
         }
         std::string sideDataString(sideDataBytes->data(), sideDataBytes->size());
-        std::unordered_map<std::string, SideData> sideDataMap;
+        CaseInsensitiveMap<SideData> sideDataMap;
         {
             auto sideData = parseSidesFromSideData(parseTdfFromString(sideDataString));
             for (auto& side : sideData)
@@ -251,12 +263,44 @@ namespace rwe
 
         MapFeatureService featureService(&vfs);
 
+        logger.info("Starting worker threads");
+        ThreadPool threadPool(defaultThreadCount());
+        logger.info("Worker thread count: {0}", threadPool.threadCount());
+
+        logger.info("Fingerprinting game data");
+        fs::path compiledUnitDatabasePath(localDataPath);
+        compiledUnitDatabasePath /= "unitdb.bin";
+        CompiledUnitDatabaseInfo compiledUnitDatabaseInfo{compiledUnitDatabasePath.string(), computeDataFingerprint(searchPath)};
+        logger.info("Data fingerprint: {0:016x}", compiledUnitDatabaseInfo.dataFingerprint);
+
+        // Every game records a replay, named after when it started unless a path was given.
+        fs::path replayDirectory(localDataPath);
+        replayDirectory /= "replays";
+        fs::create_directories(replayDirectory);
+
+        // Only the main menu browses maps, so only build the catalog when going there.
+        // It must outlive the scenes, which run after this block.
+        std::optional<MapCatalogService> mapCatalogService;
+
         if (mapName)
         {
             logger.info("Launching into map: {0}", *mapName);
             GameParameters params{*mapName, 0};
+            params.seed = makeGameSeed();
             params.players[0] = PlayerInfo{PlayerInfo::Controller::Human, "ARM", 0};
             params.players[1] = PlayerInfo{PlayerInfo::Controller::Computer, "CORE", 1};
+            params.replayPath = replayPath ? *replayPath : makeReplayPath(replayDirectory.string());
+            logger.info("Recording replay to: {0}", *params.replayPath);
+            params.network = network;
+            if (network)
+            {
+                logger.info("Playing slot {0} over the network on port {1}", network->localSlot, network->localPort);
+                for (const auto& peer : network->peers)
+                {
+                    logger.info("Peer for slot {0}: {1}:{2}", peer.slot, peer.host, peer.port);
+                }
+                assignNetworkControllers(params);
+            }
             auto scene = std::make_unique<LoadingScene>(
                 &vfs,
                 &textureService,
@@ -271,6 +315,8 @@ namespace rwe
                 sdlContext,
                 &sideDataMap,
                 &viewportService,
+                &threadPool,
+                &compiledUnitDatabaseInfo,
                 AudioService::LoopToken(),
                 params);
             sceneManager.setNextScene(std::move(scene));
@@ -278,6 +324,15 @@ namespace rwe
         else
         {
             logger.info("Launching into the main menu");
+            fs::path mapCatalogPath(localDataPath);
+            mapCatalogPath /= "mapcatalog.bin";
+            mapCatalogService.emplace(
+                &vfs,
+                &textureService,
+                &threadPool,
+                mapCatalogPath.string(),
+                compiledUnitDatabaseInfo.dataFingerprint);
+
             auto scene = std::make_unique<MainMenuScene>(
                 &sceneManager,
                 &vfs,
@@ -293,6 +348,10 @@ namespace rwe
                 sdlContext,
                 &sideDataMap,
                 &viewportService,
+                &threadPool,
+                &compiledUnitDatabaseInfo,
+                &*mapCatalogService,
+                replayDirectory.string(),
                 viewportService.width(),
                 viewportService.height());
             sceneManager.setNextScene(std::move(scene));
@@ -324,13 +383,49 @@ int main(int argc, char* argv[])
 
     try
     {
+        std::vector<std::string> args(argv + 1, argv + argc);
+
+        // Leading options set up a networked game:
+        // --net <slot>:<port> for the local player and --peer <slot>:<host>:<port> for each other player.
+        std::optional<rwe::NetworkParameters> network;
+        std::vector<rwe::NetworkPeer> peers;
+        while (args.size() >= 2 && (args[0] == "--net" || args[0] == "--peer"))
+        {
+            if (args[0] == "--net")
+            {
+                network = rwe::parseNetworkLocal(args[1]);
+            }
+            else
+            {
+                peers.push_back(rwe::parseNetworkPeer(args[1]));
+            }
+            args.erase(args.begin(), args.begin() + 2);
+        }
+        if (network)
+        {
+            network->peers = std::move(peers);
+        }
+        else if (!peers.empty())
+        {
+            throw std::runtime_error("--peer needs --net");
+        }
+
         std::optional<std::string> mapName;
-        if (argc == 2)
+        std::optional<std::string> replayPath;
+        if (args.size() >= 1)
+        {
+            mapName = args[0];
+        }
+        if (args.size() >= 2)
+        {
+            replayPath = args[1];
+        }
+        if (network && !mapName)
         {
-            mapName = argv[1];
+            throw std::runtime_error("A networked game needs a map");
         }
 
-        return rwe::run(*logger, *localDataPath, mapName);
+        return rwe::run(*logger, *localDataPath, mapName, replayPath, network);
     }
     catch (const std::exception& e)
     {
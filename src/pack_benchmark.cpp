@@ -0,0 +1,145 @@
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <rwe/BoxTreeSplit.h>
+#include <rwe/Gaf.h>
+#include <rwe/math/rwe_math.h>
+#include <rwe/vfs/CompositeVirtualFileSystem.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    class FrameSizeGafAdapter : public GafReaderAdapter
+    {
+    private:
+        std::vector<Size>* sizes;
+
+    public:
+        explicit FrameSizeGafAdapter(std::vector<Size>* sizes) : sizes(sizes) {}
+
+        void beginFrame(const GafFrameData& header) override
+        {
+            sizes->emplace_back(header.width, header.height);
+        }
+
+        void frameLayer(const LayerData& /*data*/) override {}
+
+        void endFrame() override {}
+    };
+
+    /** Collects the size of every texture frame, as MeshService would pack them. */
+    std::vector<Size> loadTextureSizes(const std::string& searchPath)
+    {
+        auto vfs = constructVfs(searchPath);
+
+        std::vector<Size> sizes;
+        for (const auto& gafName : vfs.getFileNames("textures", ".gaf"))
+        {
+            auto bytes = vfs.readFile("textures/" + gafName);
+            if (!bytes)
+            {
+                continue;
+            }
+
+            boost::interprocess::bufferstream stream(bytes->data(), bytes->size());
+            GafArchive gaf(&stream);
+            for (const auto& e : gaf.entries())
+            {
+                FrameSizeGafAdapter adapter(&sizes);
+                gaf.extract(e, adapter);
+            }
+        }
+
+        return sizes;
+    }
+
+    /** A deterministic spread of small and medium rectangles. */
+    std::vector<Size> generateSizes(std::size_t count)
+    {
+        std::mt19937 rng(12345);
+        std::uniform_int_distribution<std::size_t> dist(1, 64);
+
+        std::vector<Size> sizes;
+        sizes.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            sizes.emplace_back(dist(rng), dist(rng));
+        }
+
+        return sizes;
+    }
+
+    using Packer = BoxPackInfo<const Size*> (*)(std::vector<const Size*>&, const std::function<Size(const Size* const&)>&);
+
+    void runBenchmark(const std::string& name, Packer packer, const std::vector<Size>& sizes)
+    {
+        const int runs = 5;
+
+        std::function<Size(const Size* const&)> roundedSize = [](const Size* s) {
+            return Size(roundUpToPowerOfTwo(s->width), roundUpToPowerOfTwo(s->height));
+        };
+
+        std::size_t usedArea = 0;
+        for (const auto& s : sizes)
+        {
+            usedArea += roundedSize(&s).width * roundedSize(&s).height;
+        }
+
+        double bestMs = 0.0;
+        BoxPackInfo<const Size*> result{};
+        for (int i = 0; i < runs; ++i)
+        {
+            std::vector<const Size*> items;
+            items.reserve(sizes.size());
+            for (const auto& s : sizes)
+            {
+                items.push_back(&s);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            result = packer(items, roundedSize);
+            auto end = std::chrono::steady_clock::now();
+
+            auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+            if (i == 0 || ms < bestMs)
+            {
+                bestMs = ms;
+            }
+        }
+
+        auto atlasArea = static_cast<double>(result.width) * static_cast<double>(result.height);
+        std::cout << std::left << std::setw(10) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2) << bestMs << " ms"
+                  << std::setw(8) << result.width << "x" << std::left << std::setw(8) << result.height
+                  << std::right << std::setw(8) << std::setprecision(1) << (100.0 * static_cast<double>(usedArea) / atlasArea) << "% occupied"
+                  << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<rwe::Size> sizes;
+    if (argc >= 2)
+    {
+        sizes = rwe::loadTextureSizes(argv[1]);
+    }
+    else
+    {
+        sizes = rwe::generateSizes(5000);
+    }
+
+    if (sizes.empty())
+    {
+        std::cerr << "No textures found" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packing " << sizes.size() << " rectangles (sizes rounded up to powers of two)" << std::endl;
+    rwe::runBenchmark("box tree", &rwe::packGridsBoxTree<const rwe::Size*>, sizes);
+    rwe::runBenchmark("skyline", &rwe::packGridsGeneric<const rwe::Size*>, sizes);
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef RWE_ABSTRACTAUDIOSERVICE_H
+#define RWE_ABSTRACTAUDIOSERVICE_H
+
+#include <optional>
+#include <rwe/SoundHandle.h>
+#include <string>
+
+namespace rwe
+{
+    /**
+     * Loads the sounds that game data refers to.
+     *
+     * UnitDatabaseLoader depends on this rather than on AudioService,
+     * so that it can be built and run without SDL.
+     * Headless runs pass no audio service at all.
+     */
+    class AbstractAudioService
+    {
+    public:
+        virtual ~AbstractAudioService() = default;
+
+        virtual std::optional<SoundHandle> loadSound(const std::string& soundName) = 0;
+    };
+}
+
+#endif
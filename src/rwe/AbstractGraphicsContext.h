@@ -0,0 +1,35 @@
+#ifndef RWE_ABSTRACTGRAPHICSCONTEXT_H
+#define RWE_ABSTRACTGRAPHICSCONTEXT_H
+
+#include <GL/glew.h>
+#include <rwe/ColorPalette.h>
+#include <rwe/GlMesh.h>
+#include <rwe/GlVertex.h>
+#include <rwe/TextureHandle.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * The graphics resources that loading game data creates.
+     *
+     * Loaders such as MapLoader and MeshService depend on this
+     * rather than on GraphicsContext, so that they can be built and run
+     * without the graphics library. Headless runs pass no graphics context at all.
+     */
+    class AbstractGraphicsContext
+    {
+    public:
+        virtual ~AbstractGraphicsContext() = default;
+
+        virtual TextureHandle createTexture(unsigned int width, unsigned int height, const std::vector<Color>& image) = 0;
+
+        virtual GlMesh createColoredMesh(const std::vector<GlColoredVertex>& vertices, GLenum usage) = 0;
+
+        virtual GlMesh createTexturedNormalMesh(const std::vector<GlTexturedNormalVertex>& vertices, GLenum usage) = 0;
+
+        virtual GlMesh createColoredNormalMesh(const std::vector<GlColoredNormalVertex>& vertices, GLenum usage) = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef RWE_ABSTRACTTEXTURESERVICE_H
+#define RWE_ABSTRACTTEXTURESERVICE_H
+
+#include <memory>
+#include <optional>
+#include <rwe/SpriteSeries.h>
+#include <string>
+
+namespace rwe
+{
+    /**
+     * The sprite lookups that game data and the simulation make,
+     * such as the animations of features, explosions and smoke.
+     *
+     * These depend on this rather than on TextureService,
+     * so that they can be built and run without the graphics library.
+     * Headless runs pass no texture service at all.
+     */
+    class AbstractTextureService
+    {
+    public:
+        virtual ~AbstractTextureService() = default;
+
+        virtual std::optional<std::shared_ptr<SpriteSeries>> tryGetGafEntry(const std::string& gafName, const std::string& entryName) = 0;
+
+        virtual std::shared_ptr<SpriteSeries> getGafEntry(const std::string& gafName, const std::string& entryName) = 0;
+
+        virtual std::shared_ptr<SpriteSeries> getDefaultSpriteSeries() = 0;
+    };
+}
+
+#endif
@@ -24,7 +24,7 @@ namespace rwe
         sdlMixerContext->playChannel(-1, sound.get(), 0);
     }
 
-    std::optional<AudioService::SoundHandle> AudioService::loadSound(const std::string& soundName)
+    std::optional<SoundHandle> AudioService::loadSound(const std::string& soundName)
     {
 
         auto soundIter = soundBank.find(soundName);
@@ -63,7 +63,7 @@ namespace rwe
         sdlMixerContext->haltChannel(channel);
     }
 
-    void AudioService::playSoundIfFree(const AudioService::SoundHandle& sound, unsigned int channel)
+    void AudioService::playSoundIfFree(const SoundHandle& sound, unsigned int channel)
     {
         if (sdlMixerContext->playing(channel))
         {
@@ -73,7 +73,7 @@ namespace rwe
         sdlMixerContext->playChannel(channel, sound.get(), 0);
     }
 
-    AudioService::LoopToken::LoopToken(AudioService* audioService, int channel, const AudioService::SoundHandle& sound)
+    AudioService::LoopToken::LoopToken(AudioService* audioService, int channel, const SoundHandle& sound)
         : audioService(audioService), channel(channel), sound(sound)
     {
     }
@@ -105,7 +105,7 @@ namespace rwe
 
     AudioService::LoopToken::LoopToken() : audioService(nullptr), channel(-1), sound(nullptr) {}
 
-    std::optional<std::reference_wrapper<const AudioService::SoundHandle>> AudioService::LoopToken::getSound()
+    std::optional<std::reference_wrapper<const SoundHandle>> AudioService::LoopToken::getSound()
     {
         if (channel == -1)
         {
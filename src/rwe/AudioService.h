@@ -3,18 +3,18 @@
 
 #include <functional>
 #include <memory>
+#include <rwe/AbstractAudioService.h>
 #include <rwe/SdlContextManager.h>
+#include <rwe/SoundHandle.h>
+#include <rwe/rwe_string.h>
 #include <rwe/vfs/AbstractVirtualFileSystem.h>
 #include <unordered_map>
 
 namespace rwe
 {
-    class AudioService
+    class AudioService : public AbstractAudioService
     {
     public:
-        using Sound = Mix_Chunk;
-        using SoundHandle = std::shared_ptr<Sound>;
-
         class LoopToken
         {
         private:
@@ -37,7 +37,7 @@ namespace rwe
         SdlContext* sdlContext;
         SdlMixerContext* sdlMixerContext;
         AbstractVirtualFileSystem* fileSystem;
-        std::unordered_map<std::string, std::shared_ptr<Sound>> soundBank;
+        CaseInsensitiveMap<std::shared_ptr<Sound>> soundBank;
 
     public:
         AudioService(SdlContext* sdlContext, SdlMixerContext* sdlMixerContext, AbstractVirtualFileSystem* fileSystem);
@@ -46,7 +46,7 @@ namespace rwe
 
         void playSound(const SoundHandle& sound);
 
-        std::optional<SoundHandle> loadSound(const std::string& soundName);
+        std::optional<SoundHandle> loadSound(const std::string& soundName) override;
 
         void reserveChannels(unsigned int count);
 
@@ -0,0 +1,119 @@
+#ifndef RWE_BINARYREADER_H
+#define RWE_BINARYREADER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace rwe
+{
+    /**
+     * Reads values written by BinaryWriter out of a buffer held in memory.
+     *
+     * Every read is bounds-checked.
+     * Reading past the end of the buffer throws Exception, constructed from the message given to the reader,
+     * so that each format reports truncation with its own exception type.
+     */
+    template <typename Exception>
+    class BinaryReader
+    {
+    private:
+        const char* it;
+        const char* end;
+        const char* truncatedMessage;
+
+    public:
+        BinaryReader(const char* begin, const char* end, const char* truncatedMessage)
+            : it(begin), end(end), truncatedMessage(truncatedMessage)
+        {
+        }
+
+        bool atEnd() const { return it == end; }
+
+        /** Returns the number of bytes left to read. */
+        std::size_t remaining() const { return static_cast<std::size_t>(end - it); }
+
+        /** Reads a number written by BinaryWriter::write. */
+        template <typename T>
+        T read()
+        {
+            static_assert(std::is_arithmetic_v<T>);
+
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                return read<uint8_t>() != 0;
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                using Bits = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+                static_assert(sizeof(Bits) == sizeof(T));
+                auto bits = read<Bits>();
+                T value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+            else
+            {
+                require(sizeof(T));
+                uint64_t bits = 0;
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                {
+                    bits |= static_cast<uint64_t>(static_cast<unsigned char>(it[i])) << (8 * i);
+                }
+                it += sizeof(T);
+                return static_cast<T>(static_cast<std::make_unsigned_t<T>>(bits));
+            }
+        }
+
+        /** Reads bytes written by BinaryWriter::writeBytes. */
+        void readBytes(void* data, std::size_t size)
+        {
+            require(size);
+            std::memcpy(data, it, size);
+            it += size;
+        }
+
+        /** Skips over the given number of bytes, returning where they start. */
+        const char* skip(std::size_t size)
+        {
+            require(size);
+            auto begin = it;
+            it += size;
+            return begin;
+        }
+
+        /**
+         * Reads a size written by BinaryWriter::writeSize,
+         * for a sequence whose elements each take at least the given number of bytes.
+         * Sizes the rest of the buffer could not hold are rejected
+         * before anything is allocated for them.
+         */
+        uint32_t readSize(std::size_t minimumElementSize = 1)
+        {
+            auto size = read<uint32_t>();
+            require(static_cast<uint64_t>(size) * minimumElementSize);
+            return size;
+        }
+
+        /** Reads a string written by BinaryWriter::writeString. */
+        std::string readString()
+        {
+            auto size = readSize();
+            std::string value(it, size);
+            it += size;
+            return value;
+        }
+
+        /** Throws if fewer than the given number of bytes remain. */
+        void require(uint64_t size) const
+        {
+            if (size > static_cast<uint64_t>(end - it))
+            {
+                throw Exception(truncatedMessage);
+            }
+        }
+    };
+}
+
+#endif
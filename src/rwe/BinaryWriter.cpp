@@ -0,0 +1,33 @@
+#include "BinaryWriter.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace rwe
+{
+    BinaryWriter::BinaryWriter(std::vector<char>* buffer) : buffer(buffer)
+    {
+    }
+
+    void BinaryWriter::writeBytes(const void* data, std::size_t size)
+    {
+        const auto* begin = static_cast<const char*>(data);
+        buffer->insert(buffer->end(), begin, begin + size);
+    }
+
+    void BinaryWriter::writeSize(std::size_t size)
+    {
+        if (size > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::length_error("Sequence is too long to write");
+        }
+
+        write(static_cast<uint32_t>(size));
+    }
+
+    void BinaryWriter::writeString(const std::string& value)
+    {
+        writeSize(value.size());
+        writeBytes(value.data(), value.size());
+    }
+}
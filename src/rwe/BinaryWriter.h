@@ -0,0 +1,68 @@
+#ifndef RWE_BINARYWRITER_H
+#define RWE_BINARYWRITER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Appends values to a byte buffer, for the binary formats
+     * (compiled unit databases, map catalogs, replays, snapshots and lockstep packets).
+     *
+     * Numbers are always written little-endian, whatever the byte order of the machine,
+     * so that what one machine writes another can read. Read them back with BinaryReader.
+     */
+    class BinaryWriter
+    {
+    private:
+        std::vector<char>* buffer;
+
+    public:
+        explicit BinaryWriter(std::vector<char>* buffer);
+
+        /** Writes a number. Bools are written as one byte, 1 or 0. */
+        template <typename T>
+        void write(T value)
+        {
+            static_assert(std::is_arithmetic_v<T>);
+
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                write(static_cast<uint8_t>(value ? 1 : 0));
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                using Bits = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+                static_assert(sizeof(Bits) == sizeof(T));
+                Bits bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                write(bits);
+            }
+            else
+            {
+                auto bits = static_cast<std::make_unsigned_t<T>>(value);
+                char bytes[sizeof(T)];
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                {
+                    bytes[i] = static_cast<char>((static_cast<uint64_t>(bits) >> (8 * i)) & 0xff);
+                }
+                writeBytes(bytes, sizeof(T));
+            }
+        }
+
+        /** Writes the bytes as they are, in the byte order of the machine. */
+        void writeBytes(const void* data, std::size_t size);
+
+        /** Writes the size of a sequence as 32 bits. Throws std::length_error if it does not fit. */
+        void writeSize(std::size_t size);
+
+        /** Writes the string prefixed by its size. */
+        void writeString(const std::string& value);
+    };
+}
+
+#endif
@@ -0,0 +1,365 @@
+#ifndef RWE_BOUNDINGBOXBVH_H
+#define RWE_BOUNDINGBOXBVH_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <rwe/geometry/BoundingBox3f.h>
+#include <rwe/geometry/Line3f.h>
+#include <rwe/math/Vector3f.h>
+#include <utility>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * A bounding volume hierarchy over axis-aligned bounding boxes,
+     * for finding the first object hit by a line.
+     *
+     * The tree is built once with build and then kept up to date with refit,
+     * which recomputes the boxes of the nodes above objects that moved
+     * without changing the tree's shape.
+     * Refitting keeps queries correct,
+     * though the tree gets less tight as objects move far from where they were at build time,
+     * and must be followed by a rebuild when the set of objects changes.
+     */
+    template <typename T>
+    class BoundingBoxBvh
+    {
+    public:
+        struct Entry
+        {
+            T value;
+            BoundingBox3f box;
+        };
+
+    private:
+        static constexpr unsigned int MaxLeafSize = 4;
+
+        struct Item
+        {
+            T value;
+
+            /** The index of the object in the entries given to build. */
+            std::size_t entry;
+
+            Vector3f min;
+            Vector3f max;
+        };
+
+        /**
+         * A node of the tree.
+         * Nodes are stored in depth-first order, so a node's left child
+         * immediately follows it and every child comes after its parent.
+         */
+        struct Node
+        {
+            Vector3f min;
+            Vector3f max;
+
+            /** For leaves, the range of items in the leaf. */
+            std::size_t start;
+            std::size_t count;
+
+            /** For internal nodes, the index of the right child. */
+            std::size_t right;
+
+            bool isLeaf() const
+            {
+                return count != 0;
+            }
+        };
+
+        std::vector<Item> items;
+        std::vector<Node> nodes;
+
+        /** Scratch space for refit, marking the nodes whose boxes changed. */
+        std::vector<bool> changedNodes;
+
+    public:
+        std::size_t size() const
+        {
+            return items.size();
+        }
+
+        void clear()
+        {
+            items.clear();
+            nodes.clear();
+        }
+
+        void build(const std::vector<Entry>& entries)
+        {
+            clear();
+            items.reserve(entries.size());
+            for (std::size_t i = 0; i < entries.size(); ++i)
+            {
+                const auto& e = entries[i];
+                items.push_back(Item{e.value, i, e.box.center - e.box.extents, e.box.center + e.box.extents});
+            }
+
+            if (!items.empty())
+            {
+                nodes.reserve(2 * ((items.size() / MaxLeafSize) + 1));
+                buildNode(0, items.size());
+            }
+        }
+
+        /**
+         * Moves the objects to the given boxes, which are in the same order
+         * as the entries the tree was built from,
+         * and updates the boxes of the nodes above every object that moved.
+         * Nodes with no moved objects below them are left alone.
+         */
+        void refit(const std::vector<BoundingBox3f>& boxes)
+        {
+            assert(boxes.size() == items.size());
+
+            changedNodes.assign(nodes.size(), false);
+            for (auto i = nodes.size(); i-- > 0;)
+            {
+                auto& node = nodes[i];
+                if (node.isLeaf())
+                {
+                    bool changed = false;
+                    for (auto j = node.start; j < node.start + node.count; ++j)
+                    {
+                        auto& item = items[j];
+                        const auto& box = boxes[item.entry];
+                        auto min = box.center - box.extents;
+                        auto max = box.center + box.extents;
+                        if (min != item.min || max != item.max)
+                        {
+                            item.min = min;
+                            item.max = max;
+                            changed = true;
+                        }
+                    }
+
+                    if (changed)
+                    {
+                        setBoundsFromItems(node, node.start, node.start + node.count);
+                        changedNodes[i] = true;
+                    }
+                }
+                else if (changedNodes[i + 1] || changedNodes[node.right])
+                {
+                    const auto& left = nodes[i + 1];
+                    const auto& right = nodes[node.right];
+                    node.min = componentMin(left.min, right.min);
+                    node.max = componentMax(left.max, right.max);
+                    changedNodes[i] = true;
+                }
+            }
+        }
+
+        /**
+         * Finds the object along the line nearest its start.
+         * The narrowphase function tests the line against a candidate object
+         * and returns the fraction of the way along the line at which it hit, if it did.
+         * It is only called for objects whose boxes the line passes through,
+         * nearest boxes first, and objects whose boxes lie beyond the best hit so far
+         * are not tested at all.
+         * The hit returned by the narrowphase must lie within the object's box.
+         */
+        template <typename F>
+        std::optional<T> intersectLine(const Line3f& line, F&& narrowphase) const
+        {
+            if (nodes.empty())
+            {
+                return std::nullopt;
+            }
+
+            auto direction = line.end - line.start;
+            LineQuery query{line.start, direction, Vector3f(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z)};
+
+            std::optional<T> bestValue;
+            float bestT = std::numeric_limits<float>::infinity();
+
+            std::vector<std::pair<std::size_t, float>> stack;
+            if (auto t = intersectNode(nodes[0], query); t)
+            {
+                stack.emplace_back(0, *t);
+            }
+
+            while (!stack.empty())
+            {
+                auto [nodeIndex, enterT] = stack.back();
+                stack.pop_back();
+
+                if (enterT > bestT)
+                {
+                    continue;
+                }
+
+                const auto& node = nodes[nodeIndex];
+                if (node.isLeaf())
+                {
+                    for (auto i = node.start; i < node.start + node.count; ++i)
+                    {
+                        const auto& item = items[i];
+                        auto itemT = intersectBox(item.min, item.max, query);
+                        if (!itemT || *itemT > bestT)
+                        {
+                            continue;
+                        }
+
+                        std::optional<float> hitT = narrowphase(item.value);
+                        if (hitT && *hitT < bestT)
+                        {
+                            bestT = *hitT;
+                            bestValue = item.value;
+                        }
+                    }
+                    continue;
+                }
+
+                auto leftT = intersectNode(nodes[nodeIndex + 1], query);
+                auto rightT = intersectNode(nodes[node.right], query);
+
+                // push the farther child first so that the nearer one is visited first
+                if (leftT && rightT && *leftT < *rightT)
+                {
+                    stack.emplace_back(node.right, *rightT);
+                    stack.emplace_back(nodeIndex + 1, *leftT);
+                }
+                else
+                {
+                    if (leftT)
+                    {
+                        stack.emplace_back(nodeIndex + 1, *leftT);
+                    }
+                    if (rightT)
+                    {
+                        stack.emplace_back(node.right, *rightT);
+                    }
+                }
+            }
+
+            return bestValue;
+        }
+
+    private:
+        static Vector3f componentMin(const Vector3f& a, const Vector3f& b)
+        {
+            return Vector3f(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+        }
+
+        static Vector3f componentMax(const Vector3f& a, const Vector3f& b)
+        {
+            return Vector3f(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+        }
+
+        static float getAxis(const Vector3f& v, int axis)
+        {
+            return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+        }
+
+        struct LineQuery
+        {
+            Vector3f start;
+            Vector3f direction;
+            Vector3f inverseDirection;
+        };
+
+        /**
+         * Returns the fraction of the way along the line at which it enters the box,
+         * if the line touches the box at all.
+         * Uses the slab test with a precomputed reciprocal of the line direction.
+         */
+        static std::optional<float> intersectBox(const Vector3f& min, const Vector3f& max, const LineQuery& line)
+        {
+            float enter = 0.0f;
+            float exit = 1.0f;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                auto s = getAxis(line.start, axis);
+                auto slabMin = getAxis(min, axis);
+                auto slabMax = getAxis(max, axis);
+
+                if (getAxis(line.direction, axis) == 0.0f)
+                {
+                    if (s < slabMin || s > slabMax)
+                    {
+                        return std::nullopt;
+                    }
+                    continue;
+                }
+
+                auto inv = getAxis(line.inverseDirection, axis);
+                auto t1 = (slabMin - s) * inv;
+                auto t2 = (slabMax - s) * inv;
+                enter = std::max(enter, std::min(t1, t2));
+                exit = std::min(exit, std::max(t1, t2));
+            }
+
+            if (enter > exit)
+            {
+                return std::nullopt;
+            }
+
+            return enter;
+        }
+
+        static std::optional<float> intersectNode(const Node& node, const LineQuery& line)
+        {
+            return intersectBox(node.min, node.max, line);
+        }
+
+        void setBoundsFromItems(Node& node, std::size_t begin, std::size_t end)
+        {
+            node.min = items[begin].min;
+            node.max = items[begin].max;
+            for (auto i = begin + 1; i < end; ++i)
+            {
+                node.min = componentMin(node.min, items[i].min);
+                node.max = componentMax(node.max, items[i].max);
+            }
+        }
+
+        std::size_t buildNode(std::size_t begin, std::size_t end)
+        {
+            auto nodeIndex = nodes.size();
+            nodes.push_back(Node{Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.0f, 0.0f, 0.0f), begin, 0, 0});
+            setBoundsFromItems(nodes[nodeIndex], begin, end);
+
+            auto count = end - begin;
+            if (count <= MaxLeafSize)
+            {
+                nodes[nodeIndex].count = count;
+                return nodeIndex;
+            }
+
+            // split at the median item along the axis where the item centers are most spread out
+            auto centerMin = items[begin].min + items[begin].max;
+            auto centerMax = centerMin;
+            for (auto i = begin + 1; i < end; ++i)
+            {
+                auto center = items[i].min + items[i].max;
+                centerMin = componentMin(centerMin, center);
+                centerMax = componentMax(centerMax, center);
+            }
+            auto spread = centerMax - centerMin;
+            int axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+
+            auto mid = begin + (count / 2);
+            std::nth_element(
+                items.begin() + begin,
+                items.begin() + mid,
+                items.begin() + end,
+                [axis](const Item& a, const Item& b) {
+                    return getAxis(a.min + a.max, axis) < getAxis(b.min + b.max, axis);
+                });
+
+            buildNode(begin, mid);
+            auto right = buildNode(mid, end);
+            nodes[nodeIndex].right = right;
+
+            return nodeIndex;
+        }
+    };
+}
+
+#endif
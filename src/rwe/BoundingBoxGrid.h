@@ -0,0 +1,247 @@
+#ifndef RWE_BOUNDINGBOXGRID_H
+#define RWE_BOUNDINGBOXGRID_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <optional>
+#include <rwe/geometry/BoundingBox3f.h>
+#include <rwe/geometry/Line3f.h>
+#include <rwe/math/Vector3f.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * A broadphase index of axis-aligned bounding boxes
+     * over a uniform grid on the XZ plane.
+     *
+     * Boxes are added with insert and the index is made queryable with build,
+     * which buckets every box into each cell it overlaps.
+     * The intended use is to clear, insert and build once per tick
+     * and then run many queries against the result.
+     */
+    template <typename T>
+    class BoundingBoxGrid
+    {
+    public:
+        struct Entry
+        {
+            T value;
+            BoundingBox3f box;
+        };
+
+        struct SegmentHit
+        {
+            T value;
+
+            /** Fraction of the way along the segment at which the hit occurred. */
+            float t;
+        };
+
+    private:
+        float left;
+        float top;
+        float cellSize;
+        int width;
+        int height;
+
+        std::vector<Entry> entries;
+
+        /**
+         * For each cell, the offset in cellEntries at which its entries begin.
+         * Has one more element than there are cells,
+         * so the entries of cell i are [cellStarts[i], cellStarts[i + 1]).
+         */
+        std::vector<std::size_t> cellStarts;
+
+        /** Indices into entries, grouped by cell. */
+        std::vector<std::size_t> cellEntries;
+
+    public:
+        /**
+         * Creates a grid covering the given area of the XZ plane.
+         * Boxes outside the area are clamped into the cells at its edge.
+         */
+        BoundingBoxGrid(float left, float top, float widthInWorldUnits, float heightInWorldUnits, float cellSize)
+            : left(left),
+              top(top),
+              cellSize(cellSize),
+              width(std::max(1, static_cast<int>(std::ceil(widthInWorldUnits / cellSize)))),
+              height(std::max(1, static_cast<int>(std::ceil(heightInWorldUnits / cellSize)))),
+              cellStarts(static_cast<std::size_t>(width * height) + 1, 0)
+        {
+        }
+
+        void clear()
+        {
+            entries.clear();
+            cellEntries.clear();
+            std::fill(cellStarts.begin(), cellStarts.end(), 0);
+        }
+
+        /** Adds a box. It will not be visible to queries until the next call to build. */
+        void insert(const T& value, const BoundingBox3f& box)
+        {
+            entries.push_back(Entry{value, box});
+        }
+
+        /** Buckets all inserted boxes into cells with a counting sort. */
+        void build()
+        {
+            std::fill(cellStarts.begin(), cellStarts.end(), 0);
+
+            for (const auto& e : entries)
+            {
+                auto range = getCellRange(e.box);
+                for (int y = range.minY; y <= range.maxY; ++y)
+                {
+                    for (int x = range.minX; x <= range.maxX; ++x)
+                    {
+                        ++cellStarts[toIndex(x, y) + 1];
+                    }
+                }
+            }
+
+            for (std::size_t i = 1; i < cellStarts.size(); ++i)
+            {
+                cellStarts[i] += cellStarts[i - 1];
+            }
+
+            cellEntries.resize(cellStarts.back());
+
+            std::vector<std::size_t> cursors(cellStarts.begin(), cellStarts.end() - 1);
+            for (std::size_t i = 0; i < entries.size(); ++i)
+            {
+                auto range = getCellRange(entries[i].box);
+                for (int y = range.minY; y <= range.maxY; ++y)
+                {
+                    for (int x = range.minX; x <= range.maxX; ++x)
+                    {
+                        cellEntries[cursors[toIndex(x, y)]++] = i;
+                    }
+                }
+            }
+        }
+
+        const std::vector<Entry>& getEntries() const
+        {
+            return entries;
+        }
+
+        /**
+         * Calls the given function once for every box
+         * whose XZ extents overlap the given XZ rectangle.
+         */
+        template <typename F>
+        void forEachInArea(float minX, float minZ, float maxX, float maxZ, F&& f) const
+        {
+            auto range = getCellRange(minX, minZ, maxX, maxZ);
+            for (int y = range.minY; y <= range.maxY; ++y)
+            {
+                for (int x = range.minX; x <= range.maxX; ++x)
+                {
+                    auto cellIndex = toIndex(x, y);
+                    for (auto i = cellStarts[cellIndex]; i < cellStarts[cellIndex + 1]; ++i)
+                    {
+                        const auto& e = entries[cellEntries[i]];
+                        auto boxMin = e.box.center - e.box.extents;
+                        auto boxMax = e.box.center + e.box.extents;
+                        if (boxMax.x < minX || boxMin.x > maxX || boxMax.z < minZ || boxMin.z > maxZ)
+                        {
+                            continue;
+                        }
+
+                        // A box spanning several cells is stored in each of them.
+                        // Only report it from the cell containing the corner of its overlap
+                        // with the query area, so that it is reported exactly once.
+                        auto ownerX = toCellX(std::max(boxMin.x, minX));
+                        auto ownerY = toCellY(std::max(boxMin.z, minZ));
+                        if (ownerX != x || ownerY != y)
+                        {
+                            continue;
+                        }
+
+                        f(e);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Finds the box that the segment touches first,
+         * considering only boxes whose values pass the given predicate.
+         */
+        template <typename Predicate>
+        std::optional<SegmentHit> intersectLine(const Line3f& line, Predicate&& accept) const
+        {
+            std::optional<SegmentHit> best;
+
+            auto minX = std::min(line.start.x, line.end.x);
+            auto maxX = std::max(line.start.x, line.end.x);
+            auto minZ = std::min(line.start.z, line.end.z);
+            auto maxZ = std::max(line.start.z, line.end.z);
+
+            forEachInArea(minX, minZ, maxX, maxZ, [&](const Entry& e) {
+                if (best && best->t == 0.0f)
+                {
+                    return;
+                }
+
+                auto t = e.box.intersectLine(line);
+                if (!t || (best && *t >= best->t))
+                {
+                    return;
+                }
+
+                if (!accept(e.value))
+                {
+                    return;
+                }
+
+                best = SegmentHit{e.value, *t};
+            });
+
+            return best;
+        }
+
+    private:
+        struct CellRange
+        {
+            int minX;
+            int minY;
+            int maxX;
+            int maxY;
+        };
+
+        int toCellX(float x) const
+        {
+            return std::clamp(static_cast<int>(std::floor((x - left) / cellSize)), 0, width - 1);
+        }
+
+        int toCellY(float z) const
+        {
+            return std::clamp(static_cast<int>(std::floor((z - top) / cellSize)), 0, height - 1);
+        }
+
+        std::size_t toIndex(int x, int y) const
+        {
+            assert(x >= 0 && x < width && y >= 0 && y < height);
+            return (static_cast<std::size_t>(y) * width) + x;
+        }
+
+        CellRange getCellRange(float minX, float minZ, float maxX, float maxZ) const
+        {
+            return CellRange{toCellX(minX), toCellY(minZ), toCellX(maxX), toCellY(maxZ)};
+        }
+
+        CellRange getCellRange(const BoundingBox3f& box) const
+        {
+            auto min = box.center - box.extents;
+            auto max = box.center + box.extents;
+            return getCellRange(min.x, min.z, max.x, max.z);
+        }
+    };
+}
+
+#endif
@@ -1,10 +1,15 @@
 #ifndef RWE_BOXTREE_H
 #define RWE_BOXTREE_H
 
+#include <algorithm>
 #include <boost/variant.hpp>
+#include <cmath>
 #include <memory>
 #include <optional>
 #include <rwe/Grid.h>
+#include <rwe/SkylinePacker.h>
+#include <rwe/math/rwe_math.h>
+#include <utility>
 #include <vector>
 
 namespace rwe
@@ -305,35 +310,45 @@ namespace rwe
         Size(std::size_t width, std::size_t height);
     };
 
+    /**
+     * Packs items by growing a binary tree of free boxes from the largest item.
+     * Superseded by the skyline packer in packGridsGeneric,
+     * kept for comparison.
+     */
     template <typename T>
-    BoxPackInfo<T> packGridsGeneric(std::vector<T>& items, const std::function<Size(const T&)>& f)
+    BoxPackInfo<T> packGridsBoxTree(std::vector<T>& items, const std::function<Size(const T&)>& f)
     {
         assert(!items.empty());
 
-        std::sort(items.begin(), items.end(), [&f](const T& a, const T& b) {
-            auto sizeA = f(a);
-            auto maxSideA = std::max(sizeA.width, sizeA.height);
-
-            auto sizeB = f(b);
-            auto maxSideB = std::max(sizeB.width, sizeB.height);
+        // Measure every item once up front, the sort would otherwise
+        // call the size function twice per comparison.
+        std::vector<std::pair<Size, T>> sizedItems;
+        sizedItems.reserve(items.size());
+        for (const auto& item : items)
+        {
+            sizedItems.emplace_back(f(item), item);
+        }
 
+        std::sort(sizedItems.begin(), sizedItems.end(), [](const auto& a, const auto& b) {
+            auto maxSideA = std::max(a.first.width, a.first.height);
+            auto maxSideB = std::max(b.first.width, b.first.height);
             return maxSideA > maxSideB;
         });
 
+        for (std::size_t i = 0; i < sizedItems.size(); ++i)
+        {
+            items[i] = sizedItems[i].second;
+        }
 
-        auto it = items.begin();
-        auto end = items.end();
+        auto it = sizedItems.begin();
+        auto end = sizedItems.end();
 
-        auto rootSize = f(*it);
-        BoxTree<T> tree(rootSize.width, rootSize.height, *it);
+        BoxTree<T> tree(it->first.width, it->first.height, it->second);
         ++it;
 
         for (; it != end; ++it)
         {
-            auto size = f(*it);
-            auto width = size.width;
-            auto height = size.height;
-            tree.insert(width, height, *it);
+            tree.insert(it->first.width, it->first.height, it->second);
         }
 
         auto entries = tree.root->walk();
@@ -341,6 +356,63 @@ namespace rwe
     }
 
 
+    /**
+     * Packs items into a single area, returning the position of each item.
+     * Items are placed by a skyline packer in order of decreasing height
+     * into an area whose width is the larger of the widest item
+     * and the square root of the total area rounded up to a power of two.
+     * The size returned by f is the exact area reserved for each item,
+     * so callers that round sizes up to powers of two keep that padding,
+     * and such items are placed at multiples of their size
+     * so that mipmapping the packed area does not bleed them into each other.
+     *
+     * As a side effect, items is left in the order the items were placed.
+     */
+    template <typename T>
+    BoxPackInfo<T> packGridsGeneric(std::vector<T>& items, const std::function<Size(const T&)>& f)
+    {
+        assert(!items.empty());
+
+        std::vector<std::pair<Size, T>> sizedItems;
+        sizedItems.reserve(items.size());
+        for (const auto& item : items)
+        {
+            sizedItems.emplace_back(f(item), item);
+        }
+
+        std::sort(sizedItems.begin(), sizedItems.end(), [](const auto& a, const auto& b) {
+            if (a.first.height != b.first.height)
+            {
+                return a.first.height > b.first.height;
+            }
+
+            return a.first.width > b.first.width;
+        });
+
+        std::size_t totalArea = 0;
+        std::size_t widestItem = 0;
+        for (std::size_t i = 0; i < sizedItems.size(); ++i)
+        {
+            items[i] = sizedItems[i].second;
+            totalArea += sizedItems[i].first.width * sizedItems[i].first.height;
+            widestItem = std::max(widestItem, sizedItems[i].first.width);
+        }
+
+        auto side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(totalArea))));
+        auto width = std::max({1u, static_cast<unsigned int>(widestItem), roundUpToPowerOfTwo(side)});
+
+        SkylinePacker packer(width);
+        std::vector<BoxPackInfoEntry<T>> entries;
+        entries.reserve(sizedItems.size());
+        for (const auto& item : sizedItems)
+        {
+            auto pos = packer.insert(item.first.width, item.first.height);
+            entries.push_back(BoxPackInfoEntry<T>{pos.x, pos.y, item.second});
+        }
+
+        return BoxPackInfo<T>{packer.getWidth(), packer.getHeight(), std::move(entries)};
+    }
+
     template <typename T>
     BoxPackInfo<Grid<T>*> packGrids(std::vector<Grid<T>*>& sprites)
     {
@@ -36,7 +36,7 @@ namespace rwe
         std::vector<uint32_t> instructions;
         std::vector<std::string> pieces;
         std::vector<CobFunctionInfo> functions;
-        unsigned int staticVariableCount;
+        unsigned int staticVariableCount{0};
     };
 
     CobScript parseCob(std::istream& stream);
@@ -0,0 +1,592 @@
+#include "CompiledUnitDatabase.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <rwe/BinaryReader.h>
+#include <rwe/BinaryWriter.h>
+#include <rwe/UnitDatabase.h>
+#include <tuple>
+
+namespace rwe
+{
+    namespace
+    {
+        /** Appends values to a byte buffer in the compiled database layout. */
+        class CompiledUnitDatabaseWriter
+        {
+        private:
+            std::vector<char> buffer;
+            BinaryWriter writer{&buffer};
+
+        public:
+            CompiledUnitDatabaseWriter() = default;
+
+            CompiledUnitDatabaseWriter(const CompiledUnitDatabaseWriter&) = delete;
+
+            CompiledUnitDatabaseWriter& operator=(const CompiledUnitDatabaseWriter&) = delete;
+
+            const std::vector<char>& data() const { return buffer; }
+
+            void field(uint32_t value) { writer.write(value); }
+
+            void field(uint64_t value) { writer.write(value); }
+
+            void field(float value) { writer.write(value); }
+
+            void field(bool value) { writer.write(value); }
+
+            void field(const std::string& value) { writer.writeString(value); }
+
+            void field(const std::optional<std::string>& value)
+            {
+                field(static_cast<bool>(value));
+                if (value)
+                {
+                    field(*value);
+                }
+            }
+
+            template <typename A, typename B>
+            void field(const std::pair<A, B>& value)
+            {
+                field(value.first);
+                field(value.second);
+            }
+
+            template <typename T>
+            void field(const std::vector<T>& value)
+            {
+                writer.writeSize(value.size());
+                for (const auto& e : value)
+                {
+                    field(e);
+                }
+            }
+
+            template <typename T>
+            void field(const T& value)
+            {
+                transferFields(*this, value);
+            }
+
+            /** Writes bytes prefixed by their length, so that a reader can skip over them. */
+            void blob(const std::vector<char>& value)
+            {
+                writer.writeSize(value.size());
+                writer.writeBytes(value.data(), value.size());
+            }
+        };
+
+        /** Reads values back out of a compiled database held in memory. */
+        class CompiledUnitDatabaseReader
+        {
+        private:
+            BinaryReader<CompiledUnitDatabaseException> reader;
+
+        public:
+            CompiledUnitDatabaseReader(const char* begin, const char* end)
+                : reader(begin, end, "Compiled unit database is truncated")
+            {
+            }
+
+            void field(uint32_t& value) { value = reader.read<uint32_t>(); }
+
+            void field(uint64_t& value) { value = reader.read<uint64_t>(); }
+
+            void field(float& value) { value = reader.read<float>(); }
+
+            void field(bool& value) { value = reader.read<bool>(); }
+
+            void field(std::string& value) { value = reader.readString(); }
+
+            void field(std::optional<std::string>& value)
+            {
+                bool present;
+                field(present);
+                if (present)
+                {
+                    value.emplace();
+                    field(*value);
+                }
+                else
+                {
+                    value = std::nullopt;
+                }
+            }
+
+            template <typename A, typename B>
+            void field(std::pair<A, B>& value)
+            {
+                field(value.first);
+                field(value.second);
+            }
+
+            void field(std::vector<uint32_t>& value)
+            {
+                auto size = readSize(sizeof(uint32_t));
+                value.resize(size);
+                for (auto& e : value)
+                {
+                    e = reader.read<uint32_t>();
+                }
+            }
+
+            template <typename T>
+            void field(std::vector<T>& value)
+            {
+                // Every element takes at least one byte,
+                // so a corrupt count cannot make us allocate more than the file size.
+                auto size = readSize(1);
+                value.clear();
+                value.reserve(size);
+                for (uint32_t i = 0; i < size; ++i)
+                {
+                    value.emplace_back();
+                    field(value.back());
+                }
+            }
+
+            template <typename T>
+            void field(T& value)
+            {
+                transferFields(*this, value);
+            }
+
+            /** Skips over bytes written by CompiledUnitDatabaseWriter::blob, returning where they are. */
+            std::pair<const char*, const char*> blob()
+            {
+                auto size = readSize(1);
+                auto begin = reader.skip(size);
+                return {begin, begin + size};
+            }
+
+            /** Reads the length of a sequence whose elements are each at least the given size. */
+            uint32_t readSize(std::size_t minimumElementSize)
+            {
+                return reader.readSize(minimumElementSize);
+            }
+        };
+
+        // The field lists below are shared by the reader and the writer,
+        // so the two cannot disagree about the layout.
+        // Adding a field to one of these structs requires bumping CompiledUnitDatabaseVersion.
+
+        template <typename Archive, typename T>
+        std::enable_if_t<std::is_same_v<std::remove_const_t<T>, SoundClass>> transferFields(Archive& a, T& v)
+        {
+            a.field(v.select1);
+            a.field(v.ok1);
+            a.field(v.arrived1);
+            a.field(v.cant1);
+            a.field(v.underAttack);
+            a.field(v.count5);
+            a.field(v.count4);
+            a.field(v.count3);
+            a.field(v.count2);
+            a.field(v.count1);
+            a.field(v.count0);
+            a.field(v.cancelDestruct);
+        }
+
+        template <typename Archive, typename T>
+        std::enable_if_t<std::is_same_v<std::remove_const_t<T>, MovementClass>> transferFields(Archive& a, T& v)
+        {
+            a.field(v.name);
+            a.field(v.footprintX);
+            a.field(v.footprintZ);
+            a.field(v.minWaterDepth);
+            a.field(v.maxWaterDepth);
+            a.field(v.maxSlope);
+            a.field(v.maxWaterSlope);
+        }
+
+        template <typename Archive, typename T>
+        std::enable_if_t<std::is_same_v<std::remove_const_t<T>, WeaponTdf>> transferFields(Archive& a, T& v)
+        {
+            a.field(v.id);
+            a.field(v.name);
+            a.field(v.range);
+            a.field(v.ballistic);
+            a.field(v.lineOfSight);
+            a.field(v.dropped);
+            a.field(v.vLaunch);
+            a.field(v.noExplode);
+            a.field(v.reloadTime);
+            a.field(v.energyPerShot);
+            a.field(v.metalPerShot);
+            a.field(v.weaponTimer);
+            a.field(v.noAutoRange);
+            a.field(v.weaponVelocity);
+            a.field(v.weaponAcceleration);
+            a.field(v.areaOfEffect);
+            a.field(v.edgeEffectiveness);
+            a.field(v.turret);
+            a.field(v.fireStarter);
+            a.field(v.unitsOnly);
+            a.field(v.burst);
+            a.field(v.burstRate);
+            a.field(v.sprayAngle);
+            a.field(v.randomDecay);
+            a.field(v.groundBounce);
+            a.field(v.flightTime);
+            a.field(v.selfProp);
+            a.field(v.twoPhase);
+            a.field(v.guidance);
+            a.field(v.turnRate);
+            a.field(v.cruise);
+            a.field(v.tracks);
+            a.field(v.waterWeapon);
+            a.field(v.burnBlow);
+            a.field(v.accuracy);
+            a.field(v.tolerance);
+            a.field(v.pitchTolerance);
+            a.field(v.aimRate);
+            a.field(v.holdTime);
+            a.field(v.stockpile);
+            a.field(v.interceptor);
+            a.field(v.coverage);
+            a.field(v.targetable);
+            a.field(v.toAirWeapon);
+            a.field(v.startVelocity);
+            a.field(v.minBarrelAngle);
+            a.field(v.paralyzer);
+            a.field(v.noRadar);
+            a.field(v.model);
+            a.field(v.color);
+            a.field(v.color2);
+            a.field(v.smokeTrail);
+            a.field(v.smokeDelay);
+            a.field(v.startSmoke);
+            a.field(v.endSmoke);
+            a.field(v.renderType);
+            a.field(v.beamWeapon);
+            a.field(v.duration);
+            a.field(v.explosionGaf);
+            a.field(v.explosionArt);
+            a.field(v.waterExplosionGaf);
+            a.field(v.waterExplosionArt);
+            a.field(v.lavaExplosionGaf);
+            a.field(v.lavaExplosionArt);
+            a.field(v.propeller);
+            a.field(v.soundStart);
+            a.field(v.soundHit);
+            a.field(v.soundWater);
+            a.field(v.soundTrigger);
+            a.field(v.commandFire);
+            a.field(v.shakeMagnitude);
+            a.field(v.shakeDuration);
+            a.field(v.energy);
+            a.field(v.metal);
+            a.field(v.damage);
+            a.field(v.weaponType2);
+        }
+
+        template <typename Archive, typename T>
+        std::enable_if_t<std::is_same_v<std::remove_const_t<T>, UnitFbi>> transferFields(Archive& a, T& v)
+        {
+            a.field(v.unitName);
+            a.field(v.objectName);
+            a.field(v.soundCategory);
+            a.field(v.movementClass);
+            a.field(v.turnRate);
+            a.field(v.maxVelocity);
+            a.field(v.acceleration);
+            a.field(v.brakeRate);
+            a.field(v.footprintX);
+            a.field(v.footprintZ);
+            a.field(v.maxSlope);
+            a.field(v.maxWaterSlope);
+            a.field(v.minWaterDepth);
+            a.field(v.maxWaterDepth);
+            a.field(v.canAttack);
+            a.field(v.commander);
+            a.field(v.maxDamage);
+            a.field(v.sightDistance);
+            a.field(v.radarDistance);
+            a.field(v.bmCode);
+            a.field(v.weapon1);
+            a.field(v.weapon2);
+            a.field(v.weapon3);
+            a.field(v.explodeAs);
+        }
+
+        template <typename Archive, typename T>
+        std::enable_if_t<std::is_same_v<std::remove_const_t<T>, CobFunctionInfo>> transferFields(Archive& a, T& v)
+        {
+            a.field(v.name);
+            a.field(v.address);
+        }
+
+        template <typename Archive, typename T>
+        std::enable_if_t<std::is_same_v<std::remove_const_t<T>, CobScript>> transferFields(Archive& a, T& v)
+        {
+            a.field(v.instructions);
+            a.field(v.pieces);
+            a.field(v.functions);
+            a.field(v.staticVariableCount);
+        }
+
+        /**
+         * Writes named entries so that each can be found without decoding the others:
+         * every entry's fields are written as one blob.
+         */
+        template <typename T>
+        void writeEntries(CompiledUnitDatabaseWriter& writer, const std::vector<std::pair<std::string, T>>& entries)
+        {
+            writer.field(static_cast<uint32_t>(entries.size()));
+            for (const auto& entry : entries)
+            {
+                CompiledUnitDatabaseWriter entryWriter;
+                entryWriter.field(entry.second);
+
+                writer.field(entry.first);
+                writer.blob(entryWriter.data());
+            }
+        }
+
+        /** Locates entries written by writeEntries, returning a loader that decodes each one from the mapped file. */
+        template <typename T>
+        void readEntries(
+            CompiledUnitDatabaseReader& reader,
+            const std::shared_ptr<const boost::interprocess::mapped_region>& region,
+            std::vector<std::pair<std::string, std::function<T()>>>& entries)
+        {
+            // each entry is at least a name length and a blob length
+            auto size = reader.readSize(2 * sizeof(uint32_t));
+            entries.clear();
+            entries.reserve(size);
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                std::string name;
+                reader.field(name);
+                auto bytes = reader.blob();
+                entries.emplace_back(std::move(name), [region, bytes]() {
+                    CompiledUnitDatabaseReader entryReader(bytes.first, bytes.second);
+                    T value;
+                    entryReader.field(value);
+                    return value;
+                });
+            }
+        }
+
+        std::string stripExtension(const std::string& fileName)
+        {
+            return fileName.substr(0, fileName.size() - 4);
+        }
+
+        /**
+         * The directories that loose files can feed the cached data from.
+         * Loose files anywhere else, like music or videos, cannot affect it,
+         * so they are not worth walking on every launch.
+         */
+        const char* const FingerprintedDirectories[] = {"gamedata", "maps", "scripts", "units", "weapons"};
+
+        /** (path relative to the search path, size, last write time) */
+        using FileStat = std::tuple<std::string, uint64_t, int64_t>;
+
+        void addFileStat(const boost::filesystem::path& searchPath, const boost::filesystem::path& file, std::vector<FileStat>& entries)
+        {
+            namespace fs = boost::filesystem;
+            entries.emplace_back(
+                fs::relative(file, searchPath).generic_string(),
+                static_cast<uint64_t>(fs::file_size(file)),
+                static_cast<int64_t>(fs::last_write_time(file)));
+        }
+
+        void fnv1a(uint64_t& hash, const void* data, std::size_t size)
+        {
+            auto bytes = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3;
+            }
+        }
+    }
+
+    CompiledUnitDatabaseException::CompiledUnitDatabaseException(const char* message) : runtime_error(message)
+    {
+    }
+
+    uint64_t computeDataFingerprint(const boost::filesystem::path& searchPath)
+    {
+        namespace fs = boost::filesystem;
+
+        std::vector<FileStat> entries;
+
+        if (fs::is_directory(searchPath))
+        {
+            // Archives are only looked for at the top level.
+            // Their sizes and write times stand in for their contents.
+            for (fs::directory_iterator it(searchPath), end; it != end; ++it)
+            {
+                if (fs::is_regular_file(it->status()))
+                {
+                    addFileStat(searchPath, it->path(), entries);
+                }
+            }
+
+            for (const auto& directory : FingerprintedDirectories)
+            {
+                auto directoryPath = searchPath / directory;
+                if (!fs::is_directory(directoryPath))
+                {
+                    continue;
+                }
+
+                for (fs::recursive_directory_iterator it(directoryPath), end; it != end; ++it)
+                {
+                    if (fs::is_regular_file(it->status()))
+                    {
+                        addFileStat(searchPath, it->path(), entries);
+                    }
+                }
+            }
+        }
+
+        // directory iteration order is unspecified
+        std::sort(entries.begin(), entries.end());
+
+        uint64_t hash = 0xcbf29ce484222325;
+        for (const auto& e : entries)
+        {
+            const auto& path = std::get<0>(e);
+            fnv1a(hash, path.data(), path.size() + 1); // include the terminator as a separator
+            fnv1a(hash, &std::get<1>(e), sizeof(uint64_t));
+            fnv1a(hash, &std::get<2>(e), sizeof(int64_t));
+        }
+
+        return hash;
+    }
+
+    CompiledUnitDatabase compileUnitDatabase(AbstractVirtualFileSystem& vfs, ThreadPool& threadPool)
+    {
+        auto soundsFuture = threadPool.submit([&vfs]() { return loadSoundClasses(vfs); });
+
+        auto movementClassesFuture = threadPool.submit([&vfs]() { return loadMovementClasses(vfs); });
+
+        std::vector<std::future<std::vector<std::pair<std::string, WeaponTdf>>>> weaponFutures;
+        for (const auto& fileName : vfs.getFileNames("weapons", ".tdf"))
+        {
+            weaponFutures.push_back(threadPool.submit([&vfs, fileName]() { return loadWeaponTdf(vfs, "weapons/" + fileName); }));
+        }
+
+        std::vector<std::pair<std::string, std::future<UnitFbi>>> unitFutures;
+        for (const auto& fileName : vfs.getFileNames("units", ".fbi"))
+        {
+            unitFutures.emplace_back(
+                stripExtension(fileName),
+                threadPool.submit([&vfs, fileName]() { return loadUnitFbi(vfs, "units/" + fileName); }));
+        }
+
+        std::vector<std::pair<std::string, std::future<CobScript>>> scriptFutures;
+        for (const auto& fileName : vfs.getFileNames("scripts", ".cob"))
+        {
+            scriptFutures.emplace_back(
+                stripExtension(fileName),
+                threadPool.submit([&vfs, fileName]() { return loadUnitScript(vfs, "scripts/" + fileName); }));
+        }
+
+        CompiledUnitDatabase db;
+        db.soundClasses = soundsFuture.get();
+        db.movementClasses = movementClassesFuture.get();
+
+        for (auto& future : weaponFutures)
+        {
+            for (auto& pair : future.get())
+            {
+                db.weapons.push_back(std::move(pair));
+            }
+        }
+
+        for (auto& pair : unitFutures)
+        {
+            db.units.emplace_back(pair.first, pair.second.get());
+        }
+
+        for (auto& pair : scriptFutures)
+        {
+            db.scripts.emplace_back(pair.first, pair.second.get());
+        }
+
+        return db;
+    }
+
+    void writeCompiledUnitDatabase(const std::string& path, uint64_t dataFingerprint, const CompiledUnitDatabase& db)
+    {
+        CompiledUnitDatabaseWriter writer;
+        writer.field(CompiledUnitDatabaseMagicNumber);
+        writer.field(CompiledUnitDatabaseVersion);
+        writer.field(dataFingerprint);
+        writer.field(db.soundClasses);
+        writer.field(db.movementClasses);
+        writer.field(db.weapons);
+        writeEntries(writer, db.units);
+        writeEntries(writer, db.scripts);
+
+        // Write to a temporary file first so that a reader
+        // never sees a partially written database.
+        auto tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(writer.data().data(), writer.data().size());
+            if (!out)
+            {
+                throw std::runtime_error("Failed to write " + tempPath);
+            }
+        }
+
+        boost::filesystem::rename(tempPath, path);
+    }
+
+    std::optional<MappedCompiledUnitDatabase> readCompiledUnitDatabase(const std::string& path, uint64_t dataFingerprint)
+    {
+        namespace bip = boost::interprocess;
+
+        boost::system::error_code ec;
+        auto fileSize = boost::filesystem::file_size(path, ec);
+        if (ec || fileSize == 0)
+        {
+            return std::nullopt;
+        }
+
+        // The region outlives the file mapping object,
+        // and is kept alive by the loaders of the entries in it.
+        bip::file_mapping file(path.c_str(), bip::read_only);
+        auto region = std::make_shared<const bip::mapped_region>(file, bip::read_only);
+        auto begin = static_cast<const char*>(region->get_address());
+        CompiledUnitDatabaseReader reader(begin, begin + region->get_size());
+
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fingerprint;
+        try
+        {
+            reader.field(magic);
+            reader.field(version);
+            reader.field(fingerprint);
+        }
+        catch (const CompiledUnitDatabaseException&)
+        {
+            return std::nullopt;
+        }
+
+        if (magic != CompiledUnitDatabaseMagicNumber || version != CompiledUnitDatabaseVersion || fingerprint != dataFingerprint)
+        {
+            return std::nullopt;
+        }
+
+        MappedCompiledUnitDatabase db;
+        reader.field(db.soundClasses);
+        reader.field(db.movementClasses);
+        reader.field(db.weapons);
+        readEntries(reader, region, db.units);
+        readEntries(reader, region, db.scripts);
+        return db;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef RWE_COMPILEDUNITDATABASE_H
+#define RWE_COMPILEDUNITDATABASE_H
+
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <rwe/Cob.h>
+#include <rwe/MovementClass.h>
+#include <rwe/SoundClass.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/UnitFbi.h>
+#include <rwe/WeaponTdf.h>
+#include <rwe/vfs/AbstractVirtualFileSystem.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rwe
+{
+    /** The magic number at the start of a compiled unit database ("RWEU"). */
+    static const uint32_t CompiledUnitDatabaseMagicNumber = 0x55455752;
+
+    /**
+     * The version of the compiled unit database format.
+     * Bump this whenever the layout or any of the serialized structs change.
+     */
+    static const uint32_t CompiledUnitDatabaseVersion = 3;
+
+    /**
+     * A fully parsed snapshot of the game data that goes into a UnitDatabase,
+     * which can be saved to disk so that startup can skip TDF and COB parsing.
+     *
+     * Units and scripts are keyed by file name without extension,
+     * matching the keys UnitDatabase uses for lazily registered entries.
+     */
+    struct CompiledUnitDatabase
+    {
+        std::vector<std::pair<std::string, SoundClass>> soundClasses;
+        std::vector<std::pair<std::string, MovementClass>> movementClasses;
+        std::vector<std::pair<std::string, WeaponTdf>> weapons;
+        std::vector<std::pair<std::string, UnitFbi>> units;
+        std::vector<std::pair<std::string, CobScript>> scripts;
+    };
+
+    /**
+     * A compiled unit database opened from disk.
+     *
+     * Sound classes, movement classes and weapons are small and every game needs them,
+     * so they are decoded when the file is read.
+     * Unit FBIs and scripts are only located,
+     * and each is decoded straight from the memory-mapped file when its loader is called,
+     * so that UnitDatabase can keep them lazy.
+     * The loaders keep the file mapped and may be called from any thread.
+     * They throw CompiledUnitDatabaseException if the entry is corrupt.
+     */
+    struct MappedCompiledUnitDatabase
+    {
+        std::vector<std::pair<std::string, SoundClass>> soundClasses;
+        std::vector<std::pair<std::string, MovementClass>> movementClasses;
+        std::vector<std::pair<std::string, WeaponTdf>> weapons;
+        std::vector<std::pair<std::string, std::function<UnitFbi()>>> units;
+        std::vector<std::pair<std::string, std::function<CobScript()>>> scripts;
+    };
+
+    /** Where to find a compiled unit database and the data it must match. */
+    struct CompiledUnitDatabaseInfo
+    {
+        std::string path;
+        uint64_t dataFingerprint;
+    };
+
+    class CompiledUnitDatabaseException : public std::runtime_error
+    {
+    public:
+        explicit CompiledUnitDatabaseException(const char* message);
+    };
+
+    /**
+     * Computes a fingerprint of the game data under the given data directory
+     * from file paths, sizes and modification times, without reading any file.
+     * Covers the archives at the top level and the loose files
+     * in the directories that unit and map data are read from.
+     * Any change to that data changes the fingerprint.
+     */
+    uint64_t computeDataFingerprint(const boost::filesystem::path& searchPath);
+
+    /** Reads and parses all unit data from the VFS, in parallel on the thread pool. */
+    CompiledUnitDatabase compileUnitDatabase(AbstractVirtualFileSystem& vfs, ThreadPool& threadPool);
+
+    void writeCompiledUnitDatabase(const std::string& path, uint64_t dataFingerprint, const CompiledUnitDatabase& db);
+
+    /**
+     * Opens a compiled unit database by memory-mapping the file.
+     * Returns nothing if the file does not exist, was written by a different format version,
+     * or was built from different game data.
+     * Throws CompiledUnitDatabaseException if the file is corrupt.
+     */
+    std::optional<MappedCompiledUnitDatabase> readCompiledUnitDatabase(const std::string& path, uint64_t dataFingerprint);
+}
+
+#endif
@@ -74,7 +74,7 @@ namespace rwe
             }
         }
 
-        std::fill_n(buffer, rowLength - writePos, transparencyIndex);
+        std::fill_n(buffer + writePos, rowLength - writePos, transparencyIndex);
     }
 
     void decompressFrame(std::istream& stream, char* buffer, std::size_t width, std::size_t height, char transparencyIndex)
@@ -135,7 +135,7 @@ namespace rwe
 
     std::optional<std::reference_wrapper<const GafArchive::Entry>> GafArchive::findEntry(const std::string& name) const
     {
-        auto pos = std::find_if(_entries.begin(), _entries.end(), [&name](const Entry& e) { return toUpper(e.name) == toUpper(name); });
+        auto pos = std::find_if(_entries.begin(), _entries.end(), [&name](const Entry& e) { return equalsIgnoreCase(e.name, name); });
 
         if (pos == _entries.end())
         {
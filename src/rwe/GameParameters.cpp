@@ -0,0 +1,165 @@
+#include "GameParameters.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace rwe
+{
+    GameParameters::GameParameters(const std::string& mapName, unsigned int schemaIndex)
+        : mapName(mapName),
+          schemaIndex(schemaIndex)
+    {
+    }
+
+    unsigned int makeGameSeed()
+    {
+        std::random_device device;
+        return device();
+    }
+
+    std::array<std::optional<PlayerId>, 10> addGamePlayers(GameSimulation& simulation, const GameParameters& parameters)
+    {
+        std::array<std::optional<PlayerId>, 10> gamePlayers;
+        for (std::size_t i = 0; i < parameters.players.size(); ++i)
+        {
+            const auto& params = parameters.players[i];
+            if (params)
+            {
+                gamePlayers[i] = simulation.addPlayer(GamePlayerInfo{params->color, GamePlayerStatus::Alive});
+            }
+        }
+
+        return gamePlayers;
+    }
+
+    namespace
+    {
+        unsigned int parseNetworkNumber(const std::string& spec, const std::string& text, unsigned int max)
+        {
+            if (text.empty() || !std::all_of(text.begin(), text.end(), [](unsigned char c) { return c >= '0' && c <= '9'; }) || text.size() > 5)
+            {
+                throw std::runtime_error("Invalid network address: " + spec);
+            }
+
+            auto value = std::stoul(text);
+            if (value > max)
+            {
+                throw std::runtime_error("Invalid network address: " + spec);
+            }
+
+            return static_cast<unsigned int>(value);
+        }
+
+        unsigned int parseNetworkSlot(const std::string& spec, const std::string& text)
+        {
+            return parseNetworkNumber(spec, text, std::tuple_size<decltype(GameParameters::players)>::value - 1);
+        }
+
+        uint16_t parseNetworkPort(const std::string& spec, const std::string& text)
+        {
+            return static_cast<uint16_t>(parseNetworkNumber(spec, text, 65535));
+        }
+    }
+
+    NetworkParameters parseNetworkLocal(const std::string& spec)
+    {
+        auto colon = spec.find(':');
+        if (colon == std::string::npos)
+        {
+            throw std::runtime_error("Invalid network address: " + spec);
+        }
+
+        return NetworkParameters{
+            parseNetworkSlot(spec, spec.substr(0, colon)),
+            parseNetworkPort(spec, spec.substr(colon + 1)),
+            std::vector<NetworkPeer>()};
+    }
+
+    NetworkPeer parseNetworkPeer(const std::string& spec)
+    {
+        auto firstColon = spec.find(':');
+        auto lastColon = spec.rfind(':');
+        if (firstColon == std::string::npos || firstColon == lastColon || lastColon == firstColon + 1)
+        {
+            throw std::runtime_error("Invalid network address: " + spec);
+        }
+
+        return NetworkPeer{
+            parseNetworkSlot(spec, spec.substr(0, firstColon)),
+            spec.substr(firstColon + 1, lastColon - firstColon - 1),
+            parseNetworkPort(spec, spec.substr(lastColon + 1))};
+    }
+
+    void assignNetworkControllers(GameParameters& parameters)
+    {
+        if (!parameters.network)
+        {
+            return;
+        }
+
+        const auto& network = *parameters.network;
+
+        auto setController = [&parameters](unsigned int slot, PlayerInfo::Controller controller) {
+            auto& player = parameters.players[slot];
+            if (!player)
+            {
+                throw std::runtime_error("Network slot " + std::to_string(slot) + " has no player");
+            }
+            player->controller = controller;
+        };
+
+        for (auto& player : parameters.players)
+        {
+            if (player && player->controller == PlayerInfo::Controller::Human)
+            {
+                player->controller = PlayerInfo::Controller::Computer;
+            }
+        }
+
+        setController(network.localSlot, PlayerInfo::Controller::Human);
+        for (const auto& peer : network.peers)
+        {
+            setController(peer.slot, PlayerInfo::Controller::Remote);
+        }
+    }
+
+    void checkNetworkParameters(const GameParameters& parameters)
+    {
+        if (!parameters.network)
+        {
+            for (const auto& player : parameters.players)
+            {
+                if (player && player->controller == PlayerInfo::Controller::Remote)
+                {
+                    throw std::runtime_error("Remote players need a networked game");
+                }
+            }
+
+            return;
+        }
+
+        const auto& network = *parameters.network;
+
+        const auto& localPlayer = parameters.players[network.localSlot];
+        if (!localPlayer || localPlayer->controller != PlayerInfo::Controller::Human)
+        {
+            throw std::runtime_error("The local network slot " + std::to_string(network.localSlot) + " is not a human player");
+        }
+
+        for (std::size_t i = 0; i < parameters.players.size(); ++i)
+        {
+            const auto& player = parameters.players[i];
+            auto peerCount = std::count_if(network.peers.begin(), network.peers.end(), [i](const auto& peer) { return peer.slot == i; });
+            bool isRemote = player && player->controller == PlayerInfo::Controller::Remote;
+            if (peerCount > 1)
+            {
+                throw std::runtime_error("More than one peer plays slot " + std::to_string(i));
+            }
+            if (isRemote != (peerCount == 1))
+            {
+                throw std::runtime_error("Slot " + std::to_string(i) + (isRemote ? " is a remote player with no peer" : " has a peer but is not a remote player"));
+            }
+        }
+    }
+}
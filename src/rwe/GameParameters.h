@@ -0,0 +1,107 @@
+#ifndef RWE_GAMEPARAMETERS_H
+#define RWE_GAMEPARAMETERS_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <rwe/GameSimulation.h>
+#include <rwe/PlayerId.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    struct PlayerInfo
+    {
+        enum class Controller
+        {
+            Human,
+            Computer,
+            /** A human playing on another machine in a networked game. */
+            Remote
+        };
+
+        Controller controller;
+        std::string side;
+        unsigned int color;
+    };
+
+    /** Another machine taking part in a networked game. */
+    struct NetworkPeer
+    {
+        /** The player slot played on the peer. */
+        unsigned int slot;
+        std::string host;
+        uint16_t port;
+    };
+
+    struct NetworkParameters
+    {
+        /** The player slot played on this machine. */
+        unsigned int localSlot;
+
+        /** The UDP port on which to receive packets from peers. */
+        uint16_t localPort;
+
+        std::vector<NetworkPeer> peers;
+    };
+
+    struct GameParameters
+    {
+        std::string mapName;
+        unsigned int schemaIndex;
+        std::array<std::optional<PlayerInfo>, 10> players;
+
+        /**
+         * Seed for the simulation's random number generator, see makeGameSeed.
+         * In a networked game this is only the local share of the seed;
+         * the peers combine their shares once they hear from each other.
+         */
+        unsigned int seed{0};
+
+        /** If set, the game is recorded as a replay to this file. */
+        std::optional<std::string> replayPath;
+
+        /** If set, the game is played in lockstep with the given peers. */
+        std::optional<NetworkParameters> network;
+
+        GameParameters(const std::string& mapName, unsigned int schemaIndex);
+    };
+
+    /**
+     * Adds a player to the simulation for each occupied player slot, in slot order,
+     * and returns the ID given to the player in each slot.
+     */
+    /** Picks a fresh random seed for a new game. */
+    unsigned int makeGameSeed();
+
+    std::array<std::optional<PlayerId>, 10> addGamePlayers(GameSimulation& simulation, const GameParameters& parameters);
+
+    /**
+     * Parses the local end of a networked game from a string of the form slot:port.
+     * The result has no peers. Throws std::runtime_error if the string is malformed.
+     */
+    NetworkParameters parseNetworkLocal(const std::string& spec);
+
+    /**
+     * Parses a peer of a networked game from a string of the form slot:host:port.
+     * Throws std::runtime_error if the string is malformed.
+     */
+    NetworkPeer parseNetworkPeer(const std::string& spec);
+
+    /**
+     * Makes the local network slot the only human player and the slot of each peer a remote player.
+     * Throws std::runtime_error if any of those slots is empty.
+     */
+    void assignNetworkControllers(GameParameters& parameters);
+
+    /**
+     * Checks that the players and the network parameters agree:
+     * the local slot is a human player, every peer plays a remote player
+     * and every remote player has a peer.
+     * Throws std::runtime_error if they do not.
+     */
+    void checkNetworkParameters(const GameParameters& parameters);
+}
+
+#endif
@@ -1,59 +1,9 @@
 #include "GameScene.h"
 #include <boost/range/adaptor/map.hpp>
 #include <rwe/Mesh.h>
-#include <unordered_set>
 
 namespace rwe
 {
-    class LaserCollisionVisitor : public boost::static_visitor<bool>
-    {
-    private:
-        const GameScene* scene;
-        const std::optional<LaserProjectile>* laserPtr;
-
-    public:
-        LaserCollisionVisitor(const GameScene* scene, const std::optional<LaserProjectile>* laserPtr)
-            : scene(scene), laserPtr(laserPtr)
-        {
-        }
-
-        bool operator()(const OccupiedUnit& v) const
-        {
-            auto& laser = *laserPtr;
-            const auto& unit = scene->getSimulation().getUnit(v.id);
-
-            if (unit.isOwnedBy(laser->owner))
-            {
-                return false;
-            }
-
-            // ignore if the laser is above or below the unit
-            if (laser->position.y < unit.position.y || laser->position.y > unit.position.y + unit.height)
-            {
-                return false;
-            }
-
-            return true;
-        }
-        bool operator()(const OccupiedFeature& v) const
-        {
-            auto& laser = *laserPtr;
-            const auto& feature = scene->getSimulation().getFeature(v.id);
-
-            // ignore if the laser is above or below the feature
-            if (laser->position.y < feature.position.y || laser->position.y > feature.position.y + feature.height)
-            {
-                return false;
-            }
-
-            return true;
-        }
-        bool operator()(const OccupiedNone&) const
-        {
-            return false;
-        }
-    };
-
     GameScene::GameScene(
         SceneManager* sceneManager,
         TextureService* textureService,
@@ -69,7 +19,11 @@ namespace rwe
         MovementClassCollisionService&& collisionService,
         UnitDatabase&& unitDatabase,
         MeshService&& meshService,
-        PlayerId localPlayerId)
+        PlayerId localPlayerId,
+        std::unique_ptr<ReplayRecorder>&& replayRecorder,
+        const std::optional<NetworkParameters>& network,
+        const std::array<std::optional<PlayerId>, 10>& gamePlayers,
+        unsigned int seed)
         : sceneManager(sceneManager),
           textureService(textureService),
           cursor(cursor),
@@ -81,20 +35,57 @@ namespace rwe
           simulation(std::move(simulation)),
           collisionService(std::move(collisionService)),
           unitFactory(textureService, std::move(unitDatabase), std::move(meshService), &this->collisionService, palette, guiPalette),
-          pathFindingService(&this->simulation, &this->collisionService),
-          unitBehaviorService(this, &pathFindingService, &this->collisionService),
-          cobExecutionService(),
-          localPlayerId(localPlayerId)
+          simulationDriver(&this->simulation, &this->collisionService, &unitFactory, textureService, this),
+          localPlayerId(localPlayerId),
+          replayRecorder(std::move(replayRecorder))
     {
+        if (network)
+        {
+            lockstepDriver = std::make_unique<LockstepGameDriver>(&simulationDriver, this->replayRecorder.get(), *network, gamePlayers, seed);
+        }
+    }
+
+    GameScene::~GameScene()
+    {
+        simulationStopping = true;
+        if (simulationThread.joinable())
+        {
+            simulationThread.join();
+        }
     }
 
     void GameScene::init()
     {
         audioService->reserveChannels(reservedChannelsCount);
+
+        simulation.updateUnitSelectionBounds();
+        auto snapshot = std::make_shared<RenderSnapshot>();
+        captureRenderSnapshot(simulation, *snapshot);
+        previousSnapshot = snapshot;
+        currentSnapshot = snapshot;
+        currentSnapshotTime = sdl->getTicks();
+
+        simulationThread = std::thread(&GameScene::runSimulation, this);
     }
 
     void GameScene::render(GraphicsContext& context)
     {
+        std::shared_ptr<const RenderSnapshot> previous;
+        std::shared_ptr<const RenderSnapshot> current;
+        uint32_t snapshotTime;
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            previous = previousSnapshot;
+            current = currentSnapshot;
+            snapshotTime = currentSnapshotTime;
+        }
+
+        // Draw the game one tick behind, so that there are always two ticks to draw between.
+        auto timeSinceTick = static_cast<float>(sdl->getTicks() - snapshotTime);
+        auto alpha = std::clamp(timeSinceTick / static_cast<float>(TickInterval), 0.0f, 1.0f);
+        interpolateRenderSnapshots(*previous, *current, alpha, interpolatedSnapshot);
+        const auto& snapshot = interpolatedSnapshot;
+
         context.disableDepthBuffer();
 
         renderService.drawMapTerrain(simulation.terrain);
@@ -102,42 +93,51 @@ namespace rwe
         renderService.drawFlatFeatureShadows(simulation.features | boost::adaptors::map_values);
         renderService.drawFlatFeatures(simulation.features | boost::adaptors::map_values);
 
-        if (occupiedGridVisible)
+        if (occupiedGridVisible || pathfindingVisualisationVisible || movementClassGridVisible)
         {
-            renderService.drawOccupiedGrid(simulation.terrain, simulation.occupiedGrid);
-        }
+            // Debug views draw the live simulation, so they have to wait for it.
+            std::lock_guard<std::mutex> lock(simulationMutex);
 
-        if (pathfindingVisualisationVisible)
-        {
-            renderService.drawPathfindingVisualisation(simulation.terrain, pathFindingService.lastPathDebugInfo);
-        }
+            if (occupiedGridVisible)
+            {
+                renderService.drawOccupiedGrid(simulation.terrain, simulation.occupiedGrid);
+            }
 
-        if (selectedUnit && movementClassGridVisible)
-        {
-            const auto& unit = simulation.getUnit(*selectedUnit);
-            if (unit.movementClass)
+            if (pathfindingVisualisationVisible)
             {
-                const auto& grid = collisionService.getGrid(*unit.movementClass);
-                renderService.drawMovementClassCollisionGrid(simulation.terrain, grid);
+                renderService.drawPathfindingVisualisation(simulation.terrain, simulationDriver.getPathFindingService().lastPathDebugInfo);
+            }
+
+            if (selectedUnit && movementClassGridVisible && simulation.unitExists(*selectedUnit))
+            {
+                const auto& unit = simulation.getUnit(*selectedUnit);
+                if (unit.movementClass)
+                {
+                    const auto& grid = collisionService.getGrid(*unit.movementClass);
+                    renderService.drawMovementClassCollisionGrid(simulation.terrain, grid);
+                }
             }
         }
 
         if (selectedUnit)
         {
-            renderService.drawSelectionRect(getUnit(*selectedUnit));
+            if (auto unit = snapshot.findUnit(*selectedUnit); unit != nullptr)
+            {
+                renderService.drawSelectionRect(*unit);
+            }
         }
 
-        renderService.drawUnitShadows(simulation.terrain, simulation.units | boost::adaptors::map_values);
+        renderService.drawUnitShadows(simulation.terrain, snapshot.units);
 
         context.enableDepthBuffer();
 
         auto seaLevel = simulation.terrain.getSeaLevel();
-        for (const auto& unit : (simulation.units | boost::adaptors::map_values))
+        for (const auto& unit : snapshot.units)
         {
             renderService.drawUnit(unit, seaLevel);
         }
 
-        renderService.drawLasers(simulation.lasers);
+        renderService.drawLasers(snapshot.projectiles);
 
         context.disableDepthWrites();
 
@@ -148,7 +148,7 @@ namespace rwe
         renderService.drawStandingFeatures(simulation.features | boost::adaptors::map_values);
 
         context.disableDepthTest();
-        renderService.drawExplosions(simulation.gameTime, simulation.explosions);
+        renderService.drawExplosions(snapshot.gameTime, snapshot.explosions);
         context.enableDepthTest();
 
         context.enableDepthWrites();
@@ -158,9 +158,9 @@ namespace rwe
 
         if (healthBarsVisible)
         {
-            for (const Unit& unit : (simulation.units | boost::adaptors::map_values))
+            for (const auto& unit : snapshot.units)
             {
-                if (!unit.isOwnedBy(localPlayerId))
+                if (unit.owner != localPlayerId)
                 {
                     // only draw healthbars on units we own
                     continue;
@@ -211,6 +211,8 @@ namespace rwe
         }
         else if (keysym.sym == SDLK_s)
         {
+            std::lock_guard<std::mutex> lock(simulationMutex);
+            forgetRemovedUnits();
             stopSelectedUnit();
         }
         else if (keysym.sym == SDLK_LSHIFT)
@@ -269,6 +271,9 @@ namespace rwe
 
     void GameScene::onMouseDown(MouseButtonEvent event)
     {
+        std::lock_guard<std::mutex> lock(simulationMutex);
+        forgetRemovedUnits();
+
         if (event.button == MouseButtonEvent::MouseButton::Left)
         {
             if (boost::get<AttackCursorMode>(&cursorMode) != nullptr)
@@ -357,6 +362,9 @@ namespace rwe
 
     void GameScene::onMouseUp(MouseButtonEvent event)
     {
+        std::lock_guard<std::mutex> lock(simulationMutex);
+        forgetRemovedUnits();
+
         if (event.button == MouseButtonEvent::MouseButton::Left)
         {
             auto normalCursor = boost::get<NormalCursorMode>(&cursorMode);
@@ -385,11 +393,10 @@ namespace rwe
     void GameScene::update()
     {
         sceneTime = nextSceneTime(sceneTime);
-        simulation.gameTime = nextGameTime(simulation.gameTime);
 
         processActions();
 
-        float secondsElapsed = static_cast<float>(SceneManager::TickInterval) / 1000.0f;
+        float secondsElapsed = static_cast<float>(TickInterval) / 1000.0f;
         const float speed = CameraPanSpeed * secondsElapsed;
         int directionX = (right ? 1 : 0) - (left ? 1 : 0);
         int directionZ = (down ? 1 : 0) - (up ? 1 : 0);
@@ -410,75 +417,176 @@ namespace rwe
 
         camera.translate(Vector3f(dx, 0.0f, dz));
 
-        hoveredUnit = getUnitUnderCursor();
-
-        if (boost::get<AttackCursorMode>(&cursorMode) != nullptr)
         {
-            cursor->useAttackCursor();
-        }
-        else if (boost::get<NormalCursorMode>(&cursorMode) != nullptr)
-        {
-            if (hoveredUnit && getUnit(*hoveredUnit).isOwnedBy(localPlayerId))
+            std::lock_guard<std::mutex> lock(simulationMutex);
+
+            if (simulationError)
             {
-                cursor->useSelectCursor();
+                std::rethrow_exception(simulationError);
             }
-            else if (selectedUnit && getUnit(*selectedUnit).canAttack && hoveredUnit && isEnemy(*hoveredUnit))
+
+            forgetRemovedUnits();
+            hoveredUnit = getUnitUnderCursor();
+
+            if (boost::get<AttackCursorMode>(&cursorMode) != nullptr)
             {
-                cursor->useRedCursor();
+                cursor->useAttackCursor();
             }
-            else
+            else if (boost::get<NormalCursorMode>(&cursorMode) != nullptr)
             {
-                cursor->useNormalCursor();
+                if (hoveredUnit && getUnit(*hoveredUnit).isOwnedBy(localPlayerId))
+                {
+                    cursor->useSelectCursor();
+                }
+                else if (selectedUnit && getUnit(*selectedUnit).canAttack && hoveredUnit && isEnemy(*hoveredUnit))
+                {
+                    cursor->useRedCursor();
+                }
+                else
+                {
+                    cursor->useNormalCursor();
+                }
             }
+
+            auto winStatus = simulation.computeWinStatus();
+            if (auto wonStatus = boost::get<WinStatusWon>(&winStatus); wonStatus != nullptr)
+            {
+                delay(SceneTimeDelta(5 * 60), [sm = sceneManager]() { sm->requestExit(); });
+            }
+            else if (auto drawStatus = boost::get<WinStatusDraw>(&winStatus); drawStatus != nullptr)
+            {
+                delay(SceneTimeDelta(5 * 60), [sm = sceneManager]() { sm->requestExit(); });
+            }
+
+            soundsToPlay.swap(pendingSounds);
         }
 
-        pathFindingService.update();
+        playPendingSounds();
+    }
 
-        // run unit scripts
-        for (auto& entry : simulation.units)
+    void GameScene::runSimulation()
+    {
+        try
         {
-            auto unitId = entry.first;
-            auto& unit = entry.second;
+            auto nextTickTime = sdl->getTicks();
+            while (!simulationStopping)
+            {
+                auto now = sdl->getTicks();
+                if (now < nextTickTime)
+                {
+                    sdl->delay(nextTickTime - now);
+                    continue;
+                }
 
-            unitBehaviorService.update(unitId);
+                if (now - nextTickTime >= MaxTicksBehind * TickInterval)
+                {
+                    // We can't catch up, so give up on the time we've lost.
+                    nextTickTime = now;
+                }
 
-            unit.mesh.update(secondsElapsed);
+                // Network I/O happens outside the lock
+                // so that a slow socket never holds up the render thread.
+                if (lockstepDriver)
+                {
+                    lockstepDriver->receivePackets();
+                }
 
-            cobExecutionService.run(simulation, unitId);
-        }
+                {
+                    std::lock_guard<std::mutex> lock(simulationMutex);
+                    auto previousTime = simulation.gameTime;
+                    tickSimulation(now);
+                    if (simulation.gameTime != previousTime)
+                    {
+                        publishRenderSnapshot(sdl->getTicks());
+                    }
+                }
 
-        updateLasers();
+                if (lockstepDriver)
+                {
+                    lockstepDriver->sendPackets();
+                }
 
-        updateExplosions();
+                nextTickTime += TickInterval;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(simulationMutex);
+            simulationError = std::current_exception();
+        }
+    }
 
-        // if a commander died this frame, kill the player that owns it
-        for (const auto& p : simulation.units)
+    void GameScene::tickSimulation(uint32_t now)
+    {
+        if (lockstepDriver)
+        {
+            lockstepDriver->update(now);
+        }
+        else
         {
-            if (p.second.isCommander() && p.second.isDead())
+            simulationDriver.update();
+            if (replayRecorder)
             {
-                killPlayer(p.second.owner);
+                replayRecorder->advanceTo(simulation.gameTime);
             }
         }
 
-        auto winStatus = simulation.computeWinStatus();
-        if (auto wonStatus = boost::get<WinStatusWon>(&winStatus); wonStatus != nullptr)
+        simulation.updateUnitSelectionBounds();
+    }
+
+    void GameScene::publishRenderSnapshot(uint32_t now)
+    {
+        if (!spareSnapshot || spareSnapshot.use_count() > 1)
+        {
+            spareSnapshot = std::make_shared<RenderSnapshot>();
+        }
+
+        captureRenderSnapshot(simulation, *spareSnapshot);
+
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        auto dropped = std::move(previousSnapshot);
+        previousSnapshot = std::move(currentSnapshot);
+        currentSnapshot = std::move(spareSnapshot);
+        currentSnapshotTime = now;
+        spareSnapshot = std::move(dropped);
+    }
+
+    void GameScene::forgetRemovedUnits()
+    {
+        if (selectedUnit && !simulation.unitExists(*selectedUnit))
         {
-            delay(SceneTimeDelta(5 * 60), [sm = sceneManager]() { sm->requestExit(); });
+            selectedUnit = std::nullopt;
         }
-        else if (auto drawStatus = boost::get<WinStatusDraw>(&winStatus); drawStatus != nullptr)
+        if (hoveredUnit && !simulation.unitExists(*hoveredUnit))
         {
-            delay(SceneTimeDelta(5 * 60), [sm = sceneManager]() { sm->requestExit(); });
+            hoveredUnit = std::nullopt;
         }
+    }
 
-        deleteDeadUnits();
+    void GameScene::playPendingSounds()
+    {
+        for (const auto& pending : soundsToPlay)
+        {
+            if (pending.onSelectChannel)
+            {
+                audioService->playSoundIfFree(pending.sound, UnitSelectChannel);
+            }
+            else
+            {
+                // FIXME: should play on a unit-specific or position-aware channel
+                audioService->playSound(pending.sound);
+            }
+        }
+
+        soundsToPlay.clear();
     }
 
     void GameScene::spawnUnit(const std::string& unitType, PlayerId owner, const Vector3f& position)
     {
-        auto unit = unitFactory.createUnit(unitType, owner, simulation.getPlayer(owner).color, position);
+        std::lock_guard<std::mutex> lock(simulationMutex);
 
         // TODO: if we failed to add the unit throw some warning
-        simulation.tryAddUnit(std::move(unit));
+        simulationDriver.spawnUnit(unitType, owner, position);
     }
 
     void GameScene::setCameraPosition(const Vector3f& newPosition)
@@ -537,21 +645,19 @@ namespace rwe
         return simulation.gameTime;
     }
 
-    void GameScene::playSoundOnSelectChannel(const AudioService::SoundHandle& handle)
+    void GameScene::playSoundOnSelectChannel(const SoundHandle& handle)
     {
-        audioService->playSoundIfFree(handle, UnitSelectChannel);
+        pendingSounds.push_back(PendingSound{handle, true});
     }
 
-    void GameScene::playUnitSound(UnitId /*unitId*/, const AudioService::SoundHandle& sound)
+    void GameScene::playUnitSound(UnitId /*unitId*/, const SoundHandle& sound)
     {
-        // FIXME: should play on a unit-specific channel group
-        audioService->playSound(sound);
+        pendingSounds.push_back(PendingSound{sound, false});
     }
 
-    void GameScene::playSoundAt(const Vector3f& /*position*/, const AudioService::SoundHandle& sound)
+    void GameScene::playSoundAt(const Vector3f& /*position*/, const SoundHandle& sound)
     {
-        // FIXME: should play on a position-aware channel
-        audioService->playSound(sound);
+        pendingSounds.push_back(PendingSound{sound, false});
     }
 
     std::optional<UnitId> GameScene::getUnitUnderCursor() const
@@ -584,11 +690,25 @@ namespace rwe
         return simulation.intersectLineWithTerrain(ray.toLine());
     }
 
+    void GameScene::applyLocalCommand(const SimulationCommand& command)
+    {
+        if (lockstepDriver)
+        {
+            lockstepDriver->submit(command);
+            return;
+        }
+
+        simulationDriver.applyCommand(command);
+        if (replayRecorder)
+        {
+            replayRecorder->record(simulation.gameTime, command);
+        }
+    }
+
     void GameScene::issueMoveOrder(UnitId unitId, Vector3f position)
     {
-        auto& unit = getUnit(unitId);
-        unit.clearOrders();
-        unit.addOrder(createMoveOrder(position));
+        applyLocalCommand(MoveCommand{unitId, position.x, position.z, false});
+        const auto& unit = getUnit(unitId);
         if (unit.okSound)
         {
             playSoundOnSelectChannel(*(unit.okSound));
@@ -597,14 +717,13 @@ namespace rwe
 
     void GameScene::enqueueMoveOrder(UnitId unitId, Vector3f position)
     {
-        getUnit(unitId).addOrder(createMoveOrder(position));
+        applyLocalCommand(MoveCommand{unitId, position.x, position.z, true});
     }
 
     void GameScene::issueAttackOrder(UnitId unitId, UnitId target)
     {
-        auto& unit = getUnit(unitId);
-        unit.clearOrders();
-        unit.addOrder(createAttackOrder(target));
+        applyLocalCommand(AttackCommand{unitId, target, false});
+        const auto& unit = getUnit(unitId);
         if (unit.okSound)
         {
             playSoundOnSelectChannel(*(unit.okSound));
@@ -613,14 +732,13 @@ namespace rwe
 
     void GameScene::enqueueAttackOrder(UnitId unitId, UnitId target)
     {
-        getUnit(unitId).addOrder(createAttackOrder(target));
+        applyLocalCommand(AttackCommand{unitId, target, true});
     }
 
     void GameScene::issueAttackGroundOrder(UnitId unitId, Vector3f position)
     {
-        auto& unit = getUnit(unitId);
-        unit.clearOrders();
-        unit.addOrder(createAttackGroundOrder(position));
+        applyLocalCommand(AttackGroundCommand{unitId, position.x, position.z, false});
+        const auto& unit = getUnit(unitId);
         if (unit.okSound)
         {
             playSoundOnSelectChannel(*(unit.okSound));
@@ -629,15 +747,15 @@ namespace rwe
 
     void GameScene::enqueueAttackGroundOrder(UnitId unitId, Vector3f position)
     {
-        getUnit(unitId).addOrder(createAttackGroundOrder(position));
+        applyLocalCommand(AttackGroundCommand{unitId, position.x, position.z, true});
     }
 
     void GameScene::stopSelectedUnit()
     {
         if (selectedUnit)
         {
-            auto& unit = getUnit(*selectedUnit);
-            unit.clearOrders();
+            applyLocalCommand(StopCommand{*selectedUnit});
+            const auto& unit = getUnit(*selectedUnit);
             if (unit.okSound)
             {
                 playSoundOnSelectChannel(*(unit.okSound));
@@ -697,291 +815,6 @@ namespace rwe
         return !getUnit(id).isOwnedBy(localPlayerId);
     }
 
-    void GameScene::updateLasers()
-    {
-        auto gameTime = getGameTime();
-        for (auto& laser : simulation.lasers)
-        {
-            if (!laser)
-            {
-                continue;
-            }
-
-            laser->position += laser->velocity;
-
-            // emit smoke trail
-            if (laser->smokeTrail)
-            {
-                if (gameTime > laser->lastSmoke + *laser->smokeTrail)
-                {
-                    createLightSmoke(laser->position);
-                    laser->lastSmoke = gameTime;
-                }
-            }
-
-            // test collision with terrain
-            auto terrainHeight = simulation.terrain.getHeightAt(laser->position.x, laser->position.z);
-            auto seaLevel = simulation.terrain.getSeaLevel();
-
-            // test collision with sea
-            // FIXME: waterweapons should be allowed in water
-            if (seaLevel > terrainHeight && laser->position.y <= seaLevel)
-            {
-                doLaserImpact(laser, ImpactType::Water);
-            }
-            else if (laser->position.y <= terrainHeight)
-            {
-                doLaserImpact(laser, ImpactType::Normal);
-            }
-            else
-            {
-                // detect collision with something's footprint
-                auto heightMapPos = simulation.terrain.worldToHeightmapCoordinate(laser->position);
-                auto cellValue = simulation.occupiedGrid.grid.tryGet(heightMapPos);
-                if (cellValue)
-                {
-                    auto collides = boost::apply_visitor(LaserCollisionVisitor(this, &laser), cellValue->get());
-                    if (collides)
-                    {
-                        doLaserImpact(laser, ImpactType::Normal);
-                    }
-                }
-            }
-
-            // TODO: detect collision between a laser and the world boundary
-        }
-    }
-
-    void GameScene::updateExplosions()
-    {
-        for (auto& exp : simulation.explosions)
-        {
-            if (!exp)
-            {
-                continue;
-            }
-
-            if (exp->isFinished(simulation.gameTime))
-            {
-                exp = std::nullopt;
-                continue;
-            }
-
-            if (exp->floats)
-            {
-                // TODO: drift with the wind
-                exp->position.y += 0.5f;
-            }
-        }
-    }
-
-    void GameScene::doLaserImpact(std::optional<LaserProjectile>& laser, ImpactType impactType)
-    {
-        switch (impactType)
-        {
-            case ImpactType::Normal:
-            {
-                if (laser->soundHit)
-                {
-                    playSoundAt(laser->position, *laser->soundHit);
-                }
-                if (laser->explosion)
-                {
-                    simulation.spawnExplosion(laser->position, *laser->explosion);
-                }
-                if (laser->endSmoke)
-                {
-                    createLightSmoke(laser->position);
-                }
-                break;
-            }
-            case ImpactType::Water:
-            {
-                if (laser->soundWater)
-                {
-                    playSoundAt(laser->position, *laser->soundWater);
-                }
-                if (laser->waterExplosion)
-                {
-                    simulation.spawnExplosion(laser->position, *laser->waterExplosion);
-                }
-                break;
-            }
-        }
-
-        applyDamageInRadius(laser->position, laser->damageRadius, *laser);
-
-        laser = std::nullopt;
-    }
-
-    void GameScene::applyDamageInRadius(const Vector3f& position, float radius, const LaserProjectile& laser)
-    {
-        auto minX = position.x - radius;
-        auto maxX = position.x + radius;
-        auto minZ = position.z - radius;
-        auto maxZ = position.z + radius;
-
-        auto minPoint = simulation.terrain.worldToHeightmapCoordinate(Vector3f(minX, position.y, minZ));
-        auto maxPoint = simulation.terrain.worldToHeightmapCoordinate(Vector3f(maxX, position.y, maxZ));
-        auto minCell = simulation.terrain.getHeightMap().clampToCoords(minPoint);
-        auto maxCell = simulation.terrain.getHeightMap().clampToCoords(maxPoint);
-
-        assert(minCell.x <= maxCell.x);
-        assert(minCell.y <= maxCell.y);
-
-        auto radiusSquared = radius * radius;
-
-        std::unordered_set<UnitId> seenUnits;
-
-        // for each cell
-        for (std::size_t y = minCell.y; y <= maxCell.y; ++y)
-        {
-            for (std::size_t x = minCell.x; x <= maxCell.x; ++x)
-            {
-                // check if it's in range
-                auto cellCenter = simulation.terrain.heightmapIndexToWorldCenter(x, y);
-                Rectangle2f cellRectangle(
-                    Vector2f(cellCenter.x, cellCenter.z),
-                    Vector2f(MapTerrain::HeightTileWidthInWorldUnits / 2.0f, MapTerrain::HeightTileHeightInWorldUnits / 2.0f));
-                auto cellDistanceSquared = cellRectangle.distanceSquared(Vector2f(position.x, position.z));
-                if (cellDistanceSquared > radiusSquared)
-                {
-                    continue;
-                }
-
-                // check if a unit (or feature) is there
-                auto occupiedType = simulation.occupiedGrid.grid.get(x, y);
-                auto u = boost::get<OccupiedUnit>(&occupiedType);
-                if (u == nullptr)
-                {
-                    continue;
-                }
-
-                // check if the unit was seen/mark as seen
-                auto pair = seenUnits.insert(u->id);
-                if (!pair.second) // the unit was already present
-                {
-                    continue;
-                }
-
-                const auto& unit = simulation.getUnit(u->id);
-
-                // skip dead units
-                if (unit.isDead())
-                {
-                    continue;
-                }
-
-                // add in the third dimension component to distance,
-                // check if we are still in range
-                auto unitDistanceSquared = createBoundingBox(unit).distanceSquared(position);
-                if (unitDistanceSquared > radiusSquared)
-                {
-                    continue;
-                }
-
-                // apply appropriate damage
-                auto damageScale = std::clamp(1.0f - (std::sqrt(unitDistanceSquared) / radius), 0.0f, 1.0f);
-                auto rawDamage = laser.getDamage(unit.unitType);
-                auto scaledDamage = static_cast<unsigned int>(static_cast<float>(rawDamage) * damageScale);
-                applyDamage(u->id, scaledDamage);
-            }
-        }
-    }
-
-    void GameScene::applyDamage(UnitId unitId, unsigned int damagePoints)
-    {
-        auto& unit = simulation.getUnit(unitId);
-        if (unit.hitPoints <= damagePoints)
-        {
-            killUnit(unitId);
-        }
-        else
-        {
-            unit.hitPoints -= damagePoints;
-        }
-    }
-
-    void GameScene::createLightSmoke(const Vector3f& position)
-    {
-        simulation.spawnSmoke(position, textureService->getGafEntry("anims/FX.GAF", "smoke 1"));
-    }
-
-    void GameScene::deleteDeadUnits()
-    {
-        for (auto it = simulation.units.begin(); it != simulation.units.end();)
-        {
-            const auto& unit = it->second;
-            if (unit.isDead())
-            {
-                if (selectedUnit && *selectedUnit == it->first)
-                {
-                    selectedUnit = std::nullopt;
-                }
-                if (hoveredUnit && *hoveredUnit == it->first)
-                {
-                    hoveredUnit = std::nullopt;
-                }
-
-                auto footprintRect = computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-                auto footprintRegion = simulation.occupiedGrid.grid.tryToRegion(footprintRect);
-                assert(!!footprintRegion);
-                simulation.occupiedGrid.grid.setArea(*footprintRegion, OccupiedNone());
-
-                it = simulation.units.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
-        }
-    }
-
-    BoundingBox3f GameScene::createBoundingBox(const Unit& unit) const
-    {
-        auto footprint = simulation.computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-        auto min = Vector3f(footprint.x, unit.position.y, footprint.y);
-        auto max = Vector3f(footprint.x + footprint.width, unit.position.y + unit.height, footprint.y + footprint.height);
-        auto worldMin = simulation.terrain.heightmapToWorldSpace(min);
-        auto worldMax = simulation.terrain.heightmapToWorldSpace(max);
-        return BoundingBox3f::fromMinMax(worldMin, worldMax);
-    }
-
-    void GameScene::killUnit(UnitId unitId)
-    {
-        auto& unit = simulation.getUnit(unitId);
-
-        unit.markAsDead();
-
-        // TODO: spawn debris particles, corpse
-        if (unit.explosionWeapon)
-        {
-            auto impactType = unit.position.y < simulation.terrain.getSeaLevel() ? ImpactType::Water : ImpactType::Normal;
-            std::optional<LaserProjectile> projectile = simulation.createProjectileFromWeapon(unit.owner, *unit.explosionWeapon, unit.position, Vector3f(0.0f, -1.0f, 0.0f));
-            doLaserImpact(projectile, impactType);
-        }
-    }
-
-    void GameScene::killPlayer(PlayerId playerId)
-    {
-        simulation.getPlayer(playerId).status = GamePlayerStatus::Dead;
-        for (auto& p : simulation.units)
-        {
-            auto& unit = p.second;
-            if (unit.isDead())
-            {
-                continue;
-            }
-
-            if (!unit.isOwnedBy(playerId))
-            {
-                continue;
-            }
-
-            killUnit(p.first);
-        }
-    }
-
     void GameScene::processActions()
     {
         for (auto& a : actions)
@@ -1,30 +1,41 @@
 #ifndef RWE_GAMESCENE_H
 #define RWE_GAMESCENE_H
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <rwe/AudioService.h>
 #include <rwe/CursorService.h>
 #include <rwe/DiscreteRect.h>
 #include <rwe/GameSimulation.h>
+#include <rwe/GameParameters.h>
+#include <rwe/GameSimulationDriver.h>
+#include <rwe/LockstepGameDriver.h>
 #include <rwe/MeshService.h>
 #include <rwe/OccupiedGrid.h>
 #include <rwe/PlayerId.h>
 #include <rwe/RenderService.h>
+#include <rwe/RenderSnapshot.h>
+#include <rwe/Replay.h>
 #include <rwe/SceneManager.h>
 #include <rwe/SceneTime.h>
+#include <rwe/SimulationSoundPlayer.h>
 #include <rwe/TextureService.h>
 #include <rwe/UiRenderService.h>
 #include <rwe/Unit.h>
-#include <rwe/UnitBehaviorService.h>
 #include <rwe/UnitDatabase.h>
 #include <rwe/UnitFactory.h>
 #include <rwe/UnitId.h>
 #include <rwe/ViewportService.h>
 #include <rwe/camera/UiCamera.h>
-#include <rwe/cob/CobExecutionService.h>
-#include <rwe/pathfinding/PathFindingService.h>
+#include <thread>
+#include <vector>
 
 namespace rwe
 {
@@ -55,15 +66,26 @@ namespace rwe
 
     using CursorMode = boost::variant<AttackCursorMode, NormalCursorMode>;
 
-    enum class ImpactType
-    {
-        Normal,
-        Water
-    };
-
-    class GameScene : public SceneManager::Scene
+    /**
+     * Plays a game.
+     *
+     * The simulation runs on its own thread, ticking every TickInterval milliseconds
+     * regardless of how long frames take to draw.
+     * After each tick it publishes a RenderSnapshot,
+     * and frames are drawn from the last two snapshots, interpolated to the time of the frame,
+     * so drawing never waits on the simulation.
+     * Input is handled on the main thread, which takes the simulation lock
+     * for the moment it needs to look at the simulation or give orders.
+     */
+    class GameScene : public SceneManager::Scene, public SimulationSoundPlayer
     {
     private:
+        struct PendingSound
+        {
+            SoundHandle sound;
+            bool onSelectChannel;
+        };
+
         static const unsigned int UnitSelectChannel = 0;
 
         static const unsigned int reservedChannelsCount = 1;
@@ -74,6 +96,13 @@ namespace rwe
          */
         static constexpr float CameraPanSpeed = 1000.0f;
 
+        /**
+         * The most ticks the simulation thread falls behind real time
+         * before it gives up on catching up and lets the game run slow,
+         * rather than spending all its time running late ticks.
+         */
+        static const unsigned int MaxTicksBehind = 5;
+
         SceneManager* const sceneManager;
         TextureService* textureService;
         CursorService* cursor;
@@ -90,12 +119,19 @@ namespace rwe
 
         UnitFactory unitFactory;
 
-        PathFindingService pathFindingService;
-        UnitBehaviorService unitBehaviorService;
-        CobExecutionService cobExecutionService;
+        GameSimulationDriver simulationDriver;
 
         PlayerId localPlayerId;
 
+        /** May be null, in which case the game is not recorded. */
+        std::unique_ptr<ReplayRecorder> replayRecorder;
+
+        /**
+         * May be null, in which case the game is not networked.
+         * Otherwise the simulation advances through it rather than directly.
+         */
+        std::unique_ptr<LockstepGameDriver> lockstepDriver;
+
         SceneTime sceneTime{0};
 
         bool left{false};
@@ -119,6 +155,46 @@ namespace rwe
 
         std::deque<std::optional<GameSceneTimeAction>> actions;
 
+        /**
+         * Guards the simulation and everything the simulation thread touches along with it:
+         * the drivers, the replay recorder, the pending sounds and the simulation error.
+         * The terrain and features never change once the game has started,
+         * so they may be read without it.
+         */
+        std::mutex simulationMutex;
+
+        /** Sounds the simulation has asked for, to be played on the main thread. */
+        std::vector<PendingSound> pendingSounds;
+
+        /** Main thread scratch space for playing the pending sounds outside the lock. */
+        std::vector<PendingSound> soundsToPlay;
+
+        /** Set if the simulation thread failed, to be rethrown on the main thread. */
+        std::exception_ptr simulationError;
+
+        /** Guards the published snapshots. */
+        std::mutex snapshotMutex;
+
+        std::shared_ptr<RenderSnapshot> previousSnapshot;
+
+        std::shared_ptr<RenderSnapshot> currentSnapshot;
+
+        /** The time in milliseconds at which currentSnapshot was published. */
+        uint32_t currentSnapshotTime{0};
+
+        /**
+         * The snapshot the simulation thread captures into next.
+         * Recycled from the snapshot dropped at each publish,
+         * unless the render thread is still drawing from it.
+         */
+        std::shared_ptr<RenderSnapshot> spareSnapshot;
+
+        /** The render thread's interpolated view of the last two snapshots. */
+        RenderSnapshot interpolatedSnapshot;
+
+        std::atomic<bool> simulationStopping{false};
+
+        std::thread simulationThread;
 
     public:
         GameScene(
@@ -136,8 +212,19 @@ namespace rwe
             MovementClassCollisionService&& collisionService,
             UnitDatabase&& unitDatabase,
             MeshService&& meshService,
-            PlayerId localPlayerId);
+            PlayerId localPlayerId,
+            std::unique_ptr<ReplayRecorder>&& replayRecorder,
+            const std::optional<NetworkParameters>& network,
+            const std::array<std::optional<PlayerId>, 10>& gamePlayers,
+            unsigned int seed);
 
+        GameScene(const GameScene&) = delete;
+        GameScene& operator=(const GameScene&) = delete;
+
+        /** Stops the simulation thread. */
+        ~GameScene() override;
+
+        /** Publishes the first snapshot and starts the simulation thread. */
         void init() override;
 
         void render(GraphicsContext& context) override;
@@ -178,11 +265,15 @@ namespace rwe
 
         bool isCollisionAt(const DiscreteRect& rect, UnitId self) const;
 
-        void playSoundOnSelectChannel(const AudioService::SoundHandle& sound);
+        /**
+         * Queues the sound to be played by the next update.
+         * Like the other sound methods, call with simulationMutex held.
+         */
+        void playSoundOnSelectChannel(const SoundHandle& sound) override;
 
-        void playUnitSound(UnitId unitId, const AudioService::SoundHandle& sound);
+        void playUnitSound(UnitId unitId, const SoundHandle& sound) override;
 
-        void playSoundAt(const Vector3f& position, const AudioService::SoundHandle& sound);
+        void playSoundAt(const Vector3f& position, const SoundHandle& sound) override;
 
         DiscreteRect computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const;
 
@@ -192,11 +283,31 @@ namespace rwe
 
         const GameSimulation& getSimulation() const;
 
-        void doLaserImpact(std::optional<LaserProjectile>& laser, ImpactType impactType);
+    private:
+        /** The body of the simulation thread. */
+        void runSimulation();
 
-        void createLightSmoke(const Vector3f& position);
+        /**
+         * Runs the tick that is due, or as many as the lockstep driver allows.
+         * The lockstep driver's packets are received before and sent after this, outside the lock.
+         * Call with simulationMutex held.
+         */
+        void tickSimulation(uint32_t now);
+
+        /**
+         * Captures the simulation into a snapshot and makes it the current one.
+         * Call with simulationMutex held.
+         */
+        void publishRenderSnapshot(uint32_t now);
+
+        /**
+         * Clears the selected and hovered units if the simulation has removed them.
+         * Call with simulationMutex held.
+         */
+        void forgetRemovedUnits();
+
+        void playPendingSounds();
 
-    private:
         std::optional<UnitId> getUnitUnderCursor() const;
 
         Vector2f screenToClipSpace(Point p) const;
@@ -207,6 +318,15 @@ namespace rwe
 
         std::optional<Vector3f> getMouseTerrainCoordinate() const;
 
+        /**
+         * Applies a command given by the local player to the simulation,
+         * recording it if the game is being recorded.
+         * In a networked game the command is sent to the peers
+         * and applied after the input delay instead.
+         * Call with simulationMutex held, as for the orders below.
+         */
+        void applyLocalCommand(const SimulationCommand& command);
+
         void issueMoveOrder(UnitId unitId, Vector3f position);
 
         void enqueueMoveOrder(UnitId unitId, Vector3f position);
@@ -231,22 +351,6 @@ namespace rwe
 
         bool isEnemy(UnitId id) const;
 
-        void updateLasers();
-
-        void updateExplosions();
-
-        void applyDamageInRadius(const Vector3f& position, float radius, const LaserProjectile& laser);
-
-        void applyDamage(UnitId unitId, unsigned int damagePoints);
-
-        void deleteDeadUnits();
-
-        BoundingBox3f createBoundingBox(const Unit& unit) const;
-
-        void killUnit(UnitId unitId);
-
-        void killPlayer(PlayerId playerId);
-
         void processActions();
 
         template <typename T>
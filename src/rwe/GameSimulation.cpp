@@ -36,9 +36,10 @@ namespace rwe
         }
     };
 
-    GameSimulation::GameSimulation(MapTerrain&& terrain)
+    GameSimulation::GameSimulation(MapTerrain&& terrain, unsigned int seed)
         : terrain(std::move(terrain)),
-          occupiedGrid(this->terrain.getHeightMap().getWidth(), this->terrain.getHeightMap().getHeight())
+          occupiedGrid(this->terrain.getHeightMap().getWidth(), this->terrain.getHeightMap().getHeight()),
+          rng(seed)
     {
     }
 
@@ -251,22 +252,67 @@ namespace rwe
         return getUnit(unitId).isTurnInProgress(name, axis);
     }
 
-    std::optional<UnitId> GameSimulation::getFirstCollidingUnit(const Ray3f& ray) const
+    void GameSimulation::updateUnitSelectionBounds()
     {
-        auto bestDistance = std::numeric_limits<float>::infinity();
-        std::optional<UnitId> it;
-
+        // Walk the units alongside the IDs the tree was built from,
+        // which are in the same order, to see whether the set of units has changed.
+        bool sameUnits = units.size() == unitSelectionIds.size();
+        auto idIt = unitSelectionIds.begin();
+        unitSelectionBoxes.clear();
         for (const auto& entry : units)
         {
-            auto distance = entry.second.selectionIntersect(ray);
-            if (distance && distance < bestDistance)
+            if (sameUnits)
             {
-                bestDistance = *distance;
-                it = entry.first;
+                sameUnits = entry.first == *idIt;
+                ++idIt;
             }
+            unitSelectionBoxes.push_back(entry.second.getSelectionBounds());
+        }
+
+        if (sameUnits)
+        {
+            unitSelectionBvh.refit(unitSelectionBoxes);
+            return;
+        }
+
+        std::vector<BoundingBoxBvh<UnitId>::Entry> entries;
+        entries.reserve(units.size());
+        unitSelectionIds.clear();
+        auto boxIt = unitSelectionBoxes.begin();
+        for (const auto& entry : units)
+        {
+            entries.push_back(BoundingBoxBvh<UnitId>::Entry{entry.first, *boxIt++});
+            unitSelectionIds.push_back(entry.first);
         }
+        unitSelectionBvh.build(entries);
+    }
+
+    std::optional<UnitId> GameSimulation::getFirstCollidingUnit(const Ray3f& ray) const
+    {
+        // Selection tests only consider the ray up to t = 1,
+        // so the segment from the origin to there is all we need to search.
+        auto directionLength = ray.direction.length();
+        if (directionLength == 0.0f)
+        {
+            return std::nullopt;
+        }
+
+        return unitSelectionBvh.intersectLine(ray.toLine(), [this, &ray, directionLength](UnitId id) -> std::optional<float> {
+            // units may have been removed since the index was last updated
+            auto it = units.find(id);
+            if (it == units.end())
+            {
+                return std::nullopt;
+            }
 
-        return it;
+            auto distance = it->second.selectionIntersect(ray);
+            if (!distance)
+            {
+                return std::nullopt;
+            }
+
+            return *distance / directionLength;
+        });
     }
 
     std::optional<Vector3f> GameSimulation::intersectLineWithTerrain(const Line3f& line) const
@@ -302,48 +348,9 @@ namespace rwe
         pathRequests.push_back(PathRequest{unitId});
     }
 
-    LaserProjectile GameSimulation::createProjectileFromWeapon(
-        PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction)
-    {
-        LaserProjectile laser;
-        laser.owner = owner;
-        laser.position = position;
-        laser.origin = position;
-        laser.velocity = direction * weapon.velocity;
-        laser.duration = weapon.duration;
-        laser.color = weapon.color;
-        laser.color2 = weapon.color2;
-
-        laser.endSmoke = weapon.endSmoke;
-        laser.smokeTrail = weapon.smokeTrail;
-        laser.lastSmoke = gameTime;
-
-        laser.soundHit = weapon.soundHit;
-        laser.soundWater = weapon.soundWater;
-
-        laser.explosion = weapon.explosion;
-        laser.waterExplosion = weapon.waterExplosion;
-
-        laser.damage = weapon.damage;
-
-        laser.damageRadius = weapon.damageRadius;
-
-        return laser;
-    }
-
     void GameSimulation::spawnLaser(PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction)
     {
-        auto laser = createProjectileFromWeapon(owner, weapon, position, direction);
-
-        auto it = std::find_if(lasers.begin(), lasers.end(), [](const auto& x) { return !x; });
-        if (it == lasers.end())
-        {
-            lasers.push_back(laser);
-        }
-        else
-        {
-            *it = laser;
-        }
+        projectiles.spawn(owner, weapon.projectile, position, direction * weapon.projectile->velocity, gameTime);
     }
 
     void GameSimulation::spawnExplosion(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation)
@@ -353,15 +360,7 @@ namespace rwe
         exp.animation = animation;
         exp.startTime = gameTime;
 
-        auto it = std::find_if(explosions.begin(), explosions.end(), [](const auto& x) { return !x; });
-        if (it == explosions.end())
-        {
-            explosions.push_back(exp);
-        }
-        else
-        {
-            *it = exp;
-        }
+        explosions.push_back(exp);
     }
 
     void GameSimulation::spawnSmoke(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation)
@@ -372,15 +371,7 @@ namespace rwe
         exp.startTime = gameTime;
         exp.floats = true;
 
-        auto it = std::find_if(explosions.begin(), explosions.end(), [](const auto& x) { return !x; });
-        if (it == explosions.end())
-        {
-            explosions.push_back(exp);
-        }
-        else
-        {
-            *it = exp;
-        }
+        explosions.push_back(exp);
     }
 
     WinStatus GameSimulation::computeWinStatus() const
@@ -413,4 +404,56 @@ namespace rwe
         // no players are alive, the game is a draw
         return WinStatusDraw();
     }
+
+    namespace
+    {
+        class IsCommandAllowedVisitor : public boost::static_visitor<bool>
+        {
+        private:
+            const GameSimulation* simulation;
+            PlayerId player;
+
+        public:
+            IsCommandAllowedVisitor(const GameSimulation* simulation, PlayerId player) : simulation(simulation), player(player)
+            {
+            }
+
+            bool operator()(const SpawnUnitCommand&) const
+            {
+                return false;
+            }
+
+            bool operator()(const MoveCommand& c) const
+            {
+                return ownsUnit(c.unit);
+            }
+
+            bool operator()(const AttackCommand& c) const
+            {
+                return ownsUnit(c.unit);
+            }
+
+            bool operator()(const AttackGroundCommand& c) const
+            {
+                return ownsUnit(c.unit);
+            }
+
+            bool operator()(const StopCommand& c) const
+            {
+                return ownsUnit(c.unit);
+            }
+
+        private:
+            bool ownsUnit(UnitId unitId) const
+            {
+                auto it = simulation->units.find(unitId);
+                return it != simulation->units.end() && it->second.owner == player;
+            }
+        };
+    }
+
+    bool GameSimulation::isCommandAllowed(PlayerId player, const SimulationCommand& command) const
+    {
+        return boost::apply_visitor(IsCommandAllowedVisitor(this, player), command);
+    }
 }
@@ -1,14 +1,18 @@
 #ifndef RWE_GAMESIMULATION_H
 #define RWE_GAMESIMULATION_H
 
+#include <map>
+#include <random>
+#include <rwe/BoundingBoxBvh.h>
 #include <rwe/Explosion.h>
 #include <rwe/FeatureId.h>
 #include <rwe/GameTime.h>
-#include <rwe/LaserProjectile.h>
 #include <rwe/MapFeature.h>
 #include <rwe/MapTerrain.h>
 #include <rwe/OccupiedGrid.h>
 #include <rwe/PlayerId.h>
+#include <rwe/ProjectilePool.h>
+#include <rwe/SimulationCommand.h>
 #include <rwe/Unit.h>
 #include <unordered_map>
 
@@ -63,17 +67,40 @@ namespace rwe
 
         FeatureId nextFeatureId{0};
 
-        std::unordered_map<UnitId, Unit> units;
+        /**
+         * Ordered by ID so that units are always updated in the same order,
+         * which the simulation must do to be deterministic.
+         */
+        std::map<UnitId, Unit> units;
+
+        /**
+         * Index of unit selection bounds used for picking.
+         * Kept up to date by updateUnitSelectionBounds.
+         */
+        BoundingBoxBvh<UnitId> unitSelectionBvh;
 
-        std::vector<std::optional<LaserProjectile>> lasers;
+        /** The units in unitSelectionBvh, in the order they were given to it. */
+        std::vector<UnitId> unitSelectionIds;
 
-        std::vector<std::optional<Explosion>> explosions;
+        /** Scratch space for the selection bounds of every unit, in ID order. */
+        std::vector<BoundingBox3f> unitSelectionBoxes;
+
+        ProjectilePool projectiles;
+
+        std::vector<Explosion> explosions;
 
         std::deque<PathRequest> pathRequests;
 
         GameTime gameTime{0};
 
-        explicit GameSimulation(MapTerrain&& terrain);
+        /**
+         * The only source of randomness the simulation may use.
+         * Given the same seed and the same commands, two simulations
+         * produce the same sequence of states.
+         */
+        std::mt19937 rng;
+
+        explicit GameSimulation(MapTerrain&& terrain, unsigned int seed = 0);
 
         FeatureId addFeature(MapFeature&& newFeature);
 
@@ -129,6 +156,12 @@ namespace rwe
 
         bool isPieceTurning(UnitId unitId, const std::string& name, Axis axis) const;
 
+        /**
+         * Refits the unit selection index to the units' current positions,
+         * rebuilding it if units have been added or removed.
+         */
+        void updateUnitSelectionBounds();
+
         std::optional<UnitId> getFirstCollidingUnit(const Ray3f& ray) const;
 
         std::optional<Vector3f> intersectLineWithTerrain(const Line3f& line) const;
@@ -137,8 +170,6 @@ namespace rwe
 
         void requestPath(UnitId unitId);
 
-        LaserProjectile createProjectileFromWeapon(PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction);
-
         void spawnLaser(PlayerId owner, const UnitWeapon& weapon, const Vector3f& position, const Vector3f& direction);
 
         void spawnExplosion(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation);
@@ -146,6 +177,13 @@ namespace rwe
         void spawnSmoke(const Vector3f& position, const std::shared_ptr<SpriteSeries>& animation);
 
         WinStatus computeWinStatus() const;
+
+        /**
+         * Returns true if the given player may give the command.
+         * Players may only order units they own, and may not spawn units.
+         * Commands from peers must pass this check before they are applied.
+         */
+        bool isCommandAllowed(PlayerId player, const SimulationCommand& command) const;
     };
 }
 
@@ -0,0 +1,571 @@
+#include "GameSimulationDriver.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <rwe/GameTime.h>
+#include <rwe/vector_util.h>
+
+namespace rwe
+{
+    GameSimulationDriver::GameSimulationDriver(
+        GameSimulation* simulation,
+        MovementClassCollisionService* collisionService,
+        UnitFactory* unitFactory,
+        AbstractTextureService* textureService,
+        SimulationSoundPlayer* soundPlayer)
+        : simulation(simulation),
+          collisionService(collisionService),
+          unitFactory(unitFactory),
+          soundPlayer(soundPlayer),
+          pathFindingService(simulation, collisionService),
+          unitBehaviorService(this, &pathFindingService, collisionService),
+          cobExecutionService(),
+          unitBoxes(
+              simulation->terrain.leftInWorldUnits(),
+              simulation->terrain.topInWorldUnits(),
+              simulation->terrain.getWidthInWorldUnits(),
+              simulation->terrain.getHeightInWorldUnits(),
+              CollisionGridCellSize),
+          featureBoxes(
+              simulation->terrain.leftInWorldUnits(),
+              simulation->terrain.topInWorldUnits(),
+              simulation->terrain.getWidthInWorldUnits(),
+              simulation->terrain.getHeightInWorldUnits(),
+              CollisionGridCellSize)
+    {
+        for (const auto& p : simulation->features)
+        {
+            if (p.second.isBlocking)
+            {
+                featureBoxes.insert(p.first, createBoundingBox(p.second));
+            }
+        }
+        featureBoxes.build();
+
+        if (textureService != nullptr)
+        {
+            lightSmokeAnimation = textureService->getGafEntry("anims/FX.GAF", "smoke 1");
+        }
+    }
+
+    void GameSimulationDriver::update()
+    {
+        simulation->gameTime = nextGameTime(simulation->gameTime);
+
+        // units are about to move
+        unitBoxesUpToDate = false;
+
+        float secondsElapsed = static_cast<float>(TickInterval) / 1000.0f;
+
+        pathFindingService.update();
+
+        // run unit scripts
+        for (auto& entry : simulation->units)
+        {
+            auto unitId = entry.first;
+            auto& unit = entry.second;
+
+            unitBehaviorService.update(unitId);
+
+            unit.mesh.update(secondsElapsed);
+
+            cobExecutionService.run(*simulation, unitId);
+        }
+
+        updateLasers();
+
+        resolveImpacts();
+
+        updateExplosions();
+
+        // if a commander died this frame, kill the player that owns it
+        for (const auto& p : simulation->units)
+        {
+            if (p.second.isCommander() && p.second.isDead())
+            {
+                killPlayer(p.second.owner);
+            }
+        }
+
+        // resolve the death explosions of units killed along with their commander
+        resolveImpacts();
+
+        deleteDeadUnits();
+    }
+
+    std::optional<UnitId> GameSimulationDriver::spawnUnit(const std::string& unitType, PlayerId owner, const Vector3f& position)
+    {
+        auto unit = unitFactory->createUnit(unitType, owner, simulation->getPlayer(owner).color, position);
+
+        auto unitId = simulation->nextUnitId;
+        if (!simulation->tryAddUnit(std::move(unit)))
+        {
+            return std::nullopt;
+        }
+
+        return unitId;
+    }
+
+    namespace
+    {
+        class ApplyCommandVisitor : public boost::static_visitor<>
+        {
+        private:
+            GameSimulationDriver* driver;
+
+        public:
+            explicit ApplyCommandVisitor(GameSimulationDriver* driver) : driver(driver)
+            {
+            }
+
+            void operator()(const SpawnUnitCommand& c) const
+            {
+                driver->spawnUnit(c.unitType, c.player, toTerrainPosition(c.x, c.z));
+            }
+
+            void operator()(const MoveCommand& c) const
+            {
+                addOrder(c.unit, createMoveOrder(toTerrainPosition(c.x, c.z)), c.queued);
+            }
+
+            void operator()(const AttackCommand& c) const
+            {
+                addOrder(c.unit, createAttackOrder(c.target), c.queued);
+            }
+
+            void operator()(const AttackGroundCommand& c) const
+            {
+                addOrder(c.unit, createAttackGroundOrder(toTerrainPosition(c.x, c.z)), c.queued);
+            }
+
+            void operator()(const StopCommand& c) const
+            {
+                auto& sim = driver->getSimulation();
+                if (sim.unitExists(c.unit))
+                {
+                    sim.getUnit(c.unit).clearOrders();
+                }
+            }
+
+        private:
+            Vector3f toTerrainPosition(float x, float z) const
+            {
+                return Vector3f(x, driver->getTerrain().getHeightAt(x, z), z);
+            }
+
+            void addOrder(UnitId unitId, const UnitOrder& order, bool queued) const
+            {
+                auto& sim = driver->getSimulation();
+                if (!sim.unitExists(unitId))
+                {
+                    return;
+                }
+
+                auto& unit = sim.getUnit(unitId);
+                if (!queued)
+                {
+                    unit.clearOrders();
+                }
+                unit.addOrder(order);
+            }
+        };
+    }
+
+    void GameSimulationDriver::applyCommand(const SimulationCommand& command)
+    {
+        boost::apply_visitor(ApplyCommandVisitor(this), command);
+    }
+
+    void GameSimulationDriver::takeSnapshot(SimulationSnapshot& snapshot) const
+    {
+        takeSimulationSnapshot(*simulation, snapshot);
+    }
+
+    void GameSimulationDriver::restoreSnapshot(const SimulationSnapshot& snapshot)
+    {
+        restoreSimulationSnapshot(*simulation, snapshot, [this](const std::string& unitType, PlayerId owner) {
+            return unitFactory->createUnit(unitType, owner, simulation->getPlayer(owner).color, Vector3f(0.0f, 0.0f, 0.0f));
+        });
+    }
+
+    GameSimulation& GameSimulationDriver::getSimulation()
+    {
+        return *simulation;
+    }
+
+    const GameSimulation& GameSimulationDriver::getSimulation() const
+    {
+        return *simulation;
+    }
+
+    const MapTerrain& GameSimulationDriver::getTerrain() const
+    {
+        return simulation->terrain;
+    }
+
+    GameTime GameSimulationDriver::getGameTime() const
+    {
+        return simulation->gameTime;
+    }
+
+    const PathFindingService& GameSimulationDriver::getPathFindingService() const
+    {
+        return pathFindingService;
+    }
+
+    DiscreteRect GameSimulationDriver::computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const
+    {
+        return simulation->computeFootprintRegion(position, footprintX, footprintZ);
+    }
+
+    bool GameSimulationDriver::isCollisionAt(const DiscreteRect& rect, UnitId self) const
+    {
+        return simulation->isCollisionAt(rect, self);
+    }
+
+    void GameSimulationDriver::moveUnitOccupiedArea(const DiscreteRect& oldRect, const DiscreteRect& newRect, UnitId unitId)
+    {
+        simulation->moveUnitOccupiedArea(oldRect, newRect, unitId);
+    }
+
+    void GameSimulationDriver::playSoundOnSelectChannel(const SoundHandle& sound)
+    {
+        if (soundPlayer != nullptr)
+        {
+            soundPlayer->playSoundOnSelectChannel(sound);
+        }
+    }
+
+    void GameSimulationDriver::playUnitSound(UnitId unitId, const SoundHandle& sound)
+    {
+        if (soundPlayer != nullptr)
+        {
+            soundPlayer->playUnitSound(unitId, sound);
+        }
+    }
+
+    void GameSimulationDriver::playSoundAt(const Vector3f& position, const SoundHandle& sound)
+    {
+        if (soundPlayer != nullptr)
+        {
+            soundPlayer->playSoundAt(position, sound);
+        }
+    }
+
+    void GameSimulationDriver::updateLasers()
+    {
+        auto gameTime = getGameTime();
+        auto& projectiles = simulation->projectiles;
+
+        projectiles.integrate();
+
+        if (projectiles.size() > 0)
+        {
+            updateUnitBoxes();
+        }
+
+        // Removing a projectile moves the last one into its slot,
+        // so the index only advances when the current projectile survives.
+        for (std::size_t i = 0; i < projectiles.size();)
+        {
+            auto position = projectiles.getPosition(i);
+            auto previousPosition = position - projectiles.getVelocity(i);
+            auto owner = projectiles.getOwner(i);
+            const auto& descriptor = projectiles.getDescriptor(i);
+
+            // emit smoke trail
+            if (descriptor.smokeTrail)
+            {
+                if (gameTime > projectiles.getLastSmokeTime(i) + *descriptor.smokeTrail)
+                {
+                    createLightSmoke(position);
+                    projectiles.setLastSmokeTime(i, gameTime);
+                }
+            }
+
+            std::optional<ImpactType> impactType;
+
+            // Sweep the path travelled this tick against units and features,
+            // so that fast projectiles cannot pass through thin targets.
+            Line3f path(previousPosition, position);
+            auto unitHit = unitBoxes.intersectLine(path, [this, owner](UnitId id) {
+                const auto& unit = simulation->getUnit(id);
+                return !unit.isOwnedBy(owner) && !unit.isDead();
+            });
+            auto featureHit = featureBoxes.intersectLine(path, [](FeatureId) { return true; });
+
+            std::optional<float> hitT;
+            if (unitHit)
+            {
+                hitT = unitHit->t;
+            }
+            if (featureHit && (!hitT || featureHit->t < *hitT))
+            {
+                hitT = featureHit->t;
+            }
+
+            if (hitT)
+            {
+                position = previousPosition + ((position - previousPosition) * *hitT);
+                impactType = ImpactType::Normal;
+            }
+            else
+            {
+                // test collision with terrain
+                auto terrainHeight = simulation->terrain.getHeightAt(position.x, position.z);
+                auto seaLevel = simulation->terrain.getSeaLevel();
+
+                // test collision with sea
+                // FIXME: waterweapons should be allowed in water
+                if (seaLevel > terrainHeight && position.y <= seaLevel)
+                {
+                    impactType = ImpactType::Water;
+                }
+                else if (position.y <= terrainHeight)
+                {
+                    impactType = ImpactType::Normal;
+                }
+            }
+
+            // TODO: detect collision between a laser and the world boundary
+
+            if (impactType)
+            {
+                doProjectileImpact(projectiles.getSharedDescriptor(i), position, *impactType);
+                projectiles.remove(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void GameSimulationDriver::updateExplosions()
+    {
+        auto& explosions = simulation->explosions;
+        for (std::size_t i = 0; i < explosions.size();)
+        {
+            auto& exp = explosions[i];
+            if (exp.isFinished(simulation->gameTime))
+            {
+                swapRemove(explosions, i);
+                continue;
+            }
+
+            if (exp.floats)
+            {
+                // TODO: drift with the wind
+                exp.position.y += 0.5f;
+            }
+
+            ++i;
+        }
+    }
+
+    void GameSimulationDriver::doProjectileImpact(const std::shared_ptr<const ProjectileDescriptor>& projectile, const Vector3f& position, ImpactType impactType)
+    {
+        switch (impactType)
+        {
+            case ImpactType::Normal:
+            {
+                if (projectile->soundHit)
+                {
+                    playSoundAt(position, *projectile->soundHit);
+                }
+                if (projectile->explosion)
+                {
+                    simulation->spawnExplosion(position, *projectile->explosion);
+                }
+                if (projectile->endSmoke)
+                {
+                    createLightSmoke(position);
+                }
+                break;
+            }
+            case ImpactType::Water:
+            {
+                if (projectile->soundWater)
+                {
+                    playSoundAt(position, *projectile->soundWater);
+                }
+                if (projectile->waterExplosion)
+                {
+                    simulation->spawnExplosion(position, *projectile->waterExplosion);
+                }
+                break;
+            }
+        }
+
+        pendingImpacts.push_back(PendingImpact{position, projectile});
+    }
+
+    void GameSimulationDriver::resolveImpacts()
+    {
+        // Applying damage can kill units whose death explosions queue further impacts,
+        // so the queue may grow while it is being resolved.
+        for (std::size_t i = 0; i < pendingImpacts.size(); ++i)
+        {
+            auto impact = pendingImpacts[i];
+            applyDamageInRadius(impact.position, impact.projectile->damageRadius, *impact.projectile);
+        }
+
+        pendingImpacts.clear();
+    }
+
+    void GameSimulationDriver::applyDamageInRadius(const Vector3f& position, float radius, const ProjectileDescriptor& projectile)
+    {
+        auto radiusSquared = radius * radius;
+
+        // Impacts can happen with no projectile in flight, e.g. death explosions.
+        updateUnitBoxes();
+
+        candidateDamage.clear();
+        unitBoxes.forEachInArea(
+            position.x - radius,
+            position.z - radius,
+            position.x + radius,
+            position.z + radius,
+            [this, &position, radiusSquared](const auto& entry) {
+                auto unitDistanceSquared = entry.box.distanceSquared(position);
+                if (unitDistanceSquared <= radiusSquared)
+                {
+                    candidateDamage.emplace_back(entry.value, unitDistanceSquared);
+                }
+            });
+
+        for (const auto& candidate : candidateDamage)
+        {
+            const auto& unit = simulation->getUnit(candidate.first);
+
+            // skip dead units, including any killed by this impact
+            if (unit.isDead())
+            {
+                continue;
+            }
+
+            // apply appropriate damage
+            auto damageScale = std::clamp(1.0f - (std::sqrt(candidate.second) / radius), 0.0f, 1.0f);
+            auto rawDamage = projectile.getDamage(unit.unitType);
+            auto scaledDamage = static_cast<unsigned int>(static_cast<float>(rawDamage) * damageScale);
+            applyDamage(candidate.first, scaledDamage);
+        }
+    }
+
+    void GameSimulationDriver::applyDamage(UnitId unitId, unsigned int damagePoints)
+    {
+        auto& unit = simulation->getUnit(unitId);
+        if (unit.hitPoints <= damagePoints)
+        {
+            killUnit(unitId);
+        }
+        else
+        {
+            unit.hitPoints -= damagePoints;
+        }
+    }
+
+    void GameSimulationDriver::createLightSmoke(const Vector3f& position)
+    {
+        if (!lightSmokeAnimation)
+        {
+            return;
+        }
+
+        simulation->spawnSmoke(position, lightSmokeAnimation);
+    }
+
+    void GameSimulationDriver::deleteDeadUnits()
+    {
+        for (auto it = simulation->units.begin(); it != simulation->units.end();)
+        {
+            const auto& unit = it->second;
+            if (unit.isDead())
+            {
+                auto footprintRect = computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+                auto footprintRegion = simulation->occupiedGrid.grid.tryToRegion(footprintRect);
+                assert(!!footprintRegion);
+                simulation->occupiedGrid.grid.setArea(*footprintRegion, OccupiedNone());
+
+                it = simulation->units.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    BoundingBox3f GameSimulationDriver::createBoundingBox(const Unit& unit) const
+    {
+        auto footprint = simulation->computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+        auto min = Vector3f(footprint.x, unit.position.y, footprint.y);
+        auto max = Vector3f(footprint.x + footprint.width, unit.position.y + unit.height, footprint.y + footprint.height);
+        auto worldMin = simulation->terrain.heightmapToWorldSpace(min);
+        auto worldMax = simulation->terrain.heightmapToWorldSpace(max);
+        return BoundingBox3f::fromMinMax(worldMin, worldMax);
+    }
+
+    BoundingBox3f GameSimulationDriver::createBoundingBox(const MapFeature& feature) const
+    {
+        auto footprint = simulation->computeFootprintRegion(feature.position, feature.footprintX, feature.footprintZ);
+        auto min = Vector3f(footprint.x, feature.position.y, footprint.y);
+        auto max = Vector3f(footprint.x + footprint.width, feature.position.y + feature.height, footprint.y + footprint.height);
+        auto worldMin = simulation->terrain.heightmapToWorldSpace(min);
+        auto worldMax = simulation->terrain.heightmapToWorldSpace(max);
+        return BoundingBox3f::fromMinMax(worldMin, worldMax);
+    }
+
+    void GameSimulationDriver::updateUnitBoxes()
+    {
+        if (unitBoxesUpToDate)
+        {
+            return;
+        }
+
+        unitBoxes.clear();
+        for (const auto& p : simulation->units)
+        {
+            if (!p.second.isDead())
+            {
+                unitBoxes.insert(p.first, createBoundingBox(p.second));
+            }
+        }
+        unitBoxes.build();
+        unitBoxesUpToDate = true;
+    }
+
+    void GameSimulationDriver::killUnit(UnitId unitId)
+    {
+        auto& unit = simulation->getUnit(unitId);
+
+        unit.markAsDead();
+
+        // TODO: spawn debris particles, corpse
+        if (unit.explosionWeapon)
+        {
+            auto impactType = unit.position.y < simulation->terrain.getSeaLevel() ? ImpactType::Water : ImpactType::Normal;
+            doProjectileImpact(unit.explosionWeapon->projectile, unit.position, impactType);
+        }
+    }
+
+    void GameSimulationDriver::killPlayer(PlayerId playerId)
+    {
+        simulation->getPlayer(playerId).status = GamePlayerStatus::Dead;
+        for (auto& p : simulation->units)
+        {
+            auto& unit = p.second;
+            if (unit.isDead())
+            {
+                continue;
+            }
+
+            if (!unit.isOwnedBy(playerId))
+            {
+                continue;
+            }
+
+            killUnit(p.first);
+        }
+    }
+}
@@ -0,0 +1,200 @@
+#ifndef RWE_GAMESIMULATIONDRIVER_H
+#define RWE_GAMESIMULATIONDRIVER_H
+
+#include <memory>
+#include <optional>
+#include <rwe/AbstractTextureService.h>
+#include <rwe/BoundingBoxGrid.h>
+#include <rwe/DiscreteRect.h>
+#include <rwe/FeatureId.h>
+#include <rwe/GameSimulation.h>
+#include <rwe/MovementClassCollisionService.h>
+#include <rwe/PlayerId.h>
+#include <rwe/ProjectileDescriptor.h>
+#include <rwe/SimulationCommand.h>
+#include <rwe/SimulationSnapshot.h>
+#include <rwe/SimulationSoundPlayer.h>
+#include <rwe/SoundHandle.h>
+#include <rwe/UnitBehaviorService.h>
+#include <rwe/UnitFactory.h>
+#include <rwe/UnitId.h>
+#include <rwe/cob/CobExecutionService.h>
+#include <rwe/pathfinding/PathFindingService.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rwe
+{
+    enum class ImpactType
+    {
+        Normal,
+        Water
+    };
+
+    struct PendingImpact
+    {
+        Vector3f position;
+        std::shared_ptr<const ProjectileDescriptor> projectile;
+    };
+
+    /**
+     * Advances a game simulation one tick at a time.
+     *
+     * Owns the services that make up the game rules
+     * (unit behaviour, pathfinding, unit scripts, projectiles and damage)
+     * but nothing to do with drawing the game or taking input,
+     * so it can run with or without a window.
+     *
+     * The driver may run on a thread without the graphics context,
+     * so it never loads sprites or meshes while ticking.
+     * Sprites it needs are loaded up front by the constructor,
+     * and units are only created by spawnUnit and restoreSnapshot,
+     * which must be called from the thread that owns the graphics context.
+     */
+    class GameSimulationDriver
+    {
+    private:
+        /**
+         * Width and height of the cells of the collision broadphase grids
+         * in world units.
+         */
+        static constexpr float CollisionGridCellSize = 64.0f;
+
+        GameSimulation* const simulation;
+        MovementClassCollisionService* const collisionService;
+        UnitFactory* const unitFactory;
+
+        /** The animation of the smoke left by projectiles. May be null, in which case no smoke is spawned. */
+        std::shared_ptr<SpriteSeries> lightSmokeAnimation;
+
+        /** May be null, in which case sounds are not played. */
+        SimulationSoundPlayer* const soundPlayer;
+
+        PathFindingService pathFindingService;
+        UnitBehaviorService unitBehaviorService;
+        CobExecutionService cobExecutionService;
+
+        /**
+         * Bounding boxes of live units, for projectile collision and area damage.
+         * Rebuilt at most once per tick, and only on ticks that need them.
+         */
+        BoundingBoxGrid<UnitId> unitBoxes;
+
+        /** True if unitBoxes has been rebuilt since units last moved. */
+        bool unitBoxesUpToDate{false};
+
+        /** Bounding boxes of blocking features, which never move. */
+        BoundingBoxGrid<FeatureId> featureBoxes;
+
+        /** Impacts this tick whose area damage has not yet been applied. */
+        std::vector<PendingImpact> pendingImpacts;
+
+        /** Scratch space for the units in range of an impact and their squared distances. */
+        std::vector<std::pair<UnitId, float>> candidateDamage;
+
+    public:
+        /**
+         * @param textureService Used only here, to load the sprites the simulation spawns.
+         *                       May be null, in which case the simulation spawns no smoke.
+         */
+        GameSimulationDriver(
+            GameSimulation* simulation,
+            MovementClassCollisionService* collisionService,
+            UnitFactory* unitFactory,
+            AbstractTextureService* textureService,
+            SimulationSoundPlayer* soundPlayer);
+
+        GameSimulationDriver(const GameSimulationDriver&) = delete;
+        GameSimulationDriver& operator=(const GameSimulationDriver&) = delete;
+
+        /**
+         * Advances the simulation by one tick.
+         * Units that die during the tick are removed at the end of it.
+         */
+        void update();
+
+        /**
+         * Returns the ID of the new unit, or nothing if there was no room to place it.
+         * Loads the unit's mesh if it has not been loaded yet,
+         * so must be called from the thread that owns the graphics context.
+         */
+        std::optional<UnitId> spawnUnit(const std::string& unitType, PlayerId owner, const Vector3f& position);
+
+        /**
+         * Applies a command to the simulation.
+         * Commands that refer to units which no longer exist are ignored,
+         * since a unit may have died between the command being issued and applied.
+         * A SpawnUnitCommand spawns its unit with spawnUnit, with the same restriction on threads.
+         */
+        void applyCommand(const SimulationCommand& command);
+
+        /** Records the state of the simulation, replacing the previous contents of the snapshot. */
+        void takeSnapshot(SimulationSnapshot& snapshot) const;
+
+        /**
+         * Returns the simulation to the state recorded in the snapshot,
+         * which must have been taken of this game.
+         * Units that have died since the snapshot was taken
+         * are recreated by the unit factory.
+         */
+        void restoreSnapshot(const SimulationSnapshot& snapshot);
+
+        GameSimulation& getSimulation();
+
+        const GameSimulation& getSimulation() const;
+
+        const MapTerrain& getTerrain() const;
+
+        GameTime getGameTime() const;
+
+        const PathFindingService& getPathFindingService() const;
+
+        DiscreteRect computeFootprintRegion(const Vector3f& position, unsigned int footprintX, unsigned int footprintZ) const;
+
+        bool isCollisionAt(const DiscreteRect& rect, UnitId self) const;
+
+        void moveUnitOccupiedArea(const DiscreteRect& oldRect, const DiscreteRect& newRect, UnitId unitId);
+
+        void playSoundOnSelectChannel(const SoundHandle& sound);
+
+        void playUnitSound(UnitId unitId, const SoundHandle& sound);
+
+        void playSoundAt(const Vector3f& position, const SoundHandle& sound);
+
+        /**
+         * Plays the effects of a projectile hitting something at the given position
+         * and queues its area damage, which is applied by the next call to resolveImpacts.
+         */
+        void doProjectileImpact(const std::shared_ptr<const ProjectileDescriptor>& projectile, const Vector3f& position, ImpactType impactType);
+
+        void createLightSmoke(const Vector3f& position);
+
+    private:
+        void updateLasers();
+
+        void updateExplosions();
+
+        /** Applies the area damage of every queued impact, in the order they occurred. */
+        void resolveImpacts();
+
+        void applyDamageInRadius(const Vector3f& position, float radius, const ProjectileDescriptor& projectile);
+
+        void applyDamage(UnitId unitId, unsigned int damagePoints);
+
+        void deleteDeadUnits();
+
+        BoundingBox3f createBoundingBox(const Unit& unit) const;
+
+        BoundingBox3f createBoundingBox(const MapFeature& feature) const;
+
+        /** Rebuilds unitBoxes, unless they were already rebuilt this tick. */
+        void updateUnitBoxes();
+
+        void killUnit(UnitId unitId);
+
+        void killPlayer(PlayerId playerId);
+    };
+}
+
+#endif
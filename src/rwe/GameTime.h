@@ -9,6 +9,9 @@ namespace rwe
     using GameTime = OpaqueUnit<unsigned int, GameTimeTag>;
     using GameTimeDelta = OpaqueUnitDelta<unsigned int, GameTimeTag>;
 
+    /** Number of milliseconds between each game tick. */
+    static const unsigned int TickInterval = 1000 / 60;
+
     GameTime nextGameTime(GameTime time);
 
     GameTimeDelta deltaSecondsToTicks(float seconds);
@@ -0,0 +1,69 @@
+#ifndef RWE_GLVERTEX_H
+#define RWE_GLVERTEX_H
+
+#include <GL/glew.h>
+#include <rwe/math/Vector2f.h>
+#include <rwe/math/Vector3f.h>
+
+namespace rwe
+{
+#pragma pack(1)
+    struct GlTexturedVertex
+    {
+        GLfloat x;
+        GLfloat y;
+        GLfloat z;
+        GLfloat u;
+        GLfloat v;
+
+        GlTexturedVertex() = default;
+        GlTexturedVertex(const Vector3f& pos, const Vector2f& texCoord);
+    };
+
+    struct GlTexturedNormalVertex
+    {
+        GLfloat x;
+        GLfloat y;
+        GLfloat z;
+        GLfloat u;
+        GLfloat v;
+        GLfloat nx;
+        GLfloat ny;
+        GLfloat nz;
+
+        GlTexturedNormalVertex() = default;
+        GlTexturedNormalVertex(const Vector3f& pos, const Vector2f& texCoord, const Vector3f& normal);
+    };
+
+    struct GlColoredVertex
+    {
+        GLfloat x;
+        GLfloat y;
+        GLfloat z;
+        GLfloat r;
+        GLfloat g;
+        GLfloat b;
+
+        GlColoredVertex() = default;
+        GlColoredVertex(const Vector3f& pos, const Vector3f& color);
+    };
+
+    struct GlColoredNormalVertex
+    {
+        GLfloat x;
+        GLfloat y;
+        GLfloat z;
+        GLfloat r;
+        GLfloat g;
+        GLfloat b;
+        GLfloat nx;
+        GLfloat ny;
+        GLfloat nz;
+
+        GlColoredNormalVertex() = default;
+        GlColoredNormalVertex(const Vector3f& pos, const Vector3f& color, const Vector3f& normal);
+    };
+#pragma pack()
+}
+
+#endif
@@ -14,26 +14,6 @@ namespace rwe
         }
     }
 
-    GlTexturedVertex::GlTexturedVertex(const Vector3f& pos, const Vector2f& texCoord)
-        : x(pos.x), y(pos.y), z(pos.z), u(texCoord.x), v(texCoord.y)
-    {
-    }
-
-    GlTexturedNormalVertex::GlTexturedNormalVertex(const Vector3f& pos, const Vector2f& texCoord, const Vector3f& normal)
-        : x(pos.x), y(pos.y), z(pos.z), u(texCoord.x), v(texCoord.y), nx(normal.x), ny(normal.y), nz(normal.z)
-    {
-    }
-
-    GlColoredVertex::GlColoredVertex(const Vector3f& pos, const Vector3f& color)
-        : x(pos.x), y(pos.y), z(pos.z), r(color.x), g(color.y), b(color.z)
-    {
-    }
-
-    GlColoredNormalVertex::GlColoredNormalVertex(const Vector3f& pos, const Vector3f& color, const Vector3f& normal)
-        : x(pos.x), y(pos.y), z(pos.z), r(color.x), g(color.y), b(color.z), nx(normal.x), ny(normal.y), nz(normal.z)
-    {
-    }
-
     AttribMapping::AttribMapping(const std::string& name, GLuint location) : name(name), location(location)
     {
     }
@@ -2,10 +2,11 @@
 #define RWE_GRAPHICSCONTEXT_H
 
 #include <GL/glew.h>
-#include <SDL.h>
 #include <memory>
+#include <rwe/AbstractGraphicsContext.h>
 #include <rwe/ColorPalette.h>
 #include <rwe/GlMesh.h>
+#include <rwe/GlVertex.h>
 #include <rwe/MapFeature.h>
 #include <rwe/MapTerrain.h>
 #include <rwe/Mesh.h>
@@ -23,64 +24,6 @@
 
 namespace rwe
 {
-#pragma pack(1)
-    struct GlTexturedVertex
-    {
-        GLfloat x;
-        GLfloat y;
-        GLfloat z;
-        GLfloat u;
-        GLfloat v;
-
-        GlTexturedVertex() = default;
-        GlTexturedVertex(const Vector3f& pos, const Vector2f& texCoord);
-    };
-
-    struct GlTexturedNormalVertex
-    {
-        GLfloat x;
-        GLfloat y;
-        GLfloat z;
-        GLfloat u;
-        GLfloat v;
-        GLfloat nx;
-        GLfloat ny;
-        GLfloat nz;
-
-        GlTexturedNormalVertex() = default;
-        GlTexturedNormalVertex(const Vector3f& pos, const Vector2f& texCoord, const Vector3f& normal);
-    };
-
-    struct GlColoredVertex
-    {
-        GLfloat x;
-        GLfloat y;
-        GLfloat z;
-        GLfloat r;
-        GLfloat g;
-        GLfloat b;
-
-        GlColoredVertex() = default;
-        GlColoredVertex(const Vector3f& pos, const Vector3f& color);
-    };
-
-    struct GlColoredNormalVertex
-    {
-        GLfloat x;
-        GLfloat y;
-        GLfloat z;
-        GLfloat r;
-        GLfloat g;
-        GLfloat b;
-        GLfloat nx;
-        GLfloat ny;
-        GLfloat nz;
-
-        GlColoredNormalVertex() = default;
-        GlColoredNormalVertex(const Vector3f& pos, const Vector3f& color, const Vector3f& normal);
-    };
-#pragma pack()
-
     struct AttribMapping
     {
         std::string name;
@@ -103,14 +46,14 @@ namespace rwe
         explicit OpenGlException(GLenum error);
     };
 
-    class GraphicsContext
+    class GraphicsContext : public AbstractGraphicsContext
     {
     public:
         void clear();
 
         TextureHandle createTexture(const Grid<Color>& image);
 
-        TextureHandle createTexture(unsigned int width, unsigned int height, const std::vector<Color>& image);
+        TextureHandle createTexture(unsigned int width, unsigned int height, const std::vector<Color>& image) override;
 
         TextureHandle createTexture(unsigned int width, unsigned int height, const Color* image);
 
@@ -147,11 +90,11 @@ namespace rwe
 
         GlMesh createTexturedMesh(const std::vector<GlTexturedVertex>& vertices, GLenum usage);
 
-        GlMesh createColoredMesh(const std::vector<GlColoredVertex>& vertices, GLenum usage);
+        GlMesh createColoredMesh(const std::vector<GlColoredVertex>& vertices, GLenum usage) override;
 
-        GlMesh createTexturedNormalMesh(const std::vector<GlTexturedNormalVertex>& vertices, GLenum usage);
+        GlMesh createTexturedNormalMesh(const std::vector<GlTexturedNormalVertex>& vertices, GLenum usage) override;
 
-        GlMesh createColoredNormalMesh(const std::vector<GlColoredNormalVertex>& vertices, GLenum usage);
+        GlMesh createColoredNormalMesh(const std::vector<GlColoredNormalVertex>& vertices, GLenum usage) override;
 
         void bindShader(ShaderProgramIdentifier shader);
 
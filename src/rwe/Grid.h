@@ -1,6 +1,7 @@
 #ifndef RWE_GRID_H
 #define RWE_GRID_H
 
+#include <algorithm>
 #include <cassert>
 #include <functional>
 #include <optional>
@@ -227,10 +228,9 @@ namespace rwe
 
         for (std::size_t dy = 0; dy < replacement.getHeight(); ++dy)
         {
-            for (std::size_t dx = 0; dx < replacement.getWidth(); ++dx)
-            {
-                set(x + dx, y + dy, replacement.get(dx, dy));
-            }
+            auto srcBegin = replacement.data.begin() + (dy * replacement.getWidth());
+            auto srcEnd = srcBegin + replacement.getWidth();
+            std::copy(srcBegin, srcEnd, data.begin() + toIndex(x, y + dy));
         }
     }
 
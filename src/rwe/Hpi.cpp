@@ -264,7 +264,7 @@ namespace rwe
         return Directory{v};
     }
 
-    HpiArchive::HpiArchive(std::istream* stream) : stream(stream)
+    HpiArchive::HpiArchive(std::istream* stream)
     {
         auto v = readRaw<HpiVersion>(*stream);
         if (v.marker != HpiMagicNumber)
@@ -299,18 +299,19 @@ namespace rwe
         return _root;
     }
 
-    void HpiArchive::extract(const HpiArchive::File& file, char* buffer) const
+    void HpiArchive::extract(std::istream& stream, const HpiArchive::File& file, char* buffer) const
     {
         auto chunkCount = (file.size / 65536) + (file.size % 65536 == 0 ? 0 : 1);
-        stream->seekg(file.offset);
+        stream.clear();
+        stream.seekg(file.offset);
 
         auto chunkSizes = std::make_unique<uint32_t[]>(chunkCount);
-        readAndDecryptRawArray(*stream, decryptionKey, chunkSizes.get(), chunkCount);
+        readAndDecryptRawArray(stream, decryptionKey, chunkSizes.get(), chunkCount);
 
         std::size_t bufferOffset = 0;
         for (std::size_t i = 0; i < chunkCount; ++i)
         {
-            auto chunkHeader = readAndDecryptRaw<HpiChunk>(*stream, decryptionKey);
+            auto chunkHeader = readAndDecryptRaw<HpiChunk>(stream, decryptionKey);
             if (chunkHeader.marker != HpiChunkMagicNumber)
             {
                 throw HpiException("Invalid chunk header");
@@ -322,7 +323,7 @@ namespace rwe
             }
 
             auto chunkBuffer = std::make_unique<char[]>(chunkHeader.compressedSize);
-            readAndDecrypt(*stream, decryptionKey, chunkBuffer.get(), chunkHeader.compressedSize);
+            readAndDecrypt(stream, decryptionKey, chunkBuffer.get(), chunkHeader.compressedSize);
 
             auto checksum = computeChecksum(chunkBuffer.get(), chunkHeader.compressedSize);
             if (checksum != chunkHeader.checksum)
@@ -380,8 +381,8 @@ namespace rwe
         auto it = std::find_if(
             dir.entries.begin(),
             dir.entries.end(),
-            [name](const HpiArchive::DirectoryEntry& e) {
-                return toUpper(e.name) == toUpper(name);
+            [&name](const HpiArchive::DirectoryEntry& e) {
+                return equalsIgnoreCase(e.name, name);
             });
 
         if (it == dir.entries.end())
@@ -420,8 +421,8 @@ namespace rwe
             auto it = std::find_if(
                 begin,
                 end,
-                [c](const DirectoryEntry& e) {
-                    return toUpper(e.name) == toUpper(c);
+                [&c](const DirectoryEntry& e) {
+                    return equalsIgnoreCase(e.name, c);
                 });
             if (it == end)
             {
@@ -456,8 +457,8 @@ namespace rwe
             auto it = std::find_if(
                 begin,
                 end,
-                [c](const DirectoryEntry& e) {
-                    return toUpper(e.name) == toUpper(c);
+                [&c](const DirectoryEntry& e) {
+                    return equalsIgnoreCase(e.name, c);
                 });
             if (it == end)
             {
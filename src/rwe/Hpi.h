@@ -127,11 +127,14 @@ namespace rwe
         };
 
     private:
-        std::istream* stream;
         unsigned char decryptionKey;
         Directory _root;
 
     public:
+        /**
+         * Reads the archive directory from the given stream.
+         * The stream is only used during construction.
+         */
         explicit HpiArchive(std::istream* stream);
 
         const Directory& root() const;
@@ -140,7 +143,15 @@ namespace rwe
 
         std::optional<std::reference_wrapper<const Directory>> findDirectory(const std::string& path) const;
 
-        void extract(const File& file, char* buffer) const;
+        /**
+         * Extracts the given file from the archive into the buffer.
+         * The stream must be open on the same archive that this object was constructed from.
+         *
+         * This method does not modify the archive, so it is safe
+         * to call concurrently from multiple threads
+         * provided that each thread supplies its own stream.
+         */
+        void extract(std::istream& stream, const File& file, char* buffer) const;
 
     private:
         HpiArchive::File convertFile(const HpiFileData& file);
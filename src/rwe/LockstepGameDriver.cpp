@@ -0,0 +1,188 @@
+#include "LockstepGameDriver.h"
+
+#include <rwe/GameTime.h>
+#include <rwe/SimulationChecksum.h>
+#include <spdlog/spdlog.h>
+
+namespace rwe
+{
+    namespace
+    {
+        std::vector<unsigned int> getPeerSlots(const NetworkParameters& parameters)
+        {
+            std::vector<unsigned int> slots;
+            for (const auto& peer : parameters.peers)
+            {
+                slots.push_back(peer.slot);
+            }
+            return slots;
+        }
+    }
+
+    LockstepGameDriver::LockstepGameDriver(
+        GameSimulationDriver* simulationDriver,
+        ReplayRecorder* replayRecorder,
+        const NetworkParameters& parameters,
+        const std::array<std::optional<PlayerId>, 10>& slotPlayers,
+        unsigned int localSeed)
+        : simulationDriver(simulationDriver),
+          replayRecorder(replayRecorder),
+          session(parameters.localSlot, getPeerSlots(parameters), simulationDriver->getGameTime(), TickInterval, localSeed),
+          slotPlayers(slotPlayers),
+          transport(parameters)
+    {
+    }
+
+    void LockstepGameDriver::submit(const SimulationCommand& command)
+    {
+        session.submit(command);
+    }
+
+    void LockstepGameDriver::receivePackets()
+    {
+        while (auto slot = transport.receive(buffer))
+        {
+            try
+            {
+                auto received = readLockstepPacket(buffer.data(), buffer.size());
+
+                // a peer may only speak for its own slot
+                if (received.sender == *slot)
+                {
+                    receivedPackets.push_back(std::move(received));
+                }
+            }
+            catch (const LockstepPacketException&)
+            {
+                // Drop anything malformed, as the network might.
+                // The peer resends everything we need.
+            }
+        }
+    }
+
+    unsigned int LockstepGameDriver::update(uint32_t now)
+    {
+        deliverPackets(now);
+
+        if (!isAtEnd() && ticksBehind < MaxTicksBehind)
+        {
+            // Past the limit we can't catch up, so give up on the time we've lost.
+            ++ticksBehind;
+        }
+
+        unsigned int ticksRun = 0;
+        while (ticksBehind > 0 && ticksRun < MaxTicksPerUpdate && !isAtEnd() && session.isReady())
+        {
+            runTick();
+            --ticksBehind;
+            ++ticksRun;
+        }
+
+        if (ticksRun == 0 && ticksBehind > 0 && !isAtEnd())
+        {
+            ++stalledUpdates;
+        }
+
+        session.sealInputs();
+        makePackets(now);
+
+        return ticksRun;
+    }
+
+    void LockstepGameDriver::sendPackets()
+    {
+        for (const auto& outgoing : outgoingPackets)
+        {
+            transport.send(outgoing.slot, outgoing.data);
+        }
+    }
+
+    void LockstepGameDriver::stopAt(GameTime time)
+    {
+        endTime = time;
+    }
+
+    unsigned int LockstepGameDriver::getInputDelay() const
+    {
+        return session.getInputDelay();
+    }
+
+    unsigned int LockstepGameDriver::getStalledUpdates() const
+    {
+        return stalledUpdates;
+    }
+
+    const LockstepSession& LockstepGameDriver::getSession() const
+    {
+        return session;
+    }
+
+    bool LockstepGameDriver::isAtEnd() const
+    {
+        return endTime && simulationDriver->getGameTime().value >= endTime->value;
+    }
+
+    void LockstepGameDriver::deliverPackets(uint32_t now)
+    {
+        for (const auto& received : receivedPackets)
+        {
+            session.receivePacket(received, now);
+        }
+        receivedPackets.clear();
+    }
+
+    void LockstepGameDriver::makePackets(uint32_t now)
+    {
+        outgoingPackets.resize(session.getPeerCount());
+        for (std::size_t i = 0; i < session.getPeerCount(); ++i)
+        {
+            session.makePacket(i, now, packet);
+            outgoingPackets[i].slot = session.getPeerSlot(i);
+            writeLockstepPacket(packet, outgoingPackets[i].data);
+        }
+    }
+
+    void LockstepGameDriver::runTick()
+    {
+        auto& simulation = simulationDriver->getSimulation();
+
+        if (!seeded)
+        {
+            auto seed = session.getGameSeed();
+            simulation.rng.seed(seed);
+            if (replayRecorder)
+            {
+                replayRecorder->setSeed(seed);
+            }
+            seeded = true;
+        }
+
+        session.advance(commands);
+        for (const auto& command : commands)
+        {
+            const auto& player = slotPlayers[command.slot];
+            if (!player || !simulation.isCommandAllowed(*player, command.command))
+            {
+                if (auto logger = spdlog::get("rwe"))
+                {
+                    logger->warn("Dropped a command from slot {} that its player may not give", command.slot);
+                }
+                continue;
+            }
+
+            simulationDriver->applyCommand(command.command);
+            if (replayRecorder)
+            {
+                replayRecorder->record(simulation.gameTime, command.command);
+            }
+        }
+
+        simulationDriver->update();
+        if (replayRecorder)
+        {
+            replayRecorder->advanceTo(simulation.gameTime);
+        }
+
+        session.recordChecksum(simulation.gameTime, computeSimulationChecksum(simulation));
+    }
+}
@@ -0,0 +1,163 @@
+#ifndef RWE_LOCKSTEPGAMEDRIVER_H
+#define RWE_LOCKSTEPGAMEDRIVER_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <rwe/GameParameters.h>
+#include <rwe/GameSimulationDriver.h>
+#include <rwe/GameTime.h>
+#include <rwe/LockstepPacket.h>
+#include <rwe/LockstepSession.h>
+#include <rwe/LockstepUdpTransport.h>
+#include <rwe/PlayerId.h>
+#include <rwe/Replay.h>
+#include <rwe/SimulationCommand.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Runs a game simulation in lockstep with peers on other machines.
+     *
+     * Takes the place of calling the simulation driver directly:
+     * local commands are submitted here rather than applied,
+     * and the simulation only advances when the commands of every peer
+     * for the next tick have arrived.
+     *
+     * Each game tick the caller calls receivePackets, then update, then sendPackets.
+     * Only update touches the session and the simulation,
+     * so when the simulation is shared behind a lock
+     * the network I/O in the other two can happen without holding it.
+     * All three must be called from the same thread.
+     *
+     * Every command that comes out of the session, including our own,
+     * is checked against the player in the slot that gave it
+     * and dropped if that player may not give it,
+     * so that a peer cannot order units it does not own.
+     * Every peer drops the same commands, so the simulations stay in step.
+     */
+    class LockstepGameDriver
+    {
+    public:
+        /**
+         * The most ticks run in one update.
+         * After a stall the game catches up by running extra ticks each update,
+         * a few at a time so that frames keep coming.
+         */
+        static constexpr unsigned int MaxTicksPerUpdate = 3;
+
+        /**
+         * The most ticks the game may fall behind real time.
+         * After a long stall, ticks beyond this are dropped
+         * so that the game resumes at normal speed rather than
+         * racing through the whole backlog.
+         */
+        static constexpr unsigned int MaxTicksBehind = 5 * MaxTicksPerUpdate;
+
+    private:
+        GameSimulationDriver* const simulationDriver;
+
+        /** May be null, in which case the game is not recorded. */
+        ReplayRecorder* const replayRecorder;
+
+        LockstepSession session;
+
+        /** The player in each slot, or nothing if the slot is empty. */
+        std::array<std::optional<PlayerId>, 10> slotPlayers;
+
+        LockstepUdpTransport transport;
+
+        /** If set, no ticks are run once the simulation reaches this time. */
+        std::optional<GameTime> endTime;
+
+        /** Ticks that have fallen due but have not yet run, never more than MaxTicksBehind. */
+        unsigned int ticksBehind{0};
+
+        /** The number of updates in which a tick was due but the commands for it had not arrived. */
+        unsigned int stalledUpdates{0};
+
+        /** True once the simulation has been reseeded with the seed agreed by the peers. */
+        bool seeded{false};
+
+        /** Packets taken off the network by receivePackets, waiting for update to give them to the session. */
+        std::vector<LockstepPacket> receivedPackets;
+
+        struct OutgoingPacket
+        {
+            unsigned int slot;
+            std::vector<char> data;
+        };
+
+        /** Datagrams made by update, waiting for sendPackets to put them on the network, one per peer. */
+        std::vector<OutgoingPacket> outgoingPackets;
+
+        LockstepPacket packet;
+        std::vector<char> buffer;
+        std::vector<LockstepCommand> commands;
+
+    public:
+        /**
+         * Before the first tick the simulation's random number generator is reseeded
+         * with the game seed agreed with the peers, to which localSeed is our share.
+         * Throws SDLNetException if the network cannot be set up.
+         */
+        LockstepGameDriver(
+            GameSimulationDriver* simulationDriver,
+            ReplayRecorder* replayRecorder,
+            const NetworkParameters& parameters,
+            const std::array<std::optional<PlayerId>, 10>& slotPlayers,
+            unsigned int localSeed);
+
+        LockstepGameDriver(const LockstepGameDriver&) = delete;
+        LockstepGameDriver& operator=(const LockstepGameDriver&) = delete;
+
+        /** Queues a command given by the local player, to be applied after the input delay. */
+        void submit(const SimulationCommand& command);
+
+        /**
+         * Takes waiting packets off the network and holds them for the next update.
+         * Does not touch the session or the simulation.
+         */
+        void receivePackets();
+
+        /**
+         * Gives the received packets to the session, runs the ticks that are due and ready,
+         * and makes the packets for the next sendPackets.
+         * Call once per game tick, i.e. every TickInterval milliseconds.
+         * Returns the number of ticks run.
+         *
+         * @param now The current time in milliseconds.
+         */
+        unsigned int update(uint32_t now);
+
+        /**
+         * Sends the packets made by the last update to peers.
+         * Does not touch the session or the simulation.
+         */
+        void sendPackets();
+
+        /**
+         * Stops running ticks once the simulation reaches the given time.
+         * Packets are still exchanged, so that peers can finish too.
+         */
+        void stopAt(GameTime time);
+
+        unsigned int getInputDelay() const;
+
+        unsigned int getStalledUpdates() const;
+
+        const LockstepSession& getSession() const;
+
+    private:
+        bool isAtEnd() const;
+
+        void deliverPackets(uint32_t now);
+
+        void makePackets(uint32_t now);
+
+        void runTick();
+    };
+}
+
+#endif
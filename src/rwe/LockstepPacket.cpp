@@ -0,0 +1,263 @@
+#include "LockstepPacket.h"
+
+#include <limits>
+#include <rwe/BinaryReader.h>
+#include <rwe/BinaryWriter.h>
+#include <rwe/SimulationCommandFields.h>
+
+namespace rwe
+{
+    namespace
+    {
+        /** Set in the flags byte when the packet carries an echo. */
+        const uint8_t LockstepHasEchoFlag = 1;
+
+        /** Writes values to a buffer in the packet layout. */
+        class LockstepWriter
+        {
+        private:
+            BinaryWriter writer;
+
+        public:
+            explicit LockstepWriter(std::vector<char>* buffer) : writer(buffer)
+            {
+            }
+
+            void field(uint8_t value)
+            {
+                writer.write(value);
+            }
+
+            void field(uint16_t value)
+            {
+                writer.write(value);
+            }
+
+            void field(uint32_t value)
+            {
+                writer.write(value);
+            }
+
+            void field(uint64_t value)
+            {
+                writer.write(value);
+            }
+
+            void field(float value)
+            {
+                writer.write(value);
+            }
+
+            void field(bool value)
+            {
+                writer.write(value);
+            }
+
+            /** Strings are prefixed by a 16-bit size to keep packets small. */
+            void field(const std::string& value)
+            {
+                if (value.size() > std::numeric_limits<uint16_t>::max())
+                {
+                    throw LockstepPacketException("String is too long for a lockstep packet");
+                }
+
+                field(static_cast<uint16_t>(value.size()));
+                writer.writeBytes(value.data(), value.size());
+            }
+
+            template <typename T>
+            void field(const T& value)
+            {
+                transferFields(*this, value);
+            }
+        };
+
+        /** Reads values back out of a packet. */
+        class LockstepReader
+        {
+        private:
+            BinaryReader<LockstepPacketException> reader;
+
+        public:
+            LockstepReader(const char* begin, const char* end) : reader(begin, end, "Lockstep packet is truncated")
+            {
+            }
+
+            bool atEnd() const
+            {
+                return reader.atEnd();
+            }
+
+            void field(uint8_t& value)
+            {
+                value = reader.read<uint8_t>();
+            }
+
+            void field(uint16_t& value)
+            {
+                value = reader.read<uint16_t>();
+            }
+
+            void field(uint32_t& value)
+            {
+                value = reader.read<uint32_t>();
+            }
+
+            void field(uint64_t& value)
+            {
+                value = reader.read<uint64_t>();
+            }
+
+            void field(float& value)
+            {
+                value = reader.read<float>();
+            }
+
+            void field(bool& value)
+            {
+                value = reader.read<bool>();
+            }
+
+            void field(std::string& value)
+            {
+                auto size = reader.read<uint16_t>();
+                value.assign(reader.skip(size), size);
+            }
+
+            template <typename T>
+            void field(T& value)
+            {
+                transferFields(*this, value);
+            }
+        };
+
+        uint8_t checkCount(std::size_t count, const char* what)
+        {
+            if (count > std::numeric_limits<uint8_t>::max())
+            {
+                throw LockstepPacketException(std::string("Too many ") + what + " for a lockstep packet");
+            }
+
+            return static_cast<uint8_t>(count);
+        }
+    }
+
+    LockstepPacketException::LockstepPacketException(const std::string& message) : runtime_error(message)
+    {
+    }
+
+    void writeLockstepPacket(const LockstepPacket& packet, std::vector<char>& buffer)
+    {
+        buffer.clear();
+        LockstepWriter w(&buffer);
+
+        w.field(LockstepMagicNumber);
+        w.field(LockstepVersion);
+        w.field(packet.sender);
+        w.field(packet.sendTime);
+        w.field(packet.seed);
+        w.field(static_cast<uint8_t>(packet.echo ? LockstepHasEchoFlag : 0));
+        if (packet.echo)
+        {
+            w.field(packet.echo->time);
+            w.field(packet.echo->delay);
+        }
+        w.field(packet.ack.value);
+
+        w.field(packet.firstTick.value);
+        w.field(checkCount(packet.batches.size(), "batches"));
+        for (const auto& batch : packet.batches)
+        {
+            w.field(checkCount(batch.size(), "commands"));
+            for (const auto& command : batch)
+            {
+                w.field(getCommandTag(command));
+                writeCommandFields(w, command);
+            }
+        }
+
+        w.field(checkCount(packet.checksums.size(), "checksums"));
+        for (const auto& checksum : packet.checksums)
+        {
+            w.field(checksum.time.value);
+            w.field(checksum.checksum);
+        }
+    }
+
+    LockstepPacket readLockstepPacket(const char* data, std::size_t size)
+    {
+        LockstepReader r(data, data + size);
+
+        uint32_t magic;
+        r.field(magic);
+        if (magic != LockstepMagicNumber)
+        {
+            throw LockstepPacketException("Not a lockstep packet");
+        }
+
+        uint8_t version;
+        r.field(version);
+        if (version != LockstepVersion)
+        {
+            throw LockstepPacketException("Unsupported lockstep version " + std::to_string(version));
+        }
+
+        LockstepPacket packet;
+        r.field(packet.sender);
+        r.field(packet.sendTime);
+        r.field(packet.seed);
+
+        uint8_t flags;
+        r.field(flags);
+        if ((flags & ~LockstepHasEchoFlag) != 0)
+        {
+            throw LockstepPacketException("Lockstep packet has unknown flags");
+        }
+        if ((flags & LockstepHasEchoFlag) != 0)
+        {
+            LockstepEcho echo{0, 0};
+            r.field(echo.time);
+            r.field(echo.delay);
+            packet.echo = echo;
+        }
+        r.field(packet.ack.value);
+
+        r.field(packet.firstTick.value);
+        uint8_t batchCount;
+        r.field(batchCount);
+        packet.batches.resize(batchCount);
+        for (auto& batch : packet.batches)
+        {
+            uint8_t commandCount;
+            r.field(commandCount);
+            batch.reserve(commandCount);
+            for (unsigned int i = 0; i < commandCount; ++i)
+            {
+                uint8_t tag;
+                r.field(tag);
+                auto command = readCommandFields(r, tag);
+                if (!command)
+                {
+                    throw LockstepPacketException("Lockstep packet has an unknown command type " + std::to_string(tag));
+                }
+                batch.push_back(std::move(*command));
+            }
+        }
+
+        uint8_t checksumCount;
+        r.field(checksumCount);
+        packet.checksums.resize(checksumCount, LockstepChecksum{GameTime(0), 0});
+        for (auto& checksum : packet.checksums)
+        {
+            r.field(checksum.time.value);
+            r.field(checksum.checksum);
+        }
+
+        if (!r.atEnd())
+        {
+            throw LockstepPacketException("Lockstep packet has trailing data");
+        }
+
+        return packet;
+    }
+}
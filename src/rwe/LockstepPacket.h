@@ -0,0 +1,86 @@
+#ifndef RWE_LOCKSTEPPACKET_H
+#define RWE_LOCKSTEPPACKET_H
+
+#include <cstdint>
+#include <optional>
+#include <rwe/GameTime.h>
+#include <rwe/SimulationCommand.h>
+#include <stdexcept>
+#include <vector>
+
+namespace rwe
+{
+    /** The magic number at the start of every lockstep packet ("RWEL"). */
+    static const uint32_t LockstepMagicNumber = 0x4c455752;
+
+    /**
+     * The version of the lockstep protocol.
+     * Peers only talk to peers of the same version,
+     * so bump this whenever the layout or any of the commands change.
+     */
+    static const uint8_t LockstepVersion = 2;
+
+    /** The send time of the last packet received from a peer, sent back to it to measure the round trip. */
+    struct LockstepEcho
+    {
+        /** The time the echoed packet was sent, by the clock of the peer that sent it. */
+        uint32_t time;
+
+        /** How long in milliseconds the echoed packet was held before this packet was sent. */
+        uint32_t delay;
+    };
+
+    struct LockstepChecksum
+    {
+        /** The time of the simulation when the checksum was taken, just after the tick that reached it. */
+        GameTime time;
+        uint64_t checksum;
+    };
+
+    /**
+     * A datagram exchanged between the peers of a lockstep game.
+     *
+     * UDP may drop, repeat or reorder packets,
+     * so each one carries everything the receiver might still be missing:
+     * the sender's command batches for every tick the receiver has not yet acknowledged
+     * and the sender's most recent checksums.
+     */
+    struct LockstepPacket
+    {
+        /** The player slot of the sender. */
+        uint8_t sender{0};
+
+        /** The time the packet was sent, in milliseconds by the sender's clock. */
+        uint32_t sendTime{0};
+
+        /** The sender's share of the seed for the simulation's random number generator. */
+        uint32_t seed{0};
+
+        std::optional<LockstepEcho> echo;
+
+        /** The first tick for which the sender has yet to receive the receiver's commands. */
+        GameTime ack{0};
+
+        /** The tick of the first of the batches. */
+        GameTime firstTick{0};
+
+        /** The sender's commands for each tick from firstTick onwards, one batch per tick. */
+        std::vector<std::vector<SimulationCommand>> batches;
+
+        std::vector<LockstepChecksum> checksums;
+    };
+
+    class LockstepPacketException : public std::runtime_error
+    {
+    public:
+        explicit LockstepPacketException(const std::string& message);
+    };
+
+    /** Writes the packet into the buffer, replacing its previous contents. */
+    void writeLockstepPacket(const LockstepPacket& packet, std::vector<char>& buffer);
+
+    /** Throws LockstepPacketException if the data is not a well formed packet. */
+    LockstepPacket readLockstepPacket(const char* data, std::size_t size);
+}
+
+#endif
@@ -0,0 +1,356 @@
+#include "LockstepSession.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace rwe
+{
+    namespace
+    {
+        /**
+         * How far past the next tick batches from a peer are accepted.
+         * A well behaved peer is never more than two input delays ahead,
+         * so this only guards against runaway memory use.
+         */
+        const unsigned int MaxBatchesAhead = 4 * LockstepSession::MaxInputDelay;
+    }
+
+    LockstepSession::LockstepSession(unsigned int localSlot, const std::vector<unsigned int>& remoteSlots, GameTime startTime, unsigned int tickInterval, uint32_t localSeed)
+        : localSlot(localSlot),
+          tickInterval(tickInterval),
+          localSeed(localSeed),
+          currentTick(startTime),
+          localBatchesStart(startTime),
+          inputDelay(MinInputDelay),
+          lastInputDelayDecrease(startTime)
+    {
+        for (auto slot : remoteSlots)
+        {
+            Peer peer;
+            peer.slot = slot;
+            peer.ack = startTime;
+            peers.push_back(std::move(peer));
+        }
+
+        // commands are applied in slot order
+        std::sort(peers.begin(), peers.end(), [](const auto& a, const auto& b) { return a.slot < b.slot; });
+
+        sealInputs();
+    }
+
+    void LockstepSession::submit(const SimulationCommand& command)
+    {
+        pendingCommands.push_back(command);
+    }
+
+    void LockstepSession::sealInputs()
+    {
+        updateInputDelay();
+
+        auto sealUntil = currentTick.value + inputDelay;
+        while (sealedEnd().value < sealUntil)
+        {
+            auto count = std::min<std::size_t>(pendingCommands.size(), MaxCommandsPerBatch);
+            localBatches.emplace_back(pendingCommands.begin(), pendingCommands.begin() + count);
+            pendingCommands.erase(pendingCommands.begin(), pendingCommands.begin() + count);
+        }
+    }
+
+    bool LockstepSession::isReady() const
+    {
+        if (sealedEnd().value <= currentTick.value)
+        {
+            return false;
+        }
+
+        return std::all_of(peers.begin(), peers.end(), [](const auto& p) { return p.seed && !p.batches.empty(); });
+    }
+
+    uint32_t LockstepSession::getGameSeed() const
+    {
+        auto seed = localSeed;
+        for (const auto& peer : peers)
+        {
+            assert(peer.seed);
+            seed ^= *peer.seed;
+        }
+        return seed;
+    }
+
+    void LockstepSession::advance(std::vector<LockstepCommand>& commands)
+    {
+        assert(isReady());
+
+        commands.clear();
+
+        auto addBatch = [&commands](unsigned int slot, const std::vector<SimulationCommand>& batch) {
+            for (const auto& command : batch)
+            {
+                commands.push_back(LockstepCommand{slot, command});
+            }
+        };
+
+        const auto& localBatch = localBatches[currentTick.value - localBatchesStart.value];
+        bool localAdded = false;
+        for (auto& peer : peers)
+        {
+            if (!localAdded && localSlot < peer.slot)
+            {
+                addBatch(localSlot, localBatch);
+                localAdded = true;
+            }
+
+            addBatch(peer.slot, peer.batches.front());
+            peer.batches.pop_front();
+        }
+        if (!localAdded)
+        {
+            addBatch(localSlot, localBatch);
+        }
+
+        currentTick = nextGameTime(currentTick);
+        trimLocalBatches();
+    }
+
+    void LockstepSession::recordChecksum(GameTime time, uint64_t checksum)
+    {
+        localChecksums.push_back(LockstepChecksum{time, checksum});
+        if (localChecksums.size() > ChecksumHistorySize)
+        {
+            localChecksums.pop_front();
+        }
+
+        for (auto& peer : peers)
+        {
+            while (!peer.futureChecksums.empty() && peer.futureChecksums.front().time.value <= time.value)
+            {
+                compareChecksum(peer.futureChecksums.front());
+                peer.futureChecksums.pop_front();
+            }
+        }
+    }
+
+    void LockstepSession::makePacket(std::size_t peerIndex, uint32_t now, LockstepPacket& packet) const
+    {
+        const auto& peer = peers.at(peerIndex);
+
+        packet.sender = static_cast<uint8_t>(localSlot);
+        packet.sendTime = now;
+        packet.seed = localSeed;
+
+        if (peer.lastEcho)
+        {
+            packet.echo = LockstepEcho{peer.lastEcho->time, now - peer.lastEchoReceivedTime};
+        }
+        else
+        {
+            packet.echo = std::nullopt;
+        }
+
+        packet.ack = GameTime(currentTick.value + static_cast<unsigned int>(peer.batches.size()));
+
+        // The peer's ack never falls behind our oldest batch,
+        // since batches are only dropped once every peer has acknowledged them.
+        packet.firstTick = peer.ack;
+        auto first = localBatches.begin() + (peer.ack.value - localBatchesStart.value);
+        auto last = first + std::min<std::ptrdiff_t>(localBatches.end() - first, MaxBatchesPerPacket);
+        packet.batches.assign(first, last);
+
+        auto checksumCount = std::min<std::size_t>(localChecksums.size(), ChecksumsPerPacket);
+        packet.checksums.assign(localChecksums.end() - checksumCount, localChecksums.end());
+    }
+
+    bool LockstepSession::receivePacket(const LockstepPacket& packet, uint32_t now)
+    {
+        auto it = std::find_if(peers.begin(), peers.end(), [&packet](const auto& p) { return p.slot == packet.sender; });
+        if (it == peers.end())
+        {
+            return false;
+        }
+        auto& peer = *it;
+
+        if (!peer.seed)
+        {
+            peer.seed = packet.seed;
+        }
+
+        if (packet.ack.value > peer.ack.value)
+        {
+            peer.ack = GameTime(std::min(packet.ack.value, sealedEnd().value));
+            trimLocalBatches();
+        }
+
+        // Only take batches that follow on from those we have.
+        // Anything later is resent once the peer sees our ack.
+        auto nextTick = currentTick.value + static_cast<unsigned int>(peer.batches.size());
+        for (std::size_t i = 0; i < packet.batches.size(); ++i)
+        {
+            auto tick = packet.firstTick.value + static_cast<unsigned int>(i);
+            if (tick == nextTick && nextTick < currentTick.value + MaxBatchesAhead)
+            {
+                peer.batches.push_back(packet.batches[i]);
+                ++nextTick;
+            }
+        }
+
+        peer.lastEcho = LockstepEcho{packet.sendTime, 0};
+        peer.lastEchoReceivedTime = now;
+
+        if (packet.echo)
+        {
+            updateRoundTripTime(peer, *packet.echo, now);
+        }
+
+        receiveChecksums(peer, packet.checksums);
+
+        return true;
+    }
+
+    GameTime LockstepSession::getCurrentTick() const
+    {
+        return currentTick;
+    }
+
+    unsigned int LockstepSession::getInputDelay() const
+    {
+        return inputDelay;
+    }
+
+    std::size_t LockstepSession::getPeerCount() const
+    {
+        return peers.size();
+    }
+
+    unsigned int LockstepSession::getPeerSlot(std::size_t peerIndex) const
+    {
+        return peers.at(peerIndex).slot;
+    }
+
+    std::optional<float> LockstepSession::getRoundTripTime(std::size_t peerIndex) const
+    {
+        return peers.at(peerIndex).roundTripTime;
+    }
+
+    std::optional<GameTime> LockstepSession::getDesyncTime() const
+    {
+        return desyncTime;
+    }
+
+    GameTime LockstepSession::sealedEnd() const
+    {
+        return GameTime(localBatchesStart.value + static_cast<unsigned int>(localBatches.size()));
+    }
+
+    void LockstepSession::updateInputDelay()
+    {
+        std::optional<float> worstLatency;
+        for (const auto& peer : peers)
+        {
+            if (peer.roundTripTime)
+            {
+                // half the round trip to get there, plus some slack for jitter
+                auto latency = (*peer.roundTripTime / 2.0f) + (2.0f * peer.roundTripTimeVariance);
+                worstLatency = std::max(worstLatency.value_or(0.0f), latency);
+            }
+        }
+
+        if (!worstLatency)
+        {
+            return;
+        }
+
+        // One more tick covers the wait between sealing a batch and sending it.
+        auto ticks = static_cast<unsigned int>(std::ceil(*worstLatency / static_cast<float>(tickInterval))) + 1;
+        auto target = std::clamp(ticks, MinInputDelay, MaxInputDelay);
+
+        if (target > inputDelay)
+        {
+            inputDelay = target;
+            lastInputDelayDecrease = currentTick;
+        }
+        else if (target < inputDelay && currentTick.value - lastInputDelayDecrease.value >= InputDelayDecreaseInterval)
+        {
+            // Back off slowly, since a shorter delay seals nothing new until the game catches up with it.
+            --inputDelay;
+            lastInputDelayDecrease = currentTick;
+        }
+    }
+
+    void LockstepSession::updateRoundTripTime(Peer& peer, const LockstepEcho& echo, uint32_t now)
+    {
+        auto elapsed = now - echo.time;
+        if (echo.delay > elapsed)
+        {
+            return;
+        }
+
+        auto sample = static_cast<float>(elapsed - echo.delay);
+
+        // smoothing as TCP does it (RFC 6298)
+        if (!peer.roundTripTime)
+        {
+            peer.roundTripTime = sample;
+            peer.roundTripTimeVariance = sample / 2.0f;
+            return;
+        }
+
+        peer.roundTripTimeVariance = (0.75f * peer.roundTripTimeVariance) + (0.25f * std::abs(*peer.roundTripTime - sample));
+        peer.roundTripTime = (0.875f * *peer.roundTripTime) + (0.125f * sample);
+    }
+
+    void LockstepSession::compareChecksum(const LockstepChecksum& remote)
+    {
+        auto it = std::lower_bound(
+            localChecksums.begin(),
+            localChecksums.end(),
+            remote.time.value,
+            [](const auto& c, unsigned int time) { return c.time.value < time; });
+        if (it != localChecksums.end() && it->time.value == remote.time.value && it->checksum != remote.checksum)
+        {
+            markDesync(remote.time);
+        }
+    }
+
+    void LockstepSession::receiveChecksums(Peer& peer, const std::vector<LockstepChecksum>& checksums)
+    {
+        for (const auto& checksum : checksums)
+        {
+            if (!localChecksums.empty() && checksum.time.value <= localChecksums.back().time.value)
+            {
+                compareChecksum(checksum);
+            }
+            else if (peer.futureChecksums.empty() || checksum.time.value > peer.futureChecksums.back().time.value)
+            {
+                peer.futureChecksums.push_back(checksum);
+                if (peer.futureChecksums.size() > ChecksumHistorySize)
+                {
+                    peer.futureChecksums.pop_front();
+                }
+            }
+        }
+    }
+
+    void LockstepSession::trimLocalBatches()
+    {
+        auto oldestNeeded = currentTick.value;
+        for (const auto& peer : peers)
+        {
+            oldestNeeded = std::min(oldestNeeded, peer.ack.value);
+        }
+
+        while (!localBatches.empty() && localBatchesStart.value < oldestNeeded)
+        {
+            localBatches.pop_front();
+            localBatchesStart = nextGameTime(localBatchesStart);
+        }
+    }
+
+    void LockstepSession::markDesync(GameTime time)
+    {
+        if (!desyncTime || time.value < desyncTime->value)
+        {
+            desyncTime = time;
+        }
+    }
+}
@@ -0,0 +1,214 @@
+#ifndef RWE_LOCKSTEPSESSION_H
+#define RWE_LOCKSTEPSESSION_H
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <rwe/GameTime.h>
+#include <rwe/LockstepPacket.h>
+#include <rwe/SimulationCommand.h>
+#include <vector>
+
+namespace rwe
+{
+    /** A command given by the player in a lockstep slot. */
+    struct LockstepCommand
+    {
+        unsigned int slot;
+        SimulationCommand command;
+    };
+
+    /**
+     * The bookkeeping of one peer in a lockstep game,
+     * with no knowledge of sockets or of the simulation itself.
+     *
+     * Every peer runs the same simulation and only ever exchanges commands.
+     * Commands given locally are not applied straight away
+     * but gathered into a batch for a tick a few ticks in the future, the input delay,
+     * which is sent to the other peers repeatedly until they acknowledge it.
+     * A tick may only run once the batch of every peer for that tick has arrived,
+     * and the commands of all the batches are then applied in slot order,
+     * so every peer applies the same commands at the same time.
+     *
+     * The input delay follows the round trip time to the slowest peer,
+     * so that batches normally arrive before they are needed
+     * and the game runs smoothly at the cost of a little command latency.
+     *
+     * Peers also exchange checksums of their simulations
+     * so that a game that has fallen out of sync is noticed.
+     *
+     * Each peer picks its own share of the seed for the simulation's random number generator
+     * and sends it with every packet.
+     * The game seed combines every share, so it is known to all peers
+     * by the time the first tick is ready, and no peer chooses it alone.
+     */
+    class LockstepSession
+    {
+    public:
+        static constexpr unsigned int MinInputDelay = 2;
+        static constexpr unsigned int MaxInputDelay = 30;
+
+        /** The fewest ticks between two reductions of the input delay. */
+        static constexpr unsigned int InputDelayDecreaseInterval = 60;
+
+        /** Commands beyond this number in one tick are carried over into the next batch. */
+        static constexpr unsigned int MaxCommandsPerBatch = 32;
+
+        /** The most batches sent in one packet. Later batches wait for the peer to catch up. */
+        static constexpr unsigned int MaxBatchesPerPacket = 16;
+
+        /** The number of recent checksums sent in each packet. */
+        static constexpr unsigned int ChecksumsPerPacket = 8;
+
+        /** The number of local checksums kept to compare against those of peers. */
+        static constexpr unsigned int ChecksumHistorySize = 256;
+
+    private:
+        struct Peer
+        {
+            unsigned int slot;
+
+            /** The peer's share of the game seed, once a packet from the peer has arrived. */
+            std::optional<uint32_t> seed;
+
+            /** The peer's batches from currentTick onwards, one per tick, as far as they have arrived. */
+            std::deque<std::vector<SimulationCommand>> batches;
+
+            /** The first tick for which the peer has not acknowledged our batch. */
+            GameTime ack;
+
+            std::optional<LockstepEcho> lastEcho;
+
+            /** When lastEcho was received, by our clock. */
+            uint32_t lastEchoReceivedTime{0};
+
+            /** Smoothed round trip time in milliseconds, if one has been measured. */
+            std::optional<float> roundTripTime;
+
+            /** Smoothed deviation of the round trip time in milliseconds. */
+            float roundTripTimeVariance{0.0f};
+
+            /** Checksums from the peer for times we have not yet reached, in time order. */
+            std::deque<LockstepChecksum> futureChecksums;
+        };
+
+        unsigned int localSlot;
+
+        unsigned int tickInterval;
+
+        /** Our share of the game seed. */
+        uint32_t localSeed;
+
+        /** The next tick to run. */
+        GameTime currentTick;
+
+        /** Local commands not yet sealed into a batch. */
+        std::vector<SimulationCommand> pendingCommands;
+
+        /** The tick of the first of the local batches. */
+        GameTime localBatchesStart;
+
+        /**
+         * Local batches from localBatchesStart onwards.
+         * Batches are kept until they have been run locally and every peer has acknowledged them.
+         */
+        std::deque<std::vector<SimulationCommand>> localBatches;
+
+        unsigned int inputDelay;
+
+        /** The last tick at which the input delay was reduced. */
+        GameTime lastInputDelayDecrease{0};
+
+        std::vector<Peer> peers;
+
+        /** Recent local checksums, in time order. */
+        std::deque<LockstepChecksum> localChecksums;
+
+        std::optional<GameTime> desyncTime;
+
+    public:
+        /**
+         * @param localSlot The player slot played locally.
+         * @param remoteSlots The player slots played by each peer.
+         * @param startTime The time of the simulation when the game starts.
+         * @param tickInterval The length of a tick in milliseconds.
+         * @param localSeed Our share of the game seed.
+         */
+        LockstepSession(unsigned int localSlot, const std::vector<unsigned int>& remoteSlots, GameTime startTime, unsigned int tickInterval, uint32_t localSeed);
+
+        /** Queues a command given locally, to be sent with the next batch. */
+        void submit(const SimulationCommand& command);
+
+        /**
+         * Seals queued commands into a batch for the tick one input delay ahead,
+         * along with empty batches for any ticks before it that have not been sealed.
+         * Call after running the ticks that are ready and before making packets.
+         */
+        void sealInputs();
+
+        /** Returns true if the batches of every peer for the next tick have arrived. */
+        bool isReady() const;
+
+        /**
+         * Returns the seed that every peer uses for the simulation's random number generator.
+         * Only valid once the session has been ready, since until then some shares may be missing.
+         */
+        uint32_t getGameSeed() const;
+
+        /**
+         * Moves on to the next tick, filling commands with the commands to apply for the tick it leaves,
+         * in slot order, each with the slot that gave it. The session must be ready.
+         */
+        void advance(std::vector<LockstepCommand>& commands);
+
+        /** Records the checksum of the local simulation at the given time, to compare with those of peers. */
+        void recordChecksum(GameTime time, uint64_t checksum);
+
+        /**
+         * Creates the packet to send to the peer at the given index.
+         *
+         * @param now The current time in milliseconds.
+         */
+        void makePacket(std::size_t peerIndex, uint32_t now, LockstepPacket& packet) const;
+
+        /**
+         * Takes in a packet from a peer.
+         * Returns false if the packet does not come from a peer of this game, in which case it is ignored.
+         *
+         * @param now The current time in milliseconds.
+         */
+        bool receivePacket(const LockstepPacket& packet, uint32_t now);
+
+        GameTime getCurrentTick() const;
+
+        unsigned int getInputDelay() const;
+
+        std::size_t getPeerCount() const;
+
+        unsigned int getPeerSlot(std::size_t peerIndex) const;
+
+        /** Returns the smoothed round trip time to the peer in milliseconds, if one has been measured. */
+        std::optional<float> getRoundTripTime(std::size_t peerIndex) const;
+
+        /** Returns the earliest time at which the checksum of a peer differed from ours, if any. */
+        std::optional<GameTime> getDesyncTime() const;
+
+    private:
+        /** The tick after the last sealed local batch. */
+        GameTime sealedEnd() const;
+
+        void updateInputDelay();
+
+        void updateRoundTripTime(Peer& peer, const LockstepEcho& echo, uint32_t now);
+
+        void compareChecksum(const LockstepChecksum& remote);
+
+        void receiveChecksums(Peer& peer, const std::vector<LockstepChecksum>& checksums);
+
+        void trimLocalBatches();
+
+        void markDesync(GameTime time);
+    };
+}
+
+#endif
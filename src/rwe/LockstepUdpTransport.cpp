@@ -0,0 +1,92 @@
+#include "LockstepUdpTransport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <rwe/SdlContextManager.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+
+namespace rwe
+{
+    LockstepUdpTransport::LockstepUdpTransport(const NetworkParameters& parameters)
+    {
+        socket.reset(SDLNet_UDP_Open(parameters.localPort));
+        if (!socket)
+        {
+            throw SDLNetException(SDLNet_GetError());
+        }
+
+        packet.reset(SDLNet_AllocPacket(MaxDatagramSize));
+        if (!packet)
+        {
+            throw SDLNetException(SDLNet_GetError());
+        }
+
+        for (const auto& peer : parameters.peers)
+        {
+            IPaddress address;
+            if (SDLNet_ResolveHost(&address, peer.host.c_str(), peer.port) != 0)
+            {
+                throw SDLNetException(SDLNet_GetError());
+            }
+            peers.push_back(PeerAddress{peer.slot, address});
+        }
+    }
+
+    void LockstepUdpTransport::send(unsigned int slot, const std::vector<char>& data)
+    {
+        auto it = std::find_if(peers.begin(), peers.end(), [slot](const auto& p) { return p.slot == slot; });
+        if (it == peers.end())
+        {
+            throw std::logic_error("No peer plays slot " + std::to_string(slot));
+        }
+
+        if (data.size() > static_cast<std::size_t>(packet->maxlen))
+        {
+            throw std::logic_error("Lockstep packet is too large to send");
+        }
+
+        std::memcpy(packet->data, data.data(), data.size());
+        packet->len = static_cast<int>(data.size());
+        packet->address = it->address;
+
+        if (SDLNet_UDP_Send(socket.get(), -1, packet.get()) == 0)
+        {
+            // A datagram that fails to go out is no worse than one lost on the way.
+            // The session resends everything the peer has not acknowledged.
+            if (auto logger = spdlog::get("rwe"))
+            {
+                logger->warn("Dropping lockstep packet for slot {0}: {1}", slot, SDLNet_GetError());
+            }
+        }
+    }
+
+    std::optional<unsigned int> LockstepUdpTransport::receive(std::vector<char>& data)
+    {
+        while (true)
+        {
+            auto result = SDLNet_UDP_Recv(socket.get(), packet.get());
+            if (result < 0)
+            {
+                throw SDLNetException(SDLNet_GetError());
+            }
+            if (result == 0)
+            {
+                return std::nullopt;
+            }
+
+            const auto& from = packet->address;
+            auto it = std::find_if(peers.begin(), peers.end(), [&from](const auto& p) {
+                return p.address.host == from.host && p.address.port == from.port;
+            });
+            if (it == peers.end())
+            {
+                continue;
+            }
+
+            data.assign(packet->data, packet->data + packet->len);
+            return it->slot;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef RWE_LOCKSTEPUDPTRANSPORT_H
+#define RWE_LOCKSTEPUDPTRANSPORT_H
+
+#include <SDL_net.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <rwe/GameParameters.h>
+#include <type_traits>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Sends and receives lockstep packets over UDP with SDL_net.
+     * SDL_net must be initialised for the lifetime of the transport (see SdlNetContext).
+     *
+     * Peers are known up front by their player slot and address,
+     * and datagrams from any other address are dropped.
+     */
+    class LockstepUdpTransport
+    {
+    public:
+        /** The largest datagram sent or received, comfortably above the largest packet the session makes. */
+        static constexpr int MaxDatagramSize = 65507;
+
+    private:
+        struct SocketDeleter
+        {
+            void operator()(UDPsocket socket) { SDLNet_UDP_Close(socket); }
+        };
+
+        struct PacketDeleter
+        {
+            void operator()(UDPpacket* packet) { SDLNet_FreePacket(packet); }
+        };
+
+        struct PeerAddress
+        {
+            unsigned int slot;
+            IPaddress address;
+        };
+
+        std::unique_ptr<std::remove_pointer_t<UDPsocket>, SocketDeleter> socket;
+
+        std::unique_ptr<UDPpacket, PacketDeleter> packet;
+
+        std::vector<PeerAddress> peers;
+
+    public:
+        /** Throws SDLNetException if the port cannot be opened or a peer's host cannot be resolved. */
+        explicit LockstepUdpTransport(const NetworkParameters& parameters);
+
+        /**
+         * Sends the data to the peer playing the given slot.
+         * If the datagram cannot be sent it is logged and dropped,
+         * as if it had been lost in the network.
+         */
+        void send(unsigned int slot, const std::vector<char>& data);
+
+        /**
+         * Takes the next waiting datagram from a peer, if there is one,
+         * replacing the contents of data with it.
+         * Returns the slot of the peer that sent it, or nothing if no datagram is waiting.
+         * Throws SDLNetException on failure.
+         */
+        std::optional<unsigned int> receive(std::vector<char>& data);
+    };
+}
+
+#endif
@@ -1,7 +1,7 @@
 #include "MainMenuScene.h"
 #include <rwe/LoadingScene.h>
 #include <rwe/MainMenuModel.h>
-#include <rwe/ota.h>
+#include <rwe/Replay.h>
 #include <rwe/tdf.h>
 
 #include <rwe/gui.h>
@@ -21,8 +21,12 @@ namespace rwe
         const ColorPalette* guiPalette,
         CursorService* cursor,
         SdlContext* sdl,
-        const std::unordered_map<std::string, SideData>* sideData,
+        const CaseInsensitiveMap<SideData>* sideData,
         ViewportService* viewportService,
+        ThreadPool* threadPool,
+        const CompiledUnitDatabaseInfo* compiledUnitDatabaseInfo,
+        MapCatalogService* mapCatalogService,
+        const std::string& replayDirectory,
         float width,
         float height)
         : sceneManager(sceneManager),
@@ -39,6 +43,10 @@ namespace rwe
           sdl(sdl),
           sideData(sideData),
           viewportService(viewportService),
+          threadPool(threadPool),
+          compiledUnitDatabaseInfo(compiledUnitDatabaseInfo),
+          mapCatalogService(mapCatalogService),
+          replayDirectory(replayDirectory),
           scaledUiRenderService(graphics, shaders, UiCamera(640.0f, 480.0f)),
           nativeUiRenderService(graphics, shaders, UiCamera(width, height)),
           model(),
@@ -154,7 +162,7 @@ namespace rwe
 
     void MainMenuScene::update()
     {
-        topPanel().update(static_cast<float>(SceneManager::TickInterval) / 1000.0f);
+        topPanel().update(static_cast<float>(TickInterval) / 1000.0f);
     }
 
     void MainMenuScene::onMouseWheel(MouseWheelEvent event)
@@ -296,24 +304,20 @@ namespace rwe
 
     void MainMenuScene::setCandidateSelectedMap(const std::string& mapName)
     {
-        auto otaRaw = vfs->readFile(std::string("maps/").append(mapName).append(".ota"));
-        if (!otaRaw)
+        auto mapInfo = mapCatalogService->getMapInfo(mapName);
+        if (mapInfo == nullptr)
         {
             return;
         }
 
-        std::string otaStr(otaRaw->begin(), otaRaw->end());
-
-        auto ota = parseOta(parseTdfFromString(otaStr));
-
-        auto minimap = textureService->getMinimap(mapName);
+        auto minimap = mapCatalogService->getMinimap(mapName);
 
         // this is what TA shows in its map selection dialog
-        auto sizeInfo = std::string().append(ota.memory).append("  Players: ").append(ota.numPlayers);
+        auto sizeInfo = std::string().append(mapInfo->memory).append("  Players: ").append(mapInfo->numPlayers);
 
         MainMenuModel::SelectedMapInfo info(
             mapName,
-            ota.missionDescription,
+            mapInfo->missionDescription,
             sizeInfo,
             minimap);
 
@@ -545,6 +549,8 @@ namespace rwe
         }
 
         GameParameters params{model.selectedMap.getValue()->name, 0};
+        params.seed = makeGameSeed();
+        params.replayPath = makeReplayPath(replayDirectory);
 
         for (unsigned int i = 0; i < model.players.size(); ++i)
         {
@@ -586,6 +592,8 @@ namespace rwe
             sdl,
             sideData,
             viewportService,
+            threadPool,
+            compiledUnitDatabaseInfo,
             std::move(bgm),
             params);
 
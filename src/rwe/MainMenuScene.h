@@ -3,12 +3,15 @@
 
 #include <memory>
 #include <rwe/AudioService.h>
+#include <rwe/CompiledUnitDatabase.h>
 #include <rwe/CursorService.h>
+#include <rwe/MapCatalogService.h>
 #include <rwe/MapFeatureService.h>
 #include <rwe/RenderService.h>
 #include <rwe/SceneManager.h>
 #include <rwe/SideData.h>
 #include <rwe/TextureService.h>
+#include <rwe/ThreadPool.h>
 #include <rwe/ViewportService.h>
 #include <rwe/camera/UiCamera.h>
 #include <rwe/tdf/TdfBlock.h>
@@ -32,8 +35,14 @@ namespace rwe
         const ColorPalette* guiPalette;
         CursorService* cursor;
         SdlContext* sdl;
-        const std::unordered_map<std::string, SideData>* sideData;
+        const CaseInsensitiveMap<SideData>* sideData;
         ViewportService* viewportService;
+        ThreadPool* threadPool;
+        const CompiledUnitDatabaseInfo* compiledUnitDatabaseInfo;
+        MapCatalogService* mapCatalogService;
+
+        /** Where games started from the menu record their replays. */
+        std::string replayDirectory;
 
         UiRenderService scaledUiRenderService;
         UiRenderService nativeUiRenderService;
@@ -60,8 +69,12 @@ namespace rwe
             const ColorPalette* guiPalette,
             CursorService* cursor,
             SdlContext* sdl,
-            const std::unordered_map<std::string, SideData>* sideData,
+            const CaseInsensitiveMap<SideData>* sideData,
             ViewportService* viewportService,
+            ThreadPool* threadPool,
+            const CompiledUnitDatabaseInfo* compiledUnitDatabaseInfo,
+            MapCatalogService* mapCatalogService,
+            const std::string& replayDirectory,
             float width,
             float height);
 
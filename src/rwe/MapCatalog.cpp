@@ -0,0 +1,193 @@
+#include "MapCatalog.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <fstream>
+#include <iterator>
+#include <rwe/BinaryReader.h>
+#include <rwe/BinaryWriter.h>
+#include <rwe/ota.h>
+#include <rwe/tdf.h>
+#include <rwe/tnt/TntArchive.h>
+
+namespace rwe
+{
+    MapCatalog::MapCatalog(std::vector<MapCatalogEntry>&& entries) : entries(std::move(entries))
+    {
+        for (std::size_t i = 0; i < this->entries.size(); ++i)
+        {
+            index.insert({this->entries[i].name, i});
+        }
+    }
+
+    const std::vector<MapCatalogEntry>& MapCatalog::getEntries() const
+    {
+        return entries;
+    }
+
+    const MapCatalogEntry* MapCatalog::find(const std::string& mapName) const
+    {
+        auto it = index.find(mapName);
+        if (it == index.end())
+        {
+            return nullptr;
+        }
+
+        return &entries[it->second];
+    }
+
+    MapCatalogException::MapCatalogException(const char* message) : runtime_error(message)
+    {
+    }
+
+    std::optional<MapCatalogEntry> readMapCatalogEntry(const AbstractVirtualFileSystem& vfs, const std::string& mapName)
+    {
+        auto otaRaw = vfs.readFile("maps/" + mapName + ".ota");
+        if (!otaRaw)
+        {
+            return std::nullopt;
+        }
+
+        auto tntRaw = vfs.readFile("maps/" + mapName + ".tnt");
+        if (!tntRaw)
+        {
+            return std::nullopt;
+        }
+
+        try
+        {
+            auto ota = parseOta(parseTdfFromString(std::string_view(otaRaw->data(), otaRaw->size())));
+
+            boost::interprocess::bufferstream tntStream(tntRaw->data(), tntRaw->size());
+            TntArchive tnt(&tntStream);
+            auto minimap = tnt.readMinimap();
+
+            MapCatalogEntry entry;
+            entry.name = mapName;
+            entry.missionDescription = std::move(ota.missionDescription);
+            entry.memory = std::move(ota.memory);
+            entry.numPlayers = std::move(ota.numPlayers);
+            entry.size = std::move(ota.size);
+            for (auto& schema : ota.schemas)
+            {
+                entry.schemaTypes.push_back(std::move(schema.type));
+            }
+            entry.minimapWidth = minimap.width;
+            entry.minimapHeight = minimap.height;
+            entry.minimap = std::move(minimap.data);
+
+            return entry;
+        }
+        catch (const std::runtime_error&)
+        {
+            // A broken map should not take the rest of the catalog down with it.
+            return std::nullopt;
+        }
+    }
+
+    void writeMapCatalog(const std::string& path, uint64_t dataFingerprint, const MapCatalog& catalog)
+    {
+        // Write to a temporary file first so that a crash mid-write
+        // cannot leave a truncated catalog behind.
+        auto tempPath = path + ".tmp";
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            if (!stream)
+            {
+                throw MapCatalogException("Failed to open map catalog for writing");
+            }
+
+            std::vector<char> buffer;
+            BinaryWriter w(&buffer);
+            w.write(MapCatalogMagicNumber);
+            w.write(MapCatalogVersion);
+            w.write(dataFingerprint);
+
+            const auto& entries = catalog.getEntries();
+            w.writeSize(entries.size());
+            for (const auto& e : entries)
+            {
+                w.writeString(e.name);
+                w.writeString(e.missionDescription);
+                w.writeString(e.memory);
+                w.writeString(e.numPlayers);
+                w.writeString(e.size);
+
+                w.writeSize(e.schemaTypes.size());
+                for (const auto& type : e.schemaTypes)
+                {
+                    w.writeString(type);
+                }
+
+                w.write(static_cast<uint32_t>(e.minimapWidth));
+                w.write(static_cast<uint32_t>(e.minimapHeight));
+                w.writeBytes(e.minimap.data(), e.minimap.size());
+            }
+
+            stream.write(buffer.data(), buffer.size());
+            if (!stream)
+            {
+                throw MapCatalogException("Failed to write map catalog");
+            }
+        }
+
+        boost::filesystem::rename(tempPath, path);
+    }
+
+    std::optional<MapCatalog> readMapCatalog(const std::string& path, uint64_t dataFingerprint)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<char> bytes{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+        BinaryReader<MapCatalogException> reader(bytes.data(), bytes.data() + bytes.size(), "Map catalog is truncated");
+
+        if (bytes.size() < (2 * sizeof(uint32_t)) + sizeof(uint64_t))
+        {
+            return std::nullopt;
+        }
+
+        if (reader.read<uint32_t>() != MapCatalogMagicNumber)
+        {
+            return std::nullopt;
+        }
+
+        if (reader.read<uint32_t>() != MapCatalogVersion)
+        {
+            return std::nullopt;
+        }
+
+        if (reader.read<uint64_t>() != dataFingerprint)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<MapCatalogEntry> entries(reader.readSize());
+        for (auto& e : entries)
+        {
+            e.name = reader.readString();
+            e.missionDescription = reader.readString();
+            e.memory = reader.readString();
+            e.numPlayers = reader.readString();
+            e.size = reader.readString();
+
+            e.schemaTypes.resize(reader.readSize());
+            for (auto& type : e.schemaTypes)
+            {
+                type = reader.readString();
+            }
+
+            e.minimapWidth = reader.read<uint32_t>();
+            e.minimapHeight = reader.read<uint32_t>();
+            auto minimapSize = static_cast<uint64_t>(e.minimapWidth) * e.minimapHeight;
+            reader.require(minimapSize);
+            e.minimap.resize(static_cast<std::size_t>(minimapSize));
+            reader.readBytes(e.minimap.data(), e.minimap.size());
+        }
+
+        return MapCatalog(std::move(entries));
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef RWE_MAPCATALOG_H
+#define RWE_MAPCATALOG_H
+
+#include <cstdint>
+#include <optional>
+#include <rwe/rwe_string.h>
+#include <rwe/vfs/AbstractVirtualFileSystem.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /** The magic number at the start of a map catalog file ("RWEM"). */
+    static const uint32_t MapCatalogMagicNumber = 0x4d455752;
+
+    /**
+     * The version of the map catalog file format.
+     * Bump this whenever the layout of MapCatalogEntry changes.
+     */
+    static const uint32_t MapCatalogVersion = 1;
+
+    /** Everything the map selection dialog shows about a map. */
+    struct MapCatalogEntry
+    {
+        /** The map name, which is the OTA file name without extension. */
+        std::string name;
+        std::string missionDescription;
+        std::string memory;
+        std::string numPlayers;
+        std::string size;
+
+        /** The type of each schema in the OTA, e.g. "Network 1". */
+        std::vector<std::string> schemaTypes;
+
+        /** The minimap, trimmed of its border, as palette indices in row order. */
+        unsigned int minimapWidth;
+        unsigned int minimapHeight;
+        std::vector<char> minimap;
+    };
+
+    class MapCatalog
+    {
+    private:
+        std::vector<MapCatalogEntry> entries;
+        CaseInsensitiveMap<std::size_t> index;
+
+    public:
+        MapCatalog() = default;
+        explicit MapCatalog(std::vector<MapCatalogEntry>&& entries);
+
+        const std::vector<MapCatalogEntry>& getEntries() const;
+
+        /** Returns the entry for the given map, or null if the catalog has no such map. */
+        const MapCatalogEntry* find(const std::string& mapName) const;
+    };
+
+    class MapCatalogException : public std::runtime_error
+    {
+    public:
+        explicit MapCatalogException(const char* message);
+    };
+
+    /**
+     * Reads the OTA and TNT minimap of a single map.
+     * Returns nullopt if the map is missing or cannot be parsed.
+     * Safe to call from worker threads.
+     */
+    std::optional<MapCatalogEntry> readMapCatalogEntry(const AbstractVirtualFileSystem& vfs, const std::string& mapName);
+
+    void writeMapCatalog(const std::string& path, uint64_t dataFingerprint, const MapCatalog& catalog);
+
+    /**
+     * Reads a map catalog written by writeMapCatalog.
+     * Returns nullopt if the file does not exist, was written by a different version,
+     * or was built from different game data.
+     * Throws MapCatalogException if the file is corrupt.
+     */
+    std::optional<MapCatalog> readMapCatalog(const std::string& path, uint64_t dataFingerprint);
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "MapCatalogService.h"
+
+namespace rwe
+{
+    MapCatalogService::MapCatalogService(
+        AbstractVirtualFileSystem* vfs,
+        TextureService* textureService,
+        ThreadPool* threadPool,
+        const std::string& cachePath,
+        uint64_t dataFingerprint)
+        : textureService(textureService),
+          cachePath(cachePath),
+          dataFingerprint(dataFingerprint)
+    {
+        try
+        {
+            catalog = readMapCatalog(cachePath, dataFingerprint);
+        }
+        catch (const MapCatalogException&)
+        {
+            // corrupt cache, rebuild it below
+        }
+
+        if (catalog)
+        {
+            return;
+        }
+
+        for (const auto& fileName : vfs->getFileNames("maps", ".ota"))
+        {
+            auto mapName = fileName.substr(0, fileName.size() - 4);
+            pendingEntries.push_back(threadPool->submit([vfs, mapName]() { return readMapCatalogEntry(*vfs, mapName); }));
+        }
+    }
+
+    const MapCatalog& MapCatalogService::getCatalog()
+    {
+        if (catalog)
+        {
+            return *catalog;
+        }
+
+        std::vector<MapCatalogEntry> entries;
+        entries.reserve(pendingEntries.size());
+        for (auto& future : pendingEntries)
+        {
+            auto entry = future.get();
+            if (entry)
+            {
+                entries.push_back(std::move(*entry));
+            }
+        }
+        pendingEntries.clear();
+
+        catalog = MapCatalog(std::move(entries));
+
+        try
+        {
+            writeMapCatalog(cachePath, dataFingerprint, *catalog);
+        }
+        catch (const std::exception&)
+        {
+            // The cache is only an optimization,
+            // failing to write it just means rebuilding next time.
+        }
+
+        return *catalog;
+    }
+
+    const MapCatalogEntry* MapCatalogService::getMapInfo(const std::string& mapName)
+    {
+        return getCatalog().find(mapName);
+    }
+
+    std::shared_ptr<Sprite> MapCatalogService::getMinimap(const std::string& mapName)
+    {
+        auto info = getMapInfo(mapName);
+        if (info == nullptr)
+        {
+            return nullptr;
+        }
+
+        return textureService->getMinimap(mapName, info->minimapWidth, info->minimapHeight, info->minimap);
+    }
+}
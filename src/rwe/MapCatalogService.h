@@ -0,0 +1,58 @@
+#ifndef RWE_MAPCATALOGSERVICE_H
+#define RWE_MAPCATALOGSERVICE_H
+
+#include <future>
+#include <memory>
+#include <optional>
+#include <rwe/MapCatalog.h>
+#include <rwe/Sprite.h>
+#include <rwe/TextureService.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/vfs/AbstractVirtualFileSystem.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Owns the catalog of maps shown by the skirmish map browser.
+     *
+     * On construction the catalog is read from its cache file.
+     * If that is missing or stale, every map is read on the thread pool in the background
+     * and the result is written back to the cache once it is first needed.
+     */
+    class MapCatalogService
+    {
+    private:
+        TextureService* textureService;
+        std::string cachePath;
+        uint64_t dataFingerprint;
+
+        std::optional<MapCatalog> catalog;
+
+        /** Outstanding per-map reads, in listing order, while the catalog is being built. */
+        std::vector<std::future<std::optional<MapCatalogEntry>>> pendingEntries;
+
+    public:
+        MapCatalogService(
+            AbstractVirtualFileSystem* vfs,
+            TextureService* textureService,
+            ThreadPool* threadPool,
+            const std::string& cachePath,
+            uint64_t dataFingerprint);
+
+        /** Returns the catalog, waiting for the background build to finish if necessary. */
+        const MapCatalog& getCatalog();
+
+        /** Returns the catalog entry for the given map, or null if there is no such map. */
+        const MapCatalogEntry* getMapInfo(const std::string& mapName);
+
+        /**
+         * Returns a sprite of the map's minimap, or null if there is no such map.
+         * The sprite is created by the texture service from the catalog's copy of the minimap.
+         */
+        std::shared_ptr<Sprite> getMinimap(const std::string& mapName);
+    };
+}
+
+#endif
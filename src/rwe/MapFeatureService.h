@@ -2,6 +2,7 @@
 #define RWE_MAPFEATURESERVICE_H
 
 #include <rwe/FeatureDefinition.h>
+#include <rwe/rwe_string.h>
 #include <rwe/vfs/AbstractVirtualFileSystem.h>
 #include <string>
 
@@ -12,7 +13,7 @@ namespace rwe
     private:
         AbstractVirtualFileSystem* vfs;
 
-        std::unordered_map<std::string, FeatureDefinition> features;
+        CaseInsensitiveMap<FeatureDefinition> features;
 
     public:
         MapFeatureService(AbstractVirtualFileSystem* vfs);
@@ -0,0 +1,303 @@
+#include "MapLoader.h"
+#include <algorithm>
+#include <array>
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <future>
+#include <memory>
+#include <rwe/tdf.h>
+#include <stdexcept>
+
+namespace rwe
+{
+    MapLoader::MapLoader(
+        AbstractVirtualFileSystem* vfs,
+        MapFeatureService* featureService,
+        AbstractGraphicsContext* graphics,
+        AbstractTextureService* textureService,
+        const ColorPalette* palette,
+        ThreadPool* threadPool)
+        : vfs(vfs),
+          featureService(featureService),
+          graphics(graphics),
+          textureService(textureService),
+          palette(palette),
+          threadPool(threadPool)
+    {
+    }
+
+    OtaRecord MapLoader::loadOta(const std::string& mapName)
+    {
+        auto otaRaw = vfs->readFile(std::string("maps/").append(mapName).append(".ota"));
+        if (!otaRaw)
+        {
+            throw std::runtime_error("Failed to read OTA file");
+        }
+
+        std::string otaStr(otaRaw->begin(), otaRaw->end());
+        return parseOta(parseTdfFromString(otaStr));
+    }
+
+    GameSimulation MapLoader::createInitialSimulation(const std::string& mapName, const OtaRecord& ota, unsigned int schemaIndex, unsigned int seed)
+    {
+        auto tntBytes = vfs->readFile("maps/" + mapName + ".tnt");
+        if (!tntBytes)
+        {
+            throw std::runtime_error("Failed to load map bytes");
+        }
+
+        boost::interprocess::bufferstream tntStream(tntBytes->data(), tntBytes->size());
+        TntArchive tnt(&tntStream);
+
+        auto tileTextures = graphics != nullptr ? getTileTextures(tnt) : std::vector<TextureRegion>();
+
+        auto dataGrid = getMapData(tnt);
+
+        Grid<TntTileAttributes> mapAttributes(tnt.getHeader().width, tnt.getHeader().height);
+        tnt.readMapAttributes(mapAttributes.getData());
+
+        auto heightGrid = getHeightGrid(mapAttributes);
+
+        MapTerrain terrain(
+            std::move(tileTextures),
+            std::move(dataGrid),
+            std::move(heightGrid),
+            tnt.getHeader().seaLevel);
+
+        GameSimulation simulation(std::move(terrain), seed);
+
+        auto featureTemplates = getFeatures(tnt);
+
+        for (std::size_t y = 0; y < mapAttributes.getHeight(); ++y)
+        {
+            for (std::size_t x = 0; x < mapAttributes.getWidth(); ++x)
+            {
+                const auto& e = mapAttributes.get(x, y);
+                switch (e.feature)
+                {
+                    case TntTileAttributes::FeatureNone:
+                    case TntTileAttributes::FeatureUnknown:
+                    case TntTileAttributes::FeatureVoid:
+                        break;
+                    default:
+                        const auto& featureTemplate = featureTemplates[e.feature];
+                        Vector3f pos = computeFeaturePosition(simulation.terrain, featureTemplate, x, y);
+                        auto feature = createFeature(pos, featureTemplate);
+                        simulation.addFeature(std::move(feature));
+                }
+            }
+        }
+
+        const auto& schema = ota.schemas.at(schemaIndex);
+
+        // add features from the OTA schema
+        for (const auto& f : schema.features)
+        {
+            const auto& featureTemplate = featureService->getFeatureDefinition(f.featureName);
+            Vector3f pos = computeFeaturePosition(simulation.terrain, featureTemplate, f.xPos, f.zPos);
+            auto feature = createFeature(pos, featureTemplate);
+            simulation.addFeature(std::move(feature));
+        }
+
+        return simulation;
+    }
+
+    std::vector<TextureRegion> MapLoader::getTileTextures(TntArchive& tnt)
+    {
+        static const unsigned int tileWidth = 32;
+        static const unsigned int tileHeight = 32;
+        static const unsigned int textureWidth = 1024;
+        static const unsigned int textureHeight = 1024;
+        static const auto textureWidthInTiles = textureWidth / tileWidth;
+        static const auto textureHeightInTiles = textureHeight / tileHeight;
+        static const auto tilesPerTexture = textureWidthInTiles * textureHeightInTiles;
+
+        std::vector<TextureRegion> tileTextures;
+
+        auto tileCount = tnt.getHeader().numberOfTiles;
+        auto tileData = std::make_shared<std::vector<char>>(static_cast<std::size_t>(tileCount) * tileWidth * tileHeight);
+        tnt.readTileData(tileData->data());
+
+        std::array<Color, 256> colorTable;
+        colorTable.fill(Color::Black);
+        std::copy_n(palette->begin(), std::min<std::size_t>(palette->size(), colorTable.size()), colorTable.begin());
+
+        // Convert each texture page to colors on the thread pool.
+        // The tasks share ownership of the tile data
+        // so that it outlives them even if an upload below throws.
+        std::vector<std::future<std::vector<Color>>> pageFutures;
+        for (unsigned int firstTile = 0; firstTile < tileCount; firstTile += tilesPerTexture)
+        {
+            auto lastTile = std::min(firstTile + tilesPerTexture, tileCount);
+            pageFutures.push_back(threadPool->submit([tileData, colorTable, firstTile, lastTile]() {
+                std::vector<Color> page(textureWidth * textureHeight);
+                for (auto i = firstTile; i < lastTile; ++i)
+                {
+                    auto tileIndex = i - firstTile;
+                    auto startX = (tileIndex % textureWidthInTiles) * tileWidth;
+                    auto startY = (tileIndex / textureWidthInTiles) * tileHeight;
+                    const auto* tile = tileData->data() + (static_cast<std::size_t>(i) * tileWidth * tileHeight);
+                    for (unsigned int dy = 0; dy < tileHeight; ++dy)
+                    {
+                        const auto* src = tile + (dy * tileWidth);
+                        auto* dst = page.data() + ((startY + dy) * textureWidth) + startX;
+                        for (unsigned int dx = 0; dx < tileWidth; ++dx)
+                        {
+                            dst[dx] = colorTable[static_cast<unsigned char>(src[dx])];
+                        }
+                    }
+                }
+
+                return page;
+            }));
+        }
+
+        // upload pages in order as each one becomes ready
+        std::vector<SharedTextureHandle> textureHandles;
+        textureHandles.reserve(pageFutures.size());
+        for (auto& future : pageFutures)
+        {
+            textureHandles.emplace_back(graphics->createTexture(textureWidth, textureHeight, future.get()));
+        }
+
+        // populate the list of texture regions referencing the textures
+        for (unsigned int i = 0; i < tnt.getHeader().numberOfTiles; ++i)
+        {
+            auto textureIndex = i / tilesPerTexture;
+            auto tileIndex = i % tilesPerTexture;
+            const float regionWidth = static_cast<float>(tileWidth) / static_cast<float>(textureWidth);
+            const float regionHeight = static_cast<float>(tileHeight) / static_cast<float>(textureHeight);
+            auto x = tileIndex % textureWidthInTiles;
+            auto y = tileIndex / textureWidthInTiles;
+
+            assert(textureHandles.size() > i / tilesPerTexture);
+            tileTextures.emplace_back(
+                textureHandles[textureIndex],
+                Rectangle2f::fromTopLeft(x * regionWidth, y * regionHeight, regionWidth, regionHeight));
+        }
+
+        return tileTextures;
+    }
+
+    Grid<std::size_t> MapLoader::getMapData(TntArchive& tnt)
+    {
+        auto mapWidthInTiles = tnt.getHeader().width / 2;
+        auto mapHeightInTiles = tnt.getHeader().height / 2;
+        std::vector<uint16_t> mapData(mapWidthInTiles * mapHeightInTiles);
+        tnt.readMapData(mapData.data());
+        std::vector<std::size_t> dataCopy;
+        dataCopy.reserve(mapData.size());
+        std::copy(mapData.begin(), mapData.end(), std::back_inserter(dataCopy));
+        Grid<std::size_t> dataGrid(mapWidthInTiles, mapHeightInTiles, std::move(dataCopy));
+        return dataGrid;
+    }
+
+    std::vector<FeatureDefinition> MapLoader::getFeatures(TntArchive& tnt)
+    {
+        std::vector<FeatureDefinition> features;
+
+        tnt.readFeatures([this, &features](const auto& featureName) {
+            const auto& feature = featureService->getFeatureDefinition(featureName);
+            features.push_back(feature);
+        });
+
+        return features;
+    }
+
+    MapFeature MapLoader::createFeature(const Vector3f& pos, const FeatureDefinition& definition)
+    {
+        MapFeature f;
+        f.footprintX = definition.footprintX;
+        f.footprintZ = definition.footprintZ;
+        f.height = definition.height;
+        f.isBlocking = definition.blocking;
+        f.position = pos;
+        f.transparentAnimation = definition.animTrans;
+        f.transparentShadow = definition.shadTrans;
+
+        if (textureService == nullptr)
+        {
+            return f;
+        }
+
+        if (!definition.fileName.empty() && !definition.seqName.empty())
+        {
+            f.animation = textureService->getGafEntry("anims/" + definition.fileName + ".GAF", definition.seqName);
+        }
+        if (!f.animation)
+        {
+            f.animation = textureService->getDefaultSpriteSeries();
+        }
+
+        if (!definition.fileName.empty() && !definition.seqNameShad.empty())
+        {
+            // Some third-party features have broken shadow anim names (e.g. "empty"),
+            // ignore them if they don't exist.
+            f.shadowAnimation = textureService->tryGetGafEntry("anims/" + definition.fileName + ".GAF", definition.seqNameShad);
+        }
+
+        return f;
+    }
+
+    Grid<unsigned char> MapLoader::getHeightGrid(const Grid<TntTileAttributes>& attrs) const
+    {
+        const auto& sourceData = attrs.getVector();
+
+        std::vector<unsigned char> data;
+        data.reserve(sourceData.size());
+
+        std::transform(sourceData.begin(), sourceData.end(), std::back_inserter(data), [](const TntTileAttributes& e) {
+            return e.height;
+        });
+
+        return Grid<unsigned char>(attrs.getWidth(), attrs.getHeight(), std::move(data));
+    }
+
+    Vector3f MapLoader::computeFeaturePosition(
+        const MapTerrain& terrain,
+        const FeatureDefinition& featureDefinition,
+        std::size_t x,
+        std::size_t y) const
+    {
+        const auto& heightmap = terrain.getHeightMap();
+
+        unsigned int height = 0;
+        if (x < heightmap.getWidth() - 1 && y < heightmap.getHeight() - 1)
+        {
+            height = computeMidpointHeight(heightmap, x, y);
+        }
+
+        auto position = terrain.heightmapIndexToWorldCorner(x, y);
+        position.y = height;
+
+        position.x += (featureDefinition.footprintX * MapTerrain::HeightTileWidthInWorldUnits) / 2.0f;
+        position.z += (featureDefinition.footprintZ * MapTerrain::HeightTileHeightInWorldUnits) / 2.0f;
+
+        return position;
+    }
+
+    unsigned int MapLoader::computeMidpointHeight(const Grid<unsigned char>& heightmap, std::size_t x, std::size_t y)
+    {
+        assert(x < heightmap.getWidth() - 1);
+        assert(y < heightmap.getHeight() - 1);
+        return (heightmap.get(x, y) + heightmap.get(x + 1, y) + heightmap.get(x, y + 1) + heightmap.get(x + 1, y + 1)) / 4u;
+    }
+
+    Vector3f MapLoader::getStartPosition(const MapTerrain& terrain, const OtaRecord& ota, unsigned int schemaIndex, unsigned int playerIndex)
+    {
+        const auto& schema = ota.schemas.at(schemaIndex);
+
+        std::string startPosKey("StartPos");
+        startPosKey.append(std::to_string(playerIndex + 1));
+
+        auto startPosIt = std::find_if(schema.specials.begin(), schema.specials.end(), [&startPosKey](const OtaSpecial& s) { return s.specialWhat == startPosKey; });
+        if (startPosIt == schema.specials.end())
+        {
+            throw std::runtime_error("Missing key from schema: " + startPosKey);
+        }
+        const auto& startPos = *startPosIt;
+
+        auto worldStartPos = terrain.topLeftCoordinateToWorld(Vector3f(startPos.xPos, 0.0f, startPos.zPos));
+        worldStartPos.y = terrain.getHeightAt(worldStartPos.x, worldStartPos.z);
+        return worldStartPos;
+    }
+}
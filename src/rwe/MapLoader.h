@@ -0,0 +1,83 @@
+#ifndef RWE_MAPLOADER_H
+#define RWE_MAPLOADER_H
+
+#include <rwe/AbstractGraphicsContext.h>
+#include <rwe/AbstractTextureService.h>
+#include <rwe/ColorPalette.h>
+#include <rwe/FeatureDefinition.h>
+#include <rwe/GameSimulation.h>
+#include <rwe/Grid.h>
+#include <rwe/MapFeature.h>
+#include <rwe/MapFeatureService.h>
+#include <rwe/MapTerrain.h>
+#include <rwe/TextureRegion.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/math/Vector3f.h>
+#include <rwe/ota.h>
+#include <rwe/tnt/TntArchive.h>
+#include <rwe/vfs/AbstractVirtualFileSystem.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Loads a map from the VFS into a new game simulation.
+     *
+     * Without a graphics context and texture service the map is loaded
+     * with no tile textures and no feature animations,
+     * which is enough to run the simulation but not to draw it.
+     */
+    class MapLoader
+    {
+    private:
+        AbstractVirtualFileSystem* vfs;
+        MapFeatureService* featureService;
+
+        /** May be null, in which case the terrain has no tile textures. */
+        AbstractGraphicsContext* graphics;
+
+        /** May be null, in which case features have no animations. */
+        AbstractTextureService* textureService;
+
+        const ColorPalette* palette;
+        ThreadPool* threadPool;
+
+    public:
+        MapLoader(
+            AbstractVirtualFileSystem* vfs,
+            MapFeatureService* featureService,
+            AbstractGraphicsContext* graphics,
+            AbstractTextureService* textureService,
+            const ColorPalette* palette,
+            ThreadPool* threadPool);
+
+        OtaRecord loadOta(const std::string& mapName);
+
+        GameSimulation createInitialSimulation(const std::string& mapName, const OtaRecord& ota, unsigned int schemaIndex, unsigned int seed);
+
+        /**
+         * Returns the world position of the given player's start position
+         * in the given schema of the map.
+         * Players are numbered from 0.
+         */
+        static Vector3f getStartPosition(const MapTerrain& terrain, const OtaRecord& ota, unsigned int schemaIndex, unsigned int playerIndex);
+
+    private:
+        static unsigned int computeMidpointHeight(const Grid<unsigned char>& heightmap, std::size_t x, std::size_t y);
+
+        std::vector<TextureRegion> getTileTextures(TntArchive& tnt);
+
+        Grid<std::size_t> getMapData(TntArchive& tnt);
+
+        Grid<unsigned char> getHeightGrid(const Grid<TntTileAttributes>& attrs) const;
+
+        std::vector<FeatureDefinition> getFeatures(TntArchive& tnt);
+
+        MapFeature createFeature(const Vector3f& pos, const FeatureDefinition& definition);
+
+        Vector3f computeFeaturePosition(const MapTerrain& terrain, const FeatureDefinition& featureDefinition, std::size_t x, std::size_t y) const;
+    };
+}
+
+#endif
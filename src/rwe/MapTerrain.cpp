@@ -1,6 +1,8 @@
 #include "MapTerrain.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
-#include <rwe/geometry/Plane3f.h>
+#include <limits>
 #include <rwe/geometry/Triangle3f.h>
 
 namespace rwe
@@ -12,6 +14,7 @@ namespace rwe
         float seaLevel)
         : tileGraphics(std::move(tileGraphics)), tiles(std::move(tiles)), heights(std::move(heights)), seaLevel(seaLevel)
     {
+        buildMaxHeightPyramid();
     }
 
     const TextureRegion& MapTerrain::getTileTexture(std::size_t index) const
@@ -151,114 +154,173 @@ namespace rwe
 
     float MapTerrain::getHeightAt(float x, float z) const
     {
-        auto tilePos = worldToHeightmapCoordinate(Vector3f(x, 0.0f, z));
-        if (
-            tilePos.x < 0
-            || static_cast<std::size_t>(tilePos.x) >= heights.getWidth() - 1
-            || tilePos.y < 0
-            || static_cast<std::size_t>(tilePos.y) >= heights.getHeight() - 1)
+        auto heightPos = worldToHeightmapSpace(Vector3f(x, 0.0f, z));
+        if (heightPos.x < 0.0f || heightPos.z < 0.0f)
         {
             return 0.0f;
         }
 
-        Line3f line(Vector3f(x, MaxHeight, z), Vector3f(x, MinHeight, z));
-        auto pos = intersectLine(line);
-        if (!pos)
+        auto cellX = static_cast<int>(heightPos.x);
+        auto cellY = static_cast<int>(heightPos.z);
+        if (!isInHeightMapBounds(cellX, cellY))
         {
             return 0.0f;
         }
-        return pos->y;
+
+        return getHeightInCell(cellX, cellY, heightPos.x - static_cast<float>(cellX), heightPos.z - static_cast<float>(cellY));
+    }
+
+    void MapTerrain::setHeightsAt(std::vector<Vector3f>& positions) const
+    {
+        for (auto& p : positions)
+        {
+            p.y = getHeightAt(p.x, p.z);
+        }
     }
 
     std::optional<Vector3f> MapTerrain::intersectLine(const Line3f& line) const
     {
-        auto heightmapPosition = worldToHeightmapSpace(line.start);
-        Point startCell(static_cast<int>(heightmapPosition.x), static_cast<int>(heightmapPosition.z));
+        if (maxHeightPyramid.empty())
+        {
+            return std::nullopt;
+        }
+
+        auto start = worldToHeightmapSpace(line.start);
+        auto end = worldToHeightmapSpace(line.end);
+        return intersectLineWithNode(line, start, end, maxHeightPyramid.size() - 1, 0, 0);
+    }
+
+    std::optional<Vector3f> MapTerrain::intersectLineWithNode(
+        const Line3f& line,
+        const Vector3f& start,
+        const Vector3f& end,
+        std::size_t level,
+        int x,
+        int y) const
+    {
+        auto range = clipLineToNode(start, end, level, x, y);
+        if (!range)
+        {
+            return std::nullopt;
+        }
 
-        auto ray = Ray3f::fromLine(line);
+        // The line is straight, so its lowest point within the node is at one end of the clipped range.
+        // If that is still above everything in the node, nothing in it can be hit.
+        auto enterHeight = start.y + ((end.y - start.y) * range->first);
+        auto exitHeight = start.y + ((end.y - start.y) * range->second);
+        if (std::min(enterHeight, exitHeight) > static_cast<float>(maxHeightPyramid[level].get(x, y)))
+        {
+            return std::nullopt;
+        }
 
-        int xDirection = ray.direction.x > 0 ? 1 : -1;
-        int zDirection = ray.direction.z > 0 ? 1 : -1;
-        float xPlaneOffset = (HeightTileWidthInWorldUnits / 2.0f) * xDirection;
-        float zPlaneOffset = (HeightTileHeightInWorldUnits / 2.0f) * zDirection;
+        if (level == 0)
+        {
+            return intersectWithHeightmapCell(line, x, y);
+        }
 
-        while (true)
+        // Visit the children in the order the line enters them.
+        // Node bounds are padded slightly, so neighbouring children can overlap along the line
+        // and a later child may still contain a nearer hit; keep going until it cannot.
+        const auto& childLevel = maxHeightPyramid[level - 1];
+        std::array<std::pair<float, Point>, 4> children;
+        std::size_t childCount = 0;
+        for (int dy = 0; dy < 2; ++dy)
         {
-            auto neighbourX = (heightmapPosition.x - startCell.x) > 0.5 ? 1 : -1;
-            auto neighbourY = (heightmapPosition.z - startCell.y) > 0.5 ? 1 : -1;
-
-            // Due to floating-point precision issues,
-            // when the line passes very close to a cell boundary
-            // the "intersectWithHeightmapCell" check may fail,
-            // evaluating the line as passing outside the cell,
-            // even if the line never leaves the cell according to the values of "startCell".
-            // To guard against this, we check collision with the closest four cells,
-            // ensuring that the line cannot escape through any "cracks".
-            if (isInHeightMapBounds(startCell.x, startCell.y))
+            for (int dx = 0; dx < 2; ++dx)
             {
-                auto cellIntersect = intersectWithHeightmapCell(line, startCell.x, startCell.y);
-                if (cellIntersect)
+                auto childX = (x * 2) + dx;
+                auto childY = (y * 2) + dy;
+                if (static_cast<std::size_t>(childX) >= childLevel.getWidth() || static_cast<std::size_t>(childY) >= childLevel.getHeight())
                 {
-                    return *cellIntersect;
+                    continue;
                 }
-            }
 
-            if (isInHeightMapBounds(startCell.x + neighbourX, startCell.y))
-            {
-                auto cellIntersect = intersectWithHeightmapCell(line, startCell.x + neighbourX, startCell.y);
-                if (cellIntersect)
+                auto childRange = clipLineToNode(start, end, level - 1, childX, childY);
+                if (childRange)
                 {
-                    return *cellIntersect;
+                    children[childCount++] = {childRange->first, Point(childX, childY)};
                 }
             }
+        }
+
+        std::sort(children.begin(), children.begin() + childCount, [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        auto direction = line.end - line.start;
+        auto directionLengthSquared = direction.lengthSquared();
 
-            if (isInHeightMapBounds(startCell.x, startCell.y + neighbourY))
+        std::optional<Vector3f> best;
+        float bestT = std::numeric_limits<float>::infinity();
+        for (std::size_t i = 0; i < childCount; ++i)
+        {
+            if (children[i].first > bestT)
             {
-                auto cellIntersect = intersectWithHeightmapCell(line, startCell.x, startCell.y + neighbourY);
-                if (cellIntersect)
-                {
-                    return *cellIntersect;
-                }
+                break;
             }
 
-            if (isInHeightMapBounds(startCell.x + neighbourX, startCell.y + neighbourY))
+            auto hit = intersectLineWithNode(line, start, end, level - 1, children[i].second.x, children[i].second.y);
+            if (!hit)
             {
-                auto cellIntersect = intersectWithHeightmapCell(line, startCell.x + neighbourX, startCell.y + neighbourY);
-                if (cellIntersect)
-                {
-                    return *cellIntersect;
-                }
+                continue;
             }
 
-            auto cellPos = heightmapIndexToWorldCenter(startCell);
+            auto t = directionLengthSquared > 0.0f ? (*hit - line.start).dot(direction) / directionLengthSquared : 0.0f;
+            if (t < bestT)
+            {
+                best = hit;
+                bestT = t;
+            }
+        }
 
-            Plane3f xPlane(Vector3f(cellPos.x + xPlaneOffset, 0.0f, 0.0f), Vector3f(1.0f, 0.0f, 0.0f));
-            float xIntersect = xPlane.intersect(ray).value_or(std::numeric_limits<float>::infinity());
+        return best;
+    }
 
-            Plane3f zPlane(Vector3f(0.0f, 0.0f, cellPos.z + zPlaneOffset), Vector3f(0.0f, 0.0f, 1.0f));
-            float zIntersect = zPlane.intersect(ray).value_or(std::numeric_limits<float>::infinity());
+    std::optional<std::pair<float, float>> MapTerrain::clipLineToNode(
+        const Vector3f& start,
+        const Vector3f& end,
+        std::size_t level,
+        int x,
+        int y) const
+    {
+        // Pad the node so that a line passing exactly along a cell boundary
+        // is tested against the cells on both sides of it.
+        static const float padding = 0.001f;
 
-            if (xIntersect < zIntersect)
-            {
-                if (xIntersect > 1.0f)
-                {
-                    return std::nullopt;
-                }
+        auto cellsWidth = static_cast<int>(heights.getWidth() - 1);
+        auto cellsHeight = static_cast<int>(heights.getHeight() - 1);
 
-                startCell.x += xDirection;
-                heightmapPosition.x += xDirection;
-            }
-            else
+        auto minX = static_cast<float>(x << level) - padding;
+        auto maxX = static_cast<float>(std::min((x + 1) << level, cellsWidth)) + padding;
+        auto minZ = static_cast<float>(y << level) - padding;
+        auto maxZ = static_cast<float>(std::min((y + 1) << level, cellsHeight)) + padding;
+
+        float tMin = 0.0f;
+        float tMax = 1.0f;
+
+        auto clipAxis = [&tMin, &tMax](float from, float to, float min, float max) {
+            auto delta = to - from;
+            if (delta == 0.0f)
             {
-                if (zIntersect > 1.0f)
-                {
-                    return std::nullopt;
-                }
+                return from >= min && from <= max;
+            }
 
-                startCell.y += zDirection;
-                heightmapPosition.z += zDirection;
+            auto t0 = (min - from) / delta;
+            auto t1 = (max - from) / delta;
+            if (t0 > t1)
+            {
+                std::swap(t0, t1);
             }
+
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+            return tMin <= tMax;
+        };
+
+        if (!clipAxis(start.x, end.x, minX, maxX) || !clipAxis(start.z, end.z, minZ, maxZ))
+        {
+            return std::nullopt;
         }
+
+        return std::make_pair(tMin, tMax);
     }
 
     std::optional<Vector3f> MapTerrain::intersectWithHeightmapCell(const Line3f& line, int x, int y) const
@@ -315,6 +377,92 @@ namespace rwe
         return seaLevel;
     }
 
+    float MapTerrain::getHeightInCell(int x, int y, float u, float v) const
+    {
+        // Evaluates the same four triangles that intersectWithHeightmapCell builds:
+        // each has one edge of the cell as its base and the cell center,
+        // raised to the average corner height, as its apex.
+        // Along the base the height is interpolated between the two corners,
+        // and it changes linearly towards the apex.
+        float topLeft = heights.get(x, y);
+        float topRight = heights.get(x + 1, y);
+        float bottomLeft = heights.get(x, y + 1);
+        float bottomRight = heights.get(x + 1, y + 1);
+        float middle = (topLeft + topRight + bottomLeft + bottomRight) / 4.0f;
+
+        auto evaluate = [middle](float start, float end, float t, float distanceFromEdge) {
+            auto edgeHeight = start + ((end - start) * t);
+            auto edgeMidHeight = (start + end) / 2.0f;
+            return edgeHeight + ((distanceFromEdge * 2.0f) * (middle - edgeMidHeight));
+        };
+
+        if (u <= v)
+        {
+            if (u + v <= 1.0f)
+            {
+                return evaluate(topLeft, bottomLeft, v, u); // left
+            }
+
+            return evaluate(bottomLeft, bottomRight, u, 1.0f - v); // bottom
+        }
+
+        if (u + v <= 1.0f)
+        {
+            return evaluate(topLeft, topRight, u, v); // top
+        }
+
+        return evaluate(topRight, bottomRight, v, 1.0f - u); // right
+    }
+
+    void MapTerrain::buildMaxHeightPyramid()
+    {
+        if (heights.getWidth() < 2 || heights.getHeight() < 2)
+        {
+            return;
+        }
+
+        // level 0 holds the highest corner of each heightmap cell
+        Grid<unsigned char> cells(heights.getWidth() - 1, heights.getHeight() - 1);
+        for (std::size_t y = 0; y < cells.getHeight(); ++y)
+        {
+            for (std::size_t x = 0; x < cells.getWidth(); ++x)
+            {
+                cells.set(x, y, std::max({heights.get(x, y), heights.get(x + 1, y), heights.get(x, y + 1), heights.get(x + 1, y + 1)}));
+            }
+        }
+        maxHeightPyramid.push_back(std::move(cells));
+
+        // each further level holds the highest value of each 2x2 block below it
+        while (maxHeightPyramid.back().getWidth() > 1 || maxHeightPyramid.back().getHeight() > 1)
+        {
+            const auto& below = maxHeightPyramid.back();
+            Grid<unsigned char> level((below.getWidth() + 1) / 2, (below.getHeight() + 1) / 2);
+            for (std::size_t y = 0; y < level.getHeight(); ++y)
+            {
+                for (std::size_t x = 0; x < level.getWidth(); ++x)
+                {
+                    unsigned char maxHeight = 0;
+                    for (std::size_t dy = 0; dy < 2; ++dy)
+                    {
+                        for (std::size_t dx = 0; dx < 2; ++dx)
+                        {
+                            auto belowX = (x * 2) + dx;
+                            auto belowY = (y * 2) + dy;
+                            if (belowX < below.getWidth() && belowY < below.getHeight())
+                            {
+                                maxHeight = std::max(maxHeight, below.get(belowX, belowY));
+                            }
+                        }
+                    }
+
+                    level.set(x, y, maxHeight);
+                }
+            }
+
+            maxHeightPyramid.push_back(std::move(level));
+        }
+    }
+
     bool MapTerrain::isInHeightMapBounds(int x, int y) const
     {
         return x >= 0
@@ -6,6 +6,7 @@
 #include <rwe/TextureRegion.h>
 #include <rwe/camera/CabinetCamera.h>
 #include <rwe/geometry/Line3f.h>
+#include <utility>
 #include <vector>
 
 namespace rwe
@@ -29,6 +30,14 @@ namespace rwe
 
         Grid<unsigned char> heights;
 
+        /**
+         * Maximum terrain heights over progressively larger square regions of heightmap cells.
+         * Level 0 has one entry per cell, each further level halves the resolution,
+         * down to a single entry covering the whole map.
+         * Used by intersectLine to skip regions that a line passes entirely above.
+         */
+        std::vector<Grid<unsigned char>> maxHeightPyramid;
+
         float seaLevel;
 
     public:
@@ -79,9 +88,24 @@ namespace rwe
         /**
          * Gets the height of the terrain at the given world coordinates.
          * If the input is outside the heightmap grid, returns 0.
+         *
+         * The height is evaluated directly from the heightmap cell
+         * and agrees with the surface that intersectLine tests against.
          */
         float getHeightAt(float x, float z) const;
 
+        /**
+         * Sets the y coordinate of each position to the terrain height
+         * at its x and z coordinates, as given by getHeightAt.
+         */
+        void setHeightsAt(std::vector<Vector3f>& positions) const;
+
+        /**
+         * Returns the point where the line first hits the terrain, if any.
+         * Descends the max height pyramid,
+         * so the cost depends on how close the line runs to the surface
+         * rather than on how many cells it crosses.
+         */
         std::optional<Vector3f> intersectLine(const Line3f& line) const;
 
         std::optional<Vector3f> intersectWithHeightmapCell(const Line3f& line, int x, int y) const;
@@ -89,6 +113,33 @@ namespace rwe
         float getSeaLevel() const;
 
     private:
+        std::optional<Vector3f> intersectLineWithNode(
+            const Line3f& line,
+            const Vector3f& start,
+            const Vector3f& end,
+            std::size_t level,
+            int x,
+            int y) const;
+
+        /**
+         * Clips a line in heightmap space to the region covered by a pyramid node,
+         * returning the range of the line's parameter inside it.
+         */
+        std::optional<std::pair<float, float>> clipLineToNode(
+            const Vector3f& start,
+            const Vector3f& end,
+            std::size_t level,
+            int x,
+            int y) const;
+
+        void buildMaxHeightPyramid();
+
+        /**
+         * Returns the height of the terrain surface within the given heightmap cell,
+         * where u and v are the position within the cell in the range [0, 1].
+         */
+        float getHeightInCell(int x, int y, float u, float v) const;
+
         bool isInHeightMapBounds(int x, int y) const;
     };
 }
@@ -1,4 +1,5 @@
 #include "MeshService.h"
+#include <array>
 #include <boost/interprocess/streams/bufferstream.hpp>
 #include <rwe/BoxTreeSplit.h>
 #include <rwe/Gaf.h>
@@ -87,15 +88,16 @@ namespace rwe
         }
     };
 
-    MeshService MeshService::createMeshService(AbstractVirtualFileSystem* vfs, GraphicsContext* graphics, const ColorPalette* palette)
+    namespace
     {
-        auto gafs = vfs->getFileNames("textures", ".gaf");
-
-        std::vector<FrameInfo> frames;
-        std::unordered_map<std::string, TextureAttributes> attribs;
+        struct DecodedTextureGaf
+        {
+            std::vector<FrameInfo> frames;
+            std::vector<std::string> entryNames;
+            bool isTeamDependent;
+        };
 
-        // load all the textures into memory
-        for (const auto& gafName : gafs)
+        DecodedTextureGaf decodeTextureGaf(const AbstractVirtualFileSystem* vfs, const std::string& gafName)
         {
             auto bytes = vfs->readFile("textures/" + gafName);
             if (!bytes)
@@ -106,14 +108,56 @@ namespace rwe
             boost::interprocess::bufferstream stream(bytes->data(), bytes->size());
             GafArchive gaf(&stream);
 
-            bool isTeamDependent = toUpper(gafName) == "LOGOS.GAF";
+            DecodedTextureGaf result;
+            result.isTeamDependent = equalsIgnoreCase(gafName, "LOGOS.GAF");
 
             for (const auto& e : gaf.entries())
             {
-                attribs[e.name] = TextureAttributes{isTeamDependent};
-                FrameListGafAdapter adapter(&frames, &e.name);
+                result.entryNames.push_back(e.name);
+                FrameListGafAdapter adapter(&result.frames, &e.name);
                 gaf.extract(e, adapter);
             }
+
+            return result;
+        }
+    }
+
+    MeshService MeshService::createMeshService(
+        AbstractVirtualFileSystem* vfs,
+        AbstractGraphicsContext* graphics,
+        const ColorPalette* palette,
+        ThreadPool* threadPool)
+    {
+        if (graphics == nullptr)
+        {
+            // Headless, meshes are built without textures
+            // so there is no need to decode or pack them.
+            return MeshService(vfs, nullptr, palette, SharedTextureHandle(), {}, {});
+        }
+
+        auto gafs = vfs->getFileNames("textures", ".gaf");
+
+        // decode all the textures into memory, one file per task
+        std::vector<std::future<DecodedTextureGaf>> decodeFutures;
+        decodeFutures.reserve(gafs.size());
+        for (const auto& gafName : gafs)
+        {
+            decodeFutures.push_back(threadPool->submit([vfs, gafName]() { return decodeTextureGaf(vfs, gafName); }));
+        }
+
+        // Merge in listing order so that later files override earlier ones
+        // exactly as they did when the files were read sequentially.
+        std::vector<FrameInfo> frames;
+        CaseInsensitiveMap<TextureAttributes> attribs;
+        for (auto& future : decodeFutures)
+        {
+            auto decoded = future.get();
+            for (const auto& name : decoded.entryNames)
+            {
+                attribs[name] = TextureAttributes{decoded.isTeamDependent};
+            }
+
+            std::move(decoded.frames.begin(), decoded.frames.end(), std::back_inserter(frames));
         }
 
         // figure out how to pack the textures into an atlas
@@ -130,8 +174,8 @@ namespace rwe
             return Size(roundUpToPowerOfTwo(f->data.getWidth()), roundUpToPowerOfTwo(f->data.getHeight()));
         });
 
-        // pack the textures
-        Grid<Color> atlas(packInfo.width, packInfo.height);
+        // pack the palette indices
+        Grid<char> indexAtlas(packInfo.width, packInfo.height);
         std::unordered_map<FrameId, Rectangle2f> atlasMap;
 
         for (const auto& e : packInfo.entries)
@@ -146,23 +190,35 @@ namespace rwe
 
             atlasMap.insert({id, bounds});
 
-            atlas.transformAndReplaceArea<char>(e.x, e.y, e.value->data, [palette](char v) {
-                return (*palette)[static_cast<unsigned char>(v)];
-            });
+            indexAtlas.replaceArea(e.x, e.y, e.value->data);
         }
 
-        SharedTextureHandle atlasTexture(graphics->createTexture(atlas));
+        // convert the whole atlas to colors in a single lookup table pass
+        std::array<Color, 256> colorTable;
+        colorTable.fill(Color::Black);
+        std::copy_n(palette->begin(), std::min<std::size_t>(palette->size(), colorTable.size()), colorTable.begin());
+
+        std::vector<Color> atlas(indexAtlas.getWidth() * indexAtlas.getHeight());
+        const auto* indices = indexAtlas.getData();
+        for (std::size_t i = 0; i < atlas.size(); ++i)
+        {
+            atlas[i] = colorTable[static_cast<unsigned char>(indices[i])];
+        }
 
-        return MeshService(vfs, palette, std::move(atlasTexture), std::move(atlasMap), std::move(attribs));
+        SharedTextureHandle atlasTexture(graphics->createTexture(packInfo.width, packInfo.height, atlas));
+
+        return MeshService(vfs, graphics, palette, std::move(atlasTexture), std::move(atlasMap), std::move(attribs));
     }
 
     MeshService::MeshService(
         AbstractVirtualFileSystem* vfs,
+        AbstractGraphicsContext* graphics,
         const ColorPalette* palette,
         SharedTextureHandle&& atlas,
         std::unordered_map<FrameId, Rectangle2f>&& atlasMap,
-        std::unordered_map<std::string, TextureAttributes> textureAttributesMap)
+        CaseInsensitiveMap<TextureAttributes> textureAttributesMap)
         : vfs(vfs),
+          graphics(graphics),
           palette(palette),
           atlas(std::move(atlas)),
           atlasMap(std::move(atlasMap)),
@@ -253,7 +309,10 @@ namespace rwe
         m.name = o.name;
         auto mesh = meshFrom3do(o, teamColor);
         auto height = m.origin.y + getMeshHeight(mesh);
-        m.mesh = std::make_shared<ShaderMesh>(convertMesh(mesh));
+        if (graphics != nullptr)
+        {
+            m.mesh = std::make_shared<ShaderMesh>(convertMesh(mesh));
+        }
 
         for (const auto& c : o.children)
         {
@@ -271,8 +330,14 @@ namespace rwe
         return InnerUnitMeshInfo{std::move(m), height};
     }
 
-    MeshService::UnitMeshInfo MeshService::loadUnitMesh(const std::string& name, unsigned int teamColor)
+    const _3do::Object& MeshService::getObject(const std::string& name)
     {
+        auto it = objectCache.find(name);
+        if (it != objectCache.end())
+        {
+            return it->second;
+        }
+
         auto bytes = vfs->readFile("objects3d/" + name + ".3do");
         if (!bytes)
         {
@@ -282,9 +347,23 @@ namespace rwe
         boost::interprocess::bufferstream s(bytes->data(), bytes->size());
         auto objects = parse3doObjects(s, s.tellg());
         assert(objects.size() == 1);
-        auto selectionMesh = selectionMeshFrom3do(objects.front());
-        auto unitMesh = unitMeshFrom3do(objects.front(), teamColor);
-        return UnitMeshInfo{std::move(unitMesh.mesh), std::move(selectionMesh), unitMesh.height};
+        return objectCache.emplace(name, std::move(objects.front())).first->second;
+    }
+
+    MeshService::UnitMeshInfo MeshService::loadUnitMesh(const std::string& name, unsigned int teamColor)
+    {
+        auto& colors = unitMeshCache[name];
+        auto it = colors.find(teamColor);
+        if (it == colors.end())
+        {
+            const auto& object = getObject(name);
+            auto selectionMesh = std::make_shared<SelectionMesh>(selectionMeshFrom3do(object));
+            auto unitMesh = unitMeshFrom3do(object, teamColor);
+            it = colors.emplace(teamColor, UnitMeshInfo{std::move(unitMesh.mesh), std::move(selectionMesh), unitMesh.height}).first;
+        }
+
+        // copy the prototype, sharing its GL resources
+        return it->second;
     }
 
     SharedTextureHandle MeshService::getMeshTextureAtlas()
@@ -294,6 +373,11 @@ namespace rwe
 
     Rectangle2f MeshService::getTextureRegion(const std::string& name, unsigned int teamColor)
     {
+        if (graphics == nullptr)
+        {
+            return Rectangle2f(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+
         auto attrsIt = textureAttributesMap.find(name);
         if (attrsIt == textureAttributesMap.end())
         {
@@ -339,6 +423,11 @@ namespace rwe
 
     GlMesh MeshService::createSelectionMesh(const Vector3f& a, const Vector3f& b, const Vector3f& c, const Vector3f& d)
     {
+        if (graphics == nullptr)
+        {
+            return GlMesh(VaoHandle(), VboHandle(), 0);
+        }
+
         const Vector3f color(0.325f, 0.875f, 0.310f);
 
         std::vector<GlColoredVertex> buffer{
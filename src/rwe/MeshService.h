@@ -3,9 +3,15 @@
 
 #include <boost/functional/hash.hpp>
 #include <memory>
-#include <rwe/TextureService.h>
+#include <rwe/AbstractGraphicsContext.h>
+#include <rwe/ColorPalette.h>
+#include <rwe/Mesh.h>
+#include <rwe/SelectionMesh.h>
+#include <rwe/ThreadPool.h>
 #include <rwe/UnitMesh.h>
 #include <rwe/_3do.h>
+#include <rwe/geometry/Rectangle2f.h>
+#include <rwe/rwe_string.h>
 #include <rwe/vfs/AbstractVirtualFileSystem.h>
 
 namespace rwe
@@ -27,6 +33,14 @@ namespace std
 
 namespace rwe
 {
+    /**
+     * Loads unit meshes from 3do objects.
+     *
+     * When created without a graphics context the service runs headless:
+     * texture atlases and GL buffers are not created
+     * and the meshes it returns carry only their piece tree and selection collision mesh,
+     * which is everything the simulation needs.
+     */
     class MeshService
     {
     public:
@@ -35,43 +49,64 @@ namespace rwe
             bool isTeamDependent;
         };
 
+        struct UnitMeshInfo
+        {
+            UnitMesh mesh;
+            std::shared_ptr<SelectionMesh> selectionMesh;
+            float height;
+        };
+
+        struct InnerUnitMeshInfo
+        {
+            UnitMesh mesh;
+            float height;
+        };
+
     private:
         AbstractVirtualFileSystem* vfs;
-        GraphicsContext* graphics;
+
+        /** May be null, in which case no GL resources are created. */
+        AbstractGraphicsContext* graphics;
         const ColorPalette* palette;
         SharedTextureHandle atlas;
         std::unordered_map<FrameId, Rectangle2f> atlasMap;
-        std::unordered_map<std::string, TextureAttributes> textureAttributesMap;
+        CaseInsensitiveMap<TextureAttributes> textureAttributesMap;
+
+        /** Parsed 3do objects, keyed by object name. */
+        CaseInsensitiveMap<_3do::Object> objectCache;
+
+        /**
+         * Fully built unit meshes, keyed by object name, then by team color.
+         * The GL buffers and the selection mesh are shared by every unit cloned from a prototype,
+         * each unit only gets its own copy of the piece tree state.
+         */
+        CaseInsensitiveMap<std::unordered_map<unsigned int, UnitMeshInfo>> unitMeshCache;
 
     public:
         static MeshService createMeshService(
             AbstractVirtualFileSystem* vfs,
-            GraphicsContext* graphics,
-            const ColorPalette* palette);
+            AbstractGraphicsContext* graphics,
+            const ColorPalette* palette,
+            ThreadPool* threadPool);
 
         MeshService(
             AbstractVirtualFileSystem* vfs,
+            AbstractGraphicsContext* graphics,
             const ColorPalette* palette,
             SharedTextureHandle&& atlas,
             std::unordered_map<FrameId, Rectangle2f>&& atlasMap,
-            std::unordered_map<std::string, TextureAttributes> textureAttributesMap);
-
-        struct UnitMeshInfo
-        {
-            UnitMesh mesh;
-            SelectionMesh selectionMesh;
-            float height;
-        };
-
-        struct InnerUnitMeshInfo
-        {
-            UnitMesh mesh;
-            float height;
-        };
+            CaseInsensitiveMap<TextureAttributes> textureAttributesMap);
 
+        /**
+         * Returns a unit mesh for the given object and team color.
+         * The first request for an object/color pair builds a prototype,
+         * later requests return a copy of it that shares its GL buffers.
+         */
         UnitMeshInfo loadUnitMesh(const std::string& name, unsigned int teamColor);
 
     private:
+        const _3do::Object& getObject(const std::string& name);
+
         SharedTextureHandle getMeshTextureAtlas();
         Rectangle2f getTextureRegion(const std::string& name, unsigned int teamColor);
 
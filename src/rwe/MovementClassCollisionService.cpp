@@ -58,6 +58,23 @@ namespace rwe
         return it->second;
     }
 
+    MovementClassCollisionService createMovementClassCollisionService(const GameSimulation& sim, const UnitDatabase& unitDatabase)
+    {
+        MovementClassCollisionService collisionService;
+
+        // compute cached walkable grids for each movement class
+        UnitDatabase::MovementClassIterator it = unitDatabase.movementClassBegin();
+        UnitDatabase::MovementClassIterator end = unitDatabase.movementClassEnd();
+        for (; it != end; ++it)
+        {
+            const auto& name = it->first;
+            const auto& mc = it->second;
+            collisionService.registerMovementClass(name, computeWalkableGrid(sim, mc));
+        }
+
+        return collisionService;
+    }
+
     Grid<char> computeWalkableGrid(const GameSimulation& sim, const MovementClass& movementClass)
     {
         const auto& terrain = sim.terrain;
@@ -6,6 +6,8 @@
 #include <rwe/MovementClass.h>
 #include <rwe/MovementClassId.h>
 #include <rwe/Point.h>
+#include <rwe/UnitDatabase.h>
+#include <rwe/rwe_string.h>
 #include <unordered_map>
 
 namespace rwe
@@ -15,7 +17,7 @@ namespace rwe
     private:
         unsigned int nextId{0};
 
-        std::unordered_map<std::string, MovementClassId> movementClassNameMap;
+        CaseInsensitiveMap<MovementClassId> movementClassNameMap;
         std::unordered_map<MovementClassId, Grid<char>> walkableGrids;
 
     public:
@@ -28,6 +30,12 @@ namespace rwe
         const Grid<char>& getGrid(MovementClassId movementClass) const;
     };
 
+    /**
+     * Creates a collision service with every movement class in the database registered,
+     * each with its walkable grid computed for the given simulation's map.
+     */
+    MovementClassCollisionService createMovementClassCollisionService(const GameSimulation& sim, const UnitDatabase& unitDatabase);
+
     Grid<char> computeWalkableGrid(const GameSimulation& sim, const MovementClass& movementClass);
 
     bool isGridPointWalkable(const MapTerrain& terrain, const MovementClass& movementClass, unsigned int x, unsigned int y);
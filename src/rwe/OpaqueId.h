@@ -24,6 +24,11 @@ namespace rwe
         {
             return !(rhs == *this);
         }
+
+        bool operator<(const OpaqueId& rhs) const
+        {
+            return value < rhs.value;
+        }
     };
 }
 
@@ -0,0 +1,21 @@
+#include "ProjectileDescriptor.h"
+
+namespace rwe
+{
+    unsigned int ProjectileDescriptor::getDamage(const std::string& unitType) const
+    {
+        auto it = damage.find(unitType);
+        if (it != damage.end())
+        {
+            return it->second;
+        }
+
+        it = damage.find("DEFAULT");
+        if (it != damage.end())
+        {
+            return it->second;
+        }
+
+        throw std::runtime_error("Failed to find damage entry for projectile");
+    }
+}
@@ -1,25 +1,25 @@
-#ifndef RWE_LASERPROJECTILE_H
-#define RWE_LASERPROJECTILE_H
+#ifndef RWE_PROJECTILEDESCRIPTOR_H
+#define RWE_PROJECTILEDESCRIPTOR_H
 
-#include <rwe/AudioService.h>
+#include <memory>
+#include <optional>
 #include <rwe/GameTime.h>
-#include <rwe/PlayerId.h>
+#include <rwe/SoundHandle.h>
 #include <rwe/SpriteSeries.h>
-#include <rwe/geometry/Line3f.h>
 #include <rwe/math/Vector3f.h>
+#include <rwe/rwe_string.h>
 
 namespace rwe
 {
-    struct LaserProjectile
+    /**
+     * Properties shared by every projectile fired from a given weapon type.
+     * Projectiles refer to a single shared instance
+     * rather than carrying their own copies.
+     */
+    struct ProjectileDescriptor
     {
-        PlayerId owner;
-
-        Vector3f position;
-
-        Vector3f origin;
-
         /** Velocity in game pixels/tick */
-        Vector3f velocity;
+        float velocity;
 
         /** Duration in ticks */
         float duration;
@@ -38,21 +38,16 @@ namespace rwe
          */
         std::optional<GameTimeDelta> smokeTrail;
 
-        /** The last time the projectile emitted smoke. */
-        GameTime lastSmoke;
-
-        std::optional<AudioService::SoundHandle> soundHit;
-        std::optional<AudioService::SoundHandle> soundWater;
+        std::optional<SoundHandle> soundHit;
+        std::optional<SoundHandle> soundWater;
 
         std::optional<std::shared_ptr<SpriteSeries>> explosion;
         std::optional<std::shared_ptr<SpriteSeries>> waterExplosion;
 
-        std::unordered_map<std::string, unsigned int> damage;
+        CaseInsensitiveMap<unsigned int> damage;
 
         float damageRadius;
 
-        Vector3f getBackPosition() const;
-
         unsigned int getDamage(const std::string& unitType) const;
     };
 }
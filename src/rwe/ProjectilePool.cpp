@@ -0,0 +1,166 @@
+#include "ProjectilePool.h"
+
+#include <cassert>
+#include <rwe/vector_util.h>
+
+namespace rwe
+{
+    std::size_t ProjectilePool::size() const
+    {
+        return descriptors.size();
+    }
+
+    bool ProjectilePool::empty() const
+    {
+        return descriptors.empty();
+    }
+
+    void ProjectilePool::spawn(
+        PlayerId owner,
+        const std::shared_ptr<const ProjectileDescriptor>& descriptor,
+        const Vector3f& position,
+        const Vector3f& velocity,
+        GameTime currentTime)
+    {
+        add(owner, descriptor, position, position, velocity, currentTime);
+    }
+
+    void ProjectilePool::add(
+        PlayerId owner,
+        const std::shared_ptr<const ProjectileDescriptor>& descriptor,
+        const Vector3f& origin,
+        const Vector3f& position,
+        const Vector3f& velocity,
+        GameTime lastSmokeTime)
+    {
+        positionX.push_back(position.x);
+        positionY.push_back(position.y);
+        positionZ.push_back(position.z);
+
+        velocityX.push_back(velocity.x);
+        velocityY.push_back(velocity.y);
+        velocityZ.push_back(velocity.z);
+
+        origins.push_back(origin);
+        owners.push_back(owner);
+        lastSmokeTimes.push_back(lastSmokeTime);
+        descriptors.push_back(descriptor);
+    }
+
+    void ProjectilePool::remove(std::size_t index)
+    {
+        assert(index < size());
+
+        swapRemove(positionX, index);
+        swapRemove(positionY, index);
+        swapRemove(positionZ, index);
+
+        swapRemove(velocityX, index);
+        swapRemove(velocityY, index);
+        swapRemove(velocityZ, index);
+
+        swapRemove(origins, index);
+        swapRemove(owners, index);
+        swapRemove(lastSmokeTimes, index);
+        swapRemove(descriptors, index);
+    }
+
+    void ProjectilePool::clear()
+    {
+        positionX.clear();
+        positionY.clear();
+        positionZ.clear();
+
+        velocityX.clear();
+        velocityY.clear();
+        velocityZ.clear();
+
+        origins.clear();
+        owners.clear();
+        lastSmokeTimes.clear();
+        descriptors.clear();
+    }
+
+    void ProjectilePool::integrate()
+    {
+        auto count = size();
+
+        auto px = positionX.data();
+        auto py = positionY.data();
+        auto pz = positionZ.data();
+        const auto vx = velocityX.data();
+        const auto vy = velocityY.data();
+        const auto vz = velocityZ.data();
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            px[i] += vx[i];
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            py[i] += vy[i];
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            pz[i] += vz[i];
+        }
+    }
+
+    Vector3f ProjectilePool::getPosition(std::size_t index) const
+    {
+        return Vector3f(positionX[index], positionY[index], positionZ[index]);
+    }
+
+    Vector3f ProjectilePool::getVelocity(std::size_t index) const
+    {
+        return Vector3f(velocityX[index], velocityY[index], velocityZ[index]);
+    }
+
+    const Vector3f& ProjectilePool::getOrigin(std::size_t index) const
+    {
+        return origins[index];
+    }
+
+    PlayerId ProjectilePool::getOwner(std::size_t index) const
+    {
+        return owners[index];
+    }
+
+    GameTime ProjectilePool::getLastSmokeTime(std::size_t index) const
+    {
+        return lastSmokeTimes[index];
+    }
+
+    void ProjectilePool::setLastSmokeTime(std::size_t index, GameTime time)
+    {
+        lastSmokeTimes[index] = time;
+    }
+
+    const ProjectileDescriptor& ProjectilePool::getDescriptor(std::size_t index) const
+    {
+        return *descriptors[index];
+    }
+
+    const std::shared_ptr<const ProjectileDescriptor>& ProjectilePool::getSharedDescriptor(std::size_t index) const
+    {
+        return descriptors[index];
+    }
+
+    Vector3f ProjectilePool::getBackPosition(std::size_t index) const
+    {
+        return computeBeamBackPosition(getPosition(index), origins[index], getVelocity(index), descriptors[index]->duration);
+    }
+
+    Vector3f computeBeamBackPosition(const Vector3f& position, const Vector3f& origin, const Vector3f& velocity, float duration)
+    {
+        auto durationVector = velocity * duration;
+        if (durationVector.lengthSquared() < (position - origin).lengthSquared())
+        {
+            return position - durationVector;
+        }
+        else
+        {
+            return origin;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef RWE_PROJECTILEPOOL_H
+#define RWE_PROJECTILEPOOL_H
+
+#include <memory>
+#include <rwe/GameTime.h>
+#include <rwe/PlayerId.h>
+#include <rwe/ProjectileDescriptor.h>
+#include <rwe/math/Vector3f.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Dense storage for in-flight projectiles.
+     *
+     * Projectiles occupy indices [0, size()) with no gaps.
+     * Spawning appends to the end and removal swaps the last projectile
+     * into the removed slot, so both are O(1),
+     * but removal changes the index of the previously last projectile.
+     *
+     * Positions and velocities are stored component-wise
+     * so that integrate() runs over contiguous arrays of floats.
+     */
+    class ProjectilePool
+    {
+    private:
+        std::vector<float> positionX;
+        std::vector<float> positionY;
+        std::vector<float> positionZ;
+
+        std::vector<float> velocityX;
+        std::vector<float> velocityY;
+        std::vector<float> velocityZ;
+
+        std::vector<Vector3f> origins;
+        std::vector<PlayerId> owners;
+
+        /** The last time each projectile emitted smoke. */
+        std::vector<GameTime> lastSmokeTimes;
+
+        std::vector<std::shared_ptr<const ProjectileDescriptor>> descriptors;
+
+    public:
+        std::size_t size() const;
+
+        bool empty() const;
+
+        void spawn(
+            PlayerId owner,
+            const std::shared_ptr<const ProjectileDescriptor>& descriptor,
+            const Vector3f& position,
+            const Vector3f& velocity,
+            GameTime currentTime);
+
+        /**
+         * Adds a projectile that is already in flight,
+         * such as one restored from a snapshot.
+         */
+        void add(
+            PlayerId owner,
+            const std::shared_ptr<const ProjectileDescriptor>& descriptor,
+            const Vector3f& origin,
+            const Vector3f& position,
+            const Vector3f& velocity,
+            GameTime lastSmokeTime);
+
+        /**
+         * Removes the projectile at the given index.
+         * The last projectile is moved into its place.
+         */
+        void remove(std::size_t index);
+
+        void clear();
+
+        /** Advances every projectile by its velocity. */
+        void integrate();
+
+        Vector3f getPosition(std::size_t index) const;
+
+        Vector3f getVelocity(std::size_t index) const;
+
+        const Vector3f& getOrigin(std::size_t index) const;
+
+        PlayerId getOwner(std::size_t index) const;
+
+        GameTime getLastSmokeTime(std::size_t index) const;
+
+        void setLastSmokeTime(std::size_t index, GameTime time);
+
+        const ProjectileDescriptor& getDescriptor(std::size_t index) const;
+
+        const std::shared_ptr<const ProjectileDescriptor>& getSharedDescriptor(std::size_t index) const;
+
+        /**
+         * Returns the position of the tail of the projectile's beam,
+         * which trails the head by the projectile's duration
+         * but never extends behind the point it was fired from.
+         */
+        Vector3f getBackPosition(std::size_t index) const;
+    };
+
+    /**
+     * Returns the position of the tail of a beam whose head is at the given position,
+     * trailing it by the given number of ticks of travel
+     * but never extending behind the point it was fired from.
+     */
+    Vector3f computeBeamBackPosition(const Vector3f& position, const Vector3f& origin, const Vector3f& velocity, float duration);
+}
+
+#endif
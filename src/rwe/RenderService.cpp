@@ -33,7 +33,7 @@ namespace rwe
     }
 
     void
-    RenderService::drawSelectionRect(const Unit& unit)
+    RenderService::drawSelectionRect(const UnitRenderState& unit)
     {
         // try to ensure that the selection rectangle vertices
         // are aligned with the middle of pixels,
@@ -49,20 +49,31 @@ namespace rwe
         graphics->bindShader(shader.handle.get());
         graphics->setUniformMatrix(shader.mvpMatrix, camera.getViewProjectionMatrix() * matrix);
         graphics->setUniformFloat(shader.alpha, 1.0f);
-        graphics->drawLineLoop(unit.selectionMesh.visualMesh);
+        graphics->drawLineLoop(unit.selectionMesh->visualMesh);
     }
 
-    void RenderService::drawUnit(const Unit& unit, float seaLevel)
+    void RenderService::drawUnit(const UnitRenderState& unit, float seaLevel)
     {
-        drawUnitMesh(unit.mesh, unit.getTransform(), seaLevel);
+        drawUnitPieces(unit.pieces, unit.getTransform(), seaLevel);
     }
 
-    void RenderService::drawUnitMesh(const UnitMesh& mesh, const Matrix4f& modelMatrix, float seaLevel)
+    void RenderService::drawUnitPieces(const std::vector<PieceRenderState>& pieces, const Matrix4f& modelMatrix, float seaLevel)
     {
-        auto matrix = modelMatrix * mesh.getTransform();
-
-        if (mesh.visible)
+        // Parents are listed before their children,
+        // so each piece's parent transform is ready by the time we reach it.
+        pieceMatrices.resize(pieces.size());
+        for (std::size_t i = 0; i < pieces.size(); ++i)
         {
+            const auto& piece = pieces[i];
+            const auto& parentMatrix = piece.parent ? pieceMatrices[*piece.parent] : modelMatrix;
+            auto matrix = parentMatrix * piece.getTransform();
+            pieceMatrices[i] = matrix;
+
+            if (!piece.visible)
+            {
+                continue;
+            }
+
             auto mvpMatrix = camera.getViewProjectionMatrix() * matrix;
 
             {
@@ -71,26 +82,21 @@ namespace rwe
                 graphics->setUniformMatrix(colorShader.mvpMatrix, mvpMatrix);
                 graphics->setUniformMatrix(colorShader.modelMatrix, matrix);
                 graphics->setUniformFloat(colorShader.seaLevel, seaLevel);
-                graphics->setUniformBool(colorShader.shade, mesh.shaded);
-                graphics->drawTriangles(mesh.mesh->coloredVertices);
+                graphics->setUniformBool(colorShader.shade, piece.shaded);
+                graphics->drawTriangles(piece.mesh->coloredVertices);
             }
 
             {
                 const auto& textureShader = shaders->unitTexture;
                 graphics->bindShader(textureShader.handle.get());
-                graphics->bindTexture(mesh.mesh->texture.get());
+                graphics->bindTexture(piece.mesh->texture.get());
                 graphics->setUniformMatrix(textureShader.mvpMatrix, mvpMatrix);
                 graphics->setUniformMatrix(textureShader.modelMatrix, matrix);
                 graphics->setUniformFloat(textureShader.seaLevel, seaLevel);
-                graphics->setUniformBool(textureShader.shade, mesh.shaded);
-                graphics->drawTriangles(mesh.mesh->texturedVertices);
+                graphics->setUniformBool(textureShader.shade, piece.shaded);
+                graphics->drawTriangles(piece.mesh->texturedVertices);
             }
         }
-
-        for (const auto& c : mesh.children)
-        {
-            drawUnitMesh(c, matrix, seaLevel);
-        }
     }
 
     void RenderService::drawOccupiedGrid(const MapTerrain& terrain, const OccupiedGrid& occupiedGrid)
@@ -367,16 +373,14 @@ namespace rwe
         drawMapTerrain(terrain, x1, y1, (x2 + 1) - x1, (y2 + 1) - y1);
     }
 
-    void RenderService::drawUnitShadow(const Unit& unit, float groundHeight)
+    void RenderService::drawUnitShadow(const UnitRenderState& unit, float groundHeight)
     {
         auto shadowProjection = Matrix4f::translation(Vector3f(0.0f, groundHeight, 0.0f))
             * Matrix4f::scale(Vector3f(1.0f, 0.0f, 1.0f))
             * Matrix4f::shearXZ(0.25f, -0.25f)
             * Matrix4f::translation(Vector3f(0.0f, -groundHeight, 0.0f));
 
-        auto matrix = Matrix4f::translation(unit.position) * Matrix4f::rotationY(unit.rotation);
-
-        drawUnitMesh(unit.mesh, shadowProjection * matrix, 0.0f);
+        drawUnitPieces(unit.pieces, shadowProjection * unit.getTransform(), 0.0f);
     }
 
     CabinetCamera& RenderService::getCamera()
@@ -414,25 +418,22 @@ namespace rwe
         graphics->drawTriangles(mesh);
     }
 
-    void RenderService::drawLasers(const std::vector<std::optional<LaserProjectile>>& lasers)
+    void RenderService::drawLasers(const std::vector<ProjectileRenderState>& projectiles)
     {
         Vector3f pixelOffset(0.0f, 0.0f, -1.0f);
 
         std::vector<GlColoredVertex> vertices;
-        for (const auto& laser : lasers)
+        vertices.reserve(projectiles.size() * 4);
+        for (const auto& projectile : projectiles)
         {
-            if (!laser)
-            {
-                continue;
-            }
-
-            auto backPosition = laser->getBackPosition();
+            const auto& position = projectile.position;
+            auto backPosition = projectile.getBackPosition();
 
-            vertices.emplace_back(laser->position, laser->color);
-            vertices.emplace_back(backPosition, laser->color);
+            vertices.emplace_back(position, projectile.color);
+            vertices.emplace_back(backPosition, projectile.color);
 
-            vertices.emplace_back(laser->position + pixelOffset, laser->color2);
-            vertices.emplace_back(backPosition + pixelOffset, laser->color2);
+            vertices.emplace_back(position + pixelOffset, projectile.color2);
+            vertices.emplace_back(backPosition + pixelOffset, projectile.color2);
         }
 
         auto mesh = graphics->createColoredMesh(vertices, GL_STREAM_DRAW);
@@ -445,25 +446,20 @@ namespace rwe
         graphics->drawLines(mesh);
     }
 
-    void RenderService::drawExplosions(GameTime currentTime, const std::vector<std::optional<Explosion>>& explosions)
+    void RenderService::drawExplosions(GameTime currentTime, const std::vector<Explosion>& explosions)
     {
         graphics->bindShader(shaders->basicTexture.handle.get());
 
         for (const auto& exp : explosions)
         {
-            if (!exp)
-            {
-                continue;
-            }
-
-            if (!exp->isStarted(currentTime) || exp->isFinished(currentTime))
+            if (!exp.isStarted(currentTime) || exp.isFinished(currentTime))
             {
                 continue;
             }
 
-            const auto& position = exp->position;
-            auto frameIndex = exp->getFrameIndex(currentTime);
-            const auto& sprite = *exp->animation->sprites[frameIndex];
+            const auto& position = exp.position;
+            auto frameIndex = exp.getFrameIndex(currentTime);
+            const auto& sprite = *exp.animation->sprites[frameIndex];
 
             float alpha = 1.0f;
 
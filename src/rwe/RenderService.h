@@ -5,10 +5,9 @@
 #include <rwe/Explosion.h>
 #include <rwe/GameTime.h>
 #include <rwe/GraphicsContext.h>
-#include <rwe/LaserProjectile.h>
 #include <rwe/OccupiedGrid.h>
+#include <rwe/RenderSnapshot.h>
 #include <rwe/ShaderService.h>
-#include <rwe/Unit.h>
 #include <rwe/pathfinding/AStarPathFinder.h>
 #include <rwe/pathfinding/OctileDistance.h>
 #include <rwe/pathfinding/PathCost.h>
@@ -40,6 +39,9 @@ namespace rwe
 
         CabinetCamera camera;
 
+        /** Scratch space for the transforms of the pieces of the unit being drawn. */
+        std::vector<Matrix4f> pieceMatrices;
+
     public:
         RenderService(
             GraphicsContext* graphics,
@@ -49,10 +51,9 @@ namespace rwe
         CabinetCamera& getCamera();
         const CabinetCamera& getCamera() const;
 
-        void drawUnit(const Unit& unit, float seaLevel);
-        void drawUnitShadow(const Unit& unit, float groundHeight);
-        void drawUnitMesh(const UnitMesh& mesh, const Matrix4f& modelMatrix, float seaLevel);
-        void drawSelectionRect(const Unit& unit);
+        void drawUnit(const UnitRenderState& unit, float seaLevel);
+        void drawUnitShadow(const UnitRenderState& unit, float groundHeight);
+        void drawSelectionRect(const UnitRenderState& unit);
         void drawOccupiedGrid(const MapTerrain& terrain, const OccupiedGrid& occupiedGrid);
         void drawMovementClassCollisionGrid(const MapTerrain& terrain, const Grid<char>& movementClassGrid);
         void drawPathfindingVisualisation(const MapTerrain& terrain, const AStarPathInfo<Point, PathCost>& pathInfo);
@@ -93,7 +94,7 @@ namespace rwe
             graphics->useStencilBufferForWrites();
             graphics->disableColorBuffer();
 
-            for (const Unit& unit : units)
+            for (const UnitRenderState& unit : units)
             {
                 auto groundHeight = terrain.getHeightAt(unit.position.x, unit.position.z);
                 drawUnitShadow(unit, groundHeight);
@@ -110,11 +111,13 @@ namespace rwe
 
         void fillScreen(float r, float g, float b, float a);
 
-        void drawLasers(const std::vector<std::optional<LaserProjectile>>& lasers);
+        void drawLasers(const std::vector<ProjectileRenderState>& projectiles);
 
-        void drawExplosions(GameTime currentTime, const std::vector<std::optional<Explosion>>& explosions);
+        void drawExplosions(GameTime currentTime, const std::vector<Explosion>& explosions);
 
     private:
+        void drawUnitPieces(const std::vector<PieceRenderState>& pieces, const Matrix4f& modelMatrix, float seaLevel);
+
         GlMesh createTemporaryLinesMesh(const std::vector<Line3f>& lines);
 
         GlMesh createTemporaryLinesMesh(const std::vector<Line3f>& lines, const Color& color);
@@ -0,0 +1,166 @@
+#include "RenderSnapshot.h"
+
+#include <algorithm>
+#include <rwe/math/rwe_math.h>
+#include <rwe/util.h>
+
+namespace rwe
+{
+    namespace
+    {
+        void appendPieces(const UnitMesh& mesh, std::optional<std::size_t> parent, std::vector<PieceRenderState>& pieces)
+        {
+            auto index = pieces.size();
+            pieces.push_back(PieceRenderState{mesh.mesh, parent, mesh.origin, mesh.offset, mesh.rotation, mesh.visible, mesh.shaded});
+            for (const auto& c : mesh.children)
+            {
+                appendPieces(c, index, pieces);
+            }
+        }
+
+        float interpolate(float a, float b, float alpha)
+        {
+            return a + ((b - a) * alpha);
+        }
+
+        Vector3f interpolate(const Vector3f& a, const Vector3f& b, float alpha)
+        {
+            return a + ((b - a) * alpha);
+        }
+
+        /** Interpolates between two angles in radians the short way round. */
+        float interpolateAngle(float a, float b, float alpha)
+        {
+            return wrap(-Pif, Pif, a + (wrap(-Pif, Pif, b - a) * alpha));
+        }
+
+        Vector3f interpolateAngles(const Vector3f& a, const Vector3f& b, float alpha)
+        {
+            return Vector3f(
+                interpolateAngle(a.x, b.x, alpha),
+                interpolateAngle(a.y, b.y, alpha),
+                interpolateAngle(a.z, b.z, alpha));
+        }
+
+        void interpolateUnit(const UnitRenderState& previous, float alpha, UnitRenderState& unit)
+        {
+            unit.position = interpolate(previous.position, unit.position, alpha);
+            unit.rotation = interpolateAngle(previous.rotation, unit.rotation, alpha);
+
+            // The pieces of a unit never change,
+            // but be safe rather than pair up pieces that do not belong together.
+            if (previous.pieces.size() != unit.pieces.size())
+            {
+                return;
+            }
+
+            for (std::size_t i = 0; i < unit.pieces.size(); ++i)
+            {
+                auto& piece = unit.pieces[i];
+                piece.offset = interpolate(previous.pieces[i].offset, piece.offset, alpha);
+                piece.rotation = interpolateAngles(previous.pieces[i].rotation, piece.rotation, alpha);
+            }
+        }
+    }
+
+    Matrix4f PieceRenderState::getTransform() const
+    {
+        return Matrix4f::translation(origin) * Matrix4f::translation(offset) * Matrix4f::rotationZXY(rotation);
+    }
+
+    Matrix4f UnitRenderState::getTransform() const
+    {
+        return Matrix4f::translation(position) * Matrix4f::rotationY(rotation);
+    }
+
+    Vector3f ProjectileRenderState::getBackPosition() const
+    {
+        return computeBeamBackPosition(position, origin, velocity, duration);
+    }
+
+    const UnitRenderState* RenderSnapshot::findUnit(UnitId id) const
+    {
+        auto it = std::lower_bound(units.begin(), units.end(), id, [](const UnitRenderState& u, UnitId i) { return u.id < i; });
+        if (it == units.end() || it->id != id)
+        {
+            return nullptr;
+        }
+
+        return &*it;
+    }
+
+    void captureRenderSnapshot(const GameSimulation& simulation, RenderSnapshot& snapshot)
+    {
+        snapshot.gameTime = simulation.gameTime;
+
+        snapshot.units.resize(simulation.units.size());
+        std::size_t unitIndex = 0;
+        for (const auto& entry : simulation.units)
+        {
+            const auto& unit = entry.second;
+            auto& state = snapshot.units[unitIndex++];
+            state.id = entry.first;
+            state.owner = unit.owner;
+            state.position = unit.position;
+            state.rotation = unit.rotation;
+            state.hitPoints = unit.hitPoints;
+            state.maxHitPoints = unit.maxHitPoints;
+            state.selectionMesh = unit.selectionMesh;
+
+            state.pieces.clear();
+            appendPieces(unit.mesh, std::nullopt, state.pieces);
+        }
+
+        const auto& projectiles = simulation.projectiles;
+        snapshot.projectiles.clear();
+        snapshot.projectiles.reserve(projectiles.size());
+        for (std::size_t i = 0; i < projectiles.size(); ++i)
+        {
+            const auto& descriptor = projectiles.getDescriptor(i);
+            snapshot.projectiles.push_back(ProjectileRenderState{
+                projectiles.getPosition(i),
+                projectiles.getOrigin(i),
+                projectiles.getVelocity(i),
+                descriptor.duration,
+                descriptor.color,
+                descriptor.color2});
+        }
+
+        snapshot.explosions = simulation.explosions;
+    }
+
+    void interpolateRenderSnapshots(const RenderSnapshot& previous, const RenderSnapshot& current, float alpha, RenderSnapshot& result)
+    {
+        result.gameTime = current.gameTime;
+
+        // Both lists are in order of ID, so walk them together.
+        result.units = current.units;
+        auto previousIt = previous.units.begin();
+        for (auto& unit : result.units)
+        {
+            while (previousIt != previous.units.end() && previousIt->id < unit.id)
+            {
+                ++previousIt;
+            }
+
+            if (previousIt != previous.units.end() && previousIt->id == unit.id)
+            {
+                interpolateUnit(*previousIt, alpha, unit);
+            }
+        }
+
+        result.projectiles = current.projectiles;
+        for (auto& projectile : result.projectiles)
+        {
+            // A projectile fired this tick was not anywhere last tick.
+            if ((projectile.position - projectile.origin).lengthSquared() < projectile.velocity.lengthSquared())
+            {
+                continue;
+            }
+
+            projectile.position -= projectile.velocity * (1.0f - alpha);
+        }
+
+        result.explosions = current.explosions;
+    }
+}
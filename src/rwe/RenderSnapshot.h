@@ -0,0 +1,117 @@
+#ifndef RWE_RENDERSNAPSHOT_H
+#define RWE_RENDERSNAPSHOT_H
+
+#include <memory>
+#include <optional>
+#include <rwe/Explosion.h>
+#include <rwe/GameSimulation.h>
+#include <rwe/GameTime.h>
+#include <rwe/PlayerId.h>
+#include <rwe/SelectionMesh.h>
+#include <rwe/ShaderMesh.h>
+#include <rwe/UnitId.h>
+#include <rwe/math/Matrix4f.h>
+#include <rwe/math/Vector3f.h>
+#include <vector>
+
+namespace rwe
+{
+    /** The drawable state of one piece of a unit's mesh. */
+    struct PieceRenderState
+    {
+        std::shared_ptr<ShaderMesh> mesh;
+
+        /** The index of the parent piece within the unit's pieces, or nothing for the root piece. */
+        std::optional<std::size_t> parent;
+
+        Vector3f origin;
+        Vector3f offset;
+        Vector3f rotation;
+        bool visible{true};
+        bool shaded{true};
+
+        /** Returns the transform of the piece relative to its parent, as UnitMesh::getTransform does. */
+        Matrix4f getTransform() const;
+    };
+
+    /** The drawable state of one unit. */
+    struct UnitRenderState
+    {
+        UnitId id;
+        PlayerId owner;
+        Vector3f position;
+        float rotation{0.0f};
+        unsigned int hitPoints{0};
+        unsigned int maxHitPoints{0};
+        std::shared_ptr<SelectionMesh> selectionMesh;
+
+        /** The pieces of the unit's mesh, each listed before any of its children. */
+        std::vector<PieceRenderState> pieces;
+
+        Matrix4f getTransform() const;
+    };
+
+    /** The drawable state of one projectile. */
+    struct ProjectileRenderState
+    {
+        Vector3f position;
+        Vector3f origin;
+        Vector3f velocity;
+
+        /** Duration of the beam in ticks */
+        float duration{0.0f};
+
+        Vector3f color;
+        Vector3f color2;
+
+        Vector3f getBackPosition() const;
+    };
+
+    /**
+     * Everything the game scene draws that changes as the simulation runs,
+     * copied out of the simulation at the end of a tick.
+     *
+     * The simulation thread captures a snapshot after every tick
+     * and the render thread draws from the last two without touching the simulation.
+     * The terrain and features never change once a game has started,
+     * so they are left out and drawn straight from the simulation.
+     */
+    struct RenderSnapshot
+    {
+        GameTime gameTime{0};
+
+        /** Units in order of ID. */
+        std::vector<UnitRenderState> units;
+
+        std::vector<ProjectileRenderState> projectiles;
+
+        std::vector<Explosion> explosions;
+
+        /** Returns the unit with the given ID, or null if it is not in the snapshot. */
+        const UnitRenderState* findUnit(UnitId id) const;
+    };
+
+    /**
+     * Records the drawable state of the simulation, replacing the previous contents of the snapshot.
+     * Reuses the snapshot's memory where it can.
+     */
+    void captureRenderSnapshot(const GameSimulation& simulation, RenderSnapshot& snapshot);
+
+    /**
+     * Produces the state to draw at a point between two consecutive snapshots,
+     * replacing the previous contents of result.
+     *
+     * Units and their pieces move and turn smoothly between the two ticks.
+     * Units that appeared in the current snapshot are drawn where they are,
+     * and units that have gone are not drawn.
+     * Projectiles travel in straight lines within a tick, so they are moved back along their velocity.
+     * Explosions are drawn as they are in the current snapshot:
+     * they animate in whole frames of game time and are snapped to the pixel grid,
+     * so there is nothing to interpolate.
+     *
+     * @param alpha How far through the tick to draw, from 0 (previous) to 1 (current).
+     */
+    void interpolateRenderSnapshots(const RenderSnapshot& previous, const RenderSnapshot& current, float alpha, RenderSnapshot& result);
+}
+
+#endif
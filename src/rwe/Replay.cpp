@@ -0,0 +1,330 @@
+#include "Replay.h"
+
+#include <boost/filesystem.hpp>
+#include <ctime>
+#include <iterator>
+#include <rwe/BinaryReader.h>
+#include <rwe/BinaryWriter.h>
+#include <rwe/SimulationCommandFields.h>
+
+namespace rwe
+{
+    namespace
+    {
+        /** Record tags following the header. Commands use their variant index plus one. */
+        const uint8_t ReplayEndTag = 0;
+
+        /** Writes values in the replay layout. */
+        class ReplayWriter
+        {
+        private:
+            BinaryWriter writer;
+
+        public:
+            explicit ReplayWriter(std::vector<char>* buffer) : writer(buffer) {}
+
+            void field(uint8_t value)
+            {
+                writer.write(value);
+            }
+
+            void field(uint32_t value)
+            {
+                writer.write(value);
+            }
+
+            void field(float value)
+            {
+                writer.write(value);
+            }
+
+            void field(bool value)
+            {
+                writer.write(value);
+            }
+
+            void field(const std::string& value)
+            {
+                writer.writeString(value);
+            }
+
+            template <typename T>
+            void field(const T& value)
+            {
+                transferFields(*this, value);
+            }
+        };
+
+        /** Reads values back out of a replay held in memory. */
+        class ReplayReader
+        {
+        private:
+            BinaryReader<ReplayException> reader;
+
+        public:
+            ReplayReader(const char* begin, const char* end) : reader(begin, end, "Replay is truncated") {}
+
+            bool atEnd() const
+            {
+                return reader.atEnd();
+            }
+
+            void field(uint8_t& value)
+            {
+                value = reader.read<uint8_t>();
+            }
+
+            void field(uint32_t& value)
+            {
+                value = reader.read<uint32_t>();
+            }
+
+            void field(float& value)
+            {
+                value = reader.read<float>();
+            }
+
+            void field(bool& value)
+            {
+                value = reader.read<bool>();
+            }
+
+            void field(std::string& value)
+            {
+                value = reader.readString();
+            }
+
+            template <typename T>
+            void field(T& value)
+            {
+                transferFields(*this, value);
+            }
+        };
+
+        // The field lists below are shared by the reader and the writer,
+        // so the two cannot disagree about the layout.
+
+        template <typename Archive, typename T>
+        EnableIfType<T, PlayerInfo> transferFields(Archive& a, T& v)
+        {
+            a.field(v.side);
+            a.field(v.color);
+        }
+
+        template <typename Archive, typename T>
+        EnableIfType<T, GameParameters> transferFields(Archive& a, T& v)
+        {
+            a.field(v.mapName);
+            a.field(v.schemaIndex);
+            a.field(v.seed);
+        }
+
+        uint8_t writeController(PlayerInfo::Controller controller)
+        {
+            switch (controller)
+            {
+                case PlayerInfo::Controller::Human:
+                    return 0;
+                case PlayerInfo::Controller::Computer:
+                    return 1;
+                case PlayerInfo::Controller::Remote:
+                    return 2;
+                default:
+                    throw std::logic_error("Invalid player controller");
+            }
+        }
+
+        PlayerInfo::Controller readController(uint8_t controller)
+        {
+            switch (controller)
+            {
+                case 0:
+                    return PlayerInfo::Controller::Human;
+                case 1:
+                    return PlayerInfo::Controller::Computer;
+                case 2:
+                    return PlayerInfo::Controller::Remote;
+                default:
+                    throw ReplayException("Replay has an invalid player controller");
+            }
+        }
+
+        void writePlayers(ReplayWriter& w, const GameParameters& parameters)
+        {
+            for (const auto& player : parameters.players)
+            {
+                w.field(static_cast<bool>(player));
+                if (player)
+                {
+                    w.field(writeController(player->controller));
+                    w.field(*player);
+                }
+            }
+        }
+
+        void readPlayers(ReplayReader& r, GameParameters& parameters)
+        {
+            for (auto& player : parameters.players)
+            {
+                bool present;
+                r.field(present);
+                if (!present)
+                {
+                    player = std::nullopt;
+                    continue;
+                }
+
+                uint8_t controller;
+                r.field(controller);
+                player = PlayerInfo{readController(controller), "", 0};
+                r.field(*player);
+            }
+        }
+    }
+
+    Replay::Replay(const GameParameters& parameters) : parameters(parameters)
+    {
+    }
+
+    ReplayException::ReplayException(const std::string& message) : runtime_error(message)
+    {
+    }
+
+    ReplayRecorder::ReplayRecorder(const std::string& path, const GameParameters& parameters)
+        : stream(path, std::ios::binary | std::ios::trunc), parameters(parameters)
+    {
+        if (!stream)
+        {
+            throw ReplayException("Failed to create replay file: " + path);
+        }
+
+        writeHeader();
+    }
+
+    ReplayRecorder::~ReplayRecorder()
+    {
+        std::vector<char> buffer;
+        ReplayWriter w(&buffer);
+        w.field(ReplayEndTag);
+        w.field(currentTime.value);
+        stream.write(buffer.data(), buffer.size());
+    }
+
+    void ReplayRecorder::setSeed(unsigned int seed)
+    {
+        parameters.seed = seed;
+
+        // The seed has a fixed size, so the new header exactly covers the old one.
+        auto end = stream.tellp();
+        stream.seekp(0);
+        writeHeader();
+        stream.seekp(end);
+    }
+
+    void ReplayRecorder::record(GameTime time, const SimulationCommand& command)
+    {
+        std::vector<char> buffer;
+        ReplayWriter w(&buffer);
+        w.field(getCommandTag(command));
+        w.field(time.value);
+        writeCommandFields(w, command);
+        stream.write(buffer.data(), buffer.size());
+        stream.flush();
+
+        currentTime = time;
+    }
+
+    void ReplayRecorder::advanceTo(GameTime time)
+    {
+        currentTime = time;
+    }
+
+    void ReplayRecorder::writeHeader()
+    {
+        std::vector<char> buffer;
+        ReplayWriter w(&buffer);
+        w.field(ReplayMagicNumber);
+        w.field(ReplayVersion);
+        w.field(parameters);
+        writePlayers(w, parameters);
+        stream.write(buffer.data(), buffer.size());
+        stream.flush();
+    }
+
+    Replay readReplay(const std::string& path)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+        {
+            throw ReplayException("Failed to open replay file: " + path);
+        }
+
+        std::vector<char> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        ReplayReader r(bytes.data(), bytes.data() + bytes.size());
+
+        uint32_t magic;
+        uint32_t version;
+        r.field(magic);
+        r.field(version);
+        if (magic != ReplayMagicNumber)
+        {
+            throw ReplayException("Not a replay file: " + path);
+        }
+        if (version != ReplayVersion)
+        {
+            throw ReplayException("Replay was recorded with an unsupported format version " + std::to_string(version));
+        }
+
+        GameParameters parameters("", 0);
+        r.field(parameters);
+        readPlayers(r, parameters);
+
+        Replay replay(parameters);
+        while (!r.atEnd())
+        {
+            uint8_t tag;
+            r.field(tag);
+
+            uint32_t time;
+            r.field(time);
+
+            if (tag == ReplayEndTag)
+            {
+                replay.endTime = GameTime(time);
+                return replay;
+            }
+
+            if (!replay.commands.empty() && time < replay.commands.back().time.value)
+            {
+                throw ReplayException("Replay commands are out of order");
+            }
+
+            auto command = readCommandFields(r, tag);
+            if (!command)
+            {
+                throw ReplayException("Replay has an unknown command type " + std::to_string(tag));
+            }
+
+            replay.commands.push_back(SimulationScriptEntry{GameTime(time), std::move(*command)});
+        }
+
+        // The recording was cut off, so we only know the game lasted until its last command.
+        if (!replay.commands.empty())
+        {
+            replay.endTime = replay.commands.back().time;
+        }
+
+        return replay;
+    }
+
+    std::string makeReplayPath(const std::string& directory)
+    {
+        auto now = std::time(nullptr);
+        char name[32];
+        std::strftime(name, sizeof(name), "%Y%m%d-%H%M%S.rwr", std::localtime(&now));
+
+        boost::filesystem::path path(directory);
+        path /= name;
+        return path.string();
+    }
+}
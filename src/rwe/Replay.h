@@ -0,0 +1,107 @@
+#ifndef RWE_REPLAY_H
+#define RWE_REPLAY_H
+
+#include <cstdint>
+#include <fstream>
+#include <rwe/GameParameters.h>
+#include <rwe/GameTime.h>
+#include <rwe/SimulationScript.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /** The magic number at the start of a replay file ("RWER"). */
+    static const uint32_t ReplayMagicNumber = 0x52455752;
+
+    /**
+     * The version of the replay format.
+     * Bump this whenever the layout or any of the recorded commands change.
+     */
+    static const uint32_t ReplayVersion = 1;
+
+    /**
+     * A recorded game.
+     * Since the simulation is deterministic, the parameters the game started with
+     * and the commands given during it are enough to reproduce it exactly.
+     */
+    struct Replay
+    {
+        GameParameters parameters;
+
+        /** Every command given during the game, in the order they were applied. */
+        std::vector<SimulationScriptEntry> commands;
+
+        /** The time at which recording stopped. */
+        GameTime endTime{0};
+
+        explicit Replay(const GameParameters& parameters);
+    };
+
+    class ReplayException : public std::runtime_error
+    {
+    public:
+        explicit ReplayException(const std::string& message);
+    };
+
+    /**
+     * Records a game to a replay file as it is played.
+     *
+     * Each command is written out as soon as it is recorded,
+     * so the replay survives the game ending abruptly
+     * up to the last command that was given.
+     * The end time is written when the recorder is destroyed.
+     */
+    class ReplayRecorder
+    {
+    private:
+        std::ofstream stream;
+        GameParameters parameters;
+        GameTime currentTime{0};
+
+    public:
+        /**
+         * Creates the replay file and writes the game parameters to it.
+         * Throws ReplayException if the file cannot be created.
+         */
+        ReplayRecorder(const std::string& path, const GameParameters& parameters);
+
+        ~ReplayRecorder();
+
+        ReplayRecorder(const ReplayRecorder&) = delete;
+        ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+        /**
+         * Replaces the seed written in the header,
+         * for a networked game whose peers agree on the seed once the game is under way.
+         */
+        void setSeed(unsigned int seed);
+
+        /** Records a command applied before the simulation advanced past the given time. */
+        void record(GameTime time, const SimulationCommand& command);
+
+        /** Notes that the simulation has reached the given time. */
+        void advanceTo(GameTime time);
+
+    private:
+        void writeHeader();
+    };
+
+    /**
+     * Reads a replay file.
+     * A replay that was cut off before its end time was written
+     * ends at its last command.
+     * Throws ReplayException if the file cannot be read,
+     * was written by a different format version or is corrupt.
+     */
+    Replay readReplay(const std::string& path);
+
+    /**
+     * Returns the path of a new replay file in the given directory,
+     * named after the current local time.
+     */
+    std::string makeReplayPath(const std::string& directory);
+}
+
+#endif
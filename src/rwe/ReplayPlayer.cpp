@@ -0,0 +1,79 @@
+#include "ReplayPlayer.h"
+
+#include <algorithm>
+
+namespace rwe
+{
+    ReplayPlayer::ReplayPlayer(GameSimulationDriver* driver, const Replay* replay, GameTimeDelta snapshotInterval)
+        : driver(driver), replay(replay), snapshotInterval(snapshotInterval)
+    {
+        if (snapshotInterval.value == 0)
+        {
+            throw std::runtime_error("Snapshot interval must be positive");
+        }
+
+        // The starting state is always kept so that any time can be reached again.
+        snapshots.emplace_back();
+        driver->takeSnapshot(snapshots.back());
+    }
+
+    GameTime ReplayPlayer::getTime() const
+    {
+        return driver->getGameTime();
+    }
+
+    bool ReplayPlayer::isFinished() const
+    {
+        return getTime().value >= replay->endTime.value;
+    }
+
+    void ReplayPlayer::step()
+    {
+        auto time = getTime();
+        for (; nextCommand < replay->commands.size() && replay->commands[nextCommand].time.value <= time.value; ++nextCommand)
+        {
+            driver->applyCommand(replay->commands[nextCommand].command);
+        }
+
+        driver->update();
+
+        takeSnapshotIfDue();
+    }
+
+    void ReplayPlayer::seek(GameTime time)
+    {
+        if (time.value < getTime().value)
+        {
+            // find the last snapshot at or before the time
+            auto it = std::upper_bound(snapshots.begin(), snapshots.end(), time.value, [](unsigned int t, const SimulationSnapshot& s) {
+                return t < s.time.value;
+            });
+            const auto& snapshot = *std::prev(it);
+            driver->restoreSnapshot(snapshot);
+
+            // The snapshot was taken after the simulation reached its time,
+            // before the commands for that tick were applied.
+            auto commandIt = std::lower_bound(replay->commands.begin(), replay->commands.end(), snapshot.time.value, [](const SimulationScriptEntry& e, unsigned int t) {
+                return e.time.value < t;
+            });
+            nextCommand = commandIt - replay->commands.begin();
+        }
+
+        while (getTime().value < time.value && !isFinished())
+        {
+            step();
+        }
+    }
+
+    void ReplayPlayer::takeSnapshotIfDue()
+    {
+        auto time = getTime();
+        if (time.value % snapshotInterval.value != 0 || time.value <= snapshots.back().time.value)
+        {
+            return;
+        }
+
+        snapshots.emplace_back();
+        driver->takeSnapshot(snapshots.back());
+    }
+}
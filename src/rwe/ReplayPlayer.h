@@ -0,0 +1,65 @@
+#ifndef RWE_REPLAYPLAYER_H
+#define RWE_REPLAYPLAYER_H
+
+#include <rwe/GameSimulationDriver.h>
+#include <rwe/Replay.h>
+#include <rwe/SimulationSnapshot.h>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Plays a replay back through a simulation.
+     * The simulation must have been set up from the replay's game parameters
+     * and not yet advanced.
+     *
+     * Nothing here waits for real time to pass,
+     * so the caller decides how fast to play,
+     * whether one step per frame or as fast as possible.
+     *
+     * A snapshot of the simulation is kept at regular intervals as the replay plays,
+     * so seeking backwards restores the nearest earlier snapshot
+     * and replays only from there.
+     */
+    class ReplayPlayer
+    {
+    public:
+        /** The default time between snapshots, ten seconds of game time. */
+        static constexpr unsigned int DefaultSnapshotInterval = 600;
+
+    private:
+        GameSimulationDriver* driver;
+        const Replay* replay;
+
+        GameTimeDelta snapshotInterval;
+
+        /** The index of the next command to apply. */
+        std::size_t nextCommand{0};
+
+        /** Snapshots taken so far, in time order. */
+        std::vector<SimulationSnapshot> snapshots;
+
+    public:
+        ReplayPlayer(GameSimulationDriver* driver, const Replay* replay, GameTimeDelta snapshotInterval = GameTimeDelta(DefaultSnapshotInterval));
+
+        GameTime getTime() const;
+
+        bool isFinished() const;
+
+        /** Applies the commands for the current tick and advances the simulation by one tick. */
+        void step();
+
+        /**
+         * Moves the simulation to the given time as fast as possible,
+         * or to the end of the replay if that is sooner.
+         * Times before the current one are reached by restoring a snapshot
+         * and running forward from there.
+         */
+        void seek(GameTime time);
+
+    private:
+        void takeSnapshotIfDue();
+    };
+}
+
+#endif
@@ -95,10 +95,18 @@ namespace rwe
                 }
             }
 
-            while (currentSimulationTime < currentRealTime)
+            unsigned int updates = 0;
+            while (currentSimulationTime <= currentRealTime && updates < MaxUpdatesPerFrame)
             {
                 currentScene->update();
                 currentSimulationTime += TickInterval;
+                ++updates;
+            }
+
+            if (currentSimulationTime <= currentRealTime)
+            {
+                // We can't catch up, so give up on the time we've lost.
+                currentSimulationTime = currentRealTime + TickInterval;
             }
 
             graphics->clear();
@@ -106,10 +114,10 @@ namespace rwe
             sdl->glSwapWindow(window);
 
             auto finishTime = sdl->getTicks();
-            auto nextSimTime = currentSimulationTime + TickInterval;
-            if (finishTime < nextSimTime)
+            auto wakeTime = std::min(currentSimulationTime, currentRealTime + FrameInterval);
+            if (finishTime < wakeTime)
             {
-                sdl->delay(nextSimTime - finishTime);
+                sdl->delay(wakeTime - finishTime);
             }
         }
     }
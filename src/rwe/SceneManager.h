@@ -1,7 +1,9 @@
 #ifndef RWE_SCENEMANAGER_H
 #define RWE_SCENEMANAGER_H
 
+#include <algorithm>
 #include <memory>
+#include <rwe/GameTime.h>
 #include <rwe/GraphicsContext.h>
 #include <rwe/SdlContextManager.h>
 #include <rwe/events.h>
@@ -46,8 +48,19 @@ namespace rwe
         bool requestedExit;
 
     public:
-        // Number of milliseconds between each game tick.
-        static const unsigned int TickInterval = 1000 / 60;
+        /**
+         * The most scene updates run to catch up before a frame is drawn.
+         * Time we are further behind than this is dropped,
+         * so that one slow frame cannot lead to ever more updates per frame.
+         */
+        static const unsigned int MaxUpdatesPerFrame = 5;
+
+        /**
+         * Minimum number of milliseconds between frames.
+         * Frames are not tied to updates, so scenes that interpolate
+         * can draw more often than they update.
+         */
+        static const unsigned int FrameInterval = 1000 / 120;
 
         explicit SceneManager(SdlContext* sdl, SDL_Window* window, GraphicsContext* graphics);
         void setNextScene(std::shared_ptr<Scene> scene);
@@ -112,14 +112,18 @@ namespace rwe
         friend class SdlContextManager;
     };
 
+    /**
+     * Keeps SDL_net initialised for the lifetime of the object.
+     * Unlike the other contexts this one may be created on its own,
+     * by programs that use the network without the rest of SDL.
+     */
     class SdlNetContext
     {
-    private:
+    public:
         SdlNetContext();
         SdlNetContext(const SdlNetContext&) = delete;
+        SdlNetContext& operator=(const SdlNetContext&) = delete;
         ~SdlNetContext();
-
-        friend class SdlContextManager;
     };
 
     class SdlMixerContext
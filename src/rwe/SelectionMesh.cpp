@@ -1,5 +1,35 @@
 #include "SelectionMesh.h"
+#include <algorithm>
 
 namespace rwe
 {
+    namespace
+    {
+        BoundingBox3f computeBounds(const CollisionMesh& mesh)
+        {
+            const auto& triangles = mesh.triangles;
+            if (triangles.empty())
+            {
+                return BoundingBox3f(Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.0f, 0.0f, 0.0f));
+            }
+
+            auto min = triangles.front().a;
+            auto max = min;
+            for (const auto& t : triangles)
+            {
+                for (const auto& v : {t.a, t.b, t.c})
+                {
+                    min = Vector3f(std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z));
+                    max = Vector3f(std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z));
+                }
+            }
+
+            return BoundingBox3f::fromMinMax(min, max);
+        }
+    }
+
+    SelectionMesh::SelectionMesh(CollisionMesh&& collisionMesh, GlMesh&& visualMesh)
+        : collisionMesh(std::move(collisionMesh)), visualMesh(std::move(visualMesh)), bounds(computeBounds(this->collisionMesh))
+    {
+    }
 }
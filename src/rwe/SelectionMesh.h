@@ -4,6 +4,7 @@
 #include <rwe/GlMesh.h>
 #include <rwe/VaoHandle.h>
 #include <rwe/VboHandle.h>
+#include <rwe/geometry/BoundingBox3f.h>
 #include <rwe/geometry/CollisionMesh.h>
 
 namespace rwe
@@ -12,6 +13,14 @@ namespace rwe
     {
         CollisionMesh collisionMesh;
         GlMesh visualMesh;
+
+        /**
+         * The bounds of the collision mesh in model space,
+         * worked out once here rather than for every unit that shares the mesh.
+         */
+        BoundingBox3f bounds;
+
+        SelectionMesh(CollisionMesh&& collisionMesh, GlMesh&& visualMesh);
     };
 }
 
@@ -6,27 +6,35 @@
 
 namespace rwe
 {
+    /**
+     * Shares ownership of a resource identified by a value,
+     * freeing it with Deleter when the last handle is destroyed.
+     * As with UniqueHandle, the deleter is captured when the handle takes ownership of a value.
+     */
     template <typename Value, typename Deleter>
     class SharedHandle
     {
     public:
         using Type = SharedHandle<Value, Deleter>;
 
+        using DeleteFunction = typename UniqueHandle<Value, Deleter>::DeleteFunction;
+
     private:
         Value handle;
+        DeleteFunction deleteFunction;
         unsigned int* referenceCount;
 
     public:
-        SharedHandle() : handle(), referenceCount(nullptr) {}
+        SharedHandle() : handle(), deleteFunction(nullptr), referenceCount(nullptr) {}
 
-        explicit SharedHandle(Value handle) : handle(handle), referenceCount(new unsigned int(1)) {}
+        explicit SharedHandle(Value handle) : handle(handle), deleteFunction(&UniqueHandle<Value, Deleter>::deleteValue), referenceCount(new unsigned int(1)) {}
 
         ~SharedHandle()
         {
             destroy();
         }
 
-        SharedHandle(const Type& other) : handle(other.handle), referenceCount(other.referenceCount)
+        SharedHandle(const Type& other) : handle(other.handle), deleteFunction(other.deleteFunction), referenceCount(other.referenceCount)
         {
             if (isValid())
             {
@@ -39,6 +47,7 @@ namespace rwe
             destroy();
 
             handle = other.handle;
+            deleteFunction = other.deleteFunction;
             referenceCount = other.referenceCount;
 
             if (isValid())
@@ -49,7 +58,7 @@ namespace rwe
             return *this;
         }
 
-        SharedHandle(Type&& other) noexcept : handle(other.handle), referenceCount(other.referenceCount)
+        SharedHandle(Type&& other) noexcept : handle(other.handle), deleteFunction(other.deleteFunction), referenceCount(other.referenceCount)
         {
             other.referenceCount = nullptr;
         }
@@ -59,6 +68,7 @@ namespace rwe
             destroy();
 
             handle = other.handle;
+            deleteFunction = other.deleteFunction;
             referenceCount = other.referenceCount;
 
             other.referenceCount = nullptr;
@@ -66,8 +76,9 @@ namespace rwe
             return *this;
         }
 
-        explicit SharedHandle(UniqueHandle<Value, Deleter>&& other) noexcept : SharedHandle(other.release())
+        explicit SharedHandle(UniqueHandle<Value, Deleter>&& other) : handle(other.value), deleteFunction(other.deleteFunction), referenceCount(new unsigned int(1))
         {
+            other.release();
         }
 
         bool operator==(const Type& rhs) const
@@ -118,6 +129,7 @@ namespace rwe
         {
             destroy();
             handle = newValue;
+            deleteFunction = &UniqueHandle<Value, Deleter>::deleteValue;
             referenceCount = new unsigned int(1);
         }
 
@@ -135,7 +147,10 @@ namespace rwe
             {
                 if (--(*referenceCount) == 0)
                 {
-                    Deleter()(handle);
+                    if (deleteFunction != nullptr)
+                    {
+                        deleteFunction(handle);
+                    }
                     delete referenceCount;
                 }
             }
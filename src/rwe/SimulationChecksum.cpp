@@ -0,0 +1,409 @@
+#include "SimulationChecksum.h"
+#include <algorithm>
+#include <cstring>
+
+namespace rwe
+{
+    void ChecksumBuilder::addBytes(const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    void ChecksumBuilder::add(std::uint64_t value)
+    {
+        addBytes(&value, sizeof(value));
+    }
+
+    void ChecksumBuilder::add(unsigned int value)
+    {
+        add(static_cast<std::uint64_t>(value));
+    }
+
+    void ChecksumBuilder::add(int value)
+    {
+        add(static_cast<std::uint64_t>(static_cast<std::int64_t>(value)));
+    }
+
+    void ChecksumBuilder::add(bool value)
+    {
+        add(static_cast<std::uint64_t>(value ? 1 : 0));
+    }
+
+    void ChecksumBuilder::add(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        add(static_cast<std::uint64_t>(bits));
+    }
+
+    void ChecksumBuilder::add(const Vector3f& value)
+    {
+        add(value.x);
+        add(value.y);
+        add(value.z);
+    }
+
+    void ChecksumBuilder::add(const std::string& value)
+    {
+        add(static_cast<std::uint64_t>(value.size()));
+        addBytes(value.data(), value.size());
+    }
+
+    std::uint64_t ChecksumBuilder::get() const
+    {
+        return hash;
+    }
+
+    namespace
+    {
+        struct StateFieldName
+        {
+            const char* section;
+            std::optional<unsigned int> id;
+            const char* field;
+        };
+
+        template <typename Variant>
+        void addWhich(ChecksumBuilder& b, const Variant& value)
+        {
+            b.add(static_cast<unsigned int>(value.which()));
+        }
+
+        void addAttackTarget(ChecksumBuilder& b, const AttackTarget& target)
+        {
+            addWhich(b, target);
+            if (auto unitId = boost::get<UnitId>(&target))
+            {
+                b.add(unitId->value);
+            }
+            else
+            {
+                b.add(boost::get<Vector3f>(target));
+            }
+        }
+
+        void addOrder(ChecksumBuilder& b, const UnitOrder& order)
+        {
+            addWhich(b, order);
+            if (auto moveOrder = boost::get<MoveOrder>(&order))
+            {
+                b.add(moveOrder->destination);
+            }
+            else
+            {
+                addAttackTarget(b, boost::get<AttackOrder>(order).target);
+            }
+        }
+
+        void addBehaviourState(ChecksumBuilder& b, const UnitState& state)
+        {
+            addWhich(b, state);
+            auto moving = boost::get<MovingState>(&state);
+            if (!moving)
+            {
+                return;
+            }
+
+            addWhich(b, moving->destination);
+            if (auto point = boost::get<Vector3f>(&moving->destination))
+            {
+                b.add(*point);
+            }
+            else
+            {
+                const auto& rect = boost::get<DiscreteRect>(moving->destination);
+                b.add(rect.x);
+                b.add(rect.y);
+                b.add(rect.width);
+                b.add(rect.height);
+            }
+
+            b.add(moving->pathRequested);
+            b.add(moving->path.has_value());
+            if (moving->path)
+            {
+                const auto& waypoints = moving->path->path.waypoints;
+                b.add(static_cast<std::uint64_t>(waypoints.size()));
+                for (const auto& waypoint : waypoints)
+                {
+                    b.add(waypoint);
+                }
+                b.add(static_cast<std::uint64_t>(moving->path->currentWaypoint - waypoints.begin()));
+                b.add(moving->path->pathCreationTime.value);
+            }
+        }
+
+        void addWeaponState(ChecksumBuilder& b, const UnitWeaponState& state)
+        {
+            addWhich(b, state);
+            auto attacking = boost::get<UnitWeaponStateAttacking>(&state);
+            if (!attacking)
+            {
+                return;
+            }
+
+            addAttackTarget(b, attacking->target);
+            b.add(attacking->aimInfo.has_value());
+            if (attacking->aimInfo)
+            {
+                b.add(attacking->aimInfo->lastHeading);
+                b.add(attacking->aimInfo->lastPitch);
+            }
+        }
+
+        void addMoveOperation(ChecksumBuilder& b, const std::optional<UnitMesh::MoveOperation>& op)
+        {
+            b.add(op.has_value());
+            if (op)
+            {
+                b.add(op->targetPosition);
+                b.add(op->speed);
+            }
+        }
+
+        void addTurnOperation(ChecksumBuilder& b, const std::optional<UnitMesh::TurnOperationUnion>& op)
+        {
+            b.add(op.has_value());
+            if (!op)
+            {
+                return;
+            }
+
+            addWhich(b, *op);
+            if (auto turn = boost::get<UnitMesh::TurnOperation>(&*op))
+            {
+                b.add(turn->targetAngle.value);
+                b.add(turn->speed);
+            }
+            else if (auto spin = boost::get<UnitMesh::SpinOperation>(&*op))
+            {
+                b.add(spin->currentSpeed);
+                b.add(spin->targetSpeed);
+                b.add(spin->acceleration);
+            }
+            else
+            {
+                const auto& stop = boost::get<UnitMesh::StopSpinOperation>(*op);
+                b.add(stop.currentSpeed);
+                b.add(stop.deceleration);
+            }
+        }
+
+        void addUnitMesh(ChecksumBuilder& b, const UnitMesh& mesh)
+        {
+            b.add(mesh.offset);
+            b.add(mesh.rotation);
+            b.add(mesh.visible);
+            addMoveOperation(b, mesh.xMoveOperation);
+            addMoveOperation(b, mesh.yMoveOperation);
+            addMoveOperation(b, mesh.zMoveOperation);
+            addTurnOperation(b, mesh.xTurnOperation);
+            addTurnOperation(b, mesh.yTurnOperation);
+            addTurnOperation(b, mesh.zTurnOperation);
+            for (const auto& c : mesh.children)
+            {
+                addUnitMesh(b, c);
+            }
+        }
+
+        /**
+         * Calls the given function with the name and hash of each field of the simulation state,
+         * always in the same order.
+         */
+        template <typename F>
+        void forEachStateField(const GameSimulation& sim, F&& f)
+        {
+            {
+                ChecksumBuilder b;
+                b.add(sim.gameTime.value);
+                f(StateFieldName{"simulation", std::nullopt, "gameTime"}, b.get());
+            }
+
+            {
+                // The engine holds its whole state by value, as the snapshot also relies on.
+                // Its layout is up to the standard library, so peers must share one.
+                ChecksumBuilder b;
+                b.addBytes(&sim.rng, sizeof(sim.rng));
+                f(StateFieldName{"simulation", std::nullopt, "rng"}, b.get());
+            }
+
+            {
+                ChecksumBuilder b;
+                b.add(sim.nextUnitId.value);
+                b.add(sim.nextFeatureId.value);
+                b.add(static_cast<unsigned int>(sim.gameStatus.which()));
+                f(StateFieldName{"simulation", std::nullopt, "counters"}, b.get());
+            }
+
+            for (unsigned int i = 0; i < sim.players.size(); ++i)
+            {
+                const auto& player = sim.players[i];
+                ChecksumBuilder b;
+                b.add(player.color);
+                b.add(player.status == GamePlayerStatus::Alive);
+                f(StateFieldName{"player", i, "status"}, b.get());
+            }
+
+            {
+                ChecksumBuilder b;
+                b.add(static_cast<std::uint64_t>(sim.units.size()));
+                f(StateFieldName{"simulation", std::nullopt, "unitCount"}, b.get());
+            }
+
+            for (const auto& entry : sim.units)
+            {
+                auto id = entry.first.value;
+                const auto& unit = entry.second;
+
+                {
+                    ChecksumBuilder b;
+                    b.add(unit.unitType);
+                    b.add(unit.owner.value);
+                    f(StateFieldName{"unit", id, "identity"}, b.get());
+                }
+
+                {
+                    ChecksumBuilder b;
+                    b.add(unit.position);
+                    f(StateFieldName{"unit", id, "position"}, b.get());
+                }
+
+                {
+                    ChecksumBuilder b;
+                    b.add(unit.rotation);
+                    b.add(unit.currentSpeed);
+                    b.add(unit.targetAngle);
+                    b.add(unit.targetSpeed);
+                    b.add(unit.inCollision);
+                    f(StateFieldName{"unit", id, "movement"}, b.get());
+                }
+
+                {
+                    ChecksumBuilder b;
+                    b.add(unit.hitPoints);
+                    f(StateFieldName{"unit", id, "hitPoints"}, b.get());
+                }
+
+                {
+                    ChecksumBuilder b;
+                    b.add(static_cast<std::uint64_t>(unit.orders.size()));
+                    for (const auto& order : unit.orders)
+                    {
+                        addOrder(b, order);
+                    }
+                    addBehaviourState(b, unit.behaviourState);
+                    f(StateFieldName{"unit", id, "orders"}, b.get());
+                }
+
+                {
+                    ChecksumBuilder b;
+                    for (const auto& weapon : unit.weapons)
+                    {
+                        b.add(weapon.has_value());
+                        if (weapon)
+                        {
+                            b.add(weapon->readyTime.value);
+                            addWeaponState(b, weapon->state);
+                        }
+                    }
+                    f(StateFieldName{"unit", id, "weapons"}, b.get());
+                }
+
+                {
+                    ChecksumBuilder b;
+                    for (auto value : unit.cobEnvironment->_statics)
+                    {
+                        b.add(value);
+                    }
+                    b.add(static_cast<std::uint64_t>(unit.cobEnvironment->threads.size()));
+                    f(StateFieldName{"unit", id, "script"}, b.get());
+                }
+
+                {
+                    ChecksumBuilder b;
+                    addUnitMesh(b, unit.mesh);
+                    f(StateFieldName{"unit", id, "pieces"}, b.get());
+                }
+            }
+
+            {
+                ChecksumBuilder b;
+                b.add(static_cast<std::uint64_t>(sim.projectiles.size()));
+                f(StateFieldName{"simulation", std::nullopt, "projectileCount"}, b.get());
+            }
+
+            for (std::size_t i = 0; i < sim.projectiles.size(); ++i)
+            {
+                ChecksumBuilder b;
+                b.add(sim.projectiles.getPosition(i));
+                b.add(sim.projectiles.getVelocity(i));
+                b.add(sim.projectiles.getOwner(i).value);
+                f(StateFieldName{"projectile", static_cast<unsigned int>(i), "motion"}, b.get());
+            }
+
+            {
+                ChecksumBuilder b;
+                b.add(static_cast<std::uint64_t>(sim.pathRequests.size()));
+                for (const auto& r : sim.pathRequests)
+                {
+                    b.add(r.unitId.value);
+                }
+                f(StateFieldName{"simulation", std::nullopt, "pathRequests"}, b.get());
+            }
+        }
+    }
+
+    std::uint64_t computeSimulationChecksum(const GameSimulation& simulation)
+    {
+        ChecksumBuilder total;
+        forEachStateField(simulation, [&total](const StateFieldName&, std::uint64_t hash) { total.add(hash); });
+        return total.get();
+    }
+
+    std::vector<SimulationStateField> describeSimulationState(const GameSimulation& simulation)
+    {
+        std::vector<SimulationStateField> fields;
+        forEachStateField(simulation, [&fields](const StateFieldName& name, std::uint64_t hash) {
+            std::string fullName(name.section);
+            if (name.id)
+            {
+                fullName += " " + std::to_string(*name.id);
+            }
+            fullName += " ";
+            fullName += name.field;
+            fields.push_back(SimulationStateField{std::move(fullName), hash});
+        });
+        return fields;
+    }
+
+    std::optional<std::string> findFirstDifference(const std::vector<SimulationStateField>& a, const std::vector<SimulationStateField>& b)
+    {
+        auto count = std::min(a.size(), b.size());
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (a[i].name != b[i].name)
+            {
+                // The same position holds different fields,
+                // so one side has a unit or projectile that the other does not.
+                return a[i].name + " / " + b[i].name;
+            }
+
+            if (a[i].hash != b[i].hash)
+            {
+                return a[i].name;
+            }
+        }
+
+        if (a.size() != b.size())
+        {
+            return std::string(a.size() > b.size() ? a[count].name : b[count].name);
+        }
+
+        return std::nullopt;
+    }
+}
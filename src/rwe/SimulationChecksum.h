@@ -0,0 +1,74 @@
+#ifndef RWE_SIMULATIONCHECKSUM_H
+#define RWE_SIMULATIONCHECKSUM_H
+
+#include <cstdint>
+#include <optional>
+#include <rwe/GameSimulation.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Accumulates a 64-bit FNV-1a hash.
+     * Floats are hashed by their bit patterns,
+     * so values that compare equal but differ in representation (0 and -0) hash differently.
+     */
+    class ChecksumBuilder
+    {
+    private:
+        std::uint64_t hash{14695981039346656037ull};
+
+    public:
+        void addBytes(const void* data, std::size_t size);
+
+        void add(std::uint64_t value);
+
+        void add(unsigned int value);
+
+        void add(int value);
+
+        void add(bool value);
+
+        void add(float value);
+
+        void add(const Vector3f& value);
+
+        void add(const std::string& value);
+
+        std::uint64_t get() const;
+    };
+
+    /** The hash of one part of the simulation state, such as the position of a unit. */
+    struct SimulationStateField
+    {
+        std::string name;
+        std::uint64_t hash;
+    };
+
+    /**
+     * Computes a checksum of all the state that affects how the simulation evolves.
+     * Purely cosmetic state, such as explosion animations, is excluded,
+     * so a headless simulation and one being drawn produce the same checksums.
+     *
+     * The checksum is computed from scratch on every call, in time linear in the size of the state.
+     * The simulation does not track which state changed since the last tick,
+     * so there is nothing to update incrementally.
+     */
+    std::uint64_t computeSimulationChecksum(const GameSimulation& simulation);
+
+    /**
+     * Returns the hashes of the same state as computeSimulationChecksum,
+     * one per named field, for tracking down where two simulations diverged.
+     * Much slower than computing the checksum.
+     */
+    std::vector<SimulationStateField> describeSimulationState(const GameSimulation& simulation);
+
+    /**
+     * Returns the name of the first field that differs between two descriptions,
+     * or nothing if they are the same.
+     */
+    std::optional<std::string> findFirstDifference(const std::vector<SimulationStateField>& a, const std::vector<SimulationStateField>& b);
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef RWE_SIMULATIONCOMMAND_H
+#define RWE_SIMULATIONCOMMAND_H
+
+#include <boost/variant.hpp>
+#include <rwe/PlayerId.h>
+#include <rwe/UnitId.h>
+#include <string>
+
+namespace rwe
+{
+    /**
+     * Commands are the only way that the outside world changes a running simulation.
+     * Positions are given on the XZ plane and placed on the terrain when the command is applied.
+     */
+    struct SpawnUnitCommand
+    {
+        PlayerId player;
+        std::string unitType;
+        float x;
+        float z;
+    };
+
+    struct MoveCommand
+    {
+        UnitId unit;
+        float x;
+        float z;
+
+        /** If true, the order is added to the unit's queue rather than replacing it. */
+        bool queued;
+    };
+
+    struct AttackCommand
+    {
+        UnitId unit;
+        UnitId target;
+
+        /** If true, the order is added to the unit's queue rather than replacing it. */
+        bool queued;
+    };
+
+    struct AttackGroundCommand
+    {
+        UnitId unit;
+        float x;
+        float z;
+
+        /** If true, the order is added to the unit's queue rather than replacing it. */
+        bool queued;
+    };
+
+    struct StopCommand
+    {
+        UnitId unit;
+    };
+
+    using SimulationCommand = boost::variant<SpawnUnitCommand, MoveCommand, AttackCommand, AttackGroundCommand, StopCommand>;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef RWE_SIMULATIONCOMMANDFIELDS_H
+#define RWE_SIMULATIONCOMMANDFIELDS_H
+
+#include <boost/mpl/size.hpp>
+#include <cstdint>
+#include <optional>
+#include <rwe/SimulationCommand.h>
+#include <type_traits>
+
+namespace rwe
+{
+    // The fields of each command, in the order they are written
+    // by every binary format that carries commands, replays and network packets alike.
+    // An archive is a reader or writer with a field() overload for each plain type;
+    // the same list serves both so that they cannot disagree about the layout.
+
+    template <typename T, typename U>
+    using EnableIfType = std::enable_if_t<std::is_same_v<std::remove_const_t<T>, U>>;
+
+    template <typename Archive, typename T>
+    EnableIfType<T, SpawnUnitCommand> transferFields(Archive& a, T& v)
+    {
+        a.field(v.player.value);
+        a.field(v.unitType);
+        a.field(v.x);
+        a.field(v.z);
+    }
+
+    template <typename Archive, typename T>
+    EnableIfType<T, MoveCommand> transferFields(Archive& a, T& v)
+    {
+        a.field(v.unit.value);
+        a.field(v.x);
+        a.field(v.z);
+        a.field(v.queued);
+    }
+
+    template <typename Archive, typename T>
+    EnableIfType<T, AttackCommand> transferFields(Archive& a, T& v)
+    {
+        a.field(v.unit.value);
+        a.field(v.target.value);
+        a.field(v.queued);
+    }
+
+    template <typename Archive, typename T>
+    EnableIfType<T, AttackGroundCommand> transferFields(Archive& a, T& v)
+    {
+        a.field(v.unit.value);
+        a.field(v.x);
+        a.field(v.z);
+        a.field(v.queued);
+    }
+
+    template <typename Archive, typename T>
+    EnableIfType<T, StopCommand> transferFields(Archive& a, T& v)
+    {
+        a.field(v.unit.value);
+    }
+
+    static_assert(boost::mpl::size<SimulationCommand::types>::value == 5, "New command types must be added to readCommandFields");
+
+    /** Returns the tag that identifies the type of the command in binary formats. Tags are never zero. */
+    inline uint8_t getCommandTag(const SimulationCommand& command)
+    {
+        return static_cast<uint8_t>(command.which() + 1);
+    }
+
+    template <typename Archive>
+    class WriteCommandFieldsVisitor : public boost::static_visitor<>
+    {
+    private:
+        Archive* archive;
+
+    public:
+        explicit WriteCommandFieldsVisitor(Archive* archive) : archive(archive) {}
+
+        template <typename T>
+        void operator()(const T& command) const
+        {
+            archive->field(command);
+        }
+    };
+
+    /** Writes the fields of the command, not including its tag. */
+    template <typename Archive>
+    void writeCommandFields(Archive& a, const SimulationCommand& command)
+    {
+        boost::apply_visitor(WriteCommandFieldsVisitor<Archive>(&a), command);
+    }
+
+    template <typename T, typename Archive>
+    SimulationCommand readCommandFields(Archive& a)
+    {
+        T command{};
+        a.field(command);
+        return command;
+    }
+
+    /**
+     * Reads the fields of a command of the type with the given tag.
+     * Returns nothing if no command type has that tag.
+     */
+    template <typename Archive>
+    std::optional<SimulationCommand> readCommandFields(Archive& a, uint8_t tag)
+    {
+        switch (tag)
+        {
+            case 1:
+                return readCommandFields<SpawnUnitCommand>(a);
+            case 2:
+                return readCommandFields<MoveCommand>(a);
+            case 3:
+                return readCommandFields<AttackCommand>(a);
+            case 4:
+                return readCommandFields<AttackGroundCommand>(a);
+            case 5:
+                return readCommandFields<StopCommand>(a);
+            default:
+                return std::nullopt;
+        }
+    }
+}
+
+#endif
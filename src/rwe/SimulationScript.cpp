@@ -0,0 +1,187 @@
+#include "SimulationScript.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace rwe
+{
+    namespace
+    {
+        class ScriptLineReader
+        {
+        private:
+            std::istringstream stream;
+            unsigned int lineNumber;
+
+        public:
+            ScriptLineReader(const std::string& line, unsigned int lineNumber) : stream(line), lineNumber(lineNumber)
+            {
+            }
+
+            std::runtime_error error(const std::string& message) const
+            {
+                return std::runtime_error("Simulation script line " + std::to_string(lineNumber) + ": " + message);
+            }
+
+            std::string readWord(const char* description)
+            {
+                std::string word;
+                if (!(stream >> word))
+                {
+                    throw error(std::string("expected ") + description);
+                }
+                return word;
+            }
+
+            unsigned int readUnsigned(const char* description)
+            {
+                auto word = readWord(description);
+                if (word.empty() || !std::all_of(word.begin(), word.end(), [](char c) { return c >= '0' && c <= '9'; }))
+                {
+                    throw error(std::string("expected ") + description + ", got '" + word + "'");
+                }
+
+                try
+                {
+                    auto value = std::stoul(word);
+                    if (value > std::numeric_limits<unsigned int>::max())
+                    {
+                        throw std::out_of_range(word);
+                    }
+                    return static_cast<unsigned int>(value);
+                }
+                catch (const std::out_of_range&)
+                {
+                    throw error(std::string(description) + " out of range: " + word);
+                }
+            }
+
+            float readFloat(const char* description)
+            {
+                auto word = readWord(description);
+                try
+                {
+                    std::size_t end;
+                    auto value = std::stof(word, &end);
+                    if (end != word.size())
+                    {
+                        throw std::invalid_argument(word);
+                    }
+                    return value;
+                }
+                catch (const std::logic_error&)
+                {
+                    throw error(std::string("expected ") + description + ", got '" + word + "'");
+                }
+            }
+
+            /** Reads the optional trailing "queue" keyword and checks that nothing follows it. */
+            bool readQueued()
+            {
+                std::string word;
+                if (!(stream >> word))
+                {
+                    return false;
+                }
+
+                if (word != "queue")
+                {
+                    throw error("unexpected '" + word + "'");
+                }
+
+                expectEnd();
+                return true;
+            }
+
+            void expectEnd()
+            {
+                std::string word;
+                if (stream >> word)
+                {
+                    throw error("unexpected '" + word + "'");
+                }
+            }
+        };
+
+        SimulationCommand parseCommand(ScriptLineReader& reader)
+        {
+            auto name = reader.readWord("command");
+
+            if (name == "spawn")
+            {
+                PlayerId player(reader.readUnsigned("player"));
+                auto unitType = reader.readWord("unit type");
+                auto x = reader.readFloat("x coordinate");
+                auto z = reader.readFloat("z coordinate");
+                reader.expectEnd();
+                return SpawnUnitCommand{player, std::move(unitType), x, z};
+            }
+
+            if (name == "move")
+            {
+                UnitId unit(reader.readUnsigned("unit"));
+                auto x = reader.readFloat("x coordinate");
+                auto z = reader.readFloat("z coordinate");
+                return MoveCommand{unit, x, z, reader.readQueued()};
+            }
+
+            if (name == "attack")
+            {
+                UnitId unit(reader.readUnsigned("unit"));
+                UnitId target(reader.readUnsigned("target unit"));
+                return AttackCommand{unit, target, reader.readQueued()};
+            }
+
+            if (name == "attack-ground")
+            {
+                UnitId unit(reader.readUnsigned("unit"));
+                auto x = reader.readFloat("x coordinate");
+                auto z = reader.readFloat("z coordinate");
+                return AttackGroundCommand{unit, x, z, reader.readQueued()};
+            }
+
+            if (name == "stop")
+            {
+                UnitId unit(reader.readUnsigned("unit"));
+                reader.expectEnd();
+                return StopCommand{unit};
+            }
+
+            throw reader.error("unknown command '" + name + "'");
+        }
+    }
+
+    std::vector<SimulationScriptEntry> parseSimulationScript(std::istream& input)
+    {
+        std::vector<SimulationScriptEntry> entries;
+
+        std::string line;
+        unsigned int lineNumber = 0;
+        while (std::getline(input, line))
+        {
+            ++lineNumber;
+
+            auto commentStart = line.find('#');
+            if (commentStart != std::string::npos)
+            {
+                line.erase(commentStart);
+            }
+
+            if (std::all_of(line.begin(), line.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }))
+            {
+                continue;
+            }
+
+            ScriptLineReader reader(line, lineNumber);
+            GameTime time(reader.readUnsigned("tick"));
+            entries.push_back(SimulationScriptEntry{time, parseCommand(reader)});
+        }
+
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.time.value < b.time.value; });
+
+        return entries;
+    }
+}
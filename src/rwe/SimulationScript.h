@@ -0,0 +1,35 @@
+#ifndef RWE_SIMULATIONSCRIPT_H
+#define RWE_SIMULATIONSCRIPT_H
+
+#include <istream>
+#include <rwe/GameTime.h>
+#include <rwe/SimulationCommand.h>
+#include <vector>
+
+namespace rwe
+{
+    struct SimulationScriptEntry
+    {
+        /** The tick at which the command is applied, before the simulation is advanced. */
+        GameTime time;
+        SimulationCommand command;
+    };
+
+    /**
+     * Parses a script of timed commands, one per line:
+     *
+     *   <tick> spawn <player> <unit type> <x> <z>
+     *   <tick> move <unit> <x> <z> [queue]
+     *   <tick> attack <unit> <target unit> [queue]
+     *   <tick> attack-ground <unit> <x> <z> [queue]
+     *   <tick> stop <unit>
+     *
+     * Blank lines are ignored and '#' starts a comment.
+     * The returned entries are sorted by time,
+     * with entries for the same tick kept in the order they were written.
+     * Throws std::runtime_error if a line cannot be parsed.
+     */
+    std::vector<SimulationScriptEntry> parseSimulationScript(std::istream& input);
+}
+
+#endif
@@ -0,0 +1,993 @@
+#include "SimulationSnapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <rwe/BinaryReader.h>
+#include <rwe/BinaryWriter.h>
+#include <stack>
+#include <stdexcept>
+#include <type_traits>
+
+namespace rwe
+{
+    std::size_t SimulationSnapshot::size() const
+    {
+        return data.size();
+    }
+
+    namespace
+    {
+        /** Index written in place of a thread or shared resource that is absent. */
+        const uint32_t NoIndex = 0xFFFFFFFF;
+
+        static const char* const CorruptSnapshotMessage = "Simulation snapshot does not fit the simulation";
+
+        [[noreturn]] void throwCorruptSnapshot()
+        {
+            throw std::runtime_error(CorruptSnapshotMessage);
+        }
+
+        template <typename T>
+        uint32_t findOrAdd(std::vector<std::shared_ptr<T>>& table, const std::shared_ptr<T>& value)
+        {
+            if (!value)
+            {
+                return NoIndex;
+            }
+
+            // There are only ever a handful of distinct descriptors and animations,
+            // so a linear search beats hashing.
+            for (std::size_t i = 0; i < table.size(); ++i)
+            {
+                if (table[i] == value)
+                {
+                    return static_cast<uint32_t>(i);
+                }
+            }
+
+            table.push_back(value);
+            return static_cast<uint32_t>(table.size() - 1);
+        }
+
+        /** Appends values to the snapshot buffer. */
+        class SnapshotWriter
+        {
+        private:
+            SimulationSnapshot* snapshot;
+            BinaryWriter writer;
+
+        public:
+            static constexpr bool IsReading = false;
+
+            explicit SnapshotWriter(SimulationSnapshot* snapshot) : snapshot(snapshot), writer(&snapshot->data) {}
+
+            template <typename T>
+            std::enable_if_t<std::is_arithmetic_v<T>> field(const T& value) { writer.write(value); }
+
+            template <typename T, typename Tag>
+            void field(const OpaqueId<T, Tag>& value) { field(value.value); }
+
+            void field(const Vector3f& value)
+            {
+                field(value.x);
+                field(value.y);
+                field(value.z);
+            }
+
+            void field(const std::string& value) { writer.writeString(value); }
+
+            std::size_t count(std::size_t size)
+            {
+                writer.writeSize(size);
+                return size;
+            }
+
+            /** Transfers a vector of plain values in one block. */
+            template <typename T>
+            void array(const std::vector<T>& values)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                count(values.size());
+                bytes(values.data(), values.size() * sizeof(T));
+            }
+
+            void bytes(const void* data, std::size_t size) { writer.writeBytes(data, size); }
+
+            void projectileDescriptor(const std::shared_ptr<const ProjectileDescriptor>& descriptor)
+            {
+                field(findOrAdd(snapshot->projectileDescriptors, descriptor));
+            }
+
+            void animation(const std::shared_ptr<SpriteSeries>& animation)
+            {
+                field(findOrAdd(snapshot->animations, animation));
+            }
+        };
+
+        /** Reads values back out of the snapshot buffer, overwriting the existing values. */
+        class SnapshotReader
+        {
+        private:
+            const SimulationSnapshot* snapshot;
+            BinaryReader<std::runtime_error> reader;
+
+        public:
+            static constexpr bool IsReading = true;
+
+            explicit SnapshotReader(const SimulationSnapshot* snapshot)
+                : snapshot(snapshot),
+                  reader(snapshot->data.data(), snapshot->data.data() + snapshot->data.size(), CorruptSnapshotMessage)
+            {
+            }
+
+            bool atEnd() const { return reader.atEnd(); }
+
+            template <typename T>
+            std::enable_if_t<std::is_arithmetic_v<T>> field(T& value) { value = reader.template read<T>(); }
+
+            template <typename T, typename Tag>
+            void field(OpaqueId<T, Tag>& value) { field(value.value); }
+
+            void field(Vector3f& value)
+            {
+                field(value.x);
+                field(value.y);
+                field(value.z);
+            }
+
+            void field(std::string& value) { value = reader.readString(); }
+
+            /**
+             * Returns the size of the next container.
+             * Every element takes at least a byte,
+             * so sizes larger than the rest of the buffer are rejected
+             * before anything is allocated for them.
+             */
+            std::size_t count(std::size_t) { return reader.readSize(); }
+
+            template <typename T>
+            void array(std::vector<T>& values)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                auto size = reader.readSize(sizeof(T));
+                values.resize(size);
+                bytes(values.data(), size * sizeof(T));
+            }
+
+            void bytes(void* data, std::size_t size) { reader.readBytes(data, size); }
+
+            void projectileDescriptor(std::shared_ptr<const ProjectileDescriptor>& descriptor)
+            {
+                descriptor = lookUp(snapshot->projectileDescriptors);
+            }
+
+            void animation(std::shared_ptr<SpriteSeries>& animation)
+            {
+                animation = lookUp(snapshot->animations);
+            }
+
+        private:
+            template <typename T>
+            std::shared_ptr<T> lookUp(const std::vector<std::shared_ptr<T>>& table)
+            {
+                uint32_t index;
+                field(index);
+                if (index == NoIndex)
+                {
+                    return nullptr;
+                }
+                if (index >= table.size())
+                {
+                    throwCorruptSnapshot();
+                }
+                return table[index];
+            }
+        };
+
+        // The functions below are shared by the writer and the reader,
+        // so the two cannot disagree about the layout.
+        // When writing, the values they are given are const;
+        // when reading, they are overwritten with the values in the snapshot.
+
+        /** Exposes the container under a std::stack, so that stacks can be copied in place. */
+        template <typename T>
+        struct StackContainer : private std::stack<T>
+        {
+            static const std::deque<T>& get(const std::stack<T>& s) { return s.*(&StackContainer::c); }
+
+            static std::deque<T>& get(std::stack<T>& s) { return s.*(&StackContainer::c); }
+        };
+
+        template <typename Archive, typename E>
+        void transferEnum(Archive& a, E& value)
+        {
+            auto raw = static_cast<uint8_t>(value);
+            a.field(raw);
+            if constexpr (Archive::IsReading)
+            {
+                value = static_cast<E>(raw);
+            }
+        }
+
+        /**
+         * Transfers whether the optional holds a value
+         * and returns true if there is a value to transfer.
+         * When reading into an empty optional, it is first given the value from make.
+         */
+        template <typename Archive, typename Optional, typename Make>
+        bool transferPresence(Archive& a, Optional& value, Make&& make)
+        {
+            bool present = value.has_value();
+            a.field(present);
+            if constexpr (Archive::IsReading)
+            {
+                if (!present)
+                {
+                    value.reset();
+                }
+                else if (!value)
+                {
+                    value = make();
+                }
+            }
+            return present;
+        }
+
+        /** Transfers and returns the index of the type the variant holds. */
+        template <typename Archive, typename Variant>
+        unsigned int transferWhich(Archive& a, const Variant& value)
+        {
+            auto which = static_cast<uint8_t>(value.which());
+            a.field(which);
+            return which;
+        }
+
+        /**
+         * Returns the variant's value of type T.
+         * When reading, the variant may hold some other type,
+         * in which case it is first given the initial value.
+         */
+        template <typename T, typename Variant>
+        auto& getAlternative(Variant& variant, const T& initialValue)
+        {
+            if constexpr (!std::is_const_v<Variant>)
+            {
+                if (!boost::get<T>(&variant))
+                {
+                    variant = initialValue;
+                }
+            }
+            return *boost::get<T>(&variant);
+        }
+
+        /** Transfers a container of values that are transferred one at a time. */
+        template <typename Archive, typename Container, typename T>
+        void transferEach(Archive& a, Container& values, const T& initialValue)
+        {
+            auto size = a.count(values.size());
+            if constexpr (Archive::IsReading)
+            {
+                values.resize(size, initialValue);
+            }
+            for (auto& value : values)
+            {
+                a.field(value);
+            }
+        }
+
+        template <typename Archive, typename Target>
+        void transferAttackTarget(Archive& a, Target& target)
+        {
+            switch (transferWhich(a, target))
+            {
+                case 0:
+                    a.field(getAlternative(target, UnitId(0)));
+                    break;
+                case 1:
+                    a.field(getAlternative(target, Vector3f(0.0f, 0.0f, 0.0f)));
+                    break;
+                default:
+                    throwCorruptSnapshot();
+            }
+        }
+
+        template <typename Archive, typename Operation>
+        void transferMoveOperation(Archive& a, Operation& op)
+        {
+            if (transferPresence(a, op, [] { return UnitMesh::MoveOperation(0.0f, 0.0f); }))
+            {
+                a.field(op->targetPosition);
+                a.field(op->speed);
+            }
+        }
+
+        template <typename Archive, typename Operation>
+        void transferTurnOperation(Archive& a, Operation& op)
+        {
+            auto makeDefault = [] { return UnitMesh::TurnOperationUnion(UnitMesh::TurnOperation(RadiansAngle(0.0f), 0.0f)); };
+            if (!transferPresence(a, op, makeDefault))
+            {
+                return;
+            }
+
+            switch (transferWhich(a, *op))
+            {
+                case 0:
+                {
+                    auto& turn = getAlternative(*op, UnitMesh::TurnOperation(RadiansAngle(0.0f), 0.0f));
+                    a.field(turn.targetAngle);
+                    a.field(turn.speed);
+                    break;
+                }
+                case 1:
+                {
+                    auto& spin = getAlternative(*op, UnitMesh::SpinOperation(0.0f, 0.0f, 0.0f));
+                    a.field(spin.currentSpeed);
+                    a.field(spin.targetSpeed);
+                    a.field(spin.acceleration);
+                    break;
+                }
+                case 2:
+                {
+                    auto& stop = getAlternative(*op, UnitMesh::StopSpinOperation(0.0f, 0.0f));
+                    a.field(stop.currentSpeed);
+                    a.field(stop.deceleration);
+                    break;
+                }
+                default:
+                    throwCorruptSnapshot();
+            }
+        }
+
+        uint32_t countPieces(const UnitMesh& mesh)
+        {
+            uint32_t count = 1;
+            for (const auto& c : mesh.children)
+            {
+                count += countPieces(c);
+            }
+            return count;
+        }
+
+        /** Transfers the state of each piece, in depth-first order. */
+        template <typename Archive, typename Mesh>
+        void transferPieces(Archive& a, Mesh& mesh)
+        {
+            a.field(mesh.visible);
+            a.field(mesh.shaded);
+            a.field(mesh.offset);
+            a.field(mesh.rotation);
+            transferMoveOperation(a, mesh.xMoveOperation);
+            transferMoveOperation(a, mesh.yMoveOperation);
+            transferMoveOperation(a, mesh.zMoveOperation);
+            transferTurnOperation(a, mesh.xTurnOperation);
+            transferTurnOperation(a, mesh.yTurnOperation);
+            transferTurnOperation(a, mesh.zTurnOperation);
+
+            for (auto& c : mesh.children)
+            {
+                transferPieces(a, c);
+            }
+        }
+
+        uint32_t findThreadIndex(const CobEnvironment& env, const CobThread* thread)
+        {
+            for (std::size_t i = 0; i < env.threads.size(); ++i)
+            {
+                if (env.threads[i].get() == thread)
+                {
+                    return static_cast<uint32_t>(i);
+                }
+            }
+
+            return NoIndex;
+        }
+
+        /**
+         * Transfers a pointer to one of the environment's threads as its index.
+         * A pointer to a thread that has since been deleted becomes null.
+         */
+        template <typename Archive, typename Env, typename Thread>
+        void transferThreadReference(Archive& a, Env& env, Thread& thread)
+        {
+            uint32_t index = NoIndex;
+            if constexpr (!Archive::IsReading)
+            {
+                index = findThreadIndex(env, thread);
+            }
+
+            a.field(index);
+
+            if constexpr (Archive::IsReading)
+            {
+                if (index == NoIndex)
+                {
+                    thread = nullptr;
+                }
+                else if (index < env.threads.size())
+                {
+                    thread = env.threads[index].get();
+                }
+                else
+                {
+                    throwCorruptSnapshot();
+                }
+            }
+        }
+
+        /** Transfers a queue of threads, every one of which must belong to the environment. */
+        template <typename Archive, typename Env, typename Queue>
+        void transferThreadQueue(Archive& a, Env& env, Queue& queue)
+        {
+            auto size = a.count(queue.size());
+            if constexpr (Archive::IsReading)
+            {
+                queue.resize(size);
+            }
+            for (auto& thread : queue)
+            {
+                transferThreadReference(a, env, thread);
+                if (thread == nullptr)
+                {
+                    throwCorruptSnapshot();
+                }
+            }
+        }
+
+        template <typename Archive, typename Condition>
+        void transferBlockedCondition(Archive& a, Condition& condition)
+        {
+            using Status = CobEnvironment::BlockedStatus;
+            switch (transferWhich(a, condition))
+            {
+                case 0:
+                {
+                    auto& move = getAlternative(condition, Status::Move(0, Axis::X));
+                    a.field(move.object);
+                    transferEnum(a, move.axis);
+                    break;
+                }
+                case 1:
+                {
+                    auto& turn = getAlternative(condition, Status::Turn(0, Axis::X));
+                    a.field(turn.object);
+                    transferEnum(a, turn.axis);
+                    break;
+                }
+                case 2:
+                    a.field(getAlternative(condition, Status::Sleep(GameTime(0))).wakeUpTime);
+                    break;
+                default:
+                    throwCorruptSnapshot();
+            }
+        }
+
+        template <typename Archive, typename Thread>
+        void transferThread(Archive& a, Thread& thread)
+        {
+            a.field(thread.name);
+            a.field(thread.signalMask);
+            a.field(thread.returnValue);
+            transferEach(a, StackContainer<int>::get(thread.stack), 0);
+
+            auto& callStack = StackContainer<CobFunction>::get(thread.callStack);
+            auto callDepth = a.count(callStack.size());
+            if constexpr (Archive::IsReading)
+            {
+                callStack.resize(callDepth, CobFunction(0));
+            }
+            for (auto& function : callStack)
+            {
+                a.field(function.instructionIndex);
+                a.array(function.locals);
+                a.field(function.localCount);
+            }
+
+            a.array(thread.returnLocals);
+        }
+
+        template <typename Archive, typename Env>
+        void transferCobEnvironment(Archive& a, Env& env)
+        {
+            a.array(env._statics);
+
+            auto threadCount = a.count(env.threads.size());
+            if constexpr (Archive::IsReading)
+            {
+                env.threads.resize(threadCount);
+                for (auto& thread : env.threads)
+                {
+                    if (!thread)
+                    {
+                        thread = std::make_unique<CobThread>(std::string());
+                    }
+                }
+            }
+            for (const auto& thread : env.threads)
+            {
+                transferThread(a, *thread);
+            }
+
+            transferThreadQueue(a, env, env.readyQueue);
+
+            auto blockedCount = a.count(env.blockedQueue.size());
+            if constexpr (Archive::IsReading)
+            {
+                using Status = CobEnvironment::BlockedStatus;
+                env.blockedQueue.resize(blockedCount, std::pair<Status, CobThread*>(Status(Status::Sleep(GameTime(0))), nullptr));
+            }
+            for (auto& entry : env.blockedQueue)
+            {
+                transferBlockedCondition(a, entry.first.condition);
+                transferThreadReference(a, env, entry.second);
+                if (entry.second == nullptr)
+                {
+                    throwCorruptSnapshot();
+                }
+            }
+
+            transferThreadQueue(a, env, env.finishedQueue);
+        }
+
+        template <typename Archive, typename Orders>
+        void transferOrders(Archive& a, Orders& orders)
+        {
+            auto size = a.count(orders.size());
+            if constexpr (Archive::IsReading)
+            {
+                orders.resize(size, UnitOrder(MoveOrder(Vector3f(0.0f, 0.0f, 0.0f))));
+            }
+            for (auto& order : orders)
+            {
+                switch (transferWhich(a, order))
+                {
+                    case 0:
+                        a.field(getAlternative(order, MoveOrder(Vector3f(0.0f, 0.0f, 0.0f))).destination);
+                        break;
+                    case 1:
+                        transferAttackTarget(a, getAlternative(order, AttackOrder(UnitId(0))).target);
+                        break;
+                    default:
+                        throwCorruptSnapshot();
+                }
+            }
+        }
+
+        template <typename Archive, typename Path>
+        void transferPathFollowingInfo(Archive& a, Path& path)
+        {
+            auto& waypoints = path.path.waypoints;
+
+            uint32_t currentWaypoint = 0;
+            if constexpr (!Archive::IsReading)
+            {
+                currentWaypoint = static_cast<uint32_t>(path.currentWaypoint - waypoints.begin());
+            }
+
+            a.array(waypoints);
+            a.field(path.pathCreationTime);
+            a.field(currentWaypoint);
+
+            if constexpr (Archive::IsReading)
+            {
+                if (currentWaypoint > waypoints.size())
+                {
+                    throwCorruptSnapshot();
+                }
+                path.currentWaypoint = waypoints.cbegin() + currentWaypoint;
+            }
+        }
+
+        template <typename Archive, typename State>
+        void transferBehaviourState(Archive& a, State& state)
+        {
+            switch (transferWhich(a, state))
+            {
+                case 0:
+                    getAlternative(state, IdleState());
+                    break;
+                case 1:
+                {
+                    auto& moving = getAlternative(state, MovingState{Vector3f(0.0f, 0.0f, 0.0f), std::nullopt, false});
+                    switch (transferWhich(a, moving.destination))
+                    {
+                        case 0:
+                            a.field(getAlternative(moving.destination, Vector3f(0.0f, 0.0f, 0.0f)));
+                            break;
+                        case 1:
+                        {
+                            auto& rect = getAlternative(moving.destination, DiscreteRect(0, 0, 0, 0));
+                            a.field(rect.x);
+                            a.field(rect.y);
+                            a.field(rect.width);
+                            a.field(rect.height);
+                            break;
+                        }
+                        default:
+                            throwCorruptSnapshot();
+                    }
+
+                    a.field(moving.pathRequested);
+                    if (transferPresence(a, moving.path, [] { return PathFollowingInfo(UnitPath(), GameTime(0)); }))
+                    {
+                        transferPathFollowingInfo(a, *moving.path);
+                    }
+                    break;
+                }
+                default:
+                    throwCorruptSnapshot();
+            }
+        }
+
+        template <typename Archive, typename Env, typename Weapon>
+        void transferWeapon(Archive& a, Env& env, Weapon& weapon)
+        {
+            // Which weapons a unit has is fixed by its type.
+            bool present = weapon.has_value();
+            a.field(present);
+            if (present != weapon.has_value())
+            {
+                throwCorruptSnapshot();
+            }
+            if (!present)
+            {
+                return;
+            }
+
+            a.field(weapon->readyTime);
+
+            switch (transferWhich(a, weapon->state))
+            {
+                case 0:
+                    getAlternative(weapon->state, UnitWeaponStateIdle());
+                    break;
+                case 1:
+                {
+                    auto& attacking = getAlternative(weapon->state, UnitWeaponStateAttacking(UnitId(0)));
+                    transferAttackTarget(a, attacking.target);
+                    if (transferPresence(a, attacking.aimInfo, [] { return UnitWeaponStateAttacking::AimInfo{nullptr, 0.0f, 0.0f}; }))
+                    {
+                        transferThreadReference(a, env, attacking.aimInfo->thread);
+                        a.field(attacking.aimInfo->lastHeading);
+                        a.field(attacking.aimInfo->lastPitch);
+                    }
+                    break;
+                }
+                default:
+                    throwCorruptSnapshot();
+            }
+        }
+
+        /**
+         * Transfers the state of a unit that changes as the game runs.
+         * Everything else is fixed by the unit's type.
+         */
+        template <typename Archive, typename U>
+        void transferUnitState(Archive& a, U& unit)
+        {
+            a.field(unit.position);
+            a.field(unit.rotation);
+            a.field(unit.currentSpeed);
+            a.field(unit.targetAngle);
+            a.field(unit.targetSpeed);
+            a.field(unit.hitPoints);
+            a.field(unit.inCollision);
+
+            auto pieceCount = countPieces(unit.mesh);
+            a.field(pieceCount);
+            if (pieceCount != countPieces(unit.mesh))
+            {
+                throwCorruptSnapshot();
+            }
+            transferPieces(a, unit.mesh);
+
+            auto& env = *unit.cobEnvironment;
+            transferCobEnvironment(a, env);
+
+            transferOrders(a, unit.orders);
+            transferBehaviourState(a, unit.behaviourState);
+
+            for (auto& weapon : unit.weapons)
+            {
+                transferWeapon(a, env, weapon);
+            }
+            transferWeapon(a, env, unit.explosionWeapon);
+        }
+
+        template <typename Archive, typename Status>
+        void transferWinStatus(Archive& a, Status& status)
+        {
+            switch (transferWhich(a, status))
+            {
+                case 0:
+                    a.field(getAlternative(status, WinStatusWon{PlayerId(0)}).winner);
+                    break;
+                case 1:
+                    getAlternative(status, WinStatusDraw());
+                    break;
+                case 2:
+                    getAlternative(status, WinStatusUndecided());
+                    break;
+                default:
+                    throwCorruptSnapshot();
+            }
+        }
+
+        /** Transfers the parts of the simulation outside the occupied grid, units and projectiles. */
+        template <typename Archive, typename Simulation>
+        void transferGlobals(Archive& a, Simulation& simulation)
+        {
+            static_assert(std::is_trivially_copyable_v<std::mt19937>);
+
+            a.field(simulation.gameTime);
+            a.field(simulation.nextUnitId);
+            a.field(simulation.nextFeatureId);
+            a.bytes(&simulation.rng, sizeof(simulation.rng));
+            transferWinStatus(a, simulation.gameStatus);
+
+            auto playerCount = a.count(simulation.players.size());
+            if constexpr (Archive::IsReading)
+            {
+                simulation.players.resize(playerCount, GamePlayerInfo{0, GamePlayerStatus::Alive});
+            }
+            for (auto& player : simulation.players)
+            {
+                a.field(player.color);
+                transferEnum(a, player.status);
+            }
+        }
+
+        template <typename Archive, typename Simulation>
+        void transferEffects(Archive& a, Simulation& simulation)
+        {
+            auto explosionCount = a.count(simulation.explosions.size());
+            if constexpr (Archive::IsReading)
+            {
+                simulation.explosions.resize(explosionCount, Explosion{Vector3f(0.0f, 0.0f, 0.0f), nullptr, GameTime(0), false});
+            }
+            for (auto& explosion : simulation.explosions)
+            {
+                a.field(explosion.position);
+                a.animation(explosion.animation);
+                a.field(explosion.startTime);
+                a.field(explosion.floats);
+            }
+
+            auto requestCount = a.count(simulation.pathRequests.size());
+            if constexpr (Archive::IsReading)
+            {
+                simulation.pathRequests.resize(requestCount, PathRequest{UnitId(0)});
+            }
+            for (auto& request : simulation.pathRequests)
+            {
+                a.field(request.unitId);
+            }
+        }
+
+        struct OccupiedCell
+        {
+            uint8_t type;
+            uint32_t id;
+
+            bool operator==(const OccupiedCell& rhs) const { return type == rhs.type && id == rhs.id; }
+        };
+
+        OccupiedCell toOccupiedCell(const OccupiedType& value)
+        {
+            if (auto unit = boost::get<OccupiedUnit>(&value); unit)
+            {
+                return OccupiedCell{0, unit->id.value};
+            }
+            if (auto feature = boost::get<OccupiedFeature>(&value); feature)
+            {
+                return OccupiedCell{1, feature->id.value};
+            }
+            return OccupiedCell{2, 0};
+        }
+
+        OccupiedType fromOccupiedCell(const OccupiedCell& cell)
+        {
+            switch (cell.type)
+            {
+                case 0:
+                    return OccupiedUnit(UnitId(cell.id));
+                case 1:
+                    return OccupiedFeature(FeatureId(cell.id));
+                case 2:
+                    return OccupiedNone();
+                default:
+                    throwCorruptSnapshot();
+            }
+        }
+
+        /**
+         * Writes the occupied grid as runs of identical cells.
+         * Most of the map is empty or covered by large features,
+         * so this is far smaller than writing every cell.
+         */
+        void writeOccupiedGrid(SnapshotWriter& w, const OccupiedGrid& occupiedGrid)
+        {
+            const auto& grid = occupiedGrid.grid;
+            w.field(static_cast<uint32_t>(grid.getWidth()));
+            w.field(static_cast<uint32_t>(grid.getHeight()));
+
+            const auto* cells = grid.getData();
+            auto cellCount = grid.getWidth() * grid.getHeight();
+            std::size_t i = 0;
+            while (i < cellCount)
+            {
+                auto cell = toOccupiedCell(cells[i]);
+                auto runEnd = i + 1;
+                while (runEnd < cellCount && toOccupiedCell(cells[runEnd]) == cell)
+                {
+                    ++runEnd;
+                }
+
+                w.field(static_cast<uint32_t>(runEnd - i));
+                w.field(cell.type);
+                w.field(cell.id);
+                i = runEnd;
+            }
+        }
+
+        void readOccupiedGrid(SnapshotReader& r, OccupiedGrid& occupiedGrid)
+        {
+            auto& grid = occupiedGrid.grid;
+            uint32_t width;
+            uint32_t height;
+            r.field(width);
+            r.field(height);
+            if (width != grid.getWidth() || height != grid.getHeight())
+            {
+                throwCorruptSnapshot();
+            }
+
+            auto* cells = grid.getData();
+            std::size_t cellCount = width * height;
+            std::size_t i = 0;
+            while (i < cellCount)
+            {
+                uint32_t runLength;
+                OccupiedCell cell;
+                r.field(runLength);
+                r.field(cell.type);
+                r.field(cell.id);
+                if (runLength == 0 || runLength > cellCount - i)
+                {
+                    throwCorruptSnapshot();
+                }
+
+                std::fill(cells + i, cells + i + runLength, fromOccupiedCell(cell));
+                i += runLength;
+            }
+        }
+
+        void writeProjectiles(SnapshotWriter& w, const ProjectilePool& projectiles)
+        {
+            w.count(projectiles.size());
+            for (std::size_t i = 0; i < projectiles.size(); ++i)
+            {
+                w.field(projectiles.getOwner(i));
+                w.projectileDescriptor(projectiles.getSharedDescriptor(i));
+                w.field(projectiles.getOrigin(i));
+                w.field(projectiles.getPosition(i));
+                w.field(projectiles.getVelocity(i));
+                w.field(projectiles.getLastSmokeTime(i));
+            }
+        }
+
+        void readProjectiles(SnapshotReader& r, ProjectilePool& projectiles)
+        {
+            projectiles.clear();
+
+            auto count = r.count(0);
+            std::shared_ptr<const ProjectileDescriptor> descriptor;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                PlayerId owner(0);
+                Vector3f origin;
+                Vector3f position;
+                Vector3f velocity;
+                GameTime lastSmokeTime(0);
+                r.field(owner);
+                r.projectileDescriptor(descriptor);
+                r.field(origin);
+                r.field(position);
+                r.field(velocity);
+                r.field(lastSmokeTime);
+                if (!descriptor)
+                {
+                    throwCorruptSnapshot();
+                }
+
+                projectiles.add(owner, descriptor, origin, position, velocity, lastSmokeTime);
+            }
+        }
+
+        void writeUnits(SnapshotWriter& w, const std::map<UnitId, Unit>& units)
+        {
+            w.count(units.size());
+            for (const auto& entry : units)
+            {
+                w.field(entry.first);
+                w.field(entry.second.unitType);
+                w.field(entry.second.owner);
+                transferUnitState(w, entry.second);
+            }
+        }
+
+        /**
+         * Brings the units in line with the snapshot.
+         * Units are written in ID order, the same order as the map,
+         * so the two can be merged in a single pass.
+         * Units that still exist are updated in place,
+         * units that are not in the snapshot are removed
+         * and units that have died since are recreated.
+         */
+        void readUnits(SnapshotReader& r, std::map<UnitId, Unit>& units, const SnapshotUnitFactory& createUnit)
+        {
+            auto count = r.count(0);
+            auto it = units.begin();
+            std::string unitType;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                UnitId id(0);
+                PlayerId owner(0);
+                r.field(id);
+                r.field(unitType);
+                r.field(owner);
+
+                while (it != units.end() && it->first.value < id.value)
+                {
+                    it = units.erase(it);
+                }
+
+                if (it == units.end() || it->first != id || it->second.unitType != unitType || it->second.owner != owner)
+                {
+                    if (it != units.end() && it->first == id)
+                    {
+                        it = units.erase(it);
+                    }
+                    it = units.emplace_hint(it, id, createUnit(unitType, owner));
+                }
+
+                transferUnitState(r, it->second);
+                ++it;
+            }
+
+            units.erase(it, units.end());
+        }
+    }
+
+    void takeSimulationSnapshot(const GameSimulation& simulation, SimulationSnapshot& snapshot)
+    {
+        snapshot.time = simulation.gameTime;
+        snapshot.data.clear();
+        snapshot.projectileDescriptors.clear();
+        snapshot.animations.clear();
+
+        SnapshotWriter w(&snapshot);
+        transferGlobals(w, simulation);
+        writeOccupiedGrid(w, simulation.occupiedGrid);
+        writeUnits(w, simulation.units);
+        writeProjectiles(w, simulation.projectiles);
+        transferEffects(w, simulation);
+    }
+
+    void restoreSimulationSnapshot(GameSimulation& simulation, const SimulationSnapshot& snapshot, const SnapshotUnitFactory& createUnit)
+    {
+        SnapshotReader r(&snapshot);
+        transferGlobals(r, simulation);
+        readOccupiedGrid(r, simulation.occupiedGrid);
+        readUnits(r, simulation.units, createUnit);
+        readProjectiles(r, simulation.projectiles);
+        transferEffects(r, simulation);
+
+        if (!r.atEnd())
+        {
+            throwCorruptSnapshot();
+        }
+
+        simulation.updateUnitSelectionBounds();
+    }
+}
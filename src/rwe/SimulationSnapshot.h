@@ -0,0 +1,64 @@
+#ifndef RWE_SIMULATIONSNAPSHOT_H
+#define RWE_SIMULATIONSNAPSHOT_H
+
+#include <functional>
+#include <memory>
+#include <rwe/GameSimulation.h>
+#include <rwe/GameTime.h>
+#include <rwe/PlayerId.h>
+#include <rwe/ProjectileDescriptor.h>
+#include <rwe/SpriteSeries.h>
+#include <rwe/Unit.h>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * The changing state of a GameSimulation at one moment,
+     * packed into a single flat buffer.
+     *
+     * The terrain and features never change once a game has started,
+     * so they are left out and a snapshot can only be restored
+     * into a simulation of the game it was taken from.
+     * Projectile descriptors and explosion animations are shared with the running game,
+     * so the buffer refers to them by index into the tables alongside it
+     * and a snapshot is only meaningful within the process that took it.
+     *
+     * Snapshots are meant to be taken and restored often.
+     * Taking a snapshot into an existing one reuses its memory,
+     * and restoring updates units that still exist in place
+     * rather than creating them again.
+     */
+    struct SimulationSnapshot
+    {
+        GameTime time{0};
+
+        std::vector<char> data;
+
+        std::vector<std::shared_ptr<const ProjectileDescriptor>> projectileDescriptors;
+
+        std::vector<std::shared_ptr<SpriteSeries>> animations;
+
+        /** Returns the size of the buffer in bytes. */
+        std::size_t size() const;
+    };
+
+    /**
+     * Creates a unit of the given type for the given player, as the game would spawn it.
+     * Used to bring back units that have died since the snapshot was taken.
+     */
+    using SnapshotUnitFactory = std::function<Unit(const std::string& unitType, PlayerId owner)>;
+
+    /** Records the state of the simulation, replacing the previous contents of the snapshot. */
+    void takeSimulationSnapshot(const GameSimulation& simulation, SimulationSnapshot& snapshot);
+
+    /**
+     * Returns the simulation to the state recorded in the snapshot.
+     * Throws std::runtime_error if the snapshot does not fit the simulation,
+     * in which case the simulation is left in an unspecified state.
+     */
+    void restoreSimulationSnapshot(GameSimulation& simulation, const SimulationSnapshot& snapshot, const SnapshotUnitFactory& createUnit);
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef RWE_SIMULATIONSOUNDPLAYER_H
+#define RWE_SIMULATIONSOUNDPLAYER_H
+
+#include <rwe/SoundHandle.h>
+#include <rwe/UnitId.h>
+#include <rwe/math/Vector3f.h>
+
+namespace rwe
+{
+    /**
+     * Plays the sounds the simulation asks for.
+     * Implemented by whatever is presenting the game to the player.
+     */
+    class SimulationSoundPlayer
+    {
+    public:
+        virtual ~SimulationSoundPlayer() = default;
+        virtual void playSoundOnSelectChannel(const SoundHandle& sound) = 0;
+        virtual void playUnitSound(UnitId unitId, const SoundHandle& sound) = 0;
+        virtual void playSoundAt(const Vector3f& position, const SoundHandle& sound) = 0;
+    };
+}
+
+#endif
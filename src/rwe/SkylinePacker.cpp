@@ -0,0 +1,145 @@
+#include "SkylinePacker.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace rwe
+{
+    namespace
+    {
+        /** Returns the largest power of two that divides value, or 1 if value is 0. */
+        unsigned int getAlignment(unsigned int value)
+        {
+            return value == 0 ? 1 : value & (~value + 1);
+        }
+
+        unsigned int alignUp(unsigned int value, unsigned int alignment)
+        {
+            return ((value + alignment - 1) / alignment) * alignment;
+        }
+    }
+
+    SkylinePacker::SkylinePacker(unsigned int maxWidth) : maxWidth(maxWidth)
+    {
+        if (maxWidth == 0)
+        {
+            throw std::logic_error("Packing area must have a non-zero width");
+        }
+
+        skyline.push_back(Segment{0, 0, maxWidth});
+    }
+
+    SkylinePosition SkylinePacker::insert(unsigned int width, unsigned int height)
+    {
+        if (width > maxWidth)
+        {
+            throw std::logic_error("Rectangle is wider than the packing area");
+        }
+
+        auto alignmentX = getAlignment(width);
+        auto alignmentY = getAlignment(height);
+
+        auto bestIndex = skyline.size();
+        auto bestX = 0u;
+        auto bestY = 0u;
+        auto bestTop = std::numeric_limits<unsigned int>::max();
+
+        for (std::size_t i = 0; i < skyline.size(); ++i)
+        {
+            // Only the first aligned position within a segment need be tried,
+            // later ones cover the same segments and more besides.
+            auto x = alignUp(skyline[i].x, alignmentX);
+            if (x >= skyline[i].x + skyline[i].width)
+            {
+                continue;
+            }
+
+            if (x + width > maxWidth)
+            {
+                break;
+            }
+
+            auto y = alignUp(restingHeight(i, x, width), alignmentY);
+            if (y + height < bestTop)
+            {
+                bestIndex = i;
+                bestX = x;
+                bestY = y;
+                bestTop = y + height;
+            }
+        }
+
+        auto x = bestX;
+        auto right = x + width;
+
+        // split off the part of the segment left of the rectangle
+        if (skyline[bestIndex].x < x)
+        {
+            auto& segment = skyline[bestIndex];
+            Segment left{segment.x, segment.y, x - segment.x};
+            segment.width -= left.width;
+            segment.x = x;
+            skyline.insert(skyline.begin() + bestIndex, left);
+            ++bestIndex;
+        }
+
+        // Raise the skyline over the placed rectangle,
+        // trimming or removing the segments it now covers.
+        skyline.insert(skyline.begin() + bestIndex, Segment{x, bestTop, width});
+        auto it = skyline.begin() + bestIndex + 1;
+        while (it != skyline.end() && it->x < right)
+        {
+            auto segmentRight = it->x + it->width;
+            if (segmentRight <= right)
+            {
+                it = skyline.erase(it);
+                continue;
+            }
+
+            it->width = segmentRight - right;
+            it->x = right;
+            break;
+        }
+
+        // merge neighbours of equal height to keep the skyline short
+        for (std::size_t i = 1; i < skyline.size();)
+        {
+            if (skyline[i - 1].y == skyline[i].y)
+            {
+                skyline[i - 1].width += skyline[i].width;
+                skyline.erase(skyline.begin() + i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        usedWidth = std::max(usedWidth, right);
+        usedHeight = std::max(usedHeight, bestTop);
+
+        return SkylinePosition{x, bestY};
+    }
+
+    unsigned int SkylinePacker::getWidth() const
+    {
+        return usedWidth;
+    }
+
+    unsigned int SkylinePacker::getHeight() const
+    {
+        return usedHeight;
+    }
+
+    unsigned int SkylinePacker::restingHeight(std::size_t i, unsigned int x, unsigned int width) const
+    {
+        auto y = skyline[i].y;
+        auto right = x + width;
+        for (++i; i < skyline.size() && skyline[i].x < right; ++i)
+        {
+            y = std::max(y, skyline[i].y);
+        }
+
+        return y;
+    }
+}
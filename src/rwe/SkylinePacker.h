@@ -0,0 +1,70 @@
+#ifndef RWE_SKYLINEPACKER_H
+#define RWE_SKYLINEPACKER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace rwe
+{
+    struct SkylinePosition
+    {
+        unsigned int x;
+        unsigned int y;
+    };
+
+    /**
+     * Packs rectangles into an area of fixed width and unbounded height
+     * using the bottom-left skyline heuristic.
+     *
+     * Only the top edge of the packed region is tracked,
+     * so memory use is bounded by the width of the area rather than the number of items.
+     * Inputs should be sorted by decreasing height for good occupancy.
+     *
+     * Each rectangle is placed at an x that is a multiple of the largest power of two dividing its width,
+     * and likewise for y and its height.
+     * Rectangles whose sizes are powers of two are therefore aligned to their own size,
+     * so in an atlas packed from them the texels averaged into each mip level
+     * never come from more than one rectangle.
+     */
+    class SkylinePacker
+    {
+    private:
+        struct Segment
+        {
+            unsigned int x;
+            unsigned int y;
+            unsigned int width;
+        };
+
+        unsigned int maxWidth;
+        unsigned int usedWidth{0};
+        unsigned int usedHeight{0};
+
+        /** Horizontal segments of the skyline, sorted by x and covering the full width. */
+        std::vector<Segment> skyline;
+
+    public:
+        explicit SkylinePacker(unsigned int maxWidth);
+
+        /**
+         * Places a rectangle at the lowest available position, then leftmost.
+         * Throws if the rectangle is wider than the packing area.
+         */
+        SkylinePosition insert(unsigned int width, unsigned int height);
+
+        /** The rightmost extent of any placed rectangle. */
+        unsigned int getWidth() const;
+
+        /** The bottom extent of any placed rectangle. */
+        unsigned int getHeight() const;
+
+    private:
+        /**
+         * Returns the y position at which a rectangle of the given width would rest
+         * if placed at x, which lies within segment i.
+         */
+        unsigned int restingHeight(std::size_t i, unsigned int x, unsigned int width) const;
+    };
+}
+
+#endif
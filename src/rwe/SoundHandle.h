@@ -0,0 +1,20 @@
+#ifndef RWE_SOUNDHANDLE_H
+#define RWE_SOUNDHANDLE_H
+
+#include <memory>
+
+/** The SDL_mixer sample type, declared here so that holding a sound does not require SDL. */
+struct Mix_Chunk;
+
+namespace rwe
+{
+    using Sound = Mix_Chunk;
+
+    /**
+     * A loaded sound, as returned by AudioService.
+     * Game data such as units and weapons hold these without depending on the audio system.
+     */
+    using SoundHandle = std::shared_ptr<Sound>;
+}
+
+#endif
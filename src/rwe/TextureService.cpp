@@ -1,79 +1,171 @@
 #include "TextureService.h"
 #include <boost/interprocess/streams/bufferstream.hpp>
+#include <rwe/BoxTreeSplit.h>
 #include <rwe/Gaf.h>
+#include <rwe/Grid.h>
+#include <rwe/math/rwe_math.h>
 #include <rwe/pcx.h>
 #include <rwe/rwe_string.h>
 #include <rwe/tnt/TntArchive.h>
 
 namespace rwe
 {
-    class BufferGafAdapter : public GafReaderAdapter
+    namespace
     {
-    private:
-        GraphicsContext* graphics;
-        const ColorPalette* palette;
-        std::vector<Color> buffer;
-        GafFrameData currentFrameHeader;
+        class BufferGafAdapter : public GafReaderAdapter
+        {
+        public:
+            struct Frame
+            {
+                int posX;
+                int posY;
+                Grid<Color> image;
+            };
 
-        SpriteSeries spriteSeries;
+        private:
+            const ColorPalette* palette;
+            std::vector<Frame> frames;
+            GafFrameData currentFrameHeader;
 
-    public:
-        explicit BufferGafAdapter(GraphicsContext* graphics, const ColorPalette* palette) : graphics(graphics), palette(palette), currentFrameHeader() {}
+        public:
+            explicit BufferGafAdapter(const ColorPalette* palette) : palette(palette), currentFrameHeader() {}
 
-        void beginFrame(const GafFrameData& header) override
-        {
-            buffer.clear();
-            buffer.resize(header.width * header.height);
-            std::fill(buffer.begin(), buffer.end(), Color::Transparent);
-            currentFrameHeader = header;
-        }
+            void beginFrame(const GafFrameData& header) override
+            {
+                currentFrameHeader = header;
+                frames.push_back(Frame{header.posX, header.posY, Grid<Color>(header.width, header.height, Color::Transparent)});
+            }
 
-        void frameLayer(const LayerData& data) override
-        {
-            for (std::size_t y = 0; y < data.height; ++y)
+            void frameLayer(const LayerData& data) override
             {
-                for (std::size_t x = 0; x < data.width; ++x)
+                auto& image = frames.back().image;
+                for (std::size_t y = 0; y < data.height; ++y)
                 {
-                    auto outPosX = static_cast<int>(x) - (data.x - currentFrameHeader.posX);
-                    auto outPosY = static_cast<int>(y) - (data.y - currentFrameHeader.posY);
-
-                    if (outPosX < 0 || outPosX >= currentFrameHeader.width || outPosY < 0 || outPosY >= currentFrameHeader.height)
+                    for (std::size_t x = 0; x < data.width; ++x)
                     {
-                        throw std::runtime_error("frame coordinate out of bounds");
-                    }
+                        auto outPosX = static_cast<int>(x) - (data.x - currentFrameHeader.posX);
+                        auto outPosY = static_cast<int>(y) - (data.y - currentFrameHeader.posY);
 
-                    auto colorIndex = static_cast<unsigned char>(data.data[(y * data.width) + x]);
-                    if (colorIndex == data.transparencyKey)
-                    {
-                        continue;
-                    }
+                        if (outPosX < 0 || outPosX >= currentFrameHeader.width || outPosY < 0 || outPosY >= currentFrameHeader.height)
+                        {
+                            throw std::runtime_error("frame coordinate out of bounds");
+                        }
 
-                    buffer[(outPosY * currentFrameHeader.width) + outPosX] = (*palette)[colorIndex];
+                        auto colorIndex = static_cast<unsigned char>(data.data[(y * data.width) + x]);
+                        if (colorIndex == data.transparencyKey)
+                        {
+                            continue;
+                        }
+
+                        image.set(outPosX, outPosY, (*palette)[colorIndex]);
+                    }
                 }
             }
-        }
 
-        void endFrame() override
-        {
-            SharedTextureHandle handle(graphics->createTexture(currentFrameHeader.width, currentFrameHeader.height, buffer));
+            void endFrame() override
+            {
+            }
 
-            auto bounds = Rectangle2f::fromTopLeft(
-                -currentFrameHeader.posX,
-                -currentFrameHeader.posY,
-                currentFrameHeader.width,
-                currentFrameHeader.height);
+            std::vector<Frame>& getFrames()
+            {
+                return frames;
+            }
+        };
 
-            auto region = Rectangle2f::fromTopLeft(0.0f, 0.0f, 1.0f, 1.0f);
+        /** The frames of one GAF entry, decoded but not yet uploaded. */
+        struct DecodedGafEntry
+        {
+            std::string name;
+            std::vector<BufferGafAdapter::Frame> frames;
+        };
+
+        /**
+         * The most frame area, after padding, packed into one atlas texture.
+         * Entries beyond this go into another atlas,
+         * so that large GAF files do not make textures too big for the driver.
+         */
+        const std::size_t MaxAtlasArea = 1024 * 1024;
+
+        /**
+         * As in the mesh atlas, round each frame's area up to a power of two
+         * so that mipmapping does not bleed neighbouring frames into each other.
+         */
+        Size getPaddedSize(const Grid<Color>& image)
+        {
+            return Size(roundUpToPowerOfTwo(image.getWidth()), roundUpToPowerOfTwo(image.getHeight()));
+        }
 
-            auto sprite = std::make_shared<Sprite>(graphics->createSprite(bounds, region, handle));
-            spriteSeries.sprites.push_back(std::move(sprite));
+        std::size_t getPaddedArea(const DecodedGafEntry& entry)
+        {
+            std::size_t area = 0;
+            for (const auto& frame : entry.frames)
+            {
+                auto size = getPaddedSize(frame.image);
+                area += size.width * size.height;
+            }
+            return area;
         }
 
-        SpriteSeries extractSpriteSeries()
+        /**
+         * Uploads all frames of the entries in [begin, end) as a single texture
+         * and adds a sprite series for each entry, referencing regions of it.
+         */
+        void createSpriteSeries(
+            GraphicsContext* graphics,
+            const std::vector<DecodedGafEntry>& decoded,
+            std::size_t begin,
+            std::size_t end,
+            CaseInsensitiveMap<std::shared_ptr<SpriteSeries>>& entries)
         {
-            return std::move(spriteSeries);
+            std::vector<std::shared_ptr<SpriteSeries>> series;
+            std::vector<std::pair<std::size_t, std::size_t>> frameRefs;
+            for (auto i = begin; i < end; ++i)
+            {
+                auto entrySeries = std::make_shared<SpriteSeries>();
+                entrySeries->sprites.resize(decoded[i].frames.size());
+                entries.emplace(decoded[i].name, entrySeries);
+                series.push_back(std::move(entrySeries));
+
+                for (std::size_t j = 0; j < decoded[i].frames.size(); ++j)
+                {
+                    frameRefs.emplace_back(i - begin, j);
+                }
+            }
+
+            if (frameRefs.empty())
+            {
+                return;
+            }
+
+            auto getFrame = [&decoded, begin](const std::pair<std::size_t, std::size_t>& ref) -> const BufferGafAdapter::Frame& {
+                return decoded[begin + ref.first].frames[ref.second];
+            };
+
+            auto packInfo = packGridsGeneric<std::pair<std::size_t, std::size_t>>(frameRefs, [&getFrame](const auto& ref) {
+                return getPaddedSize(getFrame(ref).image);
+            });
+
+            Grid<Color> atlas(packInfo.width, packInfo.height, Color::Transparent);
+            for (const auto& e : packInfo.entries)
+            {
+                atlas.replaceArea(e.x, e.y, getFrame(e.value).image);
+            }
+
+            SharedTextureHandle handle(graphics->createTexture(atlas));
+
+            for (const auto& e : packInfo.entries)
+            {
+                const auto& frame = getFrame(e.value);
+                auto bounds = Rectangle2f::fromTopLeft(-frame.posX, -frame.posY, frame.image.getWidth(), frame.image.getHeight());
+                auto region = Rectangle2f::fromTopLeft(
+                    static_cast<float>(e.x) / static_cast<float>(packInfo.width),
+                    static_cast<float>(e.y) / static_cast<float>(packInfo.height),
+                    static_cast<float>(frame.image.getWidth()) / static_cast<float>(packInfo.width),
+                    static_cast<float>(frame.image.getHeight()) / static_cast<float>(packInfo.height));
+                series[e.value.first]->sprites[e.value.second] = std::make_shared<Sprite>(graphics->createSprite(bounds, region, handle));
+            }
         }
-    };
+    }
 
     TextureService::TextureService(GraphicsContext* graphics, AbstractVirtualFileSystem* fileSystem, const ColorPalette* palette)
         : graphics(graphics), fileSystem(fileSystem), palette(palette)
@@ -91,35 +183,65 @@ namespace rwe
 
     std::optional<std::shared_ptr<SpriteSeries>> TextureService::getGafEntryInternal(const std::string& gafName, const std::string& entryName)
     {
-        auto normEntryName = toUpper(entryName);
+        const auto& entries = getGafEntries(gafName);
+        auto it = entries.find(entryName);
+        if (it == entries.end())
+        {
+            return std::nullopt;
+        }
+
+        return it->second;
+    }
 
-        auto key = gafName + "/" + normEntryName;
-        auto it = animCache.find(key);
+    const CaseInsensitiveMap<std::shared_ptr<SpriteSeries>>& TextureService::getGafEntries(const std::string& gafName)
+    {
+        auto it = animCache.find(gafName);
         if (it != animCache.end())
         {
             return it->second;
         }
 
+        auto& entries = animCache[gafName];
+
         auto gafBytes = fileSystem->readFile(gafName);
         if (!gafBytes)
         {
-            return std::nullopt;
+            return entries;
         }
 
-        boost::interprocess::bufferstream gafStream(gafBytes->data(), gafBytes->size());
-        GafArchive gafArchive(&gafStream);
+        std::vector<DecodedGafEntry> decoded;
+        {
+            boost::interprocess::bufferstream stream(gafBytes->data(), gafBytes->size());
+            GafArchive archive(&stream);
+            decoded.reserve(archive.entries().size());
+            for (const auto& entry : archive.entries())
+            {
+                BufferGafAdapter adapter(palette);
+                archive.extract(entry, adapter);
+                decoded.push_back(DecodedGafEntry{entry.name, std::move(adapter.getFrames())});
+            }
+        }
+
+        // Everything is decoded, so free the file before the atlases are built.
+        gafBytes = std::nullopt;
 
-        auto gafEntry = gafArchive.findEntry(normEntryName);
-        if (!gafEntry)
+        // Pack whole entries into atlases, starting a new one when the current one is full.
+        std::size_t begin = 0;
+        std::size_t area = 0;
+        for (std::size_t i = 0; i < decoded.size(); ++i)
         {
-            return std::nullopt;
+            auto entryArea = getPaddedArea(decoded[i]);
+            if (i > begin && area + entryArea > MaxAtlasArea)
+            {
+                createSpriteSeries(graphics, decoded, begin, i, entries);
+                begin = i;
+                area = 0;
+            }
+            area += entryArea;
         }
+        createSpriteSeries(graphics, decoded, begin, decoded.size(), entries);
 
-        BufferGafAdapter adapter(graphics, palette);
-        gafArchive.extract(*gafEntry, adapter);
-        auto ptr = std::make_shared<SpriteSeries>(adapter.extractSpriteSeries());
-        animCache[key] = ptr;
-        return ptr;
+        return entries;
     }
 
     std::optional<std::shared_ptr<SpriteSeries>>
@@ -239,15 +361,26 @@ namespace rwe
         TntArchive tnt(&tntStream);
         auto minimap = tnt.readMinimap();
 
+        return getMinimap(mapName, minimap.width, minimap.height, minimap.data);
+    }
+
+    std::shared_ptr<Sprite> TextureService::getMinimap(const std::string& mapName, unsigned int width, unsigned int height, const std::vector<char>& paletteIndices)
+    {
+        auto it = minimapCache.find(mapName);
+        if (it != minimapCache.end())
+        {
+            return it->second;
+        }
+
         std::vector<Color> rgbMinimap;
-        std::transform(minimap.data.begin(), minimap.data.end(), std::back_inserter(rgbMinimap), [p = palette](unsigned char pixel) {
+        std::transform(paletteIndices.begin(), paletteIndices.end(), std::back_inserter(rgbMinimap), [p = palette](unsigned char pixel) {
             assert(pixel >= 0 && pixel <= 255);
             return (*p)[pixel];
         });
 
-        SharedTextureHandle texture(graphics->createTexture(minimap.width, minimap.height, rgbMinimap));
+        SharedTextureHandle texture(graphics->createTexture(width, height, rgbMinimap));
         auto sprite = graphics->createSprite(
-            Rectangle2f::fromTopLeft(0.0f, 0.0f, minimap.width, minimap.height),
+            Rectangle2f::fromTopLeft(0.0f, 0.0f, width, height),
             Rectangle2f::fromTopLeft(0.0f, 0.0f, 1.0f, 1.0f),
             texture);
         auto spritePtr = std::make_shared<Sprite>(std::move(sprite));
@@ -3,16 +3,18 @@
 
 #include <memory>
 #include <optional>
+#include <rwe/AbstractTextureService.h>
 #include <rwe/ColorPalette.h>
 #include <rwe/GraphicsContext.h>
 #include <rwe/SpriteSeries.h>
 #include <rwe/TextureHandle.h>
+#include <rwe/rwe_string.h>
 #include <rwe/vfs/AbstractVirtualFileSystem.h>
 #include <unordered_map>
 
 namespace rwe
 {
-    class TextureService
+    class TextureService : public AbstractTextureService
     {
     private:
         struct TextureInfo
@@ -31,25 +33,39 @@ namespace rwe
 
         std::shared_ptr<SpriteSeries> defaultSpriteSeries;
 
-        std::unordered_map<std::string, std::shared_ptr<SpriteSeries>> animCache;
-        std::unordered_map<std::string, TextureInfo> bitmapCache;
-        std::unordered_map<std::string, std::shared_ptr<Sprite>> minimapCache;
+        /**
+         * GAF name -> entry name -> sprites.
+         * The first lookup in a GAF file decodes every entry in it
+         * and packs their frames into shared atlas textures,
+         * after which the file itself is not kept.
+         * A file that does not exist has no entries.
+         */
+        CaseInsensitiveMap<CaseInsensitiveMap<std::shared_ptr<SpriteSeries>>> animCache;
+        CaseInsensitiveMap<TextureInfo> bitmapCache;
+        CaseInsensitiveMap<std::shared_ptr<Sprite>> minimapCache;
 
     public:
         TextureService(GraphicsContext* graphics, AbstractVirtualFileSystem* filesystem, const ColorPalette* palette);
 
-        std::optional<std::shared_ptr<SpriteSeries>> tryGetGafEntry(const std::string& gafName, const std::string& entryName);
-        std::shared_ptr<SpriteSeries> getGafEntry(const std::string& gafName, const std::string& entryName);
+        std::optional<std::shared_ptr<SpriteSeries>> tryGetGafEntry(const std::string& gafName, const std::string& entryName) override;
+        std::shared_ptr<SpriteSeries> getGafEntry(const std::string& gafName, const std::string& entryName) override;
         std::optional<std::shared_ptr<SpriteSeries>> getGuiTexture(const std::string& guiName, const std::string& graphicName);
         SharedTextureHandle getBitmap(const std::string& bitmapName);
         std::shared_ptr<Sprite> getBitmapRegion(const std::string& bitmapName, int x, int y, int width, int height);
         SharedTextureHandle getDefaultTexture();
-        std::shared_ptr<SpriteSeries> getDefaultSpriteSeries();
+        std::shared_ptr<SpriteSeries> getDefaultSpriteSeries() override;
         std::shared_ptr<Sprite> getDefaultSprite();
         std::shared_ptr<Sprite> getMinimap(const std::string& mapName);
 
+        /**
+         * Returns the map's minimap as getMinimap does,
+         * but if it is not cached creates it from the given palette indices instead of reading the map's TNT.
+         */
+        std::shared_ptr<Sprite> getMinimap(const std::string& mapName, unsigned int width, unsigned int height, const std::vector<char>& paletteIndices);
+
     private:
         std::optional<std::shared_ptr<SpriteSeries>> getGafEntryInternal(const std::string& gafName, const std::string& entryName);
+        const CaseInsensitiveMap<std::shared_ptr<SpriteSeries>>& getGafEntries(const std::string& gafName);
         TextureInfo getBitmapInternal(const std::string& bitmapName);
     };
 }
@@ -0,0 +1,67 @@
+#include "ThreadPool.h"
+
+namespace rwe
+{
+    ThreadPool::ThreadPool(unsigned int threadCount)
+    {
+        if (threadCount == 0)
+        {
+            throw std::logic_error("Thread pool must have at least one thread");
+        }
+
+        workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    unsigned int ThreadPool::threadCount() const
+    {
+        return static_cast<unsigned int>(workers.size());
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                {
+                    // stopping and nothing left to do
+                    return;
+                }
+
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+
+            task();
+        }
+    }
+
+    unsigned int defaultThreadCount()
+    {
+        // hardware_concurrency may return 0 if the value is not computable
+        auto count = std::thread::hardware_concurrency();
+        return count == 0 ? 1 : count;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef RWE_THREADPOOL_H
+#define RWE_THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * A fixed-size pool of worker threads that run submitted tasks in FIFO order.
+     *
+     * Tasks must not touch anything that is only safe on the main thread,
+     * such as OpenGL or SDL audio. Do the CPU-bound work (file reads, parsing, decoding)
+     * in the task and hand the result back to the main thread through the returned future.
+     */
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping{false};
+
+    public:
+        explicit ThreadPool(unsigned int threadCount);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** Finishes all queued tasks, then joins the worker threads. */
+        ~ThreadPool();
+
+        unsigned int threadCount() const;
+
+        /**
+         * Queues a task to run on a worker thread.
+         * Any exception thrown by the task is rethrown by the future's get().
+         */
+        template <typename F>
+        std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& f)
+        {
+            using R = std::invoke_result_t<std::decay_t<F>>;
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+            auto future = task->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.emplace([task]() { (*task)(); });
+            }
+            condition.notify_one();
+
+            return future;
+        }
+
+    private:
+        void workerLoop();
+    };
+
+    /** Returns the number of worker threads to use by default for this machine. */
+    unsigned int defaultThreadCount();
+}
+
+#endif
@@ -3,32 +3,52 @@
 
 namespace rwe
 {
+    template <typename Value, typename Deleter>
+    class SharedHandle;
+
+    /**
+     * Owns a resource identified by a value, freeing it with Deleter when the handle is destroyed.
+     *
+     * The deleter is captured when the handle takes ownership of a value,
+     * rather than called directly on destruction.
+     * Code that only moves and destroys handles, such as the simulation,
+     * therefore never refers to the deleter and does not need to link the library it calls.
+     */
     template <typename T, typename Deleter>
     class UniqueHandle
     {
     public:
         using Type = UniqueHandle<T, Deleter>;
 
+        using DeleteFunction = void (*)(T);
+
     private:
         T value;
+        DeleteFunction deleteFunction{nullptr};
+
+        template <typename, typename>
+        friend class SharedHandle;
 
     public:
         UniqueHandle() = default;
-        explicit UniqueHandle(T value) : value(value)
+        explicit UniqueHandle(T value) : value(value), deleteFunction(&deleteValue)
         {
         }
 
         UniqueHandle(const Type&) = delete;
         Type& operator=(const Type&) = delete;
 
-        UniqueHandle(Type&& that) noexcept : value(that.release())
+        UniqueHandle(Type&& that) noexcept : value(that.value), deleteFunction(that.deleteFunction)
         {
+            that.release();
         }
 
         Type& operator=(Type&& that) noexcept
         {
             destroy();
-            value = that.release();
+            value = that.value;
+            deleteFunction = that.deleteFunction;
+            that.release();
             return *this;
         }
 
@@ -48,6 +68,7 @@ namespace rwe
         {
             destroy();
             value = newValue;
+            deleteFunction = &deleteValue;
         }
 
         /** Resets the handle to the default value. */
@@ -55,6 +76,7 @@ namespace rwe
         {
             destroy();
             value = T();
+            deleteFunction = nullptr;
         }
 
         /** Releases the underlying resource from the responsibility of the handle. */
@@ -62,14 +84,23 @@ namespace rwe
         {
             T tmp = value;
             value = T();
+            deleteFunction = nullptr;
             return tmp;
         }
 
     private:
-        void destroy()
+        static void deleteValue(T value)
         {
             Deleter()(value);
         }
+
+        void destroy()
+        {
+            if (deleteFunction != nullptr)
+            {
+                deleteFunction(value);
+            }
+        }
     };
 }
 
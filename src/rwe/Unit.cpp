@@ -1,5 +1,5 @@
 #include "Unit.h"
-#include <rwe/GameScene.h>
+#include <algorithm>
 #include <rwe/geometry/Plane3f.h>
 #include <rwe/math/rwe_math.h>
 
@@ -34,8 +34,8 @@ namespace rwe
         return Matrix4f::rotationY(rotation) * Vector3f(0.0f, 0.0f, 1.0f);
     }
 
-    Unit::Unit(const UnitMesh& mesh, std::unique_ptr<CobEnvironment>&& cobEnvironment, SelectionMesh&& selectionMesh)
-        : mesh(mesh), cobEnvironment(std::move(cobEnvironment)), selectionMesh(std::move(selectionMesh))
+    Unit::Unit(const UnitMesh& mesh, std::unique_ptr<CobEnvironment>&& cobEnvironment, const std::shared_ptr<SelectionMesh>& selectionMesh)
+        : mesh(mesh), cobEnvironment(std::move(cobEnvironment)), selectionMesh(selectionMesh)
     {
     }
 
@@ -256,13 +256,19 @@ namespace rwe
     {
         auto line = ray.toLine();
         Line3f modelSpaceLine(line.start - position, line.end - position);
-        auto v = selectionMesh.collisionMesh.intersectLine(modelSpaceLine);
+        auto v = selectionMesh->collisionMesh.intersectLine(modelSpaceLine);
         if (!v)
         {
             return std::nullopt;
         }
 
-        return ray.origin.distance(*v);
+        return ray.origin.distance(*v + position);
+    }
+
+    BoundingBox3f Unit::getSelectionBounds() const
+    {
+        const auto& bounds = selectionMesh->bounds;
+        return BoundingBox3f(bounds.center + position, bounds.extents);
     }
 
     bool Unit::isOwnedBy(PlayerId playerId) const
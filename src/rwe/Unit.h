@@ -5,11 +5,11 @@
 #include <deque>
 #include <memory>
 #include <optional>
-#include <rwe/AudioService.h>
 #include <rwe/DiscreteRect.h>
 #include <rwe/MovementClassId.h>
 #include <rwe/PlayerId.h>
 #include <rwe/SelectionMesh.h>
+#include <rwe/SoundHandle.h>
 #include <rwe/UnitMesh.h>
 #include <rwe/UnitWeapon.h>
 #include <rwe/cob/CobEnvironment.h>
@@ -73,10 +73,10 @@ namespace rwe
         UnitMesh mesh;
         Vector3f position;
         std::unique_ptr<CobEnvironment> cobEnvironment;
-        SelectionMesh selectionMesh;
-        std::optional<AudioService::SoundHandle> selectionSound;
-        std::optional<AudioService::SoundHandle> okSound;
-        std::optional<AudioService::SoundHandle> arrivedSound;
+        std::shared_ptr<SelectionMesh> selectionMesh;
+        std::optional<SoundHandle> selectionSound;
+        std::optional<SoundHandle> okSound;
+        std::optional<SoundHandle> arrivedSound;
         PlayerId owner;
 
         /**
@@ -125,12 +125,12 @@ namespace rwe
 
         std::optional<MovementClassId> movementClass;
 
-        unsigned int footprintX;
-        unsigned int footprintZ;
-        unsigned int maxSlope;
-        unsigned int maxWaterSlope;
-        unsigned int minWaterDepth;
-        unsigned int maxWaterDepth;
+        unsigned int footprintX{0};
+        unsigned int footprintZ{0};
+        unsigned int maxSlope{0};
+        unsigned int maxWaterSlope{0};
+        unsigned int minWaterDepth{0};
+        unsigned int maxWaterDepth{0};
 
         /** If true, the unit is considered a commander for victory conditions. */
         bool commander;
@@ -138,6 +138,12 @@ namespace rwe
         unsigned int hitPoints;
         unsigned int maxHitPoints;
 
+        /** Distance the unit can see over terrain, in world units. */
+        float sightDistance;
+
+        /** Radius of the unit's radar coverage, in world units. */
+        float radarDistance;
+
         std::deque<UnitOrder> orders;
         UnitState behaviourState;
 
@@ -157,7 +163,7 @@ namespace rwe
 
         static Vector3f toDirection(float rotation);
 
-        Unit(const UnitMesh& mesh, std::unique_ptr<CobEnvironment>&& cobEnvironment, SelectionMesh&& selectionMesh);
+        Unit(const UnitMesh& mesh, std::unique_ptr<CobEnvironment>&& cobEnvironment, const std::shared_ptr<SelectionMesh>& selectionMesh);
 
         bool isCommander() const;
 
@@ -185,6 +191,9 @@ namespace rwe
          */
         std::optional<float> selectionIntersect(const Ray3f& ray) const;
 
+        /** Returns the world-space bounds of the unit's selection mesh. */
+        BoundingBox3f getSelectionBounds() const;
+
         bool isOwnedBy(PlayerId playerId) const;
 
         bool isDead() const;
@@ -1,5 +1,5 @@
 #include "UnitBehaviorService.h"
-#include <rwe/GameScene.h>
+#include <rwe/GameSimulationDriver.h>
 #include <rwe/cob/CobExecutionContext.h>
 #include <rwe/geometry/Circle2f.h>
 #include <rwe/math/rwe_math.h>
@@ -24,8 +24,8 @@ namespace rwe
         return anticlockwiseCircle.contains(Vector2f(dest.x, dest.z)) || clockwiseCircle.contains(Vector2f(dest.x, dest.z));
     }
 
-    UnitBehaviorService::UnitBehaviorService(GameScene* scene, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService)
-        : scene(scene), pathFindingService(pathFindingService), collisionService(collisionService)
+    UnitBehaviorService::UnitBehaviorService(GameSimulationDriver* driver, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService)
+        : driver(driver), pathFindingService(pathFindingService), collisionService(collisionService)
     {
     }
 
@@ -48,22 +48,22 @@ namespace rwe
     class AttackTargetToMovingStateGoalVisitor : public boost::static_visitor<MovingStateGoal>
     {
     private:
-        const GameScene* scene;
+        const GameSimulationDriver* driver;
 
     public:
-        explicit AttackTargetToMovingStateGoalVisitor(const GameScene* scene) : scene(scene) {}
+        explicit AttackTargetToMovingStateGoalVisitor(const GameSimulationDriver* driver) : driver(driver) {}
 
         MovingStateGoal operator()(const Vector3f& target) const { return target; }
         MovingStateGoal operator()(UnitId unitId) const
         {
-            const auto& targetUnit = scene->getSimulation().getUnit(unitId);
-            return scene->computeFootprintRegion(targetUnit.position, targetUnit.footprintX, targetUnit.footprintZ);
+            const auto& targetUnit = driver->getSimulation().getUnit(unitId);
+            return driver->computeFootprintRegion(targetUnit.position, targetUnit.footprintX, targetUnit.footprintZ);
         }
     };
 
     void UnitBehaviorService::update(UnitId unitId)
     {
-        auto& unit = scene->getSimulation().getUnit(unitId);
+        auto& unit = driver->getSimulation().getUnit(unitId);
 
         float previousSpeed = unit.currentSpeed;
 
@@ -82,7 +82,7 @@ namespace rwe
                 if (auto idleState = boost::get<IdleState>(&unit.behaviourState); idleState != nullptr)
                 {
                     // request a path to follow
-                    scene->getSimulation().requestPath(unitId);
+                    driver->getSimulation().requestPath(unitId);
                     const auto& destination = moveOrder->destination;
                     unit.behaviourState = MovingState{destination, std::nullopt, true};
                 }
@@ -91,7 +91,7 @@ namespace rwe
                     // if we are colliding, request a new path
                     if (unit.inCollision && !movingState->pathRequested)
                     {
-                        auto& sim = scene->getSimulation();
+                        auto& sim = driver->getSimulation();
 
                         // only request a new path if we don't have one yet,
                         // or we've already had our current one for a bit
@@ -115,7 +115,7 @@ namespace rwe
 
                             if (unit.arrivedSound)
                             {
-                                scene->playSoundOnSelectChannel(*unit.arrivedSound);
+                                driver->playSoundOnSelectChannel(*unit.arrivedSound);
                             }
                         }
                     }
@@ -212,7 +212,7 @@ namespace rwe
 
     void UnitBehaviorService::updateWeapon(UnitId id, unsigned int weaponIndex)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = driver->getSimulation().getUnit(id);
         auto& weapon = unit.weapons[weaponIndex];
         if (!weapon)
         {
@@ -224,7 +224,7 @@ namespace rwe
             // attempt to acquire a target
             if (!weapon->commandFire)
             {
-                for (const auto& entry : scene->getSimulation().units)
+                for (const auto& entry : driver->getSimulation().units)
                 {
                     auto otherUnitId = entry.first;
                     const auto& otherUnit = entry.second;
@@ -307,7 +307,7 @@ namespace rwe
 
     void UnitBehaviorService::tryFireWeapon(UnitId id, unsigned int weaponIndex, const Vector3f& targetPosition)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = driver->getSimulation().getUnit(id);
         auto& weapon = unit.weapons[weaponIndex];
 
         if (!weapon)
@@ -316,7 +316,7 @@ namespace rwe
         }
 
         // wait for the weapon to reload
-        auto gameTime = scene->getGameTime();
+        auto gameTime = driver->getGameTime();
         if (gameTime < weapon->readyTime)
         {
             return;
@@ -327,13 +327,13 @@ namespace rwe
         auto targetVector = targetPosition - firingPoint;
         if (weapon->startSmoke)
         {
-            scene->createLightSmoke(firingPoint);
+            driver->createLightSmoke(firingPoint);
         }
-        scene->getSimulation().spawnLaser(unit.owner, *weapon, firingPoint, targetVector.normalized());
+        driver->getSimulation().spawnLaser(unit.owner, *weapon, firingPoint, targetVector.normalized());
 
         if (weapon->soundStart)
         {
-            scene->playUnitSound(id, *weapon->soundStart);
+            driver->playUnitSound(id, *weapon->soundStart);
         }
         unit.cobEnvironment->createThread(getFireScriptName(weaponIndex));
 
@@ -349,7 +349,7 @@ namespace rwe
 
     void UnitBehaviorService::updateUnitRotation(UnitId id)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = driver->getSimulation().getUnit(id);
 
         auto angleDelta = wrap(-Pif, Pif, unit.targetAngle - unit.rotation);
 
@@ -366,7 +366,7 @@ namespace rwe
 
     void UnitBehaviorService::updateUnitSpeed(UnitId id)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = driver->getSimulation().getUnit(id);
 
         if (unit.targetSpeed > unit.currentSpeed)
         {
@@ -394,7 +394,7 @@ namespace rwe
         }
 
         auto effectiveMaxSpeed = unit.maxSpeed;
-        if (unit.position.y < scene->getTerrain().getSeaLevel())
+        if (unit.position.y < driver->getTerrain().getSeaLevel())
         {
             effectiveMaxSpeed /= 2.0f;
         }
@@ -403,7 +403,7 @@ namespace rwe
 
     void UnitBehaviorService::updateUnitPosition(UnitId unitId)
     {
-        auto& unit = scene->getSimulation().getUnit(unitId);
+        auto& unit = driver->getSimulation().getUnit(unitId);
 
         auto direction = Unit::toDirection(unit.rotation);
 
@@ -412,7 +412,7 @@ namespace rwe
         if (unit.currentSpeed > 0.0f)
         {
             auto newPosition = unit.position + (direction * unit.currentSpeed);
-            newPosition.y = scene->getTerrain().getHeightAt(newPosition.x, newPosition.z);
+            newPosition.y = driver->getTerrain().getHeightAt(newPosition.x, newPosition.z);
 
             if (!tryApplyMovementToPosition(unitId, newPosition))
             {
@@ -435,8 +435,8 @@ namespace rwe
                     newPos1 = unit.position + (direction * maskX * unit.currentSpeed);
                     newPos2 = unit.position + (direction * maskZ * unit.currentSpeed);
                 }
-                newPos1.y = scene->getTerrain().getHeightAt(newPos1.x, newPos1.z);
-                newPos2.y = scene->getTerrain().getHeightAt(newPos2.x, newPos2.z);
+                newPos1.y = driver->getTerrain().getHeightAt(newPos1.x, newPos1.z);
+                newPos2.y = driver->getTerrain().getHeightAt(newPos2.x, newPos2.z);
 
                 if (!tryApplyMovementToPosition(unitId, newPos1))
                 {
@@ -448,11 +448,11 @@ namespace rwe
 
     bool UnitBehaviorService::tryApplyMovementToPosition(UnitId id, const Vector3f& newPosition)
     {
-        auto& sim = scene->getSimulation();
+        auto& sim = driver->getSimulation();
         auto& unit = sim.getUnit(id);
 
         // check for collision at the new position
-        auto newFootprintRegion = scene->computeFootprintRegion(newPosition, unit.footprintX, unit.footprintZ);
+        auto newFootprintRegion = driver->computeFootprintRegion(newPosition, unit.footprintX, unit.footprintZ);
 
         // Unlike for pathfinding, TA doesn't care about the unit's actual movement class for collision checks,
         // it only cares about the attributes defined directly on the unit.
@@ -470,14 +470,14 @@ namespace rwe
             return false;
         }
 
-        if (scene->isCollisionAt(newFootprintRegion, id))
+        if (driver->isCollisionAt(newFootprintRegion, id))
         {
             return false;
         }
 
         // we passed all collision checks, update accordingly
-        auto footprintRegion = scene->computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
-        scene->moveUnitOccupiedArea(footprintRegion, newFootprintRegion, id);
+        auto footprintRegion = driver->computeFootprintRegion(unit.position, unit.footprintX, unit.footprintZ);
+        driver->moveUnitOccupiedArea(footprintRegion, newFootprintRegion, id);
         unit.position = newPosition;
         return true;
     }
@@ -544,13 +544,13 @@ namespace rwe
 
     std::optional<int> UnitBehaviorService::runCobQuery(UnitId id, const std::string& name)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = driver->getSimulation().getUnit(id);
         auto thread = unit.cobEnvironment->createNonScheduledThread(name, {0});
         if (!thread)
         {
             return std::nullopt;
         }
-        CobExecutionContext context(&scene->getSimulation(), unit.cobEnvironment.get(), &*thread, id);
+        CobExecutionContext context(&driver->getSimulation(), unit.cobEnvironment.get(), &*thread, id);
         auto status = context.execute();
         if (boost::get<CobEnvironment::FinishedStatus>(&status) == nullptr)
         {
@@ -580,7 +580,7 @@ namespace rwe
         auto pieceId = runCobQuery(id, scriptName);
         if (!pieceId)
         {
-            return scene->getSimulation().getUnit(id).position;
+            return driver->getSimulation().getUnit(id).position;
         }
 
         return getPiecePosition(id, *pieceId);
@@ -591,7 +591,7 @@ namespace rwe
         auto pieceId = runCobQuery(id, "SweetSpot");
         if (!pieceId)
         {
-            return scene->getSimulation().getUnit(id).position;
+            return driver->getSimulation().getUnit(id).position;
         }
 
         return getPiecePosition(id, *pieceId);
@@ -599,7 +599,7 @@ namespace rwe
 
     std::optional<Vector3f> UnitBehaviorService::tryGetSweetSpot(UnitId id)
     {
-        if (!scene->getSimulation().unitExists(id))
+        if (!driver->getSimulation().unitExists(id))
         {
             return std::nullopt;
         }
@@ -609,7 +609,7 @@ namespace rwe
 
     bool UnitBehaviorService::handleAttackOrder(UnitId unitId, const AttackOrder& attackOrder)
     {
-        auto& unit = scene->getSimulation().getUnit(unitId);
+        auto& unit = driver->getSimulation().getUnit(unitId);
 
         if (!unit.weapons[0])
         {
@@ -632,8 +632,8 @@ namespace rwe
                 if (unit.position.distanceSquared(*targetPosition) > maxRangeSquared)
                 {
                     // request a path to follow
-                    scene->getSimulation().requestPath(unitId);
-                    auto destination = boost::apply_visitor(AttackTargetToMovingStateGoalVisitor(scene), attackOrder.target);
+                    driver->getSimulation().requestPath(unitId);
+                    auto destination = boost::apply_visitor(AttackTargetToMovingStateGoalVisitor(driver), attackOrder.target);
                     unit.behaviourState = MovingState{destination, std::nullopt, true};
                 }
                 else
@@ -658,7 +658,7 @@ namespace rwe
                     // if we are colliding, request a new path
                     if (unit.inCollision && !movingState->pathRequested)
                     {
-                        auto& sim = scene->getSimulation();
+                        auto& sim = driver->getSimulation();
 
                         // only request a new path if we don't have one yet,
                         // or we've already had our current one for a bit
@@ -689,7 +689,7 @@ namespace rwe
 
     Vector3f UnitBehaviorService::getPiecePosition(UnitId id, unsigned int pieceId)
     {
-        auto& unit = scene->getSimulation().getUnit(id);
+        auto& unit = driver->getSimulation().getUnit(id);
 
         const auto& pieceName = unit.cobEnvironment->_script->pieces.at(pieceId);
         auto pieceTransform = unit.mesh.getPieceTransform(pieceName);
@@ -7,17 +7,17 @@
 
 namespace rwe
 {
-    class GameScene;
+    class GameSimulationDriver;
 
     class UnitBehaviorService
     {
     private:
-        GameScene* scene;
+        GameSimulationDriver* driver;
         PathFindingService* pathFindingService;
         MovementClassCollisionService* collisionService;
 
     public:
-        UnitBehaviorService(GameScene* scene, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService);
+        UnitBehaviorService(GameSimulationDriver* driver, PathFindingService* pathFindingService, MovementClassCollisionService* collisionService);
 
         void update(UnitId unitId);
 
@@ -1,44 +1,224 @@
 #include "UnitDatabase.h"
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <rwe/gui.h>
 #include <rwe/rwe_string.h>
+#include <rwe/tdf.h>
 
 namespace rwe
 {
+    namespace
+    {
+        template <typename T>
+        std::shared_future<T> makeReadyFuture(T&& value)
+        {
+            std::promise<T> promise;
+            promise.set_value(std::move(value));
+            return promise.get_future().share();
+        }
+
+        TdfBlock readTdfFile(const AbstractVirtualFileSystem& vfs, const std::string& path)
+        {
+            auto bytes = vfs.readFile(path);
+            if (!bytes)
+            {
+                throw std::runtime_error("Failed to read " + path);
+            }
+
+            return parseTdfFromString(std::string_view(bytes->data(), bytes->size()));
+        }
+    }
+
+    std::vector<std::pair<std::string, SoundClass>> loadSoundClasses(const AbstractVirtualFileSystem& vfs)
+    {
+        return parseSoundTdf(readTdfFile(vfs, "gamedata/SOUND.TDF"));
+    }
+
+    std::vector<std::pair<std::string, MovementClass>> loadMovementClasses(const AbstractVirtualFileSystem& vfs)
+    {
+        return parseMovementTdf(readTdfFile(vfs, "gamedata/MOVEINFO.TDF"));
+    }
+
+    std::vector<std::pair<std::string, WeaponTdf>> loadWeaponTdf(const AbstractVirtualFileSystem& vfs, const std::string& path)
+    {
+        return parseWeaponTdf(readTdfFile(vfs, path));
+    }
+
+    UnitFbi loadUnitFbi(const AbstractVirtualFileSystem& vfs, const std::string& path)
+    {
+        return parseUnitFbi(readTdfFile(vfs, path));
+    }
+
+    CobScript loadUnitScript(const AbstractVirtualFileSystem& vfs, const std::string& path)
+    {
+        auto bytes = vfs.readFile(path);
+        if (!bytes)
+        {
+            throw std::runtime_error("Failed to read " + path);
+        }
+
+        boost::interprocess::bufferstream s(bytes->data(), bytes->size());
+        return parseCob(s);
+    }
+
+    std::vector<std::string> loadBuildMenuButtonNames(const AbstractVirtualFileSystem& vfs, const std::string& unitName)
+    {
+        std::vector<std::string> names;
+        for (int menu = 1;; ++menu)
+        {
+            auto bytes = vfs.readFile("guis/" + unitName + std::to_string(menu) + ".gui");
+            if (!bytes)
+            {
+                break;
+            }
+
+            auto tdf = parseTdfFromString(std::string_view(bytes->data(), bytes->size()));
+            for (int i = 0;; ++i)
+            {
+                auto gadget = tdf.findBlock("GADGET" + std::to_string(i));
+                if (!gadget)
+                {
+                    break;
+                }
+
+                auto common = gadget->get().findBlock("COMMON");
+                if (!common || common->get().extractInt("id") != static_cast<int>(GuiElementType::Button))
+                {
+                    continue;
+                }
+
+                auto name = common->get().findValue("name");
+                if (name)
+                {
+                    names.push_back(*name);
+                }
+            }
+        }
+
+        return names;
+    }
+
+    UnitDatabase::UnitDatabase(const AbstractVirtualFileSystem* vfs, ThreadPool* threadPool)
+        : vfs(vfs), threadPool(threadPool)
+    {
+    }
+
+    template <typename T>
+    const T& UnitDatabase::getLazyValue(LazyEntry<T>& entry) const
+    {
+        if (!entry.value.valid())
+        {
+            // not prefetched, so load it right here
+            entry.value = makeReadyFuture(entry.load());
+        }
+
+        // Waits for the background load if a prefetch is still in flight.
+        // The shared state lives as long as the entry,
+        // so the reference stays valid.
+        return entry.value.get();
+    }
+
+    template <typename T>
+    void UnitDatabase::prefetchLazyValue(LazyEntry<T>& entry)
+    {
+        if (entry.value.valid())
+        {
+            return;
+        }
+
+        entry.value = threadPool->submit(entry.load).share();
+    }
 
     const UnitFbi& UnitDatabase::getUnitInfo(const std::string& unitName) const
     {
-        auto it = map.find(toUpper(unitName));
+        auto it = map.find(unitName);
         if (it == map.end())
         {
             throw std::runtime_error("No FBI data found for unit " + unitName);
         }
 
-        return it->second;
+        return getLazyValue(it->second);
     }
 
     void UnitDatabase::addUnitInfo(const std::string& unitName, const UnitFbi& info)
     {
-        map.insert({toUpper(unitName), info});
+        map.insert({unitName, LazyEntry<UnitFbi>{std::function<UnitFbi()>(), makeReadyFuture(UnitFbi(info))}});
+    }
+
+    void UnitDatabase::addLazyUnitInfo(const std::string& unitName, const std::string& fbiPath)
+    {
+        addLazyUnitInfo(unitName, [vfs = vfs, fbiPath]() { return loadUnitFbi(*vfs, fbiPath); });
+    }
+
+    void UnitDatabase::addLazyUnitInfo(const std::string& unitName, std::function<UnitFbi()>&& load)
+    {
+        map.insert({unitName, LazyEntry<UnitFbi>{std::move(load), std::shared_future<UnitFbi>()}});
     }
 
     const CobScript& UnitDatabase::getUnitScript(const std::string& unitName) const
     {
-        auto it = cobMap.find(toUpper(unitName));
+        auto it = cobMap.find(unitName);
         if (it == cobMap.end())
         {
             throw std::runtime_error("No script data found for unit " + unitName);
         }
 
-        return it->second;
+        return getLazyValue(it->second);
     }
 
     void UnitDatabase::addUnitScript(const std::string& unitName, CobScript&& cob)
     {
-        cobMap.insert({toUpper(unitName), std::move(cob)});
+        cobMap.insert({unitName, LazyEntry<CobScript>{std::function<CobScript()>(), makeReadyFuture(std::move(cob))}});
+    }
+
+    void UnitDatabase::addLazyUnitScript(const std::string& unitName, const std::string& cobPath)
+    {
+        addLazyUnitScript(unitName, [vfs = vfs, cobPath]() { return loadUnitScript(*vfs, cobPath); });
+    }
+
+    void UnitDatabase::addLazyUnitScript(const std::string& unitName, std::function<CobScript()>&& load)
+    {
+        cobMap.insert({unitName, LazyEntry<CobScript>{std::move(load), std::shared_future<CobScript>()}});
+    }
+
+    void UnitDatabase::prefetchUnit(const std::string& unitName)
+    {
+        auto fbiIt = map.find(unitName);
+        if (fbiIt != map.end())
+        {
+            prefetchLazyValue(fbiIt->second);
+        }
+
+        auto cobIt = cobMap.find(unitName);
+        if (cobIt != cobMap.end())
+        {
+            prefetchLazyValue(cobIt->second);
+        }
+    }
+
+    void UnitDatabase::prefetchBuildOptions(const std::string& unitName)
+    {
+        std::vector<std::string> names;
+        try
+        {
+            names = loadBuildMenuButtonNames(*vfs, unitName);
+        }
+        catch (const std::runtime_error&)
+        {
+            // Prefetching is only an optimization,
+            // so a broken menu just means its units load on first use.
+            return;
+        }
+
+        for (const auto& name : names)
+        {
+            // Buttons that are not units, like the menu paging buttons, are not in the map.
+            prefetchUnit(name);
+        }
     }
 
     const WeaponTdf& UnitDatabase::getWeapon(const std::string& weaponName) const
     {
-        auto it = weaponMap.find(toUpper(weaponName));
+        auto it = weaponMap.find(weaponName);
         if (it == weaponMap.end())
         {
             throw std::runtime_error("No weapon found with name " + weaponName);
@@ -49,7 +229,7 @@ namespace rwe
 
     void UnitDatabase::addWeapon(const std::string& weaponName, WeaponTdf&& weapon)
     {
-        weaponMap.insert({toUpper(weaponName), std::move(weapon)});
+        weaponMap.insert({weaponName, std::move(weapon)});
     }
 
     const SoundClass& UnitDatabase::getSoundClass(const std::string& className) const
@@ -68,7 +248,7 @@ namespace rwe
         soundClassMap.insert({className, std::move(soundClass)});
     }
 
-    const AudioService::SoundHandle& UnitDatabase::getSoundHandle(const std::string sound) const
+    const SoundHandle& UnitDatabase::getSoundHandle(const std::string sound) const
     {
         auto it = soundMap.find(sound);
         if (it == soundMap.end())
@@ -79,7 +259,18 @@ namespace rwe
         return it->second;
     }
 
-    void UnitDatabase::addSound(const std::string& soundName, const AudioService::SoundHandle& sound)
+    std::optional<SoundHandle> UnitDatabase::tryGetSoundHandle(const std::string& sound) const
+    {
+        auto it = soundMap.find(sound);
+        if (it == soundMap.end())
+        {
+            return std::nullopt;
+        }
+
+        return it->second;
+    }
+
+    void UnitDatabase::addSound(const std::string& soundName, const SoundHandle& sound)
     {
         soundMap.insert({soundName, sound});
     }
@@ -1,42 +1,109 @@
 #ifndef RWE_UNITDATABASE_H
 #define RWE_UNITDATABASE_H
 
-#include <rwe/AudioService.h>
+#include <functional>
+#include <future>
 #include <rwe/Cob.h>
 #include <rwe/MovementClass.h>
 #include <rwe/SoundClass.h>
+#include <rwe/SoundHandle.h>
+#include <rwe/ThreadPool.h>
 #include <rwe/UnitFbi.h>
 #include <rwe/WeaponTdf.h>
+#include <rwe/rwe_string.h>
+#include <rwe/vfs/AbstractVirtualFileSystem.h>
 
 namespace rwe
 {
+    /**
+     * Holds the definitions of all units, weapons, movement classes and sounds
+     * available to a game.
+     *
+     * Unit FBIs and scripts may be registered lazily,
+     * by path or by a function that produces them.
+     * A lazy entry is loaded the first time it is looked up,
+     * or earlier in the background if it was prefetched.
+     *
+     * The database itself must only be used from one thread.
+     * Background loads run on the thread pool
+     * and only touch the VFS, never the database.
+     */
     class UnitDatabase
     {
     public:
-        using MovementClassIterator = typename std::unordered_map<std::string, MovementClass>::const_iterator;
+        using MovementClassIterator = typename CaseInsensitiveMap<MovementClass>::const_iterator;
 
     private:
-        std::unordered_map<std::string, UnitFbi> map;
+        template <typename T>
+        struct LazyEntry
+        {
+            /** Loads the value. Runs on the thread pool when prefetched. */
+            std::function<T()> load;
 
-        std::unordered_map<std::string, CobScript> cobMap;
+            /** Invalid until a load of the entry has been started. */
+            std::shared_future<T> value;
+        };
 
-        std::unordered_map<std::string, WeaponTdf> weaponMap;
+        const AbstractVirtualFileSystem* vfs;
 
-        std::unordered_map<std::string, SoundClass> soundClassMap;
+        ThreadPool* threadPool;
 
-        std::unordered_map<std::string, MovementClass> movementClassMap;
+        // Lookups are logically const, but may start a lazy load.
+        mutable CaseInsensitiveMap<LazyEntry<UnitFbi>> map;
 
-        std::unordered_map<std::string, AudioService::SoundHandle> soundMap;
+        mutable CaseInsensitiveMap<LazyEntry<CobScript>> cobMap;
+
+        CaseInsensitiveMap<WeaponTdf> weaponMap;
+
+        CaseInsensitiveMap<SoundClass> soundClassMap;
+
+        CaseInsensitiveMap<MovementClass> movementClassMap;
+
+        CaseInsensitiveMap<SoundHandle> soundMap;
 
     public:
+        UnitDatabase(const AbstractVirtualFileSystem* vfs, ThreadPool* threadPool);
+
         const UnitFbi& getUnitInfo(const std::string& unitName) const;
 
         void addUnitInfo(const std::string& unitName, const UnitFbi& info);
 
+        /** Registers an FBI file that will be parsed on first use. */
+        void addLazyUnitInfo(const std::string& unitName, const std::string& fbiPath);
+
+        /**
+         * Registers a unit whose FBI is produced by the given function on first use.
+         * The function may be called from a thread pool thread.
+         */
+        void addLazyUnitInfo(const std::string& unitName, std::function<UnitFbi()>&& load);
+
         const CobScript& getUnitScript(const std::string& unitName) const;
 
         void addUnitScript(const std::string& unitName, CobScript&& cob);
 
+        /** Registers a COB file that will be parsed on first use. */
+        void addLazyUnitScript(const std::string& unitName, const std::string& cobPath);
+
+        /**
+         * Registers a unit whose script is produced by the given function on first use.
+         * The function may be called from a thread pool thread.
+         */
+        void addLazyUnitScript(const std::string& unitName, std::function<CobScript()>&& load);
+
+        /**
+         * Starts loading the FBI and script of the given unit in the background,
+         * if they are lazy and not already loaded.
+         * Does nothing for unknown units.
+         */
+        void prefetchUnit(const std::string& unitName);
+
+        /**
+         * Prefetches every unit on the given unit's build menus.
+         * The menus themselves are read right away, on the calling thread.
+         * Menus that cannot be read or parsed are skipped.
+         */
+        void prefetchBuildOptions(const std::string& unitName);
+
         const WeaponTdf& getWeapon(const std::string& weaponName) const;
 
         void addWeapon(const std::string& name, WeaponTdf&& weapon);
@@ -49,14 +116,45 @@ namespace rwe
 
         void addMovementClass(const std::string& className, MovementClass&& movementClass);
 
-        const AudioService::SoundHandle& getSoundHandle(const std::string sound) const;
+        const SoundHandle& getSoundHandle(const std::string sound) const;
+
+        /**
+         * Returns the named sound, or nothing if it was never added,
+         * as happens when the sound failed to load or sounds are not loaded at all.
+         */
+        std::optional<SoundHandle> tryGetSoundHandle(const std::string& sound) const;
 
-        void addSound(const std::string& soundName, const AudioService::SoundHandle& sound);
+        void addSound(const std::string& soundName, const SoundHandle& sound);
 
         MovementClassIterator movementClassBegin() const;
 
         MovementClassIterator movementClassEnd() const;
+
+    private:
+        template <typename T>
+        const T& getLazyValue(LazyEntry<T>& entry) const;
+
+        template <typename T>
+        void prefetchLazyValue(LazyEntry<T>& entry);
     };
+
+    std::vector<std::pair<std::string, SoundClass>> loadSoundClasses(const AbstractVirtualFileSystem& vfs);
+
+    std::vector<std::pair<std::string, MovementClass>> loadMovementClasses(const AbstractVirtualFileSystem& vfs);
+
+    std::vector<std::pair<std::string, WeaponTdf>> loadWeaponTdf(const AbstractVirtualFileSystem& vfs, const std::string& path);
+
+    UnitFbi loadUnitFbi(const AbstractVirtualFileSystem& vfs, const std::string& path);
+
+    CobScript loadUnitScript(const AbstractVirtualFileSystem& vfs, const std::string& path);
+
+    /**
+     * Returns the names of the buttons on the unit's build menus,
+     * guis/<unit>1.gui, guis/<unit>2.gui and so on up to the first one missing.
+     * Besides the units it can build, these include the menus' own buttons,
+     * such as those that page between menus.
+     */
+    std::vector<std::string> loadBuildMenuButtonNames(const AbstractVirtualFileSystem& vfs, const std::string& unitName);
 }
 
 #endif
@@ -0,0 +1,182 @@
+#include "UnitDatabaseLoader.h"
+
+#include <spdlog/spdlog.h>
+
+namespace rwe
+{
+    UnitDatabaseLoader::UnitDatabaseLoader(
+        AbstractVirtualFileSystem* vfs,
+        AbstractAudioService* audioService,
+        ThreadPool* threadPool,
+        const CompiledUnitDatabaseInfo* compiledUnitDatabaseInfo)
+        : vfs(vfs),
+          audioService(audioService),
+          threadPool(threadPool),
+          compiledUnitDatabaseInfo(compiledUnitDatabaseInfo)
+    {
+    }
+
+    UnitDatabase UnitDatabaseLoader::createUnitDatabase()
+    {
+        if (compiledUnitDatabaseInfo != nullptr)
+        {
+            try
+            {
+                auto compiled = readCompiledUnitDatabase(compiledUnitDatabaseInfo->path, compiledUnitDatabaseInfo->dataFingerprint);
+                if (compiled)
+                {
+                    return createUnitDatabase(std::move(*compiled));
+                }
+            }
+            catch (const CompiledUnitDatabaseException& e)
+            {
+                // The compiled database is only an optimization,
+                // so a corrupt one just means parsing the game data instead.
+                if (auto logger = spdlog::get("rwe"))
+                {
+                    logger->warn("Ignoring corrupt compiled unit database {0}: {1}", compiledUnitDatabaseInfo->path, e.what());
+                }
+            }
+        }
+
+        // Every file is read and parsed independently on the thread pool.
+        // Results are merged into the database here, on the main thread,
+        // in listing order, so the outcome does not depend on how tasks were scheduled.
+        // Sounds are also loaded here because the audio service is not thread-safe.
+        auto soundsFuture = threadPool->submit([vfs = vfs]() { return loadSoundClasses(*vfs); });
+
+        auto movementClassesFuture = threadPool->submit([vfs = vfs]() { return loadMovementClasses(*vfs); });
+
+        std::vector<std::future<std::vector<std::pair<std::string, WeaponTdf>>>> weaponFutures;
+        for (const auto& fileName : vfs->getFileNames("weapons", ".tdf"))
+        {
+            weaponFutures.push_back(threadPool->submit([vfs = vfs, fileName]() { return loadWeaponTdf(*vfs, "weapons/" + fileName); }));
+        }
+
+        UnitDatabase db(vfs, threadPool);
+
+        // read sound categories
+        for (auto& s : soundsFuture.get())
+        {
+            addSoundClass(db, s.first, std::move(s.second));
+        }
+
+        // read movement classes
+        for (auto& c : movementClassesFuture.get())
+        {
+            auto name = c.second.name;
+            db.addMovementClass(name, std::move(c.second));
+        }
+
+        // read weapons
+        for (auto& future : weaponFutures)
+        {
+            for (auto& pair : future.get())
+            {
+                addWeapon(db, pair.first, std::move(pair.second));
+            }
+        }
+
+        // Unit FBIs and scripts are only indexed here.
+        // They are parsed when the unit is first created, or earlier if prefetched.
+        // FBIs are indexed by file name, which by convention matches the unit name.
+        for (const auto& fbiName : vfs->getFileNames("units", ".fbi"))
+        {
+            auto unitName = fbiName.substr(0, fbiName.size() - 4);
+            db.addLazyUnitInfo(unitName, "units/" + fbiName);
+        }
+
+        for (const auto& scriptName : vfs->getFileNames("scripts", ".cob"))
+        {
+            auto scriptNameWithoutExtension = scriptName.substr(0, scriptName.size() - 4);
+            db.addLazyUnitScript(scriptNameWithoutExtension, "scripts/" + scriptName);
+        }
+
+        return db;
+    }
+
+    UnitDatabase UnitDatabaseLoader::createUnitDatabase(MappedCompiledUnitDatabase&& compiled)
+    {
+        // Units and scripts are still decoded on demand, but from the compiled file.
+        UnitDatabase db(vfs, threadPool);
+
+        for (auto& s : compiled.soundClasses)
+        {
+            addSoundClass(db, s.first, std::move(s.second));
+        }
+
+        for (auto& c : compiled.movementClasses)
+        {
+            auto name = c.second.name;
+            db.addMovementClass(name, std::move(c.second));
+        }
+
+        for (auto& w : compiled.weapons)
+        {
+            addWeapon(db, w.first, std::move(w.second));
+        }
+
+        for (auto& u : compiled.units)
+        {
+            db.addLazyUnitInfo(u.first, std::move(u.second));
+        }
+
+        for (auto& s : compiled.scripts)
+        {
+            db.addLazyUnitScript(s.first, std::move(s.second));
+        }
+
+        return db;
+    }
+
+    void UnitDatabaseLoader::addSoundClass(UnitDatabase& db, const std::string& className, SoundClass&& c)
+    {
+        preloadSound(db, c.select1);
+        preloadSound(db, c.ok1);
+        preloadSound(db, c.arrived1);
+        preloadSound(db, c.cant1);
+        preloadSound(db, c.underAttack);
+        preloadSound(db, c.count5);
+        preloadSound(db, c.count4);
+        preloadSound(db, c.count3);
+        preloadSound(db, c.count2);
+        preloadSound(db, c.count1);
+        preloadSound(db, c.count0);
+        preloadSound(db, c.cancelDestruct);
+        db.addSoundClass(className, std::move(c));
+    }
+
+    void UnitDatabaseLoader::addWeapon(UnitDatabase& db, const std::string& weaponName, WeaponTdf&& weapon)
+    {
+        preloadSound(db, weapon.soundStart);
+        preloadSound(db, weapon.soundHit);
+        preloadSound(db, weapon.soundWater);
+        db.addWeapon(weaponName, std::move(weapon));
+    }
+
+    void UnitDatabaseLoader::preloadSound(UnitDatabase& db, const std::optional<std::string>& soundName)
+    {
+        if (!soundName)
+        {
+            return;
+        }
+
+        preloadSound(db, *soundName);
+    }
+
+    void UnitDatabaseLoader::preloadSound(UnitDatabase& db, const std::string& soundName)
+    {
+        if (audioService == nullptr)
+        {
+            return;
+        }
+
+        auto sound = audioService->loadSound(soundName);
+        if (!sound)
+        {
+            return; // sometimes sound categories name invalid sounds
+        }
+
+        db.addSound(soundName, *sound);
+    }
+}
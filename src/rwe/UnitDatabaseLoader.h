@@ -0,0 +1,58 @@
+#ifndef RWE_UNITDATABASELOADER_H
+#define RWE_UNITDATABASELOADER_H
+
+#include <optional>
+#include <rwe/AbstractAudioService.h>
+#include <rwe/CompiledUnitDatabase.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/UnitDatabase.h>
+#include <rwe/vfs/AbstractVirtualFileSystem.h>
+#include <string>
+
+namespace rwe
+{
+    /**
+     * Builds the unit database for a game,
+     * from the compiled unit database if it is up to date
+     * or else from the files in the VFS.
+     *
+     * Units are keyed by the name of their FBI file rather than
+     * the UnitName inside it, so that FBIs need not be parsed up front.
+     * The two match in the game data, by convention.
+     */
+    class UnitDatabaseLoader
+    {
+    private:
+        AbstractVirtualFileSystem* vfs;
+
+        /** May be null, in which case no sounds are loaded. */
+        AbstractAudioService* audioService;
+
+        ThreadPool* threadPool;
+
+        /** May be null, in which case unit data is always parsed from the VFS. */
+        const CompiledUnitDatabaseInfo* compiledUnitDatabaseInfo;
+
+    public:
+        UnitDatabaseLoader(
+            AbstractVirtualFileSystem* vfs,
+            AbstractAudioService* audioService,
+            ThreadPool* threadPool,
+            const CompiledUnitDatabaseInfo* compiledUnitDatabaseInfo);
+
+        UnitDatabase createUnitDatabase();
+
+    private:
+        UnitDatabase createUnitDatabase(MappedCompiledUnitDatabase&& compiled);
+
+        void addSoundClass(UnitDatabase& db, const std::string& className, SoundClass&& soundClass);
+
+        void addWeapon(UnitDatabase& db, const std::string& weaponName, WeaponTdf&& weapon);
+
+        void preloadSound(UnitDatabase& db, const std::string& soundName);
+
+        void preloadSound(UnitDatabase& db, const std::optional<std::string>& soundName);
+    };
+}
+
+#endif
@@ -4,7 +4,7 @@
 namespace rwe
 {
     UnitFactory::UnitFactory(
-        TextureService* textureService,
+        AbstractTextureService* textureService,
         UnitDatabase&& unitDatabase,
         MeshService&& meshService,
         MovementClassCollisionService* collisionService,
@@ -52,7 +52,7 @@ namespace rwe
         const auto& script = unitDatabase.getUnitScript(fbi.unitName);
         auto cobEnv = std::make_unique<CobEnvironment>(&script);
         cobEnv->createThread("Create", std::vector<int>());
-        Unit unit(meshInfo.mesh, std::move(cobEnv), std::move(meshInfo.selectionMesh));
+        Unit unit(meshInfo.mesh, std::move(cobEnv), meshInfo.selectionMesh);
         unit.unitType = toUpper(unitType);
         unit.owner = owner;
         unit.position = position;
@@ -79,6 +79,9 @@ namespace rwe
         unit.maxHitPoints = fbi.maxDamage;
         unit.hitPoints = fbi.maxDamage;
 
+        unit.sightDistance = fbi.sightDistance;
+        unit.radarDistance = fbi.radarDistance;
+
         if (movementClassOption)
         {
             auto movementClass = &movementClassOption->get();
@@ -129,15 +132,15 @@ namespace rwe
 
         if (soundClass.select1)
         {
-            unit.selectionSound = unitDatabase.getSoundHandle(*(soundClass.select1));
+            unit.selectionSound = unitDatabase.tryGetSoundHandle(*(soundClass.select1));
         }
         if (soundClass.ok1)
         {
-            unit.okSound = unitDatabase.getSoundHandle(*(soundClass.ok1));
+            unit.okSound = unitDatabase.tryGetSoundHandle(*(soundClass.ok1));
         }
         if (soundClass.arrived1)
         {
-            unit.arrivedSound = unitDatabase.getSoundHandle(*(soundClass.arrived1));
+            unit.arrivedSound = unitDatabase.tryGetSoundHandle(*(soundClass.arrived1));
         }
 
         return unit;
@@ -152,46 +155,67 @@ namespace rwe
         weapon.reloadTime = tdf.reloadTime;
         weapon.tolerance = toleranceToRadians(tdf.tolerance);
         weapon.pitchTolerance = toleranceToRadians(tdf.pitchTolerance);
-        weapon.velocity = static_cast<float>(tdf.weaponVelocity) / 60.0f;
-        weapon.duration = tdf.duration * 60.0f * 2.0f; // duration seems to match better if doubled
-        weapon.color = getLaserColor(tdf.color);
-        weapon.color2 = getLaserColor(tdf.color2);
         weapon.commandFire = tdf.commandFire;
         weapon.startSmoke = tdf.startSmoke;
-        weapon.endSmoke = tdf.endSmoke;
-        if (tdf.smokeTrail)
+        if (!tdf.soundStart.empty())
         {
-            weapon.smokeTrail = GameTimeDelta(static_cast<unsigned int>(tdf.smokeDelay * 60.0f));
+            weapon.soundStart = unitDatabase.tryGetSoundHandle(tdf.soundStart);
         }
-        if (!tdf.soundStart.empty())
+
+        weapon.projectile = getProjectileDescriptor(weaponType);
+
+        return weapon;
+    }
+
+    std::shared_ptr<const ProjectileDescriptor> UnitFactory::getProjectileDescriptor(const std::string& weaponType)
+    {
+        auto it = projectileDescriptors.find(weaponType);
+        if (it != projectileDescriptors.end())
         {
-            weapon.soundStart = unitDatabase.getSoundHandle(tdf.soundStart);
+            return it->second;
         }
-        if (!tdf.soundHit.empty())
+
+        const auto& tdf = unitDatabase.getWeapon(weaponType);
+        auto projectile = std::make_shared<ProjectileDescriptor>();
+
+        projectile->velocity = static_cast<float>(tdf.weaponVelocity) / 60.0f;
+        projectile->duration = tdf.duration * 60.0f * 2.0f; // duration seems to match better if doubled
+        projectile->color = getLaserColor(tdf.color);
+        projectile->color2 = getLaserColor(tdf.color2);
+        projectile->endSmoke = tdf.endSmoke;
+        if (tdf.smokeTrail)
         {
-            weapon.soundHit = unitDatabase.getSoundHandle(tdf.soundHit);
+            projectile->smokeTrail = GameTimeDelta(static_cast<unsigned int>(tdf.smokeDelay * 60.0f));
         }
-        if (!tdf.soundWater.empty())
+        if (!tdf.soundHit.empty())
         {
-            weapon.soundWater = unitDatabase.getSoundHandle(tdf.soundWater);
+            projectile->soundHit = unitDatabase.tryGetSoundHandle(tdf.soundHit);
         }
-        if (!tdf.explosionGaf.empty() && !tdf.explosionArt.empty())
+        if (!tdf.soundWater.empty())
         {
-            weapon.explosion = textureService->getGafEntry("anims/" + tdf.explosionGaf + ".gaf", tdf.explosionArt);
+            projectile->soundWater = unitDatabase.tryGetSoundHandle(tdf.soundWater);
         }
-        if (!tdf.waterExplosionGaf.empty() && !tdf.waterExplosionArt.empty())
+        if (textureService != nullptr)
         {
-            weapon.waterExplosion = textureService->getGafEntry("anims/" + tdf.waterExplosionGaf + ".gaf", tdf.waterExplosionArt);
+            if (!tdf.explosionGaf.empty() && !tdf.explosionArt.empty())
+            {
+                projectile->explosion = textureService->getGafEntry("anims/" + tdf.explosionGaf + ".gaf", tdf.explosionArt);
+            }
+            if (!tdf.waterExplosionGaf.empty() && !tdf.waterExplosionArt.empty())
+            {
+                projectile->waterExplosion = textureService->getGafEntry("anims/" + tdf.waterExplosionGaf + ".gaf", tdf.waterExplosionArt);
+            }
         }
 
         for (const auto& p : tdf.damage)
         {
-            weapon.damage.insert_or_assign(toUpper(p.first), p.second);
+            projectile->damage.insert_or_assign(p.first, p.second);
         }
 
-        weapon.damageRadius = static_cast<float>(tdf.areaOfEffect) / 2.0f;
+        projectile->damageRadius = static_cast<float>(tdf.areaOfEffect) / 2.0f;
 
-        return weapon;
+        projectileDescriptors.insert({weaponType, projectile});
+        return projectile;
     }
 
     Vector3f colorToVector(const Color& color)
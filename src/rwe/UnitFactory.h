@@ -1,11 +1,14 @@
 #ifndef RWE_UNITFACTORY_H
 #define RWE_UNITFACTORY_H
 
+#include <rwe/AbstractTextureService.h>
 #include <rwe/MeshService.h>
 #include <rwe/MovementClass.h>
 #include <rwe/MovementClassCollisionService.h>
+#include <rwe/ProjectileDescriptor.h>
 #include <rwe/Unit.h>
 #include <rwe/UnitDatabase.h>
+#include <rwe/rwe_string.h>
 #include <string>
 
 namespace rwe
@@ -13,16 +16,20 @@ namespace rwe
     class UnitFactory
     {
     private:
-        TextureService* const textureService;
+        /** May be null, in which case projectiles have no explosion animations. */
+        AbstractTextureService* const textureService;
         UnitDatabase unitDatabase;
         MeshService meshService;
         MovementClassCollisionService* const collisionService;
         const ColorPalette* palette;
         const ColorPalette* guiPalette;
 
+        /** Projectile properties shared by every weapon of the same type. */
+        CaseInsensitiveMap<std::shared_ptr<const ProjectileDescriptor>> projectileDescriptors;
+
     public:
         UnitFactory(
-            TextureService* textureService,
+            AbstractTextureService* textureService,
             UnitDatabase&& unitDatabase,
             MeshService&& meshService,
             MovementClassCollisionService* collisionService,
@@ -35,6 +42,8 @@ namespace rwe
     private:
         UnitWeapon createWeapon(const std::string& weaponType);
 
+        std::shared_ptr<const ProjectileDescriptor> getProjectileDescriptor(const std::string& weaponType);
+
         Vector3f getLaserColor(unsigned int colorIndex);
     };
 }
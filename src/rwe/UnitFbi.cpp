@@ -42,6 +42,9 @@ namespace rwe
 
         tdf.readOrDefault("MaxDamage", u.maxDamage);
 
+        tdf.readOrDefault("SightDistance", u.sightDistance);
+        tdf.readOrDefault("RadarDistance", u.radarDistance);
+
         tdf.readOrDefault("BMCode", u.bmCode);
 
         tdf.readOrDefault("Weapon1", u.weapon1);
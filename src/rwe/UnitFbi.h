@@ -31,6 +31,9 @@ namespace rwe
 
         unsigned int maxDamage;
 
+        unsigned int sightDistance;
+        unsigned int radarDistance;
+
         bool bmCode;
 
         std::string weapon1;
@@ -2,9 +2,10 @@
 #define RWE_UNITWEAPON_H
 
 #include <boost/variant.hpp>
-#include <rwe/AudioService.h>
+#include <memory>
 #include <rwe/GameTime.h>
-#include <rwe/SpriteSeries.h>
+#include <rwe/ProjectileDescriptor.h>
+#include <rwe/SoundHandle.h>
 #include <rwe/UnitId.h>
 #include <rwe/cob/CobThread.h>
 #include <rwe/math/Vector3f.h>
@@ -45,16 +46,8 @@ namespace rwe
         float reloadTime;
 
         bool startSmoke;
-        bool endSmoke;
 
-        std::optional<GameTimeDelta> smokeTrail;
-
-        std::optional<AudioService::SoundHandle> soundStart;
-        std::optional<AudioService::SoundHandle> soundHit;
-        std::optional<AudioService::SoundHandle> soundWater;
-
-        std::optional<std::shared_ptr<SpriteSeries>> explosion;
-        std::optional<std::shared_ptr<SpriteSeries>> waterExplosion;
+        std::optional<SoundHandle> soundStart;
 
         /** The game time at which the weapon next becomes ready to fire. */
         GameTime readyTime{0};
@@ -63,21 +56,11 @@ namespace rwe
 
         float pitchTolerance;
 
-        Vector3f color;
-        Vector3f color2;
-
-        /** Projectile velocity in pixels/tick. */
-        float velocity;
-
-        /** Beam duration in ticks. */
-        float duration;
-
         /** If true, the weapon only fires on command and does not auto-target. */
         bool commandFire;
 
-        std::unordered_map<std::string, unsigned int> damage;
-
-        float damageRadius;
+        /** Properties of the projectiles the weapon fires. */
+        std::shared_ptr<const ProjectileDescriptor> projectile;
 
         /** The internal state of the weapon. */
         UnitWeaponState state{UnitWeaponStateIdle()};
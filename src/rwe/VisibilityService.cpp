@@ -0,0 +1,326 @@
+#include "VisibilityService.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace rwe
+{
+    HorizonTable computeHorizonTable(unsigned int radius)
+    {
+        HorizonTable table;
+        table.radius = radius;
+
+        auto r = static_cast<int>(radius);
+        auto side = (2 * r) + 1;
+
+        // maps an offset to its index in the table
+        std::vector<int> indices(side * side, -1);
+        auto toSlot = [r, side](int dx, int dy) { return ((dy + r) * side) + (dx + r); };
+
+        // Visit the square in rings of increasing Chebyshev distance.
+        // A cell's parent is always on the previous ring,
+        // so it has already been added by the time the cell is.
+        for (int d = 1; d <= r; ++d)
+        {
+            for (int dy = -d; dy <= d; ++dy)
+            {
+                for (int dx = -d; dx <= d; ++dx)
+                {
+                    if (std::max(std::abs(dx), std::abs(dy)) != d)
+                    {
+                        continue;
+                    }
+
+                    int parent = -1;
+                    if (d > 1)
+                    {
+                        auto scale = static_cast<float>(d - 1) / static_cast<float>(d);
+                        auto px = static_cast<int>(std::round(dx * scale));
+                        auto py = static_cast<int>(std::round(dy * scale));
+                        parent = indices[toSlot(px, py)];
+                        assert(parent != -1);
+                    }
+
+                    auto distance = std::sqrt(static_cast<float>((dx * dx) + (dy * dy)));
+                    indices[toSlot(dx, dy)] = static_cast<int>(table.entries.size());
+                    table.entries.push_back(HorizonTable::Entry{dx, dy, parent, distance, distance <= static_cast<float>(radius)});
+                }
+            }
+        }
+
+        return table;
+    }
+
+    VisibilityService::VisibilityService(const MapTerrain* terrain) : terrain(terrain)
+    {
+        const auto& heights = terrain->getHeightMap();
+        auto width = (heights.getWidth() + CellSizeInHeightmapCells - 1) / CellSizeInHeightmapCells;
+        auto height = (heights.getHeight() + CellSizeInHeightmapCells - 1) / CellSizeInHeightmapCells;
+
+        occluderHeights = Grid<float>(width, height, 0.0f);
+        targetHeights = Grid<float>(width, height, 0.0f);
+
+        for (std::size_t y = 0; y < height; ++y)
+        {
+            for (std::size_t x = 0; x < width; ++x)
+            {
+                auto startX = x * CellSizeInHeightmapCells;
+                auto startY = y * CellSizeInHeightmapCells;
+                auto endX = std::min(startX + CellSizeInHeightmapCells, heights.getWidth());
+                auto endY = std::min(startY + CellSizeInHeightmapCells, heights.getHeight());
+
+                float sum = 0.0f;
+                unsigned char max = 0;
+                for (auto hy = startY; hy < endY; ++hy)
+                {
+                    for (auto hx = startX; hx < endX; ++hx)
+                    {
+                        auto h = heights.get(hx, hy);
+                        sum += h;
+                        max = std::max(max, h);
+                    }
+                }
+
+                occluderHeights.set(x, y, sum / static_cast<float>((endX - startX) * (endY - startY)));
+                targetHeights.set(x, y, max);
+            }
+        }
+    }
+
+    void VisibilityService::updateUnit(UnitId unitId, PlayerId owner, const Vector3f& position, float eyeHeight, float sightDistance, float radarDistance)
+    {
+        auto cell = worldToVisibilityCell(position);
+        auto sightRadius = toCellRadius(sightDistance);
+        auto radarRadius = toCellRadius(radarDistance);
+
+        auto it = units.find(unitId);
+        if (it == units.end())
+        {
+            it = units.emplace(unitId, UnitVisibility{owner, cell, sightRadius, radarRadius, {}}).first;
+        }
+        else
+        {
+            auto& unit = it->second;
+            if (unit.owner == owner && unit.cell == cell && unit.sightRadius == sightRadius && unit.radarRadius == radarRadius)
+            {
+                return;
+            }
+
+            auto& oldPlayer = getPlayer(unit.owner);
+            unstampSight(oldPlayer.sight, unit);
+            stampRadar(oldPlayer.radar, unit, -1);
+
+            unit.owner = owner;
+            unit.cell = cell;
+            unit.sightRadius = sightRadius;
+            unit.radarRadius = radarRadius;
+        }
+
+        auto& unit = it->second;
+        auto& player = getPlayer(owner);
+        stampSight(player.sight, unit, position.y + eyeHeight);
+        stampRadar(player.radar, unit, 1);
+    }
+
+    void VisibilityService::removeUnit(UnitId unitId)
+    {
+        auto it = units.find(unitId);
+        if (it == units.end())
+        {
+            return;
+        }
+
+        auto& unit = it->second;
+        auto& player = getPlayer(unit.owner);
+        unstampSight(player.sight, unit);
+        stampRadar(player.radar, unit, -1);
+
+        units.erase(it);
+    }
+
+    bool VisibilityService::isVisible(PlayerId player, const Vector3f& position) const
+    {
+        auto p = tryGetPlayer(player);
+        auto index = tryGetCellIndex(position);
+        return p != nullptr && index && p->sight.getData()[*index] != 0;
+    }
+
+    bool VisibilityService::isOnRadar(PlayerId player, const Vector3f& position) const
+    {
+        auto p = tryGetPlayer(player);
+        auto index = tryGetCellIndex(position);
+        return p != nullptr && index && p->radar.getData()[*index] != 0;
+    }
+
+    Point VisibilityService::worldToVisibilityCell(const Vector3f& position) const
+    {
+        auto heightPos = terrain->worldToHeightmapSpace(position);
+        return Point(
+            static_cast<int>(std::floor(heightPos.x / CellSizeInHeightmapCells)),
+            static_cast<int>(std::floor(heightPos.z / CellSizeInHeightmapCells)));
+    }
+
+    std::size_t VisibilityService::getWidth() const
+    {
+        return targetHeights.getWidth();
+    }
+
+    std::size_t VisibilityService::getHeight() const
+    {
+        return targetHeights.getHeight();
+    }
+
+    VisibilityService::PlayerVisibility& VisibilityService::getPlayer(PlayerId player)
+    {
+        while (players.size() <= player.value)
+        {
+            players.push_back(PlayerVisibility{
+                Grid<unsigned short>(getWidth(), getHeight(), 0),
+                Grid<unsigned short>(getWidth(), getHeight(), 0)});
+        }
+
+        return players[player.value];
+    }
+
+    const HorizonTable& VisibilityService::getHorizonTable(unsigned int radius)
+    {
+        auto it = horizonTables.find(radius);
+        if (it == horizonTables.end())
+        {
+            it = horizonTables.emplace(radius, computeHorizonTable(radius)).first;
+        }
+
+        return it->second;
+    }
+
+    unsigned int VisibilityService::toCellRadius(float distance) const
+    {
+        if (distance <= 0.0f)
+        {
+            return 0;
+        }
+
+        auto cellWidth = MapTerrain::HeightTileWidthInWorldUnits * CellSizeInHeightmapCells;
+        return static_cast<unsigned int>(std::ceil(distance / cellWidth));
+    }
+
+    const VisibilityService::PlayerVisibility* VisibilityService::tryGetPlayer(PlayerId player) const
+    {
+        if (player.value >= players.size())
+        {
+            return nullptr;
+        }
+
+        return &players[player.value];
+    }
+
+    std::optional<std::size_t> VisibilityService::tryGetCellIndex(const Vector3f& position) const
+    {
+        auto cell = worldToVisibilityCell(position);
+        if (cell.x < 0 || cell.y < 0 || cell.x >= static_cast<int>(getWidth()) || cell.y >= static_cast<int>(getHeight()))
+        {
+            return std::nullopt;
+        }
+
+        return targetHeights.toIndex(cell.x, cell.y);
+    }
+
+    void VisibilityService::stampSight(Grid<unsigned short>& grid, UnitVisibility& unit, float eyeHeight)
+    {
+        assert(unit.sightCells.empty());
+
+        if (unit.sightRadius == 0)
+        {
+            return;
+        }
+
+        auto width = static_cast<int>(getWidth());
+        auto height = static_cast<int>(getHeight());
+        auto inBounds = [width, height](int x, int y) { return x >= 0 && y >= 0 && x < width && y < height; };
+
+        if (inBounds(unit.cell.x, unit.cell.y))
+        {
+            unit.sightCells.push_back(grid.toIndex(unit.cell.x, unit.cell.y));
+        }
+
+        const auto& table = getHorizonTable(unit.sightRadius);
+
+        // Steepest slope from the eye to the terrain
+        // on the way out to each cell, exclusive of the cell itself.
+        // A cell is visible if the slope to its highest point is not below this.
+        std::vector<float> horizons(table.entries.size());
+
+        for (std::size_t i = 0; i < table.entries.size(); ++i)
+        {
+            const auto& e = table.entries[i];
+            auto horizon = e.parent == -1 ? -std::numeric_limits<float>::infinity() : horizons[e.parent];
+
+            auto x = unit.cell.x + e.dx;
+            auto y = unit.cell.y + e.dy;
+            if (!inBounds(x, y))
+            {
+                horizons[i] = horizon;
+                continue;
+            }
+
+            auto targetSlope = (targetHeights.get(x, y) - eyeHeight) / e.distance;
+            if (e.inRange && targetSlope >= horizon)
+            {
+                unit.sightCells.push_back(grid.toIndex(x, y));
+            }
+
+            auto occluderSlope = (occluderHeights.get(x, y) - eyeHeight) / e.distance;
+            horizons[i] = std::max(horizon, occluderSlope);
+        }
+
+        auto data = grid.getData();
+        for (auto index : unit.sightCells)
+        {
+            ++data[index];
+        }
+    }
+
+    void VisibilityService::unstampSight(Grid<unsigned short>& grid, UnitVisibility& unit)
+    {
+        auto data = grid.getData();
+        for (auto index : unit.sightCells)
+        {
+            assert(data[index] > 0);
+            --data[index];
+        }
+
+        unit.sightCells.clear();
+    }
+
+    void VisibilityService::stampRadar(Grid<unsigned short>& grid, const UnitVisibility& unit, int delta)
+    {
+        if (unit.radarRadius == 0)
+        {
+            return;
+        }
+
+        auto r = static_cast<int>(unit.radarRadius);
+        auto minX = std::max(unit.cell.x - r, 0);
+        auto maxX = std::min(unit.cell.x + r, static_cast<int>(getWidth()) - 1);
+        auto minY = std::max(unit.cell.y - r, 0);
+        auto maxY = std::min(unit.cell.y + r, static_cast<int>(getHeight()) - 1);
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            auto dy = y - unit.cell.y;
+            for (int x = minX; x <= maxX; ++x)
+            {
+                auto dx = x - unit.cell.x;
+                if ((dx * dx) + (dy * dy) > r * r)
+                {
+                    continue;
+                }
+
+                auto& count = grid.get(x, y);
+                count = static_cast<unsigned short>(count + delta);
+            }
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef RWE_VISIBILITYSERVICE_H
+#define RWE_VISIBILITYSERVICE_H
+
+#include <optional>
+#include <rwe/Grid.h>
+#include <rwe/MapTerrain.h>
+#include <rwe/PlayerId.h>
+#include <rwe/Point.h>
+#include <rwe/UnitId.h>
+#include <rwe/math/Vector3f.h>
+#include <unordered_map>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Offsets of the cells within a square of a given radius around an observer,
+     * ordered so that every cell comes after its parent.
+     * The parent of a cell is the next cell back along the line towards the observer,
+     * so the terrain horizon seen from the observer can be propagated outwards
+     * in a single pass over the table.
+     */
+    struct HorizonTable
+    {
+        struct Entry
+        {
+            int dx;
+            int dy;
+
+            /** Index of the parent entry, or -1 for cells adjacent to the observer. */
+            int parent;
+
+            /** Distance from the observer in visibility cells. */
+            float distance;
+
+            /** True if the cell lies within the circle of the table's radius. */
+            bool inRange;
+        };
+
+        unsigned int radius;
+        std::vector<Entry> entries;
+    };
+
+    HorizonTable computeHorizonTable(unsigned int radius);
+
+    /**
+     * Tracks which parts of the map each player can see and has radar coverage over.
+     *
+     * The map is divided into coarse visibility cells.
+     * Each unit stamps the cells it can see into a per-player counter grid,
+     * and the stamp is only recomputed when the unit moves into a different cell
+     * or its ranges change, so queries are a single grid lookup.
+     *
+     * Sight is occluded by terrain, tested against precomputed horizon tables.
+     * Radar coverage is not.
+     *
+     * Nothing in the game reads visibility yet, so the game loop does not keep one up to date.
+     * It is meant to be driven from the simulation tick,
+     * calling updateUnit for every unit and removeUnit when a unit is deleted,
+     * once rendering, picking or targeting filter by it.
+     */
+    class VisibilityService
+    {
+    public:
+        /** Width and height of a visibility cell in heightmap cells. */
+        static constexpr int CellSizeInHeightmapCells = 2;
+
+    private:
+        struct PlayerVisibility
+        {
+            Grid<unsigned short> sight;
+            Grid<unsigned short> radar;
+        };
+
+        struct UnitVisibility
+        {
+            PlayerId owner;
+            Point cell;
+            unsigned int sightRadius;
+            unsigned int radarRadius;
+            std::vector<std::size_t> sightCells;
+        };
+
+        const MapTerrain* terrain;
+
+        /** Average terrain height in each visibility cell, used to occlude sight. */
+        Grid<float> occluderHeights;
+
+        /** Maximum terrain height in each visibility cell, used as the point to be seen. */
+        Grid<float> targetHeights;
+
+        std::vector<PlayerVisibility> players;
+
+        std::unordered_map<UnitId, UnitVisibility> units;
+
+        std::unordered_map<unsigned int, HorizonTable> horizonTables;
+
+    public:
+        explicit VisibilityService(const MapTerrain* terrain);
+
+        /**
+         * Informs the service of the unit's current position and ranges.
+         * Cheap if the unit has not changed visibility cell since the last call.
+         * Ranges are in world units.
+         */
+        void updateUnit(UnitId unitId, PlayerId owner, const Vector3f& position, float eyeHeight, float sightDistance, float radarDistance);
+
+        void removeUnit(UnitId unitId);
+
+        bool isVisible(PlayerId player, const Vector3f& position) const;
+
+        bool isOnRadar(PlayerId player, const Vector3f& position) const;
+
+        Point worldToVisibilityCell(const Vector3f& position) const;
+
+        std::size_t getWidth() const;
+
+        std::size_t getHeight() const;
+
+    private:
+        PlayerVisibility& getPlayer(PlayerId player);
+
+        const HorizonTable& getHorizonTable(unsigned int radius);
+
+        unsigned int toCellRadius(float distance) const;
+
+        const PlayerVisibility* tryGetPlayer(PlayerId player) const;
+
+        std::optional<std::size_t> tryGetCellIndex(const Vector3f& position) const;
+
+        void stampSight(Grid<unsigned short>& grid, UnitVisibility& unit, float eyeHeight);
+
+        void unstampSight(Grid<unsigned short>& grid, UnitVisibility& unit);
+
+        void stampRadar(Grid<unsigned short>& grid, const UnitVisibility& unit, int delta);
+    };
+}
+
+#endif
@@ -1,5 +1,5 @@
 #include "CobExecutionContext.h"
-#include <rwe/SceneManager.h>
+#include <rwe/GameTime.h>
 #include <rwe/cob/CobConstants.h>
 #include <rwe/cob/CobOpCode.h>
 
@@ -156,7 +156,7 @@ namespace rwe
                 {
                     auto duration = pop();
 
-                    auto ticksToWait = GameTimeDelta(duration / SceneManager::TickInterval);
+                    auto ticksToWait = GameTimeDelta(duration / TickInterval);
                     auto currentTime = sim->gameTime;
 
                     return CobEnvironment::BlockedStatus(CobEnvironment::BlockedStatus::Sleep(currentTime + ticksToWait));
@@ -218,9 +218,16 @@ namespace rwe
         auto high = pop();
         auto low = pop();
         auto range = high - low;
+        if (range <= 0)
+        {
+            push(low);
+            return;
+        }
 
-        // FIXME: replace with deterministic RNG source
-        auto value = (std::rand() % range) + low;
+        // mt19937 output is fully specified by the standard,
+        // unlike the standard distributions, so reduce it ourselves
+        // to get the same result on every platform.
+        auto value = static_cast<int>(sim->rng() % static_cast<unsigned int>(range)) + low;
         push(value);
     }
 
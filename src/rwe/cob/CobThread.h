@@ -20,7 +20,7 @@ namespace rwe
 
         std::stack<CobFunction> callStack;
 
-        int returnValue;
+        int returnValue{0};
 
         /**
          * Required for query functions, which communicate back to the engine
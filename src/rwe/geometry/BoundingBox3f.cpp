@@ -1,6 +1,7 @@
 #include "BoundingBox3f.h"
 #include <cmath>
 #include <rwe/geometry/Plane3f.h>
+#include <utility>
 
 namespace rwe
 {
@@ -88,6 +89,44 @@ namespace rwe
         return std::nullopt;
     }
 
+    std::optional<float> BoundingBox3f::intersectLine(const Line3f& line) const
+    {
+        auto min = center - extents;
+        auto max = center + extents;
+        auto direction = line.end - line.start;
+
+        float enter = 0.0f;
+        float exit = 1.0f;
+
+        // clip the segment against the slab between each pair of opposite faces
+        auto clipToSlab = [&enter, &exit](float start, float delta, float slabMin, float slabMax) {
+            if (delta == 0.0f)
+            {
+                return start >= slabMin && start <= slabMax;
+            }
+
+            auto t1 = (slabMin - start) / delta;
+            auto t2 = (slabMax - start) / delta;
+            if (t1 > t2)
+            {
+                std::swap(t1, t2);
+            }
+
+            enter = std::fmax(enter, t1);
+            exit = std::fmin(exit, t2);
+            return enter <= exit;
+        };
+
+        if (!clipToSlab(line.start.x, direction.x, min.x, max.x)
+            || !clipToSlab(line.start.y, direction.y, min.y, max.y)
+            || !clipToSlab(line.start.z, direction.z, min.z, max.z))
+        {
+            return std::nullopt;
+        }
+
+        return enter;
+    }
+
     float BoundingBox3f::distanceSquared(const Vector3f& pos) const
     {
         auto toCenter = center - pos;
@@ -2,6 +2,7 @@
 #define RWE_GEOMETRY_BOUNDINGBOX3F_H
 
 #include <optional>
+#include <rwe/geometry/Line3f.h>
 #include <rwe/geometry/Ray3f.h>
 #include <rwe/math/Vector3f.h>
 
@@ -35,6 +36,14 @@ namespace rwe
          */
         std::optional<RayIntersect> intersect(const Ray3f& ray) const;
 
+        /**
+         * Computes the intersection between the given line segment and the bounding box.
+         * If the segment touches the box, returns the fraction of the way
+         * from the start to the end of the segment at which it first does so,
+         * which is 0 if the segment starts inside the box.
+         */
+        std::optional<float> intersectLine(const Line3f& line) const;
+
         float distanceSquared(const Vector3f& pos) const;
     };
 }
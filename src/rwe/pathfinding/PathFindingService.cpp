@@ -63,6 +63,7 @@ namespace rwe
         {
             waypoints.push_back(getWorldCenter(DiscreteRect(it->x, it->y, unit.footprintX, unit.footprintZ)));
         }
+        simulation->terrain.setHeightsAt(waypoints);
 
         return UnitPath{std::move(waypoints)};
     }
@@ -99,6 +100,7 @@ namespace rwe
         {
             waypoints.push_back(getWorldCenter(DiscreteRect(it->x, it->y, unit.footprintX, unit.footprintZ)));
         }
+        simulation->terrain.setHeightsAt(waypoints);
         waypoints.back() = destination;
 
         return UnitPath{std::move(waypoints)};
@@ -111,9 +113,7 @@ namespace rwe
         auto halfWorldWidth = (rect.width * MapTerrain::HeightTileWidthInWorldUnits) / 2.0f;
         auto halfWorldHeight = (rect.height * MapTerrain::HeightTileHeightInWorldUnits) / 2.0f;
 
-        auto center = corner + Vector3f(halfWorldWidth, 0.0f, halfWorldHeight);
-        center.y = simulation->terrain.getHeightAt(center.x, center.z);
-        return center;
+        return corner + Vector3f(halfWorldWidth, 0.0f, halfWorldHeight);
     }
 
     DiscreteRect PathFindingService::expandTopLeft(const DiscreteRect& rect, unsigned int width, unsigned int height)
@@ -52,6 +52,7 @@ namespace rwe
         UnitPath findPath(UnitId unitId, const Vector3f& destination);
         UnitPath findPath(UnitId unitId, const DiscreteRect& destination);
 
+        /** Returns the center of the rect in world space, at zero height. */
         Vector3f getWorldCenter(const DiscreteRect& discreteRect);
 
         DiscreteRect expandTopLeft(const DiscreteRect& rect, unsigned int width, unsigned int height);
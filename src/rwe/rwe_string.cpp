@@ -68,6 +68,34 @@ namespace rwe
         return copy;
     }
 
+    bool equalsIgnoreCase(std::string_view a, std::string_view b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (asciiToUpper(a[i]) != asciiToUpper(b[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool startsWithIgnoreCase(std::string_view str, std::string_view prefix)
+    {
+        return str.size() >= prefix.size() && equalsIgnoreCase(str.substr(0, prefix.size()), prefix);
+    }
+
+    bool endsWithIgnoreCase(std::string_view str, std::string_view end)
+    {
+        return str.size() >= end.size() && equalsIgnoreCase(str.substr(str.size() - end.size()), end);
+    }
+
     ConstUtf8Iterator utf8Begin(const std::string& str)
     {
         return utf8::iterator<std::string::const_iterator>(str.begin(), str.begin(), str.end());
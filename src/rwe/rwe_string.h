@@ -2,6 +2,8 @@
 #define RWE_STRING_H
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <utf8.h>
@@ -22,6 +24,53 @@ namespace rwe
 
     std::string toUpper(const std::string& str);
 
+    /** Upper-cases a single ASCII character, leaving all other bytes alone, like toUpper. */
+    inline char asciiToUpper(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b);
+    bool startsWithIgnoreCase(std::string_view str, std::string_view prefix);
+    bool endsWithIgnoreCase(std::string_view str, std::string_view end);
+
+    /**
+     * Hashes a string as if it had been passed through toUpper,
+     * without making a copy.
+     * Transparent, so that it can look up string_view keys
+     * in containers that support heterogeneous lookup.
+     */
+    struct CaseInsensitiveHash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view key) const
+        {
+            // FNV-1a
+            std::size_t hash = static_cast<std::size_t>(14695981039346656037ull);
+            for (auto c : key)
+            {
+                hash ^= static_cast<unsigned char>(asciiToUpper(c));
+                hash *= static_cast<std::size_t>(1099511628211ull);
+            }
+            return hash;
+        }
+    };
+
+    struct CaseInsensitiveEquals
+    {
+        using is_transparent = void;
+
+        bool operator()(std::string_view a, std::string_view b) const
+        {
+            return equalsIgnoreCase(a, b);
+        }
+    };
+
+    /** A map keyed by asset or definition name, which TA treats case-insensitively. */
+    template <typename T>
+    using CaseInsensitiveMap = std::unordered_map<std::string, T, CaseInsensitiveHash, CaseInsensitiveEquals>;
+
     Utf8Iterator utf8Begin(std::string& str);
     ConstUtf8Iterator utf8Begin(const std::string& str);
     ConstUtf8Iterator cUtf8Begin(const std::string& str);
@@ -1,6 +1,7 @@
 #include "tdf.h"
 
 #include <rwe/tdf/SimpleTdfAdapter.h>
+#include <rwe/tdf/TdfDocument.h>
 
 namespace rwe
 {
@@ -10,18 +11,18 @@ namespace rwe
         return parser.parse(begin, end);
     }
 
-    TdfBlock parseTdfFromString(const std::string& input)
+    TdfBlock parseTdfFromString(std::string_view input)
     {
-        TdfParser<ConstUtf8Iterator, TdfBlock> parser(new SimpleTdfAdapter);
+        SimpleTdfAdapter adapter;
 
         // TA files typically use legacy ISO-8859-1 encoding (latin1)
         // so fall back to that if the input isn't valid UTF8.
         if (!utf8::is_valid(input.begin(), input.end()))
         {
-            auto convertedInput = latin1ToUtf8(input);
-            return parser.parse(cUtf8Begin(convertedInput), cUtf8End(convertedInput));
+            auto convertedInput = latin1ToUtf8(std::string(input));
+            return adaptTdfDocument(parseTdfDocument(convertedInput), adapter);
         }
 
-        return parser.parse(cUtf8Begin(input), cUtf8End(input));
+        return adaptTdfDocument(parseTdfDocument(input), adapter);
     }
 }
@@ -3,12 +3,13 @@
 
 #include <rwe/rwe_string.h>
 #include <rwe/tdf/TdfBlock.h>
+#include <string_view>
 
 namespace rwe
 {
     TdfBlock parseTdf(ConstUtf8Iterator& begin, ConstUtf8Iterator& end);
 
-    TdfBlock parseTdfFromString(const std::string& input);
+    TdfBlock parseTdfFromString(std::string_view input);
 }
 
 #endif
@@ -43,28 +43,10 @@ namespace rwe
 
     struct TdfPropertyValue;
 
-    struct CaseInsensitiveHash
-    {
-        std::hash<std::string> hash;
-
-        std::size_t operator()(const std::string& key) const
-        {
-            return hash(toUpper(key));
-        }
-    };
-
-    struct CaseInsensitiveEquals
-    {
-        bool operator()(const std::string& a, const std::string& b) const
-        {
-            return toUpper(a) == toUpper(b);
-        }
-    };
-
     struct TdfBlock
     {
-        using PropertyMap = std::unordered_map<std::string, std::string, CaseInsensitiveHash, CaseInsensitiveEquals>;
-        using BlockMap = std::unordered_map<std::string, std::unique_ptr<TdfBlock>, CaseInsensitiveHash, CaseInsensitiveEquals>;
+        using PropertyMap = CaseInsensitiveMap<std::string>;
+        using BlockMap = CaseInsensitiveMap<std::unique_ptr<TdfBlock>>;
 
         PropertyMap properties;
         BlockMap blocks;
@@ -0,0 +1,494 @@
+#include "TdfDocument.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rwe
+{
+    namespace
+    {
+        bool isAsciiLower(char c)
+        {
+            return c >= 'a' && c <= 'z';
+        }
+
+        bool isTrimmable(char c)
+        {
+            // matches std::isspace in the C locale
+            return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        }
+
+        std::string_view trim(std::string_view str)
+        {
+            std::size_t begin = 0;
+            while (begin < str.size() && isTrimmable(str[begin]))
+            {
+                ++begin;
+            }
+
+            std::size_t end = str.size();
+            while (end > begin && isTrimmable(str[end - 1]))
+            {
+                --end;
+            }
+
+            return str.substr(begin, end - begin);
+        }
+
+        /** Compares a name against a key that is already upper case. */
+        bool equalsKey(std::string_view key, std::string_view name)
+        {
+            if (key.size() != name.size())
+            {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < key.size(); ++i)
+            {
+                if (key[i] != asciiToUpper(name[i]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    char* TdfArena::allocate(std::size_t size)
+    {
+        if (size > remaining)
+        {
+            // Oversized requests get a chunk of their own
+            // so that the current chunk can continue to be used.
+            if (size > ChunkSize / 4)
+            {
+                chunks.push_back(std::make_unique<char[]>(size));
+                return chunks.back().get();
+            }
+
+            chunks.push_back(std::make_unique<char[]>(ChunkSize));
+            current = chunks.back().get();
+            remaining = ChunkSize;
+        }
+
+        auto p = current;
+        current += size;
+        remaining -= size;
+        return p;
+    }
+
+    std::string_view TdfArena::store(std::string_view str)
+    {
+        if (str.empty())
+        {
+            return std::string_view();
+        }
+
+        auto p = allocate(str.size());
+        std::memcpy(p, str.data(), str.size());
+        return std::string_view(p, str.size());
+    }
+
+    const TdfDocument::Block& TdfDocument::root() const
+    {
+        return blocks.front();
+    }
+
+    TdfDocument::Range<TdfDocument::Property> TdfDocument::getProperties(const Block& block) const
+    {
+        auto begin = properties.data() + block.firstProperty;
+        return Range<Property>(begin, begin + block.propertyCount);
+    }
+
+    TdfDocument::ChildRange TdfDocument::getChildren(const Block& block) const
+    {
+        auto begin = children.data() + block.firstChild;
+        return ChildRange(ChildIterator(this, begin), ChildIterator(this, begin + block.childCount));
+    }
+
+    std::optional<std::string_view> TdfDocument::findValue(const Block& block, std::string_view name) const
+    {
+        auto range = getProperties(block);
+        for (auto it = range.end(); it != range.begin();)
+        {
+            --it;
+            if (equalsKey(it->key, name))
+            {
+                return it->value;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    const TdfDocument::Block* TdfDocument::findBlock(const Block& block, std::string_view name) const
+    {
+        auto begin = children.data() + block.firstChild;
+        for (auto it = begin + block.childCount; it != begin;)
+        {
+            --it;
+            const auto& child = blocks[*it];
+            if (equalsKey(child.key, name))
+            {
+                return &child;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Recursive descent parser over raw bytes.
+     * Mirrors the grammar and quirks of TdfParser,
+     * but produces views instead of building strings one code point at a time.
+     */
+    class TdfDocumentParser
+    {
+    private:
+        /** Properties and children of a block that is still open. */
+        struct Frame
+        {
+            std::string_view name;
+            std::vector<TdfDocument::Property> properties;
+            std::vector<uint32_t> children;
+        };
+
+        TdfDocument& doc;
+
+        const char* begin;
+        const char* p;
+        const char* end;
+
+        /** Frames are reused between blocks at the same depth to avoid reallocating. */
+        std::vector<Frame> frames;
+        std::size_t depth{0};
+
+        /** Scratch space for text that contained comments or carriage returns. */
+        std::string scratch;
+
+    public:
+        TdfDocumentParser(TdfDocument& doc, std::string_view input) : doc(doc)
+        {
+            doc.source = doc.arena.store(input);
+            begin = doc.source.data();
+            p = begin;
+            end = begin + doc.source.size();
+        }
+
+        void parse()
+        {
+            doc.blocks.emplace_back(); // placeholder for the root
+            pushFrame(std::string_view());
+
+            consumeWhitespaceAndComments();
+            while (!isEndOfFile())
+            {
+                block();
+                consumeWhitespaceAndComments();
+            }
+
+            auto root = finishFrame();
+            doc.blocks[0] = root;
+        }
+
+    private:
+        void block()
+        {
+            expect('[');
+            consumeWhitespaceAndComments();
+            auto name = text(']', ']');
+            consumeWhitespaceAndComments();
+            expect(']');
+
+            pushFrame(name);
+
+            consumeWhitespaceAndComments();
+            blockBody();
+
+            auto finished = finishFrame();
+            auto index = static_cast<uint32_t>(doc.blocks.size());
+            doc.blocks.push_back(finished);
+            frames[depth - 1].children.push_back(index);
+        }
+
+        void blockBody()
+        {
+            expect('{');
+            consumeWhitespaceAndComments();
+            while (!accept('}'))
+            {
+                if (peek() == '[')
+                {
+                    block();
+                }
+                else
+                {
+                    property();
+                }
+
+                consumeWhitespaceAndComments();
+            }
+        }
+
+        void property()
+        {
+            auto first = peek();
+            if (first == '=' || first == '\n' || first == ';' || first == TdfEndOfFile)
+            {
+                throw error("Expected property name");
+            }
+
+            auto name = text('=', ';');
+            consumeWhitespaceAndComments();
+            expect('=');
+            consumeWhitespaceAndComments();
+            auto value = text(';', ';');
+            consumeWhitespaceAndComments();
+            expect(';');
+
+            auto& frame = frames[depth - 1];
+            auto precedingChildren = static_cast<uint32_t>(frame.children.size());
+            frame.properties.push_back(TdfDocument::Property{name, foldKey(name), value, precedingChildren});
+        }
+
+        void pushFrame(std::string_view name)
+        {
+            if (depth == frames.size())
+            {
+                frames.emplace_back();
+            }
+
+            auto& frame = frames[depth++];
+            frame.name = name;
+            frame.properties.clear();
+            frame.children.clear();
+        }
+
+        TdfDocument::Block finishFrame()
+        {
+            auto& frame = frames[--depth];
+
+            TdfDocument::Block block;
+            block.name = frame.name;
+            block.key = foldKey(frame.name);
+            block.firstProperty = static_cast<uint32_t>(doc.properties.size());
+            block.propertyCount = static_cast<uint32_t>(frame.properties.size());
+            block.firstChild = static_cast<uint32_t>(doc.children.size());
+            block.childCount = static_cast<uint32_t>(frame.children.size());
+
+            doc.properties.insert(doc.properties.end(), frame.properties.begin(), frame.properties.end());
+            doc.children.insert(doc.children.end(), frame.children.begin(), frame.children.end());
+
+            return block;
+        }
+
+        std::string_view foldKey(std::string_view name)
+        {
+            auto it = std::find_if(name.begin(), name.end(), isAsciiLower);
+            if (it == name.end())
+            {
+                return name;
+            }
+
+            auto key = doc.arena.allocate(name.size());
+            std::transform(name.begin(), name.end(), key, asciiToUpper);
+            return std::string_view(key, name.size());
+        }
+
+        /**
+         * Reads text up to (not including) one of the given stop characters or the end of file,
+         * skipping comments, then trims it.
+         * The result is a view into the source unless the text had to be rewritten.
+         */
+        std::string_view text(char stop1, char stop2)
+        {
+            auto start = p;
+            auto segmentStart = p;
+            auto rewritten = false;
+
+            while (true)
+            {
+                if (atComment())
+                {
+                    if (!rewritten)
+                    {
+                        scratch.clear();
+                        rewritten = true;
+                    }
+                    scratch.append(segmentStart, p);
+                    consumeComment();
+                    segmentStart = p;
+                    continue;
+                }
+
+                auto cp = peek();
+                if (cp == static_cast<unsigned char>(stop1) || cp == static_cast<unsigned char>(stop2) || cp == TdfEndOfFile)
+                {
+                    break;
+                }
+
+                if (*p == '\r')
+                {
+                    // the source parser sees \r and \r\n as \n
+                    if (!rewritten)
+                    {
+                        scratch.clear();
+                        rewritten = true;
+                    }
+                    scratch.append(segmentStart, p);
+                    scratch.push_back('\n');
+                    next();
+                    segmentStart = p;
+                    continue;
+                }
+
+                next();
+            }
+
+            if (!rewritten)
+            {
+                return trim(std::string_view(start, p - start));
+            }
+
+            scratch.append(segmentStart, p);
+            return doc.arena.store(trim(scratch));
+        }
+
+        bool atComment() const
+        {
+            return end - p >= 2 && p[0] == '/' && (p[1] == '/' || p[1] == '*');
+        }
+
+        void consumeComment()
+        {
+            if (p[1] == '/')
+            {
+                p += 2;
+                while (peek() != '\n' && peek() != TdfEndOfFile)
+                {
+                    next();
+                }
+                return;
+            }
+
+            p += 2;
+            while (true)
+            {
+                if (end - p >= 2 && p[0] == '*' && p[1] == '/')
+                {
+                    p += 2;
+                    return;
+                }
+
+                if (isEndOfFile())
+                {
+                    throw error("Expected */, got end of file");
+                }
+
+                next();
+            }
+        }
+
+        void consumeWhitespaceAndComments()
+        {
+            while (true)
+            {
+                auto cp = peek();
+                if (cp == ' ' || cp == '\t' || cp == '\n')
+                {
+                    next();
+                }
+                else if (atComment())
+                {
+                    consumeComment();
+                }
+                else
+                {
+                    return;
+                }
+            }
+        }
+
+        void expect(TdfCodePoint cp)
+        {
+            if (!accept(cp))
+            {
+                throw error("Expected " + std::to_string(cp));
+            }
+        }
+
+        bool accept(TdfCodePoint cp)
+        {
+            if (peek() != cp)
+            {
+                return false;
+            }
+
+            next();
+            return true;
+        }
+
+        bool isEndOfFile() const
+        {
+            return p == end;
+        }
+
+        TdfCodePoint peek() const
+        {
+            if (p == end)
+            {
+                return TdfEndOfFile;
+            }
+
+            auto c = static_cast<unsigned char>(*p);
+            return c == '\r' ? '\n' : c;
+        }
+
+        void next()
+        {
+            if (p == end)
+            {
+                return;
+            }
+
+            if (*p == '\r' && p + 1 != end && p[1] == '\n')
+            {
+                p += 2;
+                return;
+            }
+
+            ++p;
+        }
+
+        /** Builds an exception carrying the line and column (in code points) of the current position. */
+        TdfParserException error(const std::string& message) const
+        {
+            std::size_t line = 1;
+            std::size_t column = 1;
+            for (auto it = begin; it != p; ++it)
+            {
+                if (*it == '\n' || (*it == '\r' && (it + 1 == p || it[1] != '\n')))
+                {
+                    ++line;
+                    column = 1;
+                }
+                else if (*it != '\r' && (static_cast<unsigned char>(*it) & 0xc0) != 0x80)
+                {
+                    ++column;
+                }
+            }
+
+            return TdfParserException(line, column, message);
+        }
+    };
+
+    TdfDocument parseTdfDocument(std::string_view input)
+    {
+        TdfDocument doc;
+        TdfDocumentParser parser(doc, input);
+        parser.parse();
+
+        return doc;
+    }
+}
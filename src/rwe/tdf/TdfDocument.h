@@ -0,0 +1,209 @@
+#ifndef RWE_TDFDOCUMENT_H
+#define RWE_TDFDOCUMENT_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <rwe/tdf/TdfParser.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Bump allocator for the strings of a TdfDocument.
+     * Memory is only released when the arena is destroyed.
+     * Allocations never move, so views into them survive moving the arena.
+     */
+    class TdfArena
+    {
+    private:
+        static const std::size_t ChunkSize = 16 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> chunks;
+        char* current{nullptr};
+        std::size_t remaining{0};
+
+    public:
+        char* allocate(std::size_t size);
+
+        std::string_view store(std::string_view str);
+    };
+
+    /**
+     * A parsed TDF file.
+     *
+     * Names and values are views into a single copy of the source text.
+     * Only text that had to be rewritten (to drop comments or normalize line endings)
+     * and upper-cased lookup keys are stored separately, in the document's arena.
+     *
+     * Blocks and properties are stored in flat vectors.
+     * The properties and child blocks of each block are contiguous,
+     * in the order they appeared in the source.
+     */
+    class TdfDocument
+    {
+    public:
+        struct Property
+        {
+            std::string_view name;
+
+            /** The name folded to ASCII upper case. */
+            std::string_view key;
+
+            std::string_view value;
+
+            /** The number of the block's children that appear before this property. */
+            uint32_t precedingChildren;
+        };
+
+        struct Block
+        {
+            std::string_view name;
+
+            /** The name folded to ASCII upper case. */
+            std::string_view key;
+
+            uint32_t firstProperty;
+            uint32_t propertyCount;
+
+            uint32_t firstChild;
+            uint32_t childCount;
+        };
+
+        template <typename T>
+        class Range
+        {
+        private:
+            const T* _begin;
+            const T* _end;
+
+        public:
+            Range(const T* begin, const T* end) : _begin(begin), _end(end) {}
+            const T* begin() const { return _begin; }
+            const T* end() const { return _end; }
+            std::size_t size() const { return _end - _begin; }
+        };
+
+        class ChildIterator
+        {
+        private:
+            const TdfDocument* document;
+            const uint32_t* it;
+
+        public:
+            ChildIterator(const TdfDocument* document, const uint32_t* it) : document(document), it(it) {}
+            const Block& operator*() const { return document->blocks[*it]; }
+            const Block* operator->() const { return &document->blocks[*it]; }
+            ChildIterator& operator++()
+            {
+                ++it;
+                return *this;
+            }
+            bool operator==(const ChildIterator& rhs) const { return it == rhs.it; }
+            bool operator!=(const ChildIterator& rhs) const { return it != rhs.it; }
+        };
+
+        class ChildRange
+        {
+        private:
+            ChildIterator _begin;
+            ChildIterator _end;
+
+        public:
+            ChildRange(const ChildIterator& begin, const ChildIterator& end) : _begin(begin), _end(end) {}
+            ChildIterator begin() const { return _begin; }
+            ChildIterator end() const { return _end; }
+        };
+
+    private:
+        friend class TdfDocumentParser;
+
+        TdfArena arena;
+
+        std::string_view source;
+
+        /** The root block is always at index 0. */
+        std::vector<Block> blocks;
+
+        std::vector<Property> properties;
+
+        /** Indices into blocks. */
+        std::vector<uint32_t> children;
+
+    public:
+        const Block& root() const;
+
+        Range<Property> getProperties(const Block& block) const;
+
+        ChildRange getChildren(const Block& block) const;
+
+        /**
+         * Finds the value of the property with the given name, ignoring case.
+         * If the property appears more than once, the last value wins.
+         */
+        std::optional<std::string_view> findValue(const Block& block, std::string_view name) const;
+
+        /**
+         * Finds the child block with the given name, ignoring case.
+         * If the block appears more than once, the last one wins.
+         */
+        const Block* findBlock(const Block& block, std::string_view name) const;
+    };
+
+    /**
+     * Parses TDF text into a document.
+     * The input must already be UTF-8 (or any ASCII-compatible encoding);
+     * the parser only looks at ASCII delimiters.
+     * Produces exactly the same names and values as TdfParser.
+     * Throws TdfParserException on malformed input.
+     */
+    TdfDocument parseTdfDocument(std::string_view input);
+
+    /**
+     * Replays a document through an adapter,
+     * for code written against the TdfParser callback interface.
+     * Properties and blocks are reported in the order they appeared in the source.
+     */
+    template <typename Result>
+    Result adaptTdfDocument(const TdfDocument& document, TdfAdapter<Result>& adapter);
+
+    template <typename Result>
+    void adaptTdfDocumentBlock(const TdfDocument& document, const TdfDocument::Block& block, TdfAdapter<Result>& adapter)
+    {
+        auto adaptChild = [&document, &adapter](const TdfDocument::Block& child) {
+            adapter.onStartBlock(std::string(child.name));
+            adaptTdfDocumentBlock(document, child, adapter);
+            adapter.onEndBlock();
+        };
+
+        auto children = document.getChildren(block);
+        auto childIt = children.begin();
+        uint32_t childIndex = 0;
+        for (const auto& property : document.getProperties(block))
+        {
+            for (; childIndex < property.precedingChildren; ++childIndex, ++childIt)
+            {
+                adaptChild(*childIt);
+            }
+
+            adapter.onProperty(std::string(property.name), std::string(property.value));
+        }
+
+        for (; childIt != children.end(); ++childIt)
+        {
+            adaptChild(*childIt);
+        }
+    }
+
+    template <typename Result>
+    Result adaptTdfDocument(const TdfDocument& document, TdfAdapter<Result>& adapter)
+    {
+        adapter.onStart();
+        adaptTdfDocumentBlock(document, document.root(), adapter);
+        return adapter.onDone();
+    }
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef RWE_TDFPARSER_H
 #define RWE_TDFPARSER_H
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <rwe/rwe_string.h>
@@ -101,6 +102,7 @@ namespace rwe
     {
     public:
         using Result = T;
+        virtual ~TdfAdapter() = default;
         virtual void onStart() = 0;
         virtual void onProperty(const std::string& name, const std::string& value) = 0;
         virtual void onStartBlock(const std::string& name) = 0;
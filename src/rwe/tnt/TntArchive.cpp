@@ -36,6 +36,17 @@ namespace rwe
         }
     }
 
+    void TntArchive::readTileData(char* outputBuffer)
+    {
+        stream->seekg(header.tileGraphicsOffset);
+        auto size = static_cast<std::streamsize>(header.numberOfTiles) * 32 * 32;
+        stream->read(outputBuffer, size);
+        if (stream->gcount() != size)
+        {
+            throw TntException("Tile data is truncated");
+        }
+    }
+
     void TntArchive::readFeatures(std::function<void(const std::string&)> featureCallback)
     {
         stream->seekg(header.featuresOffset);
@@ -99,6 +99,14 @@ namespace rwe
 
         void readTiles(std::function<void(const char*)> tileCallback);
 
+        /**
+         * Reads the graphics of every tile in one block.
+         * Tiles are stored one after another, each 32x32 palette indices in row order.
+         * The buffer must hold numberOfTiles * 32 * 32 bytes.
+         * Throws TntException if the archive ends before all the tiles are read.
+         */
+        void readTileData(char* outputBuffer);
+
         void readFeatures(std::function<void(const std::string&)> featureCallback);
 
         void readMapData(uint16_t* outputBuffer);
@@ -339,7 +339,7 @@ namespace rwe
         return listBox;
     }
 
-    std::optional<AudioService::SoundHandle> UiFactory::deduceButtonSound(const std::string& guiName, const GuiEntry& entry)
+    std::optional<SoundHandle> UiFactory::deduceButtonSound(const std::string& guiName, const GuiEntry& entry)
     {
         auto sound = getButtonSound(entry.common.name);
         if (!sound && (entry.common.name == "PrevMenu" || entry.common.name == "PREVMENU"))
@@ -414,7 +414,7 @@ namespace rwe
         return series;
     }
 
-    std::optional<AudioService::SoundHandle> UiFactory::getButtonSound(const std::string& buttonName)
+    std::optional<SoundHandle> UiFactory::getButtonSound(const std::string& buttonName)
     {
         auto soundBlock = soundLookup->findBlock(buttonName);
         if (!soundBlock)
@@ -48,9 +48,9 @@ namespace rwe
 
         std::shared_ptr<SpriteSeries> getDefaultButtonGraphics(const std::string& guiName, int width, int height);
 
-        std::optional<AudioService::SoundHandle> getButtonSound(const std::string& buttonName);
+        std::optional<SoundHandle> getButtonSound(const std::string& buttonName);
 
-        std::optional<AudioService::SoundHandle> deduceButtonSound(const std::string& guiName, const GuiEntry& entry);
+        std::optional<SoundHandle> deduceButtonSound(const std::string& guiName, const GuiEntry& entry);
 
         std::shared_ptr<SpriteSeries> getDefaultStagedButtonGraphics(const std::string& guiName, int stages);
 
@@ -0,0 +1,26 @@
+#ifndef RWE_VECTOR_UTIL_H
+#define RWE_VECTOR_UTIL_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace rwe
+{
+    /**
+     * Removes the element at the given index in constant time
+     * by moving the last element into its place.
+     * This does not preserve the order of the elements.
+     */
+    template <typename T>
+    void swapRemove(std::vector<T>& v, std::size_t index)
+    {
+        if (index != v.size() - 1)
+        {
+            v[index] = std::move(v.back());
+        }
+        v.pop_back();
+    }
+}
+
+#endif
@@ -7,6 +7,16 @@
 
 namespace rwe
 {
+    /**
+     * Read-only view of a collection of game data files.
+     *
+     * Thread safety: once constructed, implementations must allow
+     * readFile, getFileNames and getFileNamesRecursive to be called
+     * concurrently from any number of threads.
+     * Operations that change what the file system contains,
+     * such as CompositeVirtualFileSystem::emplaceFileSystem,
+     * must not run concurrently with any other call.
+     */
     class AbstractVirtualFileSystem
     {
     public:
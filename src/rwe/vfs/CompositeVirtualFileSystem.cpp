@@ -63,7 +63,7 @@ namespace rwe
         {
             const auto& e = *it;
             auto ext = e.path().extension().string();
-            if (toUpper(ext) == toUpper(extension))
+            if (equalsIgnoreCase(ext, extension))
             {
                 vfs.emplaceFileSystem<HpiFileSystem>(e.path().string());
             }
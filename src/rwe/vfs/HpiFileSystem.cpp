@@ -3,6 +3,20 @@
 
 namespace rwe
 {
+    namespace
+    {
+        std::unique_ptr<std::ifstream> openArchiveStream(const std::string& file)
+        {
+            auto stream = std::make_unique<std::ifstream>(file, std::ios::binary);
+            if (!stream->is_open())
+            {
+                throw std::runtime_error("Could not open file");
+            }
+
+            return stream;
+        }
+    }
+
     std::optional<std::vector<char>> HpiFileSystem::readFile(const std::string& filename) const
     {
         auto file = hpi.findFile(filename);
@@ -12,19 +26,46 @@ namespace rwe
         }
 
         std::vector<char> buffer(file->get().size);
-        hpi.extract(*file, buffer.data());
+
+        // If extraction throws, the stream is discarded rather than returned to the pool.
+        auto stream = acquireStream();
+        hpi.extract(*stream, *file, buffer.data());
+        releaseStream(std::move(stream));
 
         return buffer;
     }
 
     HpiFileSystem::HpiFileSystem(const std::string& file)
-        : stream(file, std::ios::binary),
-          hpi(&stream)
+        : HpiFileSystem(file, openArchiveStream(file))
+    {
+    }
+
+    HpiFileSystem::HpiFileSystem(const std::string& file, std::unique_ptr<std::ifstream>&& stream)
+        : path(file),
+          hpi(stream.get())
+    {
+        streamPool.push_back(std::move(stream));
+    }
+
+    std::unique_ptr<std::ifstream> HpiFileSystem::acquireStream() const
     {
-        if (!stream.is_open())
         {
-            throw std::runtime_error("Could not open file");
+            std::lock_guard<std::mutex> lock(streamPoolMutex);
+            if (!streamPool.empty())
+            {
+                auto stream = std::move(streamPool.back());
+                streamPool.pop_back();
+                return stream;
+            }
         }
+
+        return openArchiveStream(path);
+    }
+
+    void HpiFileSystem::releaseStream(std::unique_ptr<std::ifstream>&& stream) const
+    {
+        std::lock_guard<std::mutex> lock(streamPoolMutex);
+        streamPool.push_back(std::move(stream));
     }
 
     std::vector<std::string> HpiFileSystem::getFileNames(const std::string& directory, const std::string& extension)
@@ -59,7 +100,7 @@ namespace rwe
 
         for (const auto& e : directory.entries)
         {
-            if (endsWith(toUpper(e.name), toUpper(extension)))
+            if (endsWithIgnoreCase(e.name, extension))
             {
                 v.push_back(e.name);
             }
@@ -94,7 +135,7 @@ namespace rwe
 
     std::vector<std::string> HpiFileSystem::HpiRecursiveFilenamesVisitor::operator()(const HpiArchive::File& /*e*/) const
     {
-        return endsWith(toUpper(*name), toUpper(*extension)) ? std::vector<std::string>{*name} : std::vector<std::string>();
+        return endsWithIgnoreCase(*name, *extension) ? std::vector<std::string>{*name} : std::vector<std::string>();
     }
 
     std::vector<std::string>
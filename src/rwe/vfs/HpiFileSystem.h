@@ -2,6 +2,8 @@
 #define RWE_HPIFILESYSTEM_H
 
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <rwe/Hpi.h>
 #include <rwe/vfs/AbstractVirtualFileSystem.h>
 
@@ -26,9 +28,18 @@ namespace rwe
         };
 
     private:
-        std::ifstream stream;
+        std::string path;
         HpiArchive hpi;
 
+        /**
+         * Pool of idle streams open on the archive.
+         * Each readFile call takes a stream from the pool
+         * (or opens a new one if the pool is empty)
+         * so that concurrent reads never share stream state.
+         */
+        mutable std::mutex streamPoolMutex;
+        mutable std::vector<std::unique_ptr<std::ifstream>> streamPool;
+
     public:
         explicit HpiFileSystem(const std::string& file);
         std::optional<std::vector<char>> readFile(const std::string& filename) const override;
@@ -39,6 +50,11 @@ namespace rwe
         getFileNamesRecursive(const std::string& directory, const std::string& extension) override;
 
     private:
+        HpiFileSystem(const std::string& file, std::unique_ptr<std::ifstream>&& stream);
+
+        std::unique_ptr<std::ifstream> acquireStream() const;
+        void releaseStream(std::unique_ptr<std::ifstream>&& stream) const;
+
         std::vector<std::string> getFileNamesInternal(const HpiArchive::Directory& directory, const std::string& extension);
         std::vector<std::string> getFileNamesRecursiveInternal(const HpiArchive::Directory& directory, const std::string& extension);
     };
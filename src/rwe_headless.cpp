@@ -0,0 +1,536 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <rwe/ColorPalette.h>
+#include <rwe/GameSimulationDriver.h>
+#include <rwe/MapFeatureService.h>
+#include <rwe/MapLoader.h>
+#include <rwe/MeshService.h>
+#include <rwe/MovementClassCollisionService.h>
+#include <rwe/Replay.h>
+#include <rwe/ReplayPlayer.h>
+#include <rwe/SideData.h>
+#include <rwe/SimulationChecksum.h>
+#include <rwe/SimulationScript.h>
+#include <rwe/SimulationSnapshot.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/UnitDatabaseLoader.h>
+#include <rwe/UnitFactory.h>
+#include <rwe/rwe_string.h>
+#include <rwe/tdf.h>
+#include <rwe/vfs/CompositeVirtualFileSystem.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef RWE_HEADLESS_NETWORK
+#include <rwe/LockstepGameDriver.h>
+#include <rwe/SdlContextManager.h>
+#endif
+
+namespace rwe
+{
+    namespace
+    {
+        ColorPalette loadPalette(const AbstractVirtualFileSystem& vfs, const std::string& path)
+        {
+            auto bytes = vfs.readFile(path);
+            if (!bytes)
+            {
+                throw std::runtime_error("Couldn't find palette: " + path);
+            }
+
+            auto palette = readPalette(*bytes);
+            if (!palette)
+            {
+                throw std::runtime_error("Couldn't read palette: " + path);
+            }
+
+            return std::move(*palette);
+        }
+
+        CaseInsensitiveMap<SideData> loadSideData(const AbstractVirtualFileSystem& vfs)
+        {
+            auto bytes = vfs.readFile("gamedata/SIDEDATA.TDF");
+            if (!bytes)
+            {
+                throw std::runtime_error("Missing side data");
+            }
+
+            std::string sideDataString(bytes->data(), bytes->size());
+            CaseInsensitiveMap<SideData> sideDataMap;
+            for (auto& side : parseSidesFromSideData(parseTdfFromString(sideDataString)))
+            {
+                std::string name = side.name;
+                sideDataMap.insert({std::move(name), std::move(side)});
+            }
+
+            return sideDataMap;
+        }
+
+        std::vector<SimulationScriptEntry> loadScript(const std::string& path)
+        {
+            std::ifstream input(path);
+            if (!input)
+            {
+                throw std::runtime_error("Couldn't open script: " + path);
+            }
+
+            return parseSimulationScript(input);
+        }
+
+        class PrintWinStatusVisitor : public boost::static_visitor<>
+        {
+        public:
+            void operator()(const WinStatusWon& s) const
+            {
+                std::cout << "Player " << s.winner.value << " won" << std::endl;
+            }
+
+            void operator()(const WinStatusDraw&) const
+            {
+                std::cout << "The game was a draw" << std::endl;
+            }
+
+            void operator()(const WinStatusUndecided&) const
+            {
+                std::cout << "The game is undecided" << std::endl;
+            }
+        };
+
+        struct HeadlessOptions
+        {
+            bool checkDeterminism{false};
+            bool benchmarkSnapshots{false};
+
+            /** If set, the game is played in lockstep with peers instead of from the script alone. */
+            std::optional<NetworkParameters> network;
+        };
+
+        /** How often the snapshot benchmark takes a snapshot, once a second of game time. */
+        const unsigned int SnapshotBenchmarkInterval = 60;
+
+        /** Running totals of the snapshots taken and restored by the snapshot benchmark. */
+        struct SnapshotBenchmark
+        {
+            unsigned int count{0};
+            std::size_t totalBytes{0};
+            std::size_t maxBytes{0};
+            double totalTakeMicroseconds{0.0};
+            double totalRestoreMicroseconds{0.0};
+
+            /**
+             * Takes a snapshot of the game and restores it straight back, timing both.
+             * Returns false if the restore did not reproduce the state exactly.
+             */
+            bool measure(GameSimulationDriver& driver, SimulationSnapshot& snapshot)
+            {
+                auto checksum = computeSimulationChecksum(driver.getSimulation());
+
+                auto takeStart = std::chrono::steady_clock::now();
+                driver.takeSnapshot(snapshot);
+                auto takeEnd = std::chrono::steady_clock::now();
+                driver.restoreSnapshot(snapshot);
+                auto restoreEnd = std::chrono::steady_clock::now();
+
+                ++count;
+                totalBytes += snapshot.size();
+                maxBytes = std::max(maxBytes, snapshot.size());
+                totalTakeMicroseconds += std::chrono::duration<double, std::micro>(takeEnd - takeStart).count();
+                totalRestoreMicroseconds += std::chrono::duration<double, std::micro>(restoreEnd - takeEnd).count();
+
+                return computeSimulationChecksum(driver.getSimulation()) == checksum;
+            }
+
+            void print() const
+            {
+                if (count == 0)
+                {
+                    std::cout << "No snapshots taken" << std::endl;
+                    return;
+                }
+
+                std::cout << "Snapshots: " << count << " taken, "
+                          << (totalBytes / count) << " bytes average, " << maxBytes << " bytes max, "
+                          << (totalTakeMicroseconds / count) << " us to take, "
+                          << (totalRestoreMicroseconds / count) << " us to restore" << std::endl;
+            }
+        };
+
+#ifdef RWE_HEADLESS_NETWORK
+        /** How long a networked game waits without progress before giving up on its peers. */
+        const uint32_t LockstepPeerTimeout = 10000;
+
+        /** How long a networked game keeps answering its peers after reaching the end, so that they can finish too. */
+        const uint32_t LockstepLingerTime = 2000;
+
+        /**
+         * Plays the game in lockstep with peers over UDP, in real time at the game's tick rate.
+         *
+         * This process gives the commands of the replay as if its player were giving them,
+         * each one once the game reaches its time, so they take effect after the input delay.
+         * Each peer runs its own copy of this program with the same map, length and slot layout,
+         * giving the commands of its own player, and every copy should finish with the same checksum.
+         * Peers only accept orders to units the player owns, so spawn commands in the replay are dropped.
+         */
+        int runLockstep(
+            GameSimulationDriver& driver,
+            const Replay& replay,
+            const NetworkParameters& network,
+            const std::array<std::optional<PlayerId>, 10>& gamePlayers)
+        {
+            SdlNetContext sdlNet;
+
+            const auto& simulation = driver.getSimulation();
+
+            LockstepGameDriver lockstep(&driver, nullptr, network, gamePlayers, replay.parameters.seed);
+            lockstep.stopAt(replay.endTime);
+
+            auto clockStart = std::chrono::steady_clock::now();
+            auto getTicks = [clockStart]() {
+                return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - clockStart).count());
+            };
+
+            std::size_t nextCommand = 0;
+            uint32_t nextUpdateTime = 0;
+            uint32_t lastProgressTime = 0;
+            std::optional<uint32_t> finishTime;
+            while (true)
+            {
+                auto now = getTicks();
+                if (now < nextUpdateTime)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(nextUpdateTime - now));
+                    continue;
+                }
+                nextUpdateTime += TickInterval;
+
+                while (nextCommand < replay.commands.size() && replay.commands[nextCommand].time.value <= simulation.gameTime.value)
+                {
+                    lockstep.submit(replay.commands[nextCommand].command);
+                    ++nextCommand;
+                }
+
+                lockstep.receivePackets();
+                auto ticksRun = lockstep.update(now);
+                lockstep.sendPackets();
+                if (ticksRun > 0)
+                {
+                    lastProgressTime = now;
+                }
+
+                if (simulation.gameTime.value >= replay.endTime.value)
+                {
+                    if (!finishTime)
+                    {
+                        finishTime = now;
+                    }
+                    if (now - *finishTime >= LockstepLingerTime)
+                    {
+                        break;
+                    }
+                }
+                else if (now - lastProgressTime >= LockstepPeerTimeout)
+                {
+                    std::cout << "Timed out waiting for peers at tick " << simulation.gameTime.value << std::endl;
+                    return 4;
+                }
+            }
+
+            const auto& session = lockstep.getSession();
+            std::cout << "Ran " << simulation.gameTime.value << " ticks in " << *finishTime << " ms, "
+                      << "stalled for " << lockstep.getStalledUpdates() << " ticks, "
+                      << "final input delay " << lockstep.getInputDelay() << " ticks" << std::endl;
+            for (std::size_t i = 0; i < session.getPeerCount(); ++i)
+            {
+                auto roundTripTime = session.getRoundTripTime(i);
+                std::cout << "Peer for slot " << session.getPeerSlot(i) << ": ";
+                if (roundTripTime)
+                {
+                    std::cout << *roundTripTime << " ms round trip" << std::endl;
+                }
+                else
+                {
+                    std::cout << "round trip not measured" << std::endl;
+                }
+            }
+            std::cout << "Units remaining: " << simulation.units.size() << std::endl;
+            std::cout << "Final checksum: " << std::hex << std::setw(16) << std::setfill('0') << computeSimulationChecksum(simulation) << std::dec << std::endl;
+            boost::apply_visitor(PrintWinStatusVisitor(), simulation.computeWinStatus());
+
+            if (auto desyncTime = session.getDesyncTime())
+            {
+                std::cout << "Peers fell out of sync at tick " << desyncTime->value << std::endl;
+                return 2;
+            }
+
+            return 0;
+        }
+
+#endif
+
+        /**
+         * Adds the players and spawns their commanders, as LoadingScene does for a real game.
+         * Returns the ID given to the player in each slot.
+         */
+        std::array<std::optional<PlayerId>, 10> setUpGame(GameSimulationDriver& driver, const OtaRecord& ota, const GameParameters& parameters, const CaseInsensitiveMap<SideData>& sides)
+        {
+            auto& simulation = driver.getSimulation();
+            auto gamePlayers = addGamePlayers(simulation, parameters);
+            for (unsigned int i = 0; i < parameters.players.size(); ++i)
+            {
+                const auto& player = parameters.players[i];
+                if (!player)
+                {
+                    continue;
+                }
+
+                auto sideIt = sides.find(player->side);
+                if (sideIt == sides.end())
+                {
+                    throw std::runtime_error("Missing side data for " + player->side);
+                }
+
+                auto startPos = MapLoader::getStartPosition(simulation.terrain, ota, parameters.schemaIndex, i);
+                if (!driver.spawnUnit(sideIt->second.commander, *gamePlayers[i], startPos))
+                {
+                    throw std::runtime_error("Failed to spawn commander for side " + player->side);
+                }
+            }
+
+            return gamePlayers;
+        }
+
+        /**
+         * Plays a replay with no window, sound or rendering,
+         * advancing the simulation as fast as possible.
+         *
+         * With checkDeterminism, a second copy of the game is run alongside the first
+         * and their checksums are compared after every tick.
+         * The run stops at the first tick where they differ
+         * and reports the part of the state that diverged.
+         *
+         * With benchmarkSnapshots, the first copy of the game is snapshotted
+         * and restored from the snapshot once a second of game time,
+         * and the size of the snapshots and the time taken are reported.
+         * The run stops if restoring a snapshot changes the state.
+         *
+         * With network parameters, the game is instead played in lockstep with peers
+         * in real time, see runLockstep.
+         * Networked play is only built into rwe_headless_net,
+         * so that plain rwe_headless does not depend on SDL.
+         */
+        int runHeadless(const std::string& searchPath, const Replay& replay, const HeadlessOptions& options)
+        {
+            const auto& parameters = replay.parameters;
+
+            auto vfs = constructVfs(searchPath);
+            auto palette = loadPalette(vfs, "palettes/PALETTE.PAL");
+            auto guiPalette = loadPalette(vfs, "palettes/GUIPAL.PAL");
+            auto sides = loadSideData(vfs);
+
+            MapFeatureService featureService(&vfs);
+            featureService.loadAllFeatureDefinitions();
+
+            ThreadPool threadPool(defaultThreadCount());
+
+            auto loadStart = std::chrono::steady_clock::now();
+
+            MapLoader mapLoader(&vfs, &featureService, nullptr, nullptr, &palette, &threadPool);
+            auto ota = mapLoader.loadOta(parameters.mapName);
+
+            std::vector<std::unique_ptr<GameSimulation>> simulations;
+            for (int i = 0; i < (options.checkDeterminism ? 2 : 1); ++i)
+            {
+                simulations.push_back(std::make_unique<GameSimulation>(
+                    mapLoader.createInitialSimulation(parameters.mapName, ota, parameters.schemaIndex, parameters.seed)));
+            }
+
+            auto unitDatabase = UnitDatabaseLoader(&vfs, nullptr, &threadPool, nullptr).createUnitDatabase();
+
+            // The map is the same for every copy of the game, so they can share walkable grids.
+            auto collisionService = createMovementClassCollisionService(*simulations.front(), unitDatabase);
+            auto meshService = MeshService::createMeshService(&vfs, nullptr, &palette, &threadPool);
+
+            UnitFactory unitFactory(nullptr, std::move(unitDatabase), std::move(meshService), &collisionService, &palette, &guiPalette);
+
+            std::vector<std::unique_ptr<GameSimulationDriver>> drivers;
+            std::vector<ReplayPlayer> players;
+            std::array<std::optional<PlayerId>, 10> gamePlayers;
+            for (auto& simulation : simulations)
+            {
+                drivers.push_back(std::make_unique<GameSimulationDriver>(simulation.get(), &collisionService, &unitFactory, nullptr, nullptr));
+                gamePlayers = setUpGame(*drivers.back(), ota, parameters, sides);
+                players.emplace_back(drivers.back().get(), &replay);
+            }
+
+            auto loadEnd = std::chrono::steady_clock::now();
+            std::cout << "Loaded in " << std::chrono::duration<double, std::milli>(loadEnd - loadStart).count() << " ms" << std::endl;
+
+#ifdef RWE_HEADLESS_NETWORK
+            if (options.network)
+            {
+                return runLockstep(*drivers.front(), replay, *options.network, gamePlayers);
+            }
+#endif
+
+            SimulationSnapshot snapshot;
+            SnapshotBenchmark snapshotBenchmark;
+
+            auto start = std::chrono::steady_clock::now();
+            while (!players.front().isFinished())
+            {
+                for (auto& player : players)
+                {
+                    player.step();
+                }
+
+                if (options.benchmarkSnapshots && simulations[0]->gameTime.value % SnapshotBenchmarkInterval == 0)
+                {
+                    if (!snapshotBenchmark.measure(*drivers.front(), snapshot))
+                    {
+                        std::cout << "Restoring a snapshot changed the simulation at tick " << simulations[0]->gameTime.value << std::endl;
+                        return 3;
+                    }
+                }
+
+                if (options.checkDeterminism && computeSimulationChecksum(*simulations[0]) != computeSimulationChecksum(*simulations[1]))
+                {
+                    auto field = findFirstDifference(describeSimulationState(*simulations[0]), describeSimulationState(*simulations[1]));
+                    std::cout << "Simulations diverged at tick " << simulations[0]->gameTime.value
+                              << " in " << field.value_or("unknown field") << std::endl;
+                    return 2;
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            const auto& simulation = *simulations.front();
+            auto tickCount = simulation.gameTime.value;
+
+            auto seconds = std::chrono::duration<double>(end - start).count();
+            std::cout << "Ran " << tickCount << " ticks in " << (seconds * 1000.0) << " ms ("
+                      << (seconds > 0.0 ? static_cast<double>(tickCount * drivers.size()) / seconds : 0.0) << " ticks/sec)" << std::endl;
+            std::cout << "Units remaining: " << simulation.units.size() << std::endl;
+            std::cout << "Final checksum: " << std::hex << std::setw(16) << std::setfill('0') << computeSimulationChecksum(simulation) << std::dec << std::endl;
+            boost::apply_visitor(PrintWinStatusVisitor(), simulation.computeWinStatus());
+
+            if (options.benchmarkSnapshots)
+            {
+                snapshotBenchmark.print();
+            }
+
+            return 0;
+        }
+
+        /** Creates a game of one commander per side, run for the given number of ticks with the given script. */
+        Replay createScriptedGame(
+            const std::string& mapName,
+            unsigned int tickCount,
+            std::vector<SimulationScriptEntry>&& script)
+        {
+            GameParameters parameters(mapName, 0);
+            parameters.players[0] = PlayerInfo{PlayerInfo::Controller::Computer, "ARM", 0};
+            parameters.players[1] = PlayerInfo{PlayerInfo::Controller::Computer, "CORE", 1};
+
+            Replay replay(parameters);
+            replay.commands = std::move(script);
+            replay.endTime = GameTime(tickCount);
+            return replay;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    rwe::HeadlessOptions options;
+    std::vector<rwe::NetworkPeer> peers;
+    while (!args.empty())
+    {
+        if (args.front() == "--check-determinism")
+        {
+            options.checkDeterminism = true;
+        }
+        else if (args.front() == "--benchmark-snapshots")
+        {
+            options.benchmarkSnapshots = true;
+        }
+#ifdef RWE_HEADLESS_NETWORK
+        else if (args.size() >= 2 && args.front() == "--net")
+        {
+            args.erase(args.begin());
+            options.network = rwe::parseNetworkLocal(args.front());
+        }
+        else if (args.size() >= 2 && args.front() == "--peer")
+        {
+            args.erase(args.begin());
+            peers.push_back(rwe::parseNetworkPeer(args.front()));
+        }
+#endif
+        else
+        {
+            break;
+        }
+        args.erase(args.begin());
+    }
+
+    try
+    {
+        if (options.network)
+        {
+            options.network->peers = std::move(peers);
+            if (options.checkDeterminism || options.benchmarkSnapshots)
+            {
+                std::cerr << "A networked game cannot also check determinism or benchmark snapshots" << std::endl;
+                return 1;
+            }
+        }
+        else if (!peers.empty())
+        {
+            std::cerr << "--peer needs --net" << std::endl;
+            return 1;
+        }
+
+        if (args.size() == 3 && args[0] == "--replay")
+        {
+            auto replay = rwe::readReplay(args[2]);
+            return rwe::runHeadless(args[1], replay, options);
+        }
+
+        if (args.size() < 3 || args.size() > 4)
+        {
+            std::cerr << "Usage: " << argv[0] << " [--check-determinism] [--benchmark-snapshots] <search path> <map> <ticks> [script]" << std::endl;
+            std::cerr << "       " << argv[0] << " [--check-determinism] [--benchmark-snapshots] --replay <search path> <replay file>" << std::endl;
+#ifdef RWE_HEADLESS_NETWORK
+            std::cerr << "       " << argv[0] << " --net <slot>:<port> --peer <slot>:<host>:<port>... <search path> <map> <ticks> [script]" << std::endl;
+#endif
+            return 1;
+        }
+
+        auto tickCount = static_cast<unsigned int>(std::stoul(args[2]));
+
+        std::vector<rwe::SimulationScriptEntry> script;
+        if (args.size() == 4)
+        {
+            script = rwe::loadScript(args[3]);
+        }
+
+        auto game = rwe::createScriptedGame(args[1], tickCount, std::move(script));
+        game.parameters.network = options.network;
+        rwe::assignNetworkControllers(game.parameters);
+        rwe::checkNetworkParameters(game.parameters);
+
+        return rwe::runHeadless(args[0], game, options);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <rwe/CompiledUnitDatabase.h>
+#include <rwe/ThreadPool.h>
+#include <rwe/vfs/CompositeVirtualFileSystem.h>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Specify a search path and output file" << std::endl;
+        return 1;
+    }
+
+    std::string searchPath(argv[1]);
+    std::string outputPath(argv[2]);
+
+    auto vfs = rwe::constructVfs(searchPath);
+    rwe::ThreadPool threadPool(rwe::defaultThreadCount());
+
+    auto fingerprint = rwe::computeDataFingerprint(searchPath);
+    auto db = rwe::compileUnitDatabase(vfs, threadPool);
+    rwe::writeCompiledUnitDatabase(outputPath, fingerprint, db);
+
+    std::cout << "Sound classes: " << db.soundClasses.size() << std::endl;
+    std::cout << "Movement classes: " << db.movementClasses.size() << std::endl;
+    std::cout << "Weapons: " << db.weapons.size() << std::endl;
+    std::cout << "Units: " << db.units.size() << std::endl;
+    std::cout << "Scripts: " << db.scripts.size() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <catch.hpp>
+#include <cmath>
+#include <rwe/BinaryReader.h>
+#include <rwe/BinaryWriter.h>
+#include <stdexcept>
+#include <vector>
+
+namespace rwe
+{
+    namespace
+    {
+        class TestReadException : public std::runtime_error
+        {
+        public:
+            explicit TestReadException(const char* message) : std::runtime_error(message) {}
+        };
+    }
+
+    TEST_CASE("BinaryWriter/BinaryReader")
+    {
+        std::vector<char> buffer;
+        BinaryWriter w(&buffer);
+
+        SECTION("round-trips numbers, strings and bytes")
+        {
+            w.write(static_cast<uint8_t>(200));
+            w.write(static_cast<uint16_t>(0xbeef));
+            w.write(static_cast<uint32_t>(0xdeadbeef));
+            w.write(static_cast<uint64_t>(0x0123456789abcdefull));
+            w.write(-5);
+            w.write(-0.0f);
+            w.write(2.5);
+            w.write(true);
+            w.writeString("hello");
+            const char bytes[] = {1, 2, 3};
+            w.writeBytes(bytes, sizeof(bytes));
+
+            BinaryReader<TestReadException> r(buffer.data(), buffer.data() + buffer.size(), "truncated");
+            REQUIRE(r.read<uint8_t>() == 200);
+            REQUIRE(r.read<uint16_t>() == 0xbeef);
+            REQUIRE(r.read<uint32_t>() == 0xdeadbeef);
+            REQUIRE(r.read<uint64_t>() == 0x0123456789abcdefull);
+            REQUIRE(r.read<int>() == -5);
+            auto f = r.read<float>();
+            REQUIRE(f == 0.0f);
+            REQUIRE(std::signbit(f));
+            REQUIRE(r.read<double>() == 2.5);
+            REQUIRE(r.read<bool>());
+            REQUIRE(r.readString() == "hello");
+            std::vector<char> readBytes(3);
+            r.readBytes(readBytes.data(), readBytes.size());
+            std::vector<char> expectedBytes{1, 2, 3};
+            REQUIRE(readBytes == expectedBytes);
+            REQUIRE(r.atEnd());
+        }
+
+        SECTION("writes numbers little-endian")
+        {
+            w.write(static_cast<uint32_t>(0x04030201));
+            std::vector<char> expected{1, 2, 3, 4};
+            REQUIRE(buffer == expected);
+        }
+
+        SECTION("throws the given exception when reading past the end")
+        {
+            w.write(static_cast<uint16_t>(1));
+            BinaryReader<TestReadException> r(buffer.data(), buffer.data() + buffer.size(), "truncated");
+            REQUIRE_THROWS_AS(r.read<uint32_t>(), const TestReadException&);
+        }
+
+        SECTION("rejects sizes the rest of the buffer cannot hold")
+        {
+            w.writeSize(3);
+            w.write(static_cast<uint32_t>(0));
+            w.write(static_cast<uint32_t>(0));
+
+            BinaryReader<TestReadException> r(buffer.data(), buffer.data() + buffer.size(), "truncated");
+            REQUIRE_THROWS_AS(r.readSize(sizeof(uint32_t)), const TestReadException&);
+        }
+
+        SECTION("rejects strings longer than the rest of the buffer")
+        {
+            w.writeSize(10);
+            w.writeBytes("abc", 3);
+
+            BinaryReader<TestReadException> r(buffer.data(), buffer.data() + buffer.size(), "truncated");
+            REQUIRE_THROWS_AS(r.readString(), const TestReadException&);
+        }
+    }
+}
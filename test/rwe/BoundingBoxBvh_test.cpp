@@ -0,0 +1,144 @@
+#include <catch.hpp>
+#include <rwe/BoundingBoxBvh.h>
+
+namespace rwe
+{
+    namespace
+    {
+        std::optional<int> bruteForceFirstHit(const std::vector<BoundingBoxBvh<int>::Entry>& entries, const Line3f& line)
+        {
+            std::optional<int> best;
+            float bestT = 2.0f;
+            for (const auto& e : entries)
+            {
+                auto t = e.box.intersectLine(line);
+                if (t && *t < bestT)
+                {
+                    bestT = *t;
+                    best = e.value;
+                }
+            }
+            return best;
+        }
+    }
+
+    TEST_CASE("BoundingBoxBvh")
+    {
+        // a row of unit cubes along the X axis, one every 10 units
+        std::vector<BoundingBoxBvh<int>::Entry> entries;
+        for (int i = 0; i < 20; ++i)
+        {
+            auto x = static_cast<float>(i * 10);
+            entries.push_back(BoundingBoxBvh<int>::Entry{i, BoundingBox3f(Vector3f(x, 0.0f, 0.0f), Vector3f(1.0f, 1.0f, 1.0f))});
+        }
+
+        BoundingBoxBvh<int> bvh;
+        bvh.build(entries);
+
+        auto boxNarrowphase = [&entries](const Line3f& line) {
+            return [&entries, line](int value) { return entries[value].box.intersectLine(line); };
+        };
+
+        SECTION("finds nothing when empty")
+        {
+            BoundingBoxBvh<int> empty;
+            Line3f line(Vector3f(0.0f, 10.0f, 0.0f), Vector3f(0.0f, -10.0f, 0.0f));
+            REQUIRE(!empty.intersectLine(line, [](int) { return std::optional<float>(0.0f); }));
+        }
+
+        SECTION("finds the nearest box along the line")
+        {
+            Line3f line(Vector3f(-50.0f, 0.0f, 0.0f), Vector3f(500.0f, 0.0f, 0.0f));
+            REQUIRE(bvh.intersectLine(line, boxNarrowphase(line)) == std::optional<int>(0));
+
+            Line3f reverse(Vector3f(500.0f, 0.0f, 0.0f), Vector3f(-50.0f, 0.0f, 0.0f));
+            REQUIRE(bvh.intersectLine(reverse, boxNarrowphase(reverse)) == std::optional<int>(19));
+        }
+
+        SECTION("finds a box hit from above")
+        {
+            Line3f line(Vector3f(70.5f, 10.0f, 0.5f), Vector3f(70.5f, -10.0f, 0.5f));
+            REQUIRE(bvh.intersectLine(line, boxNarrowphase(line)) == std::optional<int>(7));
+        }
+
+        SECTION("finds nothing when the line passes between boxes")
+        {
+            Line3f line(Vector3f(75.0f, 10.0f, 0.0f), Vector3f(75.0f, -10.0f, 0.0f));
+            REQUIRE(!bvh.intersectLine(line, boxNarrowphase(line)));
+        }
+
+        SECTION("skips boxes rejected by the narrowphase")
+        {
+            Line3f line(Vector3f(-50.0f, 0.0f, 0.0f), Vector3f(500.0f, 0.0f, 0.0f));
+            auto result = bvh.intersectLine(line, [&entries, &line](int value) -> std::optional<float> {
+                if (value < 5)
+                {
+                    return std::nullopt;
+                }
+                return entries[value].box.intersectLine(line);
+            });
+            REQUIRE(result == std::optional<int>(5));
+        }
+
+        SECTION("agrees with brute force after refitting")
+        {
+            for (auto& e : entries)
+            {
+                // shuffle the boxes around so that the tree is no longer tight
+                auto x = static_cast<float>((e.value * 37) % 200);
+                auto z = static_cast<float>((e.value * 53) % 40);
+                e.box = BoundingBox3f(Vector3f(x, 0.0f, z), Vector3f(2.0f, 1.0f, 2.0f));
+            }
+
+            std::vector<BoundingBox3f> boxes;
+            for (const auto& e : entries)
+            {
+                boxes.push_back(e.box);
+            }
+            bvh.refit(boxes);
+
+            for (int i = 0; i < 40; ++i)
+            {
+                auto z = static_cast<float>(i);
+                Line3f line(Vector3f(-10.0f, 0.5f, z), Vector3f(210.0f, 0.5f, z));
+                REQUIRE(bvh.intersectLine(line, boxNarrowphase(line)) == bruteForceFirstHit(entries, line));
+
+                Line3f diagonal(Vector3f(-10.0f, 5.0f, z), Vector3f(210.0f, -5.0f, 40.0f - z));
+                REQUIRE(bvh.intersectLine(diagonal, boxNarrowphase(diagonal)) == bruteForceFirstHit(entries, diagonal));
+            }
+        }
+
+        SECTION("refit moves only the objects that moved")
+        {
+            // move one cube off the end of the row
+            entries[3].box = BoundingBox3f(Vector3f(300.0f, 0.0f, 0.0f), Vector3f(1.0f, 1.0f, 1.0f));
+
+            std::vector<BoundingBox3f> boxes;
+            for (const auto& e : entries)
+            {
+                boxes.push_back(e.box);
+            }
+            bvh.refit(boxes);
+
+            Line3f oldPlace(Vector3f(30.5f, 10.0f, 0.5f), Vector3f(30.5f, -10.0f, 0.5f));
+            REQUIRE(!bvh.intersectLine(oldPlace, boxNarrowphase(oldPlace)));
+
+            Line3f newPlace(Vector3f(300.5f, 10.0f, 0.5f), Vector3f(300.5f, -10.0f, 0.5f));
+            REQUIRE(bvh.intersectLine(newPlace, boxNarrowphase(newPlace)) == std::optional<int>(3));
+
+            Line3f reverse(Vector3f(500.0f, 0.0f, 0.0f), Vector3f(-50.0f, 0.0f, 0.0f));
+            REQUIRE(bvh.intersectLine(reverse, boxNarrowphase(reverse)) == std::optional<int>(3));
+
+            Line3f unmoved(Vector3f(40.5f, 10.0f, 0.5f), Vector3f(40.5f, -10.0f, 0.5f));
+            REQUIRE(bvh.intersectLine(unmoved, boxNarrowphase(unmoved)) == std::optional<int>(4));
+        }
+
+        SECTION("clear empties the tree")
+        {
+            bvh.clear();
+            REQUIRE(bvh.size() == 0);
+            Line3f line(Vector3f(-50.0f, 0.0f, 0.0f), Vector3f(500.0f, 0.0f, 0.0f));
+            REQUIRE(!bvh.intersectLine(line, boxNarrowphase(line)));
+        }
+    }
+}
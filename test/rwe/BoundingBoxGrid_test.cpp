@@ -0,0 +1,89 @@
+#include <catch.hpp>
+#include <rwe/BoundingBoxGrid.h>
+
+namespace rwe
+{
+    TEST_CASE("BoundingBoxGrid")
+    {
+        BoundingBoxGrid<int> grid(-100.0f, -100.0f, 200.0f, 200.0f, 20.0f);
+
+        // a small box in one cell
+        grid.insert(1, BoundingBox3f::fromMinMax(Vector3f(2.0f, 0.0f, 2.0f), Vector3f(6.0f, 10.0f, 6.0f)));
+
+        // a wide box spanning several cells
+        grid.insert(2, BoundingBox3f::fromMinMax(Vector3f(-50.0f, 0.0f, -50.0f), Vector3f(-10.0f, 10.0f, -30.0f)));
+
+        // a box hanging off the edge of the grid
+        grid.insert(3, BoundingBox3f::fromMinMax(Vector3f(90.0f, 0.0f, 90.0f), Vector3f(130.0f, 10.0f, 130.0f)));
+
+        grid.build();
+
+        SECTION("forEachInArea reports every overlapping box exactly once")
+        {
+            std::vector<int> found;
+            grid.forEachInArea(-100.0f, -100.0f, 100.0f, 100.0f, [&found](const auto& e) { found.push_back(e.value); });
+            std::sort(found.begin(), found.end());
+            REQUIRE(found == std::vector<int>({1, 2, 3}));
+        }
+
+        SECTION("forEachInArea skips boxes outside the area")
+        {
+            std::vector<int> found;
+            grid.forEachInArea(-45.0f, -45.0f, 4.0f, 4.0f, [&found](const auto& e) { found.push_back(e.value); });
+            std::sort(found.begin(), found.end());
+            REQUIRE(found == std::vector<int>({1, 2}));
+
+            found.clear();
+            grid.forEachInArea(10.0f, 10.0f, 80.0f, 80.0f, [&found](const auto& e) { found.push_back(e.value); });
+            REQUIRE(found.empty());
+        }
+
+        SECTION("forEachInArea finds boxes outside the grid area")
+        {
+            std::vector<int> found;
+            grid.forEachInArea(120.0f, 120.0f, 125.0f, 125.0f, [&found](const auto& e) { found.push_back(e.value); });
+            REQUIRE(found == std::vector<int>({3}));
+        }
+
+        SECTION("intersectLine finds the first box hit")
+        {
+            Line3f line(Vector3f(-60.0f, 5.0f, -40.0f), Vector3f(4.0f, 5.0f, 4.0f));
+            auto hit = grid.intersectLine(line, [](int) { return true; });
+            REQUIRE(hit);
+            REQUIRE(hit->value == 2);
+            REQUIRE(hit->t == Approx(10.0f / 64.0f));
+        }
+
+        SECTION("intersectLine skips boxes rejected by the predicate")
+        {
+            Line3f line(Vector3f(-60.0f, 5.0f, -40.0f), Vector3f(4.0f, 5.0f, 4.0f));
+            auto hit = grid.intersectLine(line, [](int v) { return v != 2; });
+            REQUIRE(hit);
+            REQUIRE(hit->value == 1);
+        }
+
+        SECTION("intersectLine does not tunnel through thin boxes")
+        {
+            Line3f line(Vector3f(0.0f, 5.0f, 4.0f), Vector3f(80.0f, 5.0f, 4.0f));
+            auto hit = grid.intersectLine(line, [](int) { return true; });
+            REQUIRE(hit);
+            REQUIRE(hit->value == 1);
+            REQUIRE(hit->t == Approx(2.0f / 80.0f));
+        }
+
+        SECTION("intersectLine misses when passing over boxes")
+        {
+            Line3f line(Vector3f(-60.0f, 15.0f, -40.0f), Vector3f(4.0f, 15.0f, 4.0f));
+            REQUIRE(!grid.intersectLine(line, [](int) { return true; }));
+        }
+
+        SECTION("clear empties the grid")
+        {
+            grid.clear();
+            grid.build();
+            std::vector<int> found;
+            grid.forEachInArea(-100.0f, -100.0f, 100.0f, 100.0f, [&found](const auto& e) { found.push_back(e.value); });
+            REQUIRE(found.empty());
+        }
+    }
+}
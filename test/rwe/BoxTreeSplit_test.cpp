@@ -49,6 +49,55 @@ namespace rwe
                 REQUIRE(output.width == 8);
                 REQUIRE(output.height == 8);
             }
+
+            SECTION("packs many power-of-two items without gaps")
+            {
+                std::vector<Grid<int>> v;
+                for (int i = 0; i < 16; ++i)
+                {
+                    v.emplace_back(4, 4);
+                }
+                v.emplace_back(8, 8);
+                v.emplace_back(8, 8);
+                v.emplace_back(8, 8);
+                v.emplace_back(8, 8);
+
+                std::vector<Grid<int>*> vec;
+                for (auto& e : v)
+                {
+                    vec.push_back(&e);
+                }
+
+                auto output = packGrids(vec);
+
+                REQUIRE(output.width * output.height == 512);
+                REQUIRE(output.entries.size() == 20);
+            }
+        }
+
+        SECTION("packGridsBoxTree")
+        {
+            SECTION("works for a simple case")
+            {
+                Grid<int> a(4, 3);
+                Grid<int> b(8, 6);
+
+                std::vector<Grid<int>*> vec{&a, &b};
+
+                auto output = packGridsBoxTree<Grid<int>*>(vec, [](const auto& s) { return Size(s->getWidth(), s->getHeight()); });
+
+                REQUIRE(output.width == 8);
+                REQUIRE(output.height == 9);
+
+                REQUIRE(output.entries.size() == 2);
+                REQUIRE(output.entries[0].x == 0);
+                REQUIRE(output.entries[0].y == 0);
+                REQUIRE(output.entries[0].value == &b);
+
+                REQUIRE(output.entries[1].x == 0);
+                REQUIRE(output.entries[1].y == 6);
+                REQUIRE(output.entries[1].value == &a);
+            }
         }
     }
 }
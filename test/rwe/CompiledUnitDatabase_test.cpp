@@ -0,0 +1,175 @@
+#include <boost/filesystem.hpp>
+#include <catch.hpp>
+#include <fstream>
+#include <rwe/CompiledUnitDatabase.h>
+
+namespace rwe
+{
+    namespace
+    {
+        CompiledUnitDatabase makeTestDatabase()
+        {
+            CompiledUnitDatabase db;
+
+            SoundClass sound{};
+            sound.select1 = "ARMSEL";
+            sound.ok1 = "ARMOK";
+            db.soundClasses.emplace_back("ARM_COMMANDER", sound);
+
+            MovementClass mc{"TANKSH2", 2, 3, 0, 22, 18, 255};
+            db.movementClasses.emplace_back("TANKSH2", mc);
+
+            WeaponTdf weapon{};
+            weapon.name = "Light Laser";
+            weapon.range = 280;
+            weapon.reloadTime = 0.95f;
+            weapon.lineOfSight = true;
+            weapon.soundStart = "lasrfir1";
+            weapon.damage = {{"DEFAULT", 40}, {"ARMCOM", 10}};
+            db.weapons.emplace_back("ARM_LIGHTLASER", weapon);
+
+            UnitFbi unit{};
+            unit.unitName = "ARMCOM";
+            unit.objectName = "ARMCOM";
+            unit.soundCategory = "ARM_COMMANDER";
+            unit.turnRate = 900.0f;
+            unit.commander = true;
+            unit.sightDistance = 450;
+            unit.radarDistance = 700;
+            unit.weapon1 = "ARM_LIGHTLASER";
+            db.units.emplace_back("ARMCOM", unit);
+
+            CobScript script;
+            script.instructions = {0x10001000, 3, 0x10002000, 7};
+            script.pieces = {"base", "torso"};
+            script.functions = {{"Create", 0}, {"Killed", 2}};
+            script.staticVariableCount = 4;
+            db.scripts.emplace_back("ARMCOM", script);
+
+            return db;
+        }
+    }
+
+    TEST_CASE("CompiledUnitDatabase")
+    {
+        auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rwe-%%%%-%%%%.bin");
+        auto db = makeTestDatabase();
+        writeCompiledUnitDatabase(path.string(), 1234, db);
+
+        SECTION("round trips through a file")
+        {
+            auto result = readCompiledUnitDatabase(path.string(), 1234);
+            REQUIRE(result);
+
+            REQUIRE(result->soundClasses.size() == 1);
+            REQUIRE(result->soundClasses[0].first == "ARM_COMMANDER");
+            REQUIRE(result->soundClasses[0].second.select1 == std::optional<std::string>("ARMSEL"));
+            REQUIRE(result->soundClasses[0].second.ok1 == std::optional<std::string>("ARMOK"));
+            REQUIRE(!result->soundClasses[0].second.cant1);
+
+            REQUIRE(result->movementClasses.size() == 1);
+            REQUIRE(result->movementClasses[0].second.name == "TANKSH2");
+            REQUIRE(result->movementClasses[0].second.footprintZ == 3);
+            REQUIRE(result->movementClasses[0].second.maxWaterSlope == 255);
+
+            REQUIRE(result->weapons.size() == 1);
+            const auto& weapon = result->weapons[0].second;
+            REQUIRE(weapon.name == "Light Laser");
+            REQUIRE(weapon.range == 280);
+            REQUIRE(weapon.reloadTime == 0.95f);
+            REQUIRE(weapon.lineOfSight);
+            REQUIRE(!weapon.ballistic);
+            REQUIRE(weapon.soundStart == "lasrfir1");
+            REQUIRE(weapon.damage == db.weapons[0].second.damage);
+
+            REQUIRE(result->units.size() == 1);
+            auto unit = result->units[0].second();
+            REQUIRE(unit.unitName == "ARMCOM");
+            REQUIRE(unit.turnRate == 900.0f);
+            REQUIRE(unit.commander);
+            REQUIRE(unit.sightDistance == 450);
+            REQUIRE(unit.radarDistance == 700);
+            REQUIRE(unit.weapon1 == "ARM_LIGHTLASER");
+
+            REQUIRE(result->scripts.size() == 1);
+            auto script = result->scripts[0].second();
+            REQUIRE(script.instructions == db.scripts[0].second.instructions);
+            REQUIRE(script.pieces == db.scripts[0].second.pieces);
+            REQUIRE(script.functions.size() == 2);
+            REQUIRE(script.functions[1].name == "Killed");
+            REQUIRE(script.functions[1].address == 2);
+            REQUIRE(script.staticVariableCount == 4);
+        }
+
+        SECTION("returns none when the fingerprint does not match")
+        {
+            REQUIRE(!readCompiledUnitDatabase(path.string(), 4321));
+        }
+
+        SECTION("returns none when the file does not exist")
+        {
+            REQUIRE(!readCompiledUnitDatabase(path.string() + ".missing", 1234));
+        }
+
+        SECTION("throws when the file is truncated")
+        {
+            auto size = boost::filesystem::file_size(path);
+            boost::filesystem::resize_file(path, size - 5);
+            REQUIRE_THROWS(readCompiledUnitDatabase(path.string(), 1234));
+        }
+
+        SECTION("decodes entries after the result of reading has moved")
+        {
+            auto result = readCompiledUnitDatabase(path.string(), 1234);
+            REQUIRE(result);
+            auto loadUnit = std::move(result->units[0].second);
+            result.reset();
+
+            REQUIRE(loadUnit().unitName == "ARMCOM");
+            REQUIRE(loadUnit().unitName == "ARMCOM");
+        }
+
+        boost::filesystem::remove(path);
+    }
+
+    TEST_CASE("computeDataFingerprint")
+    {
+        auto dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rwe-%%%%-%%%%");
+        boost::filesystem::create_directories(dir / "units");
+        boost::filesystem::create_directories(dir / "music");
+        std::ofstream((dir / "a.hpi").string()) << "hello";
+
+        auto original = computeDataFingerprint(dir);
+
+        SECTION("is stable")
+        {
+            REQUIRE(computeDataFingerprint(dir) == original);
+        }
+
+        SECTION("changes when an archive is added")
+        {
+            std::ofstream((dir / "b.ufo").string()) << "x";
+            REQUIRE(computeDataFingerprint(dir) != original);
+        }
+
+        SECTION("changes when a loose unit file is added")
+        {
+            std::ofstream((dir / "units" / "ARMCOM.FBI").string()) << "x";
+            REQUIRE(computeDataFingerprint(dir) != original);
+        }
+
+        SECTION("ignores loose files that no cached data is read from")
+        {
+            std::ofstream((dir / "music" / "track1.ogg").string()) << "x";
+            REQUIRE(computeDataFingerprint(dir) == original);
+        }
+
+        SECTION("changes when a file changes size")
+        {
+            std::ofstream((dir / "a.hpi").string()) << "hello world";
+            REQUIRE(computeDataFingerprint(dir) != original);
+        }
+
+        boost::filesystem::remove_all(dir);
+    }
+}
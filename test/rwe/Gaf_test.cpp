@@ -0,0 +1,95 @@
+#include <catch.hpp>
+#include <cstring>
+#include <rwe/Gaf.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rwe
+{
+    namespace
+    {
+        template <typename T>
+        void appendRaw(std::string& buffer, const T& value)
+        {
+            auto offset = buffer.size();
+            buffer.resize(offset + sizeof(T));
+            std::memcpy(&buffer[offset], &value, sizeof(T));
+        }
+
+        class LayerRecordingAdapter : public GafReaderAdapter
+        {
+        public:
+            std::vector<std::vector<unsigned char>> layers;
+
+            void beginFrame(const GafFrameData& /*header*/) override
+            {
+            }
+
+            void frameLayer(const LayerData& data) override
+            {
+                auto begin = reinterpret_cast<const unsigned char*>(data.data);
+                layers.emplace_back(begin, begin + (data.width * data.height));
+            }
+
+            void endFrame() override
+            {
+            }
+        };
+
+        /**
+         * Builds a GAF file with one entry holding one compressed frame
+         * of the given size, followed by the given compressed rows.
+         */
+        std::string makeCompressedGaf(uint16_t width, uint16_t height, uint8_t transparencyIndex, const std::string& rows)
+        {
+            std::string buffer;
+
+            GafHeader header{GafVersionNumber, 1, 0};
+            appendRaw(buffer, header);
+            appendRaw(buffer, static_cast<uint32_t>(buffer.size() + sizeof(uint32_t)));
+
+            GafEntry entry{};
+            entry.frames = 1;
+            std::memcpy(entry.name, "test", 4);
+            appendRaw(buffer, entry);
+
+            auto frameEntryOffset = buffer.size() + sizeof(GafFrameEntry);
+            GafFrameEntry frameEntry{static_cast<uint32_t>(frameEntryOffset), 0};
+            appendRaw(buffer, frameEntry);
+
+            GafFrameData frame{};
+            frame.width = width;
+            frame.height = height;
+            frame.transparencyIndex = transparencyIndex;
+            frame.compressed = 1;
+            frame.frameDataOffset = static_cast<uint32_t>(buffer.size() + sizeof(GafFrameData));
+            appendRaw(buffer, frame);
+
+            buffer += rows;
+            return buffer;
+        }
+    }
+
+    TEST_CASE("GafArchive")
+    {
+        SECTION("pads the rest of a compressed row that ends early with transparency")
+        {
+            // One row: a copy of two bytes (7, 8), then nothing for the last two pixels.
+            std::string rows;
+            appendRaw(rows, static_cast<uint16_t>(3));
+            rows += std::string{'\x04', '\x07', '\x08'};
+
+            std::istringstream stream(makeCompressedGaf(4, 1, 9, rows));
+            GafArchive archive(&stream);
+            REQUIRE(archive.entries().size() == 1);
+
+            LayerRecordingAdapter adapter;
+            archive.extract(archive.entries().front(), adapter);
+
+            REQUIRE(adapter.layers.size() == 1);
+            std::vector<unsigned char> expected{7, 8, 9, 9};
+            REQUIRE(adapter.layers.front() == expected);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include <catch.hpp>
+#include <rwe/GameParameters.h>
+
+namespace rwe
+{
+    TEST_CASE("parseNetworkLocal")
+    {
+        SECTION("reads the slot and port")
+        {
+            auto network = parseNetworkLocal("1:7000");
+            REQUIRE(network.localSlot == 1);
+            REQUIRE(network.localPort == 7000);
+            REQUIRE(network.peers.empty());
+        }
+
+        SECTION("rejects malformed addresses")
+        {
+            REQUIRE_THROWS_AS(parseNetworkLocal("7000"), const std::runtime_error&);
+            REQUIRE_THROWS_AS(parseNetworkLocal(":7000"), const std::runtime_error&);
+            REQUIRE_THROWS_AS(parseNetworkLocal("1:"), const std::runtime_error&);
+            REQUIRE_THROWS_AS(parseNetworkLocal("10:7000"), const std::runtime_error&);
+            REQUIRE_THROWS_AS(parseNetworkLocal("1:70000"), const std::runtime_error&);
+            REQUIRE_THROWS_AS(parseNetworkLocal("1:-7"), const std::runtime_error&);
+        }
+    }
+
+    TEST_CASE("parseNetworkPeer")
+    {
+        SECTION("reads the slot, host and port")
+        {
+            auto peer = parseNetworkPeer("0:127.0.0.1:7001");
+            REQUIRE(peer.slot == 0);
+            REQUIRE(peer.host == "127.0.0.1");
+            REQUIRE(peer.port == 7001);
+        }
+
+        SECTION("rejects malformed addresses")
+        {
+            REQUIRE_THROWS_AS(parseNetworkPeer("0:7001"), const std::runtime_error&);
+            REQUIRE_THROWS_AS(parseNetworkPeer("0::7001"), const std::runtime_error&);
+            REQUIRE_THROWS_AS(parseNetworkPeer("x:localhost:7001"), const std::runtime_error&);
+        }
+    }
+
+    TEST_CASE("assignNetworkControllers")
+    {
+        GameParameters parameters("Coast To Coast", 0);
+        parameters.players[0] = PlayerInfo{PlayerInfo::Controller::Human, "ARM", 0};
+        parameters.players[1] = PlayerInfo{PlayerInfo::Controller::Computer, "CORE", 1};
+        parameters.players[2] = PlayerInfo{PlayerInfo::Controller::Computer, "CORE", 2};
+
+        SECTION("leaves a local game alone")
+        {
+            assignNetworkControllers(parameters);
+            REQUIRE(parameters.players[0]->controller == PlayerInfo::Controller::Human);
+            REQUIRE_NOTHROW(checkNetworkParameters(parameters));
+        }
+
+        SECTION("gives the local slot to the human and the peers' slots to remote players")
+        {
+            parameters.network = NetworkParameters{1, 7000, {NetworkPeer{0, "localhost", 7001}}};
+            assignNetworkControllers(parameters);
+
+            REQUIRE(parameters.players[0]->controller == PlayerInfo::Controller::Remote);
+            REQUIRE(parameters.players[1]->controller == PlayerInfo::Controller::Human);
+            REQUIRE(parameters.players[2]->controller == PlayerInfo::Controller::Computer);
+            REQUIRE_NOTHROW(checkNetworkParameters(parameters));
+        }
+
+        SECTION("refuses peers for empty slots")
+        {
+            parameters.network = NetworkParameters{0, 7000, {NetworkPeer{3, "localhost", 7001}}};
+            REQUIRE_THROWS_AS(assignNetworkControllers(parameters), const std::runtime_error&);
+        }
+    }
+
+    TEST_CASE("checkNetworkParameters")
+    {
+        GameParameters parameters("Coast To Coast", 0);
+        parameters.players[0] = PlayerInfo{PlayerInfo::Controller::Human, "ARM", 0};
+        parameters.players[1] = PlayerInfo{PlayerInfo::Controller::Remote, "CORE", 1};
+
+        SECTION("refuses remote players in a local game")
+        {
+            REQUIRE_THROWS_AS(checkNetworkParameters(parameters), const std::runtime_error&);
+        }
+
+        SECTION("refuses remote players with no peer")
+        {
+            parameters.network = NetworkParameters{0, 7000, {}};
+            REQUIRE_THROWS_AS(checkNetworkParameters(parameters), const std::runtime_error&);
+        }
+
+        SECTION("refuses two peers for one slot")
+        {
+            parameters.network = NetworkParameters{0, 7000, {NetworkPeer{1, "a", 7001}, NetworkPeer{1, "b", 7002}}};
+            REQUIRE_THROWS_AS(checkNetworkParameters(parameters), const std::runtime_error&);
+        }
+
+        SECTION("refuses a local slot that is not the human player")
+        {
+            parameters.network = NetworkParameters{1, 7000, {NetworkPeer{0, "a", 7001}}};
+            REQUIRE_THROWS_AS(checkNetworkParameters(parameters), const std::runtime_error&);
+        }
+
+        SECTION("accepts a matching game")
+        {
+            parameters.network = NetworkParameters{0, 7000, {NetworkPeer{1, "a", 7001}}};
+            REQUIRE_NOTHROW(checkNetworkParameters(parameters));
+        }
+    }
+}
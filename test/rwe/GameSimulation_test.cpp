@@ -0,0 +1,42 @@
+#include "SimulationTestFixtures.h"
+#include <catch.hpp>
+#include <rwe/GameSimulation.h>
+
+namespace rwe
+{
+    TEST_CASE("GameSimulation::isCommandAllowed")
+    {
+        auto simulation = makeTestSimulation(1);
+
+        CobScript script;
+        UnitMesh mesh;
+        REQUIRE(simulation.tryAddUnit(makeTestUnit(mesh, &script, PlayerId(0), Vector3f(0.0f, 0.0f, 0.0f))));
+        REQUIRE(simulation.tryAddUnit(makeTestUnit(mesh, &script, PlayerId(1), Vector3f(-32.0f, 0.0f, -32.0f))));
+
+        SECTION("allows orders to the player's own units")
+        {
+            REQUIRE(simulation.isCommandAllowed(PlayerId(0), MoveCommand{UnitId(0), 10.0f, 10.0f, false}));
+            REQUIRE(simulation.isCommandAllowed(PlayerId(0), AttackCommand{UnitId(0), UnitId(1), false}));
+            REQUIRE(simulation.isCommandAllowed(PlayerId(0), AttackGroundCommand{UnitId(0), 10.0f, 10.0f, true}));
+            REQUIRE(simulation.isCommandAllowed(PlayerId(0), StopCommand{UnitId(0)}));
+        }
+
+        SECTION("drops orders forged for another player's units")
+        {
+            REQUIRE(!simulation.isCommandAllowed(PlayerId(1), MoveCommand{UnitId(0), 10.0f, 10.0f, false}));
+            REQUIRE(!simulation.isCommandAllowed(PlayerId(1), AttackCommand{UnitId(0), UnitId(1), false}));
+            REQUIRE(!simulation.isCommandAllowed(PlayerId(1), AttackGroundCommand{UnitId(0), 10.0f, 10.0f, true}));
+            REQUIRE(!simulation.isCommandAllowed(PlayerId(1), StopCommand{UnitId(0)}));
+        }
+
+        SECTION("drops orders to units that do not exist")
+        {
+            REQUIRE(!simulation.isCommandAllowed(PlayerId(0), StopCommand{UnitId(2)}));
+        }
+
+        SECTION("drops spawn commands, even for the player's own side")
+        {
+            REQUIRE(!simulation.isCommandAllowed(PlayerId(0), SpawnUnitCommand{PlayerId(0), "ARMCOM", 10.0f, 10.0f}));
+        }
+    }
+}
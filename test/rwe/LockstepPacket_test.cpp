@@ -0,0 +1,98 @@
+#include <catch.hpp>
+#include <rwe/LockstepPacket.h>
+
+namespace rwe
+{
+    TEST_CASE("LockstepPacket")
+    {
+        LockstepPacket packet;
+        packet.sender = 3;
+        packet.sendTime = 123456;
+        packet.seed = 0xdeadbeef;
+        packet.echo = LockstepEcho{654321, 7};
+        packet.ack = GameTime(40);
+        packet.firstTick = GameTime(38);
+        packet.batches.push_back({SpawnUnitCommand{PlayerId(1), "ARMPW", 10.0f, -20.5f}, StopCommand{UnitId(4)}});
+        packet.batches.push_back({});
+        packet.batches.push_back({MoveCommand{UnitId(2), 1.0f, 2.0f, true}, AttackCommand{UnitId(2), UnitId(9), false}, AttackGroundCommand{UnitId(2), 3.0f, 4.0f, true}});
+        packet.checksums.push_back(LockstepChecksum{GameTime(36), 0x0123456789abcdefull});
+        packet.checksums.push_back(LockstepChecksum{GameTime(37), 42});
+
+        std::vector<char> buffer;
+        writeLockstepPacket(packet, buffer);
+
+        SECTION("round trips every field")
+        {
+            auto read = readLockstepPacket(buffer.data(), buffer.size());
+
+            REQUIRE(read.sender == 3);
+            REQUIRE(read.sendTime == 123456);
+            REQUIRE(read.seed == 0xdeadbeef);
+            REQUIRE(read.echo);
+            REQUIRE(read.echo->time == 654321);
+            REQUIRE(read.echo->delay == 7);
+            REQUIRE(read.ack == GameTime(40));
+            REQUIRE(read.firstTick == GameTime(38));
+
+            REQUIRE(read.batches.size() == 3);
+            REQUIRE(read.batches[0].size() == 2);
+            auto spawn = boost::get<SpawnUnitCommand>(&read.batches[0][0]);
+            REQUIRE(spawn);
+            REQUIRE(spawn->player == PlayerId(1));
+            REQUIRE(spawn->unitType == "ARMPW");
+            REQUIRE(spawn->x == 10.0f);
+            REQUIRE(spawn->z == -20.5f);
+            REQUIRE(boost::get<StopCommand>(&read.batches[0][1]));
+            REQUIRE(read.batches[1].empty());
+            REQUIRE(read.batches[2].size() == 3);
+            auto move = boost::get<MoveCommand>(&read.batches[2][0]);
+            REQUIRE(move);
+            REQUIRE(move->unit == UnitId(2));
+            REQUIRE(move->queued);
+            auto attack = boost::get<AttackCommand>(&read.batches[2][1]);
+            REQUIRE(attack);
+            REQUIRE(attack->target == UnitId(9));
+            REQUIRE(boost::get<AttackGroundCommand>(&read.batches[2][2]));
+
+            REQUIRE(read.checksums.size() == 2);
+            REQUIRE(read.checksums[0].time == GameTime(36));
+            REQUIRE(read.checksums[0].checksum == 0x0123456789abcdefull);
+            REQUIRE(read.checksums[1].checksum == 42);
+        }
+
+        SECTION("leaves out the echo when there is none")
+        {
+            std::vector<char> withEcho = buffer;
+            packet.echo = std::nullopt;
+            writeLockstepPacket(packet, buffer);
+
+            REQUIRE(buffer.size() == withEcho.size() - 8);
+            REQUIRE(!readLockstepPacket(buffer.data(), buffer.size()).echo);
+        }
+
+        SECTION("rejects packets that are truncated")
+        {
+            for (std::size_t size = 0; size < buffer.size(); ++size)
+            {
+                REQUIRE_THROWS_AS(readLockstepPacket(buffer.data(), size), const LockstepPacketException&);
+            }
+        }
+
+        SECTION("rejects packets with trailing data")
+        {
+            buffer.push_back(0);
+            REQUIRE_THROWS_AS(readLockstepPacket(buffer.data(), buffer.size()), const LockstepPacketException&);
+        }
+
+        SECTION("rejects packets of another protocol or version")
+        {
+            auto badMagic = buffer;
+            badMagic[0] = 'X';
+            REQUIRE_THROWS_AS(readLockstepPacket(badMagic.data(), badMagic.size()), const LockstepPacketException&);
+
+            auto badVersion = buffer;
+            badVersion[4] = static_cast<char>(LockstepVersion + 1);
+            REQUIRE_THROWS_AS(readLockstepPacket(badVersion.data(), badVersion.size()), const LockstepPacketException&);
+        }
+    }
+}
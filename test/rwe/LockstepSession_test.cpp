@@ -0,0 +1,217 @@
+#include <catch.hpp>
+#include <rwe/LockstepSession.h>
+
+namespace rwe
+{
+    namespace
+    {
+        /** Sends a packet from one session to the other, through the wire format. */
+        bool deliverLockstepPacket(const LockstepSession& from, LockstepSession& to, uint32_t now)
+        {
+            LockstepPacket packet;
+            from.makePacket(0, now, packet);
+
+            std::vector<char> buffer;
+            writeLockstepPacket(packet, buffer);
+            return to.receivePacket(readLockstepPacket(buffer.data(), buffer.size()), now);
+        }
+
+        using LockstepApplied = std::vector<std::pair<unsigned int, std::vector<std::pair<unsigned int, unsigned int>>>>;
+
+        /**
+         * Runs the next tick if the session is ready for it, as a game would once a frame,
+         * and notes the slot and unit of each stop command applied.
+         */
+        void runLockstepTick(LockstepSession& session, LockstepApplied& applied)
+        {
+            if (session.isReady())
+            {
+                auto tick = session.getCurrentTick().value;
+                std::vector<LockstepCommand> commands;
+                session.advance(commands);
+                if (!commands.empty())
+                {
+                    std::vector<std::pair<unsigned int, unsigned int>> units;
+                    for (const auto& command : commands)
+                    {
+                        units.emplace_back(command.slot, boost::get<StopCommand>(command.command).unit.value);
+                    }
+                    applied.emplace_back(tick, units);
+                }
+            }
+            session.sealInputs();
+        }
+    }
+
+    TEST_CASE("LockstepSession")
+    {
+        LockstepSession a(0, {1}, GameTime(0), 16, 0x1234);
+        LockstepSession b(1, {0}, GameTime(0), 16, 0x5678);
+
+        LockstepApplied appliedA;
+        LockstepApplied appliedB;
+
+        SECTION("waits for the inputs of every peer")
+        {
+            REQUIRE(!a.isReady());
+            REQUIRE(!b.isReady());
+
+            REQUIRE(deliverLockstepPacket(b, a, 0));
+            REQUIRE(a.isReady());
+            REQUIRE(!b.isReady());
+        }
+
+        SECTION("agrees on a game seed made from every share")
+        {
+            deliverLockstepPacket(a, b, 0);
+            deliverLockstepPacket(b, a, 0);
+            REQUIRE(a.isReady());
+            REQUIRE(b.isReady());
+            REQUIRE(a.getGameSeed() == b.getGameSeed());
+            REQUIRE(a.getGameSeed() == (0x1234u ^ 0x5678u));
+        }
+
+        SECTION("ignores packets from players not in the game")
+        {
+            LockstepSession c(2, {0}, GameTime(0), 16, 0);
+            REQUIRE(!deliverLockstepPacket(c, a, 0));
+            REQUIRE(!a.isReady());
+        }
+
+        SECTION("applies commands at the same tick on every peer, in slot order")
+        {
+            b.submit(StopCommand{UnitId(1)});
+            a.submit(StopCommand{UnitId(0)});
+            a.sealInputs();
+            b.sealInputs();
+
+            for (uint32_t now = 0; now < 20 * 16; now += 16)
+            {
+                deliverLockstepPacket(a, b, now);
+                deliverLockstepPacket(b, a, now);
+                runLockstepTick(a, appliedA);
+                runLockstepTick(b, appliedB);
+            }
+
+            REQUIRE(a.getCurrentTick().value > 10);
+            REQUIRE(appliedA.size() == 1);
+            REQUIRE(appliedA[0].first == LockstepSession::MinInputDelay);
+            REQUIRE(appliedA[0].second == (std::vector<std::pair<unsigned int, unsigned int>>{{0, 0}, {1, 1}}));
+            REQUIRE(appliedB == appliedA);
+        }
+
+        SECTION("recovers from lost packets")
+        {
+            a.submit(StopCommand{UnitId(0)});
+            a.sealInputs();
+
+            // lose every packet from a until well after the command was due
+            for (uint32_t now = 0; now < 10 * 16; now += 16)
+            {
+                deliverLockstepPacket(b, a, now);
+                runLockstepTick(a, appliedA);
+                runLockstepTick(b, appliedB);
+            }
+            REQUIRE(b.getCurrentTick() == GameTime(0));
+            REQUIRE(a.getCurrentTick().value <= LockstepSession::MinInputDelay + 1);
+
+            for (uint32_t now = 10 * 16; now < 30 * 16; now += 16)
+            {
+                deliverLockstepPacket(a, b, now);
+                deliverLockstepPacket(b, a, now);
+                runLockstepTick(a, appliedA);
+                runLockstepTick(b, appliedB);
+            }
+
+            REQUIRE(b.getCurrentTick().value > 10);
+            REQUIRE(appliedA.size() == 1);
+            REQUIRE(appliedB == appliedA);
+        }
+
+        SECTION("carries over commands beyond the batch limit")
+        {
+            for (unsigned int i = 0; i < LockstepSession::MaxCommandsPerBatch + 1; ++i)
+            {
+                a.submit(StopCommand{UnitId(i)});
+            }
+            a.sealInputs();
+
+            for (uint32_t now = 0; now < 10 * 16; now += 16)
+            {
+                deliverLockstepPacket(a, b, now);
+                deliverLockstepPacket(b, a, now);
+                runLockstepTick(a, appliedA);
+                runLockstepTick(b, appliedB);
+            }
+
+            REQUIRE(appliedA.size() == 2);
+            REQUIRE(appliedA[0].second.size() == LockstepSession::MaxCommandsPerBatch);
+            REQUIRE(appliedA[1].first == appliedA[0].first + 1);
+            REQUIRE(appliedA[1].second.size() == 1);
+            REQUIRE(appliedB == appliedA);
+        }
+
+        SECTION("raises the input delay to cover the round trip and lowers it slowly")
+        {
+            // each packet takes 100ms to arrive
+            std::vector<std::pair<uint32_t, LockstepPacket>> toA;
+            std::vector<std::pair<uint32_t, LockstepPacket>> toB;
+            auto exchange = [&](uint32_t start, uint32_t end, uint32_t latency) {
+                for (uint32_t now = start; now < end; now += 16)
+                {
+                    LockstepPacket packet;
+                    a.makePacket(0, now, packet);
+                    toB.emplace_back(now + latency, packet);
+                    b.makePacket(0, now, packet);
+                    toA.emplace_back(now + latency, packet);
+
+                    for (auto* queue : {&toA, &toB})
+                    {
+                        auto& session = queue == &toA ? a : b;
+                        while (!queue->empty() && queue->front().first <= now)
+                        {
+                            session.receivePacket(queue->front().second, now);
+                            queue->erase(queue->begin());
+                        }
+                    }
+
+                    runLockstepTick(a, appliedA);
+                    runLockstepTick(b, appliedB);
+                }
+            };
+
+            exchange(0, 5000, 100);
+            REQUIRE(a.getRoundTripTime(0));
+            REQUIRE(*a.getRoundTripTime(0) >= 190.0f);
+            REQUIRE(*a.getRoundTripTime(0) <= 230.0f);
+            auto slowDelay = a.getInputDelay();
+            REQUIRE(slowDelay >= 7);
+            REQUIRE(slowDelay <= LockstepSession::MaxInputDelay);
+
+            // the game keeps moving despite the latency
+            REQUIRE(a.getCurrentTick().value > (5000 / 16) - 2 * slowDelay);
+
+            exchange(5000, 5000 + 16 * 30, 0);
+            REQUIRE(a.getInputDelay() >= slowDelay - 1);
+
+            exchange(5000 + 16 * 30, 30000, 0);
+            REQUIRE(a.getInputDelay() == LockstepSession::MinInputDelay);
+        }
+
+        SECTION("detects checksums that differ")
+        {
+            a.recordChecksum(GameTime(1), 10);
+            a.recordChecksum(GameTime(2), 20);
+            b.recordChecksum(GameTime(1), 10);
+
+            deliverLockstepPacket(a, b, 0);
+            REQUIRE(!b.getDesyncTime());
+
+            b.recordChecksum(GameTime(2), 21);
+            REQUIRE(b.getDesyncTime() == GameTime(2));
+
+            deliverLockstepPacket(b, a, 0);
+            REQUIRE(a.getDesyncTime() == GameTime(2));
+        }
+    }
+}
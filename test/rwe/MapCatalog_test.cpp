@@ -0,0 +1,104 @@
+#include <boost/filesystem.hpp>
+#include <catch.hpp>
+#include <rwe/MapCatalog.h>
+
+namespace rwe
+{
+    namespace
+    {
+        MapCatalogEntry makeTestMapEntry(const std::string& name)
+        {
+            MapCatalogEntry entry;
+            entry.name = name;
+            entry.missionDescription = "Two players face off across a river";
+            entry.memory = "32 MB";
+            entry.numPlayers = "2";
+            entry.size = "12 x 12";
+            entry.schemaTypes = {"Network 1", "Network 2"};
+            entry.minimapWidth = 3;
+            entry.minimapHeight = 2;
+            entry.minimap = {1, 2, 3, 4, 5, static_cast<char>(250)};
+            return entry;
+        }
+    }
+
+    TEST_CASE("MapCatalog")
+    {
+        std::vector<MapCatalogEntry> entries{makeTestMapEntry("Coast To Coast"), makeTestMapEntry("Evad River Confluence")};
+        MapCatalog catalog(std::move(entries));
+
+        SECTION("finds entries by name, ignoring case")
+        {
+            auto entry = catalog.find("coast to coast");
+            REQUIRE(entry != nullptr);
+            REQUIRE(entry->name == "Coast To Coast");
+        }
+
+        SECTION("returns null for unknown maps")
+        {
+            REQUIRE(catalog.find("Nowhere") == nullptr);
+        }
+    }
+
+    TEST_CASE("writeMapCatalog/readMapCatalog")
+    {
+        auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rwe-mapcatalog-%%%%-%%%%.bin");
+
+        std::vector<MapCatalogEntry> entries{makeTestMapEntry("Coast To Coast"), makeTestMapEntry("Evad River Confluence")};
+        writeMapCatalog(path.string(), 1234, MapCatalog(std::move(entries)));
+
+        SECTION("round-trips the catalog")
+        {
+            auto catalog = readMapCatalog(path.string(), 1234);
+            REQUIRE(catalog);
+            REQUIRE(catalog->getEntries().size() == 2);
+
+            auto entry = catalog->find("Evad River Confluence");
+            REQUIRE(entry != nullptr);
+
+            auto expected = makeTestMapEntry("Evad River Confluence");
+            REQUIRE(entry->missionDescription == expected.missionDescription);
+            REQUIRE(entry->memory == expected.memory);
+            REQUIRE(entry->numPlayers == expected.numPlayers);
+            REQUIRE(entry->size == expected.size);
+            REQUIRE(entry->schemaTypes == expected.schemaTypes);
+            REQUIRE(entry->minimapWidth == 3);
+            REQUIRE(entry->minimapHeight == 2);
+            REQUIRE(entry->minimap == expected.minimap);
+        }
+
+        SECTION("returns none when the fingerprint does not match")
+        {
+            REQUIRE(!readMapCatalog(path.string(), 4321));
+        }
+
+        SECTION("returns none when the file does not exist")
+        {
+            REQUIRE(!readMapCatalog(path.string() + ".missing", 1234));
+        }
+
+        SECTION("throws when the file is truncated")
+        {
+            auto size = boost::filesystem::file_size(path);
+            boost::filesystem::resize_file(path, size - 5);
+            REQUIRE_THROWS(readMapCatalog(path.string(), 1234));
+        }
+
+        boost::filesystem::remove(path);
+    }
+
+    TEST_CASE("readMapCatalog rejects minimap sizes larger than the file")
+    {
+        auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rwe-mapcatalog-%%%%-%%%%.bin");
+
+        auto entry = makeTestMapEntry("Coast To Coast");
+        entry.minimapWidth = 0xffffffff;
+        entry.minimapHeight = 0xffffffff;
+        std::vector<MapCatalogEntry> entries{std::move(entry)};
+        writeMapCatalog(path.string(), 1234, MapCatalog(std::move(entries)));
+
+        REQUIRE_THROWS_AS(readMapCatalog(path.string(), 1234), const MapCatalogException&);
+
+        boost::filesystem::remove(path);
+    }
+}
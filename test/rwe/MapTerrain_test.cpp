@@ -0,0 +1,206 @@
+#include <catch.hpp>
+#include <random>
+#include <rwe/MapTerrain.h>
+
+namespace rwe
+{
+    namespace
+    {
+        MapTerrain makeTestTerrain(std::size_t widthInTiles, std::size_t heightInTiles, unsigned int seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<int> dist(0, 255);
+
+            Grid<unsigned char> heights(widthInTiles * 2, heightInTiles * 2);
+            for (std::size_t y = 0; y < heights.getHeight(); ++y)
+            {
+                for (std::size_t x = 0; x < heights.getWidth(); ++x)
+                {
+                    heights.set(x, y, static_cast<unsigned char>(dist(rng)));
+                }
+            }
+
+            return MapTerrain(
+                std::vector<TextureRegion>(),
+                Grid<std::size_t>(widthInTiles, heightInTiles),
+                std::move(heights),
+                0.0f);
+        }
+
+        float intersectHeight(const MapTerrain& terrain, float x, float z)
+        {
+            Line3f line(Vector3f(x, MapTerrain::MaxHeight, z), Vector3f(x, MapTerrain::MinHeight, z));
+            auto pos = terrain.intersectLine(line);
+            return pos ? pos->y : 0.0f;
+        }
+
+        /** Tests the line against every cell and returns the hit nearest the start of the line. */
+        std::optional<Vector3f> intersectLineBruteForce(const MapTerrain& terrain, const Line3f& line)
+        {
+            const auto& heights = terrain.getHeightMap();
+            std::optional<Vector3f> best;
+            for (std::size_t y = 0; y < heights.getHeight() - 1; ++y)
+            {
+                for (std::size_t x = 0; x < heights.getWidth() - 1; ++x)
+                {
+                    best = closestTo(line.start, best, terrain.intersectWithHeightmapCell(line, x, y));
+                }
+            }
+
+            return best;
+        }
+    }
+
+    TEST_CASE("MapTerrain")
+    {
+        SECTION(".getHeightAt")
+        {
+            SECTION("returns corner heights at heightmap vertices")
+            {
+                auto terrain = makeTestTerrain(4, 4, 1);
+                const auto& heights = terrain.getHeightMap();
+                for (int y = 0; y < 7; ++y)
+                {
+                    for (int x = 0; x < 7; ++x)
+                    {
+                        auto corner = terrain.heightmapIndexToWorldCorner(x, y);
+                        REQUIRE(terrain.getHeightAt(corner.x, corner.z) == Approx(heights.get(x, y)));
+                    }
+                }
+            }
+
+            SECTION("returns the average corner height at cell centers")
+            {
+                auto terrain = makeTestTerrain(4, 4, 2);
+                const auto& heights = terrain.getHeightMap();
+                auto center = terrain.heightmapIndexToWorldCenter(2, 3);
+                float expected = (heights.get(2, 3) + heights.get(3, 3) + heights.get(2, 4) + heights.get(3, 4)) / 4.0f;
+                REQUIRE(terrain.getHeightAt(center.x, center.z) == Approx(expected));
+            }
+
+            SECTION("matches the ray cast against the terrain triangles")
+            {
+                auto terrain = makeTestTerrain(8, 6, 3);
+                std::mt19937 rng(4);
+                std::uniform_real_distribution<float> xDist(-128.0f, 128.0f);
+                std::uniform_real_distribution<float> zDist(-96.0f, 96.0f);
+
+                for (int i = 0; i < 2000; ++i)
+                {
+                    auto x = xDist(rng);
+                    auto z = zDist(rng);
+                    auto heightPos = terrain.worldToHeightmapCoordinate(Vector3f(x, 0.0f, z));
+                    if (heightPos.x >= 15 || heightPos.y >= 11)
+                    {
+                        continue;
+                    }
+
+                    REQUIRE(terrain.getHeightAt(x, z) == Approx(intersectHeight(terrain, x, z)).margin(0.01));
+                }
+            }
+
+            SECTION("matches the ray cast just off cell edges and diagonals")
+            {
+                // Points exactly on an edge are avoided,
+                // since there the ray cast can also accept a neighbouring triangle
+                // whose edge merely lines up with the point.
+                const float offset = 0.01f;
+
+                auto terrain = makeTestTerrain(4, 4, 5);
+                for (int y = 0; y < 7; ++y)
+                {
+                    for (int x = 0; x < 7; ++x)
+                    {
+                        auto corner = terrain.heightmapIndexToWorldCorner(x, y);
+                        for (float t : {0.1f, 0.25f, 0.5f, 0.75f, 0.9f})
+                        {
+                            auto d = t * MapTerrain::HeightTileWidthInWorldUnits;
+                            auto nearTop = Vector3f(corner.x + d, 0.0f, corner.z + offset);
+                            auto nearLeft = Vector3f(corner.x + offset, 0.0f, corner.z + d);
+                            auto nearDiagonal = Vector3f(corner.x + d + offset, 0.0f, corner.z + d);
+                            auto nearAntiDiagonal = Vector3f(corner.x + d + offset, 0.0f, corner.z + MapTerrain::HeightTileHeightInWorldUnits - d);
+                            for (const auto& p : {nearTop, nearLeft, nearDiagonal, nearAntiDiagonal})
+                            {
+                                REQUIRE(terrain.getHeightAt(p.x, p.z) == Approx(intersectHeight(terrain, p.x, p.z)).margin(0.05));
+                            }
+                        }
+                    }
+                }
+            }
+
+            SECTION("returns 0 outside the heightmap")
+            {
+                auto terrain = makeTestTerrain(4, 4, 6);
+                REQUIRE(terrain.getHeightAt(-65.0f, 0.0f) == 0.0f);
+                REQUIRE(terrain.getHeightAt(0.0f, -65.0f) == 0.0f);
+                REQUIRE(terrain.getHeightAt(64.0f, 0.0f) == 0.0f);
+                REQUIRE(terrain.getHeightAt(0.0f, 1000.0f) == 0.0f);
+            }
+        }
+
+        SECTION(".intersectLine")
+        {
+            SECTION("finds the same hit as testing every cell")
+            {
+                auto terrain = makeTestTerrain(16, 12, 8);
+                std::mt19937 rng(9);
+                std::uniform_real_distribution<float> xDist(-250.0f, 230.0f);
+                std::uniform_real_distribution<float> zDist(-190.0f, 170.0f);
+
+                for (int i = 0; i < 300; ++i)
+                {
+                    // long, shallow lines from above the terrain down to below it,
+                    // staying inside the map so that they must hit
+                    Vector3f start(xDist(rng), 300.0f, zDist(rng));
+                    Vector3f end(xDist(rng), -10.0f, zDist(rng));
+                    Line3f line(start, end);
+
+                    auto expected = intersectLineBruteForce(terrain, line);
+                    auto actual = terrain.intersectLine(line);
+                    REQUIRE(expected);
+                    REQUIRE(actual);
+                    REQUIRE(actual->x == Approx(expected->x).margin(0.01));
+                    REQUIRE(actual->y == Approx(expected->y).margin(0.01));
+                    REQUIRE(actual->z == Approx(expected->z).margin(0.01));
+                }
+            }
+
+            SECTION("misses when the line passes above the terrain")
+            {
+                auto terrain = makeTestTerrain(8, 8, 10);
+                Line3f line(Vector3f(-120.0f, 256.0f, -120.0f), Vector3f(100.0f, 256.0f, 90.0f));
+                REQUIRE(!terrain.intersectLine(line));
+            }
+
+            SECTION("hits along a cell boundary")
+            {
+                auto terrain = makeTestTerrain(4, 4, 11);
+                auto corner = terrain.heightmapIndexToWorldCorner(3, 0);
+                auto farCorner = terrain.heightmapIndexToWorldCorner(3, 7);
+                Line3f line(Vector3f(corner.x, 300.0f, corner.z), Vector3f(farCorner.x, -10.0f, farCorner.z));
+
+                auto hit = terrain.intersectLine(line);
+                REQUIRE(hit);
+                REQUIRE(hit->x == Approx(corner.x));
+            }
+        }
+
+        SECTION(".setHeightsAt")
+        {
+            auto terrain = makeTestTerrain(4, 4, 7);
+            std::vector<Vector3f> positions{
+                Vector3f(-10.0f, 99.0f, 3.0f),
+                Vector3f(5.5f, 0.0f, -20.25f),
+                Vector3f(1000.0f, 5.0f, 0.0f),
+            };
+
+            terrain.setHeightsAt(positions);
+
+            REQUIRE(positions[0].y == terrain.getHeightAt(-10.0f, 3.0f));
+            REQUIRE(positions[0].x == -10.0f);
+            REQUIRE(positions[0].z == 3.0f);
+            REQUIRE(positions[1].y == terrain.getHeightAt(5.5f, -20.25f));
+            REQUIRE(positions[2].y == 0.0f);
+        }
+    }
+}
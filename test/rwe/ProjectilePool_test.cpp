@@ -0,0 +1,77 @@
+#include <catch.hpp>
+#include <rwe/ProjectilePool.h>
+
+namespace rwe
+{
+    TEST_CASE("ProjectilePool")
+    {
+        auto laser = std::make_shared<ProjectileDescriptor>();
+        laser->duration = 2.0f;
+
+        auto cannon = std::make_shared<ProjectileDescriptor>();
+        cannon->duration = 0.0f;
+
+        ProjectilePool pool;
+        REQUIRE(pool.empty());
+
+        pool.spawn(PlayerId(0), laser, Vector3f(0.0f, 0.0f, 0.0f), Vector3f(1.0f, 0.0f, 0.0f), GameTime(5));
+        pool.spawn(PlayerId(1), cannon, Vector3f(10.0f, 0.0f, 0.0f), Vector3f(0.0f, 2.0f, 0.0f), GameTime(6));
+        pool.spawn(PlayerId(2), laser, Vector3f(20.0f, 0.0f, 0.0f), Vector3f(0.0f, 0.0f, 3.0f), GameTime(7));
+        REQUIRE(pool.size() == 3);
+
+        SECTION("stores projectile attributes")
+        {
+            REQUIRE(pool.getPosition(1) == Vector3f(10.0f, 0.0f, 0.0f));
+            REQUIRE(pool.getVelocity(1) == Vector3f(0.0f, 2.0f, 0.0f));
+            REQUIRE(pool.getOrigin(1) == Vector3f(10.0f, 0.0f, 0.0f));
+            REQUIRE(pool.getOwner(1) == PlayerId(1));
+            REQUIRE(pool.getLastSmokeTime(1) == GameTime(6));
+            REQUIRE(&pool.getDescriptor(1) == cannon.get());
+        }
+
+        SECTION("integrate advances every projectile by its velocity")
+        {
+            pool.integrate();
+            REQUIRE(pool.getPosition(0) == Vector3f(1.0f, 0.0f, 0.0f));
+            REQUIRE(pool.getPosition(1) == Vector3f(10.0f, 2.0f, 0.0f));
+            REQUIRE(pool.getPosition(2) == Vector3f(20.0f, 0.0f, 3.0f));
+            REQUIRE(pool.getOrigin(0) == Vector3f(0.0f, 0.0f, 0.0f));
+        }
+
+        SECTION("remove moves the last projectile into the removed slot")
+        {
+            pool.remove(0);
+            REQUIRE(pool.size() == 2);
+            REQUIRE(pool.getOwner(0) == PlayerId(2));
+            REQUIRE(pool.getPosition(0) == Vector3f(20.0f, 0.0f, 0.0f));
+            REQUIRE(pool.getVelocity(0) == Vector3f(0.0f, 0.0f, 3.0f));
+            REQUIRE(pool.getLastSmokeTime(0) == GameTime(7));
+            REQUIRE(pool.getOwner(1) == PlayerId(1));
+
+            pool.remove(1);
+            REQUIRE(pool.size() == 1);
+            REQUIRE(pool.getOwner(0) == PlayerId(2));
+
+            pool.remove(0);
+            REQUIRE(pool.empty());
+        }
+
+        SECTION("back position trails the head but stops at the origin")
+        {
+            pool.integrate();
+            REQUIRE(pool.getBackPosition(0) == Vector3f(0.0f, 0.0f, 0.0f));
+
+            pool.integrate();
+            pool.integrate();
+            REQUIRE(pool.getBackPosition(0) == Vector3f(1.0f, 0.0f, 0.0f));
+
+            REQUIRE(pool.getBackPosition(1) == pool.getPosition(1));
+        }
+
+        SECTION("descriptors are shared, not copied")
+        {
+            REQUIRE(&pool.getDescriptor(0) == &pool.getDescriptor(2));
+            REQUIRE(laser.use_count() == 3);
+        }
+    }
+}
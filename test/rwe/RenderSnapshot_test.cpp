@@ -0,0 +1,183 @@
+#include "SimulationTestFixtures.h"
+#include <catch.hpp>
+#include <rwe/RenderSnapshot.h>
+#include <rwe/util.h>
+
+namespace rwe
+{
+    namespace
+    {
+        Unit makeRenderTestUnit(const CobScript* script, PlayerId owner, const Vector3f& position)
+        {
+            UnitMesh barrel;
+            barrel.name = "barrel";
+            barrel.offset = Vector3f(0.0f, 0.0f, 2.0f);
+
+            UnitMesh turret;
+            turret.name = "turret";
+            turret.children.push_back(barrel);
+
+            UnitMesh base;
+            base.name = "base";
+            base.children.push_back(turret);
+            base.children.push_back(UnitMesh());
+            base.children.back().name = "flag";
+            base.children.back().visible = false;
+
+            auto unit = makeTestUnit(base, script, owner, position);
+            unit.hitPoints = 50;
+            return unit;
+        }
+
+        UnitRenderState makeRenderTestUnitState(UnitId id, const Vector3f& position, float rotation)
+        {
+            UnitRenderState unit;
+            unit.id = id;
+            unit.position = position;
+            unit.rotation = rotation;
+
+            PieceRenderState piece;
+            piece.offset = position;
+            piece.rotation = Vector3f(0.0f, rotation, 0.0f);
+            unit.pieces.push_back(piece);
+
+            return unit;
+        }
+    }
+
+    TEST_CASE("captureRenderSnapshot")
+    {
+        CobScript script;
+        auto sim = makeTestSimulation(7);
+        REQUIRE(sim.tryAddUnit(makeRenderTestUnit(&script, PlayerId(0), Vector3f(-40.0f, 0.0f, -40.0f))));
+        REQUIRE(sim.tryAddUnit(makeRenderTestUnit(&script, PlayerId(1), Vector3f(40.0f, 0.0f, 40.0f))));
+
+        auto descriptor = std::make_shared<ProjectileDescriptor>();
+        descriptor->duration = 3.0f;
+        descriptor->color = Vector3f(1.0f, 0.0f, 0.0f);
+        sim.projectiles.spawn(PlayerId(0), descriptor, Vector3f(1.0f, 2.0f, 3.0f), Vector3f(0.0f, 0.0f, 1.0f), GameTime(0));
+        sim.spawnExplosion(Vector3f(5.0f, 0.0f, 5.0f), std::make_shared<SpriteSeries>());
+        sim.gameTime = GameTime(30);
+
+        RenderSnapshot snapshot;
+        captureRenderSnapshot(sim, snapshot);
+
+        REQUIRE(snapshot.gameTime == GameTime(30));
+
+        REQUIRE(snapshot.units.size() == 2);
+        REQUIRE(snapshot.units[0].id == UnitId(0));
+        REQUIRE(snapshot.units[0].owner == PlayerId(0));
+        REQUIRE(snapshot.units[0].position == Vector3f(-40.0f, 0.0f, -40.0f));
+        REQUIRE(snapshot.units[0].hitPoints == 50);
+        REQUIRE(snapshot.units[0].maxHitPoints == 100);
+        REQUIRE(snapshot.units[1].id == UnitId(1));
+
+        SECTION("lists each piece before its children")
+        {
+            const auto& pieces = snapshot.units[0].pieces;
+            REQUIRE(pieces.size() == 4);
+            REQUIRE(!pieces[0].parent);
+            REQUIRE(pieces[1].parent == std::optional<std::size_t>(0));
+            REQUIRE(pieces[2].parent == std::optional<std::size_t>(1));
+            REQUIRE(pieces[2].offset == Vector3f(0.0f, 0.0f, 2.0f));
+            REQUIRE(pieces[3].parent == std::optional<std::size_t>(0));
+            REQUIRE(!pieces[3].visible);
+        }
+
+        SECTION("records projectiles and explosions")
+        {
+            REQUIRE(snapshot.projectiles.size() == 1);
+            REQUIRE(snapshot.projectiles[0].position == Vector3f(1.0f, 2.0f, 3.0f));
+            REQUIRE(snapshot.projectiles[0].velocity == Vector3f(0.0f, 0.0f, 1.0f));
+            REQUIRE(snapshot.projectiles[0].duration == 3.0f);
+            REQUIRE(snapshot.projectiles[0].color == Vector3f(1.0f, 0.0f, 0.0f));
+
+            REQUIRE(snapshot.explosions.size() == 1);
+            REQUIRE(snapshot.explosions[0].position == Vector3f(5.0f, 0.0f, 5.0f));
+        }
+
+        SECTION("replaces what was there before")
+        {
+            sim.units.erase(UnitId(0));
+            sim.projectiles.clear();
+            captureRenderSnapshot(sim, snapshot);
+
+            REQUIRE(snapshot.units.size() == 1);
+            REQUIRE(snapshot.units[0].id == UnitId(1));
+            REQUIRE(snapshot.units[0].pieces.size() == 4);
+            REQUIRE(snapshot.projectiles.empty());
+        }
+
+        SECTION("finds units by ID")
+        {
+            REQUIRE(snapshot.findUnit(UnitId(1)) == &snapshot.units[1]);
+            REQUIRE(snapshot.findUnit(UnitId(2)) == nullptr);
+        }
+    }
+
+    TEST_CASE("interpolateRenderSnapshots")
+    {
+        RenderSnapshot previous;
+        previous.gameTime = GameTime(10);
+        previous.units.push_back(makeRenderTestUnitState(UnitId(1), Vector3f(0.0f, 0.0f, 0.0f), 0.0f));
+        previous.units.push_back(makeRenderTestUnitState(UnitId(2), Vector3f(0.0f, 0.0f, 0.0f), 3.0f));
+        previous.units.push_back(makeRenderTestUnitState(UnitId(3), Vector3f(0.0f, 0.0f, 0.0f), 0.0f));
+
+        RenderSnapshot current;
+        current.gameTime = GameTime(11);
+        current.units.push_back(makeRenderTestUnitState(UnitId(1), Vector3f(2.0f, 0.0f, 4.0f), 1.0f));
+        current.units.push_back(makeRenderTestUnitState(UnitId(2), Vector3f(0.0f, 0.0f, 0.0f), -3.0f));
+        current.units.push_back(makeRenderTestUnitState(UnitId(4), Vector3f(8.0f, 0.0f, 8.0f), 1.0f));
+
+        current.projectiles.push_back(ProjectileRenderState{Vector3f(0.0f, 0.0f, 10.0f), Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.0f, 0.0f, 2.0f), 1.0f, Vector3f(), Vector3f()});
+        current.projectiles.push_back(ProjectileRenderState{Vector3f(0.0f, 0.0f, 1.0f), Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.0f, 0.0f, 2.0f), 1.0f, Vector3f(), Vector3f()});
+
+        RenderSnapshot result;
+
+        SECTION("draws the current snapshot at the end of the tick")
+        {
+            interpolateRenderSnapshots(previous, current, 1.0f, result);
+            REQUIRE(result.gameTime == GameTime(11));
+            REQUIRE(result.units[0].position == Vector3f(2.0f, 0.0f, 4.0f));
+            REQUIRE(result.units[0].rotation == Approx(1.0f));
+            REQUIRE(result.projectiles[0].position == Vector3f(0.0f, 0.0f, 10.0f));
+        }
+
+        interpolateRenderSnapshots(previous, current, 0.5f, result);
+
+        SECTION("moves units and their pieces part way")
+        {
+            REQUIRE(result.units[0].id == UnitId(1));
+            REQUIRE(result.units[0].position == Vector3f(1.0f, 0.0f, 2.0f));
+            REQUIRE(result.units[0].rotation == Approx(0.5f));
+            REQUIRE(result.units[0].pieces[0].offset == Vector3f(1.0f, 0.0f, 2.0f));
+            REQUIRE(result.units[0].pieces[0].rotation.y == Approx(0.5f));
+        }
+
+        SECTION("turns the short way round")
+        {
+            REQUIRE(result.units[1].id == UnitId(2));
+            REQUIRE(std::abs(result.units[1].rotation) == Approx(Pif));
+        }
+
+        SECTION("draws new units where they are and leaves out removed units")
+        {
+            REQUIRE(result.units.size() == 3);
+            REQUIRE(result.units[2].id == UnitId(4));
+            REQUIRE(result.units[2].position == Vector3f(8.0f, 0.0f, 8.0f));
+            REQUIRE(result.findUnit(UnitId(3)) == nullptr);
+        }
+
+        SECTION("moves projectiles back along their velocity")
+        {
+            REQUIRE(result.projectiles[0].position == Vector3f(0.0f, 0.0f, 9.0f));
+            REQUIRE(result.projectiles[0].getBackPosition() == Vector3f(0.0f, 0.0f, 7.0f));
+        }
+
+        SECTION("leaves projectiles fired this tick where they are")
+        {
+            REQUIRE(result.projectiles[1].position == Vector3f(0.0f, 0.0f, 1.0f));
+            REQUIRE(result.projectiles[1].getBackPosition() == Vector3f(0.0f, 0.0f, 0.0f));
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#include <boost/filesystem.hpp>
+#include <catch.hpp>
+#include <rwe/Replay.h>
+
+namespace rwe
+{
+    TEST_CASE("Replay")
+    {
+        auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rwe-%%%%-%%%%.rwr");
+
+        GameParameters parameters("Coast To Coast", 1);
+        parameters.seed = 42;
+        parameters.players[0] = PlayerInfo{PlayerInfo::Controller::Human, "ARM", 3};
+        parameters.players[2] = PlayerInfo{PlayerInfo::Controller::Computer, "CORE", 5};
+        parameters.players[3] = PlayerInfo{PlayerInfo::Controller::Remote, "CORE", 6};
+
+        SECTION("round trips the parameters and every command")
+        {
+            {
+                ReplayRecorder recorder(path.string(), parameters);
+                recorder.record(GameTime(0), SpawnUnitCommand{PlayerId(1), "ARMPW", 10.0f, -20.5f});
+                recorder.record(GameTime(3), MoveCommand{UnitId(2), 1.0f, 2.0f, false});
+                recorder.record(GameTime(3), AttackCommand{UnitId(2), UnitId(0), true});
+                recorder.record(GameTime(7), AttackGroundCommand{UnitId(2), 3.0f, 4.0f, true});
+                recorder.record(GameTime(9), StopCommand{UnitId(2)});
+                recorder.advanceTo(GameTime(100));
+            }
+
+            auto replay = readReplay(path.string());
+
+            REQUIRE(replay.parameters.mapName == "Coast To Coast");
+            REQUIRE(replay.parameters.schemaIndex == 1);
+            REQUIRE(replay.parameters.seed == 42);
+            REQUIRE(!replay.parameters.replayPath);
+            REQUIRE(replay.parameters.players[0]);
+            REQUIRE(replay.parameters.players[0]->controller == PlayerInfo::Controller::Human);
+            REQUIRE(replay.parameters.players[0]->side == "ARM");
+            REQUIRE(replay.parameters.players[0]->color == 3);
+            REQUIRE(!replay.parameters.players[1]);
+            REQUIRE(replay.parameters.players[2]);
+            REQUIRE(replay.parameters.players[2]->controller == PlayerInfo::Controller::Computer);
+            REQUIRE(replay.parameters.players[2]->side == "CORE");
+            REQUIRE(replay.parameters.players[2]->color == 5);
+            REQUIRE(replay.parameters.players[3]);
+            REQUIRE(replay.parameters.players[3]->controller == PlayerInfo::Controller::Remote);
+
+            REQUIRE(replay.endTime == GameTime(100));
+            REQUIRE(replay.commands.size() == 5);
+
+            auto spawn = boost::get<SpawnUnitCommand>(&replay.commands[0].command);
+            REQUIRE(spawn);
+            REQUIRE(replay.commands[0].time == GameTime(0));
+            REQUIRE(spawn->player == PlayerId(1));
+            REQUIRE(spawn->unitType == "ARMPW");
+            REQUIRE(spawn->x == 10.0f);
+            REQUIRE(spawn->z == -20.5f);
+
+            auto move = boost::get<MoveCommand>(&replay.commands[1].command);
+            REQUIRE(move);
+            REQUIRE(replay.commands[1].time == GameTime(3));
+            REQUIRE(move->unit == UnitId(2));
+            REQUIRE(move->x == 1.0f);
+            REQUIRE(move->z == 2.0f);
+            REQUIRE(!move->queued);
+
+            auto attack = boost::get<AttackCommand>(&replay.commands[2].command);
+            REQUIRE(attack);
+            REQUIRE(attack->target == UnitId(0));
+            REQUIRE(attack->queued);
+
+            auto attackGround = boost::get<AttackGroundCommand>(&replay.commands[3].command);
+            REQUIRE(attackGround);
+            REQUIRE(replay.commands[3].time == GameTime(7));
+            REQUIRE(attackGround->x == 3.0f);
+            REQUIRE(attackGround->z == 4.0f);
+
+            auto stop = boost::get<StopCommand>(&replay.commands[4].command);
+            REQUIRE(stop);
+            REQUIRE(stop->unit == UnitId(2));
+        }
+
+        SECTION("replaces the seed once the game is under way")
+        {
+            {
+                ReplayRecorder recorder(path.string(), parameters);
+                recorder.record(GameTime(0), StopCommand{UnitId(2)});
+                recorder.setSeed(0xcafef00d);
+                recorder.record(GameTime(1), StopCommand{UnitId(3)});
+                recorder.advanceTo(GameTime(2));
+            }
+
+            auto replay = readReplay(path.string());
+            REQUIRE(replay.parameters.seed == 0xcafef00d);
+            REQUIRE(replay.parameters.mapName == "Coast To Coast");
+            REQUIRE(replay.commands.size() == 2);
+            REQUIRE(replay.endTime == GameTime(2));
+        }
+
+        SECTION("a replay cut off before its end time ends at its last command")
+        {
+            {
+                ReplayRecorder recorder(path.string(), parameters);
+                recorder.record(GameTime(5), StopCommand{UnitId(1)});
+                recorder.record(GameTime(8), StopCommand{UnitId(2)});
+            }
+
+            // chop off the end record
+            auto size = boost::filesystem::file_size(path);
+            boost::filesystem::resize_file(path, size - 5);
+
+            auto replay = readReplay(path.string());
+            REQUIRE(replay.commands.size() == 2);
+            REQUIRE(replay.endTime == GameTime(8));
+        }
+
+        SECTION("rejects truncated commands")
+        {
+            {
+                ReplayRecorder recorder(path.string(), parameters);
+                recorder.record(GameTime(5), MoveCommand{UnitId(1), 1.0f, 2.0f, false});
+            }
+
+            auto size = boost::filesystem::file_size(path);
+            boost::filesystem::resize_file(path, size - 7);
+
+            REQUIRE_THROWS_AS(readReplay(path.string()), const ReplayException&);
+        }
+
+        SECTION("rejects files that are not replays")
+        {
+            {
+                std::ofstream out(path.string(), std::ios::binary);
+                out << "definitely not a replay";
+            }
+
+            REQUIRE_THROWS_AS(readReplay(path.string()), const ReplayException&);
+        }
+
+        boost::filesystem::remove(path);
+    }
+
+    TEST_CASE("makeReplayPath")
+    {
+        boost::filesystem::path path(makeReplayPath("replays"));
+        REQUIRE(path.parent_path() == boost::filesystem::path("replays"));
+        REQUIRE(path.extension() == ".rwr");
+    }
+}
@@ -0,0 +1,95 @@
+#include "SimulationTestFixtures.h"
+#include <catch.hpp>
+#include <rwe/SimulationChecksum.h>
+
+namespace rwe
+{
+    TEST_CASE("ChecksumBuilder")
+    {
+        SECTION("is order sensitive")
+        {
+            ChecksumBuilder a;
+            a.add(1u);
+            a.add(2u);
+
+            ChecksumBuilder b;
+            b.add(2u);
+            b.add(1u);
+
+            REQUIRE(a.get() != b.get());
+        }
+
+        SECTION("distinguishes floats by representation")
+        {
+            ChecksumBuilder a;
+            a.add(0.0f);
+
+            ChecksumBuilder b;
+            b.add(-0.0f);
+
+            REQUIRE(a.get() != b.get());
+        }
+    }
+
+    TEST_CASE("computeSimulationChecksum")
+    {
+        auto a = makeTestSimulation(1);
+        auto b = makeTestSimulation(1);
+
+        SECTION("matches for identical simulations")
+        {
+            REQUIRE(computeSimulationChecksum(a) == computeSimulationChecksum(b));
+            REQUIRE(!findFirstDifference(describeSimulationState(a), describeSimulationState(b)));
+        }
+
+        SECTION("does not disturb the random number generator")
+        {
+            computeSimulationChecksum(a);
+            REQUIRE(a.rng() == b.rng());
+        }
+
+        SECTION("reports a diverged random number generator")
+        {
+            a.rng();
+            REQUIRE(computeSimulationChecksum(a) != computeSimulationChecksum(b));
+            REQUIRE(findFirstDifference(describeSimulationState(a), describeSimulationState(b)) == std::string("simulation rng"));
+        }
+
+        SECTION("reports differently seeded simulations")
+        {
+            auto c = makeTestSimulation(2);
+            REQUIRE(findFirstDifference(describeSimulationState(a), describeSimulationState(c)) == std::string("simulation rng"));
+        }
+
+        SECTION("reports the diverged field")
+        {
+            b.getPlayer(PlayerId(1)).status = GamePlayerStatus::Dead;
+            REQUIRE(computeSimulationChecksum(a) != computeSimulationChecksum(b));
+            REQUIRE(findFirstDifference(describeSimulationState(a), describeSimulationState(b)) == std::string("player 1 status"));
+        }
+
+        SECTION("reports extra state on one side")
+        {
+            b.addPlayer(GamePlayerInfo{2, GamePlayerStatus::Alive});
+            REQUIRE(findFirstDifference(describeSimulationState(a), describeSimulationState(b)) == std::string("simulation unitCount / player 2 status"));
+        }
+
+        SECTION("reports diverged order and piece payloads")
+        {
+            CobScript script;
+            UnitMesh mesh;
+            REQUIRE(a.tryAddUnit(makeTestUnit(mesh, &script, PlayerId(0), Vector3f(0.0f, 0.0f, 0.0f))));
+            REQUIRE(b.tryAddUnit(makeTestUnit(mesh, &script, PlayerId(0), Vector3f(0.0f, 0.0f, 0.0f))));
+
+            a.getUnit(UnitId(0)).addOrder(createMoveOrder(Vector3f(10.0f, 0.0f, 10.0f)));
+            b.getUnit(UnitId(0)).addOrder(createMoveOrder(Vector3f(10.0f, 0.0f, 20.0f)));
+            REQUIRE(findFirstDifference(describeSimulationState(a), describeSimulationState(b)) == std::string("unit 0 orders"));
+
+            b.getUnit(UnitId(0)).clearOrders();
+            b.getUnit(UnitId(0)).addOrder(createMoveOrder(Vector3f(10.0f, 0.0f, 10.0f)));
+            a.getUnit(UnitId(0)).mesh.yTurnOperation = UnitMesh::TurnOperation(RadiansAngle(1.0f), 1.0f);
+            b.getUnit(UnitId(0)).mesh.yTurnOperation = UnitMesh::TurnOperation(RadiansAngle(2.0f), 1.0f);
+            REQUIRE(findFirstDifference(describeSimulationState(a), describeSimulationState(b)) == std::string("unit 0 pieces"));
+        }
+    }
+}
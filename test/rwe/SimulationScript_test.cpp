@@ -0,0 +1,99 @@
+#include <catch.hpp>
+#include <rwe/SimulationScript.h>
+#include <sstream>
+
+namespace rwe
+{
+    TEST_CASE("parseSimulationScript")
+    {
+        SECTION("parses every command type")
+        {
+            std::istringstream input(
+                "# spawn a unit and send it somewhere\n"
+                "0 spawn 1 ARMPW 100 -200.5\n"
+                "\n"
+                "5 move 3 10 20\n"
+                "5 move 3 30 40 queue # then go here\n"
+                "6 attack 3 4\n"
+                "7 attack-ground 3 1.5 2.5 queue\n"
+                "8 stop 3\n");
+
+            auto entries = parseSimulationScript(input);
+            REQUIRE(entries.size() == 6);
+
+            REQUIRE(entries[0].time == GameTime(0));
+            auto spawn = boost::get<SpawnUnitCommand>(&entries[0].command);
+            REQUIRE(spawn);
+            REQUIRE(spawn->player == PlayerId(1));
+            REQUIRE(spawn->unitType == "ARMPW");
+            REQUIRE(spawn->x == 100.0f);
+            REQUIRE(spawn->z == -200.5f);
+
+            REQUIRE(entries[1].time == GameTime(5));
+            auto move = boost::get<MoveCommand>(&entries[1].command);
+            REQUIRE(move);
+            REQUIRE(move->unit == UnitId(3));
+            REQUIRE(move->x == 10.0f);
+            REQUIRE(move->z == 20.0f);
+            REQUIRE(!move->queued);
+
+            auto queuedMove = boost::get<MoveCommand>(&entries[2].command);
+            REQUIRE(queuedMove);
+            REQUIRE(queuedMove->queued);
+
+            auto attack = boost::get<AttackCommand>(&entries[3].command);
+            REQUIRE(attack);
+            REQUIRE(attack->unit == UnitId(3));
+            REQUIRE(attack->target == UnitId(4));
+            REQUIRE(!attack->queued);
+
+            auto attackGround = boost::get<AttackGroundCommand>(&entries[4].command);
+            REQUIRE(attackGround);
+            REQUIRE(attackGround->x == 1.5f);
+            REQUIRE(attackGround->z == 2.5f);
+            REQUIRE(attackGround->queued);
+
+            auto stop = boost::get<StopCommand>(&entries[5].command);
+            REQUIRE(stop);
+            REQUIRE(stop->unit == UnitId(3));
+        }
+
+        SECTION("sorts entries by time, keeping ties in order")
+        {
+            std::istringstream input(
+                "10 stop 1\n"
+                "2 stop 2\n"
+                "10 stop 3\n"
+                "2 stop 4\n");
+
+            auto entries = parseSimulationScript(input);
+            std::vector<unsigned int> units;
+            for (const auto& e : entries)
+            {
+                units.push_back(boost::get<StopCommand>(e.command).unit.value);
+            }
+
+            REQUIRE(units == std::vector<unsigned int>({2, 4, 1, 3}));
+        }
+
+        SECTION("rejects malformed lines")
+        {
+            std::vector<std::string> badLines{
+                "move 1 2 3",
+                "-1 stop 1",
+                "0 dance 1",
+                "0 move 1 2",
+                "0 move 1 2 x",
+                "0 move 1 2 3 later",
+                "0 stop 1 2",
+                "0 spawn 1 ARMPW 0 0 queue",
+            };
+
+            for (const auto& line : badLines)
+            {
+                std::istringstream input("0 stop 1\n" + line + "\n");
+                REQUIRE_THROWS_WITH(parseSimulationScript(input), Catch::Contains("line 2"));
+            }
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#include "SimulationTestFixtures.h"
+#include <catch.hpp>
+#include <rwe/SimulationChecksum.h>
+#include <rwe/SimulationSnapshot.h>
+
+namespace rwe
+{
+    namespace
+    {
+        CobScript makeSnapshotTestScript()
+        {
+            CobScript script;
+            script.staticVariableCount = 2;
+            script.functions.push_back(CobFunctionInfo{"Create", 0});
+            script.functions.push_back(CobFunctionInfo{"AimPrimary", 10});
+            return script;
+        }
+
+        UnitMesh makeSnapshotTestMesh()
+        {
+            UnitMesh turret;
+            turret.name = "turret";
+
+            UnitMesh base;
+            base.name = "base";
+            base.children.push_back(turret);
+            return base;
+        }
+
+        Unit makeSnapshotTestUnit(const CobScript* script, const std::string& unitType, PlayerId owner, const Vector3f& position)
+        {
+            auto unit = makeTestUnit(makeSnapshotTestMesh(), script, owner, position);
+            unit.cobEnvironment->createThread("Create", std::vector<int>());
+            unit.unitType = unitType;
+
+            UnitWeapon weapon;
+            weapon.projectile = std::make_shared<ProjectileDescriptor>();
+            unit.weapons[0] = weapon;
+
+            return unit;
+        }
+
+        GameSimulation makeSnapshotTestSimulation(const CobScript* script)
+        {
+            auto sim = makeTestSimulation(7);
+            sim.tryAddUnit(makeSnapshotTestUnit(script, "ARMCOM", PlayerId(0), Vector3f(-40.0f, 0.0f, -40.0f)));
+            sim.tryAddUnit(makeSnapshotTestUnit(script, "CORCOM", PlayerId(1), Vector3f(40.0f, 0.0f, 40.0f)));
+            return sim;
+        }
+    }
+
+    TEST_CASE("SimulationSnapshot")
+    {
+        auto script = makeSnapshotTestScript();
+        auto sim = makeSnapshotTestSimulation(&script);
+
+        unsigned int unitsCreated = 0;
+        SnapshotUnitFactory createUnit = [&script, &unitsCreated](const std::string& unitType, PlayerId owner) {
+            ++unitsCreated;
+            return makeSnapshotTestUnit(&script, unitType, owner, Vector3f(0.0f, 0.0f, 0.0f));
+        };
+
+        // put some of everything into the simulation
+        auto& first = sim.getUnit(UnitId(0));
+        first.addOrder(createMoveOrder(Vector3f(10.0f, 0.0f, 10.0f)));
+        first.addOrder(createAttackOrder(UnitId(1)));
+        first.behaviourState = MovingState{Vector3f(10.0f, 0.0f, 10.0f), std::nullopt, false};
+        auto& moving = boost::get<MovingState>(first.behaviourState);
+        moving.path = PathFollowingInfo(UnitPath{{Vector3f(1.0f, 0.0f, 1.0f), Vector3f(2.0f, 0.0f, 2.0f), Vector3f(3.0f, 0.0f, 3.0f)}}, GameTime(3));
+        ++moving.path->currentWaypoint;
+        first.mesh.children[0].yTurnOperation = UnitMesh::TurnOperationUnion(UnitMesh::SpinOperation(1.0f, 2.0f, 0.5f));
+        first.mesh.children[0].offset = Vector3f(0.0f, 5.0f, 0.0f);
+        first.cobEnvironment->setStatic(1, 42);
+        auto aimThread = first.cobEnvironment->createThread(1, std::vector<int>{0, 0});
+        first.setWeaponTarget(0, UnitId(1));
+        boost::get<UnitWeaponStateAttacking>(first.weapons[0]->state).aimInfo = UnitWeaponStateAttacking::AimInfo{aimThread, 0.5f, 0.25f};
+        sim.projectiles.spawn(PlayerId(0), first.weapons[0]->projectile, Vector3f(1.0f, 2.0f, 3.0f), Vector3f(0.0f, 0.0f, 1.0f), GameTime(0));
+        sim.requestPath(UnitId(0));
+        sim.gameTime = GameTime(50);
+
+        SimulationSnapshot snapshot;
+        takeSimulationSnapshot(sim, snapshot);
+        auto checksum = computeSimulationChecksum(sim);
+
+        SECTION("records the time and the shared resources")
+        {
+            REQUIRE(snapshot.time == GameTime(50));
+            REQUIRE(snapshot.size() > 0);
+            REQUIRE(snapshot.projectileDescriptors.size() == 1);
+        }
+
+        SECTION("restoring an unchanged simulation changes nothing")
+        {
+            restoreSimulationSnapshot(sim, snapshot, createUnit);
+            REQUIRE(computeSimulationChecksum(sim) == checksum);
+            REQUIRE(unitsCreated == 0);
+
+            SimulationSnapshot again;
+            takeSimulationSnapshot(sim, again);
+            REQUIRE(again.data == snapshot.data);
+        }
+
+        SECTION("undoes changes to the simulation")
+        {
+            sim.rng();
+            sim.gameTime = GameTime(80);
+            auto& unit = sim.getUnit(UnitId(0));
+            unit.position = Vector3f(0.0f, 0.0f, 0.0f);
+            unit.clearOrders();
+            unit.clearWeaponTargets();
+            unit.behaviourState = IdleState();
+            unit.mesh.children[0].yTurnOperation = std::nullopt;
+            unit.cobEnvironment->setStatic(1, 0);
+            unit.cobEnvironment->createThread("Create", std::vector<int>());
+            sim.projectiles.clear();
+            sim.pathRequests.clear();
+            sim.getPlayer(PlayerId(1)).status = GamePlayerStatus::Dead;
+
+            restoreSimulationSnapshot(sim, snapshot, createUnit);
+            REQUIRE(computeSimulationChecksum(sim) == checksum);
+
+            SimulationSnapshot again;
+            takeSimulationSnapshot(sim, again);
+            REQUIRE(again.data == snapshot.data);
+        }
+
+        SECTION("points restored threads into the restored environment")
+        {
+            auto& unit = sim.getUnit(UnitId(0));
+            unit.cobEnvironment->deleteThread(aimThread);
+            unit.clearWeaponTargets();
+
+            restoreSimulationSnapshot(sim, snapshot, createUnit);
+
+            const auto& restored = sim.getUnit(UnitId(0));
+            const auto& env = *restored.cobEnvironment;
+            REQUIRE(env.threads.size() == 2);
+            REQUIRE(env.readyQueue.size() == 2);
+            REQUIRE(env.readyQueue[1] == env.threads[1].get());
+            const auto& attacking = boost::get<UnitWeaponStateAttacking>(restored.weapons[0]->state);
+            REQUIRE(attacking.aimInfo);
+            REQUIRE(attacking.aimInfo->thread == env.threads[1].get());
+            REQUIRE(env.threads[1]->callStack.top().locals == std::vector<int>({0, 0}));
+        }
+
+        SECTION("keeps the unit's place along its path")
+        {
+            auto& unit = sim.getUnit(UnitId(0));
+            unit.behaviourState = IdleState();
+
+            restoreSimulationSnapshot(sim, snapshot, createUnit);
+
+            const auto& restored = boost::get<MovingState>(sim.getUnit(UnitId(0)).behaviourState);
+            REQUIRE(restored.path);
+            REQUIRE(restored.path->pathCreationTime == GameTime(3));
+            REQUIRE(*restored.path->currentWaypoint == Vector3f(2.0f, 0.0f, 2.0f));
+        }
+
+        SECTION("recreates units that have died and removes units that did not exist")
+        {
+            sim.units.erase(UnitId(1));
+            sim.occupiedGrid.grid.setArea(0, 0, 8, 8, OccupiedNone());
+            REQUIRE(sim.tryAddUnit(makeSnapshotTestUnit(&script, "ARMPW", PlayerId(0), Vector3f(0.0f, 0.0f, 0.0f))));
+
+            restoreSimulationSnapshot(sim, snapshot, createUnit);
+
+            REQUIRE(unitsCreated == 1);
+            REQUIRE(sim.units.size() == 2);
+            REQUIRE(sim.getUnit(UnitId(1)).unitType == "CORCOM");
+            REQUIRE(sim.getUnit(UnitId(1)).owner == PlayerId(1));
+            REQUIRE(sim.nextUnitId == UnitId(2));
+            REQUIRE(computeSimulationChecksum(sim) == checksum);
+
+            SimulationSnapshot again;
+            takeSimulationSnapshot(sim, again);
+            REQUIRE(again.data == snapshot.data);
+        }
+
+        SECTION("reuses the buffer when taken again")
+        {
+            auto capacity = snapshot.data.capacity();
+            auto data = snapshot.data.data();
+            takeSimulationSnapshot(sim, snapshot);
+            REQUIRE(snapshot.data.capacity() == capacity);
+            REQUIRE(snapshot.data.data() == data);
+        }
+
+        SECTION("refuses to restore onto a different map")
+        {
+            MapTerrain terrain(
+                std::vector<TextureRegion>(),
+                Grid<std::size_t>(8, 8),
+                Grid<unsigned char>(16, 16),
+                0.0f);
+            GameSimulation other(std::move(terrain), 7);
+            REQUIRE_THROWS_AS(restoreSimulationSnapshot(other, snapshot, createUnit), const std::runtime_error&);
+        }
+    }
+}
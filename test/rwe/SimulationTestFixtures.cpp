@@ -0,0 +1,33 @@
+#include "SimulationTestFixtures.h"
+
+namespace rwe
+{
+    GameSimulation makeTestSimulation(unsigned int seed)
+    {
+        MapTerrain terrain(
+            std::vector<TextureRegion>(),
+            Grid<std::size_t>(4, 4),
+            Grid<unsigned char>(8, 8),
+            0.0f);
+        GameSimulation sim(std::move(terrain), seed);
+        sim.addPlayer(GamePlayerInfo{0, GamePlayerStatus::Alive});
+        sim.addPlayer(GamePlayerInfo{1, GamePlayerStatus::Alive});
+        return sim;
+    }
+
+    Unit makeTestUnit(const UnitMesh& mesh, const CobScript* script, PlayerId owner, const Vector3f& position)
+    {
+        auto selectionMesh = std::make_shared<SelectionMesh>(SelectionMesh{CollisionMesh(), GlMesh(VaoHandle(), VboHandle(), 0)});
+        Unit unit(mesh, std::make_unique<CobEnvironment>(script), selectionMesh);
+        unit.owner = owner;
+        unit.position = position;
+        unit.height = 10.0f;
+        unit.footprintX = 2;
+        unit.footprintZ = 2;
+        unit.hitPoints = 100;
+        unit.maxHitPoints = 100;
+        unit.sightDistance = 0.0f;
+        unit.radarDistance = 0.0f;
+        return unit;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef RWE_SIMULATION_TEST_FIXTURES_H
+#define RWE_SIMULATION_TEST_FIXTURES_H
+
+#include <rwe/GameSimulation.h>
+
+namespace rwe
+{
+    /**
+     * Creates a small, flat simulation with two living players and no units.
+     */
+    GameSimulation makeTestSimulation(unsigned int seed);
+
+    /**
+     * Creates a unit with a 2x2 footprint and full health,
+     * so that it can be added to a simulation from makeTestSimulation.
+     */
+    Unit makeTestUnit(const UnitMesh& mesh, const CobScript* script, PlayerId owner, const Vector3f& position);
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include <catch.hpp>
+#include <rwe/SkylinePacker.h>
+
+namespace rwe
+{
+    TEST_CASE("SkylinePacker")
+    {
+        SECTION("places the first rectangle at the origin")
+        {
+            SkylinePacker packer(8);
+            auto pos = packer.insert(4, 2);
+            REQUIRE(pos.x == 0);
+            REQUIRE(pos.y == 0);
+            REQUIRE(packer.getWidth() == 4);
+            REQUIRE(packer.getHeight() == 2);
+        }
+
+        SECTION("fills across before going down")
+        {
+            SkylinePacker packer(8);
+            auto a = packer.insert(4, 4);
+            auto b = packer.insert(4, 4);
+            auto c = packer.insert(4, 4);
+
+            REQUIRE(a.x == 0);
+            REQUIRE(a.y == 0);
+            REQUIRE(b.x == 4);
+            REQUIRE(b.y == 0);
+            REQUIRE(c.x == 0);
+            REQUIRE(c.y == 4);
+            REQUIRE(packer.getWidth() == 8);
+            REQUIRE(packer.getHeight() == 8);
+        }
+
+        SECTION("drops into the lowest gap")
+        {
+            SkylinePacker packer(8);
+            packer.insert(4, 4);
+            packer.insert(2, 2);
+            packer.insert(2, 1);
+
+            auto pos = packer.insert(2, 1);
+            REQUIRE(pos.x == 6);
+            REQUIRE(pos.y == 1);
+        }
+
+        SECTION("aligns power-of-two rectangles to their size")
+        {
+            SkylinePacker packer(8);
+            packer.insert(1, 1);
+
+            // the lowest spot is at x = 1, but a 4 wide rectangle there would straddle two 4x4 cells
+            auto a = packer.insert(4, 2);
+            REQUIRE(a.x == 4);
+            REQUIRE(a.y == 0);
+
+            // resting on the first rectangle would put this at y = 1
+            auto b = packer.insert(4, 2);
+            REQUIRE(b.x == 0);
+            REQUIRE(b.y == 2);
+        }
+
+        SECTION("keeps every mip level of power-of-two rectangles separate")
+        {
+            SkylinePacker packer(64);
+            std::vector<std::pair<SkylinePosition, std::pair<unsigned int, unsigned int>>> placed;
+            for (unsigned int i = 0; i < 100; ++i)
+            {
+                // deliberately unsorted, so that alignment cannot come from the insertion order
+                auto w = 1u << ((i * 7) % 5);
+                auto h = 1u << ((i * 11) % 4);
+                placed.emplace_back(packer.insert(w, h), std::make_pair(w, h));
+            }
+
+            // At mip level k each texel covers a 2^k square of the original.
+            // A rectangle at least that big, aligned to its size,
+            // covers whole texels at that level, so none is shared with a neighbour.
+            for (const auto& p : placed)
+            {
+                REQUIRE(p.first.x % p.second.first == 0);
+                REQUIRE(p.first.y % p.second.second == 0);
+            }
+        }
+
+        SECTION("rests a wide rectangle on the highest segment beneath it")
+        {
+            SkylinePacker packer(8);
+            packer.insert(4, 4);
+            packer.insert(2, 2);
+
+            auto pos = packer.insert(6, 1);
+            REQUIRE(pos.x == 0);
+            REQUIRE(pos.y == 4);
+        }
+
+        SECTION("never overlaps rectangles")
+        {
+            SkylinePacker packer(64);
+            std::vector<std::pair<SkylinePosition, std::pair<unsigned int, unsigned int>>> placed;
+            for (unsigned int i = 0; i < 200; ++i)
+            {
+                auto w = 1 + ((i * 7) % 13);
+                auto h = 1 + ((i * 11) % 9);
+                placed.emplace_back(packer.insert(w, h), std::make_pair(w, h));
+            }
+
+            for (std::size_t i = 0; i < placed.size(); ++i)
+            {
+                const auto& a = placed[i];
+                REQUIRE(a.first.x + a.second.first <= 64);
+                REQUIRE(a.first.x + a.second.first <= packer.getWidth());
+                REQUIRE(a.first.y + a.second.second <= packer.getHeight());
+
+                for (std::size_t j = i + 1; j < placed.size(); ++j)
+                {
+                    const auto& b = placed[j];
+                    auto separate = a.first.x + a.second.first <= b.first.x
+                        || b.first.x + b.second.first <= a.first.x
+                        || a.first.y + a.second.second <= b.first.y
+                        || b.first.y + b.second.second <= a.first.y;
+                    REQUIRE(separate);
+                }
+            }
+        }
+
+        SECTION("rejects rectangles wider than the area")
+        {
+            SkylinePacker packer(8);
+            REQUIRE_THROWS(packer.insert(9, 1));
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include <catch.hpp>
+#include <rwe/tdf/SimpleTdfAdapter.h>
+#include <rwe/tdf/TdfDocument.h>
+
+namespace rwe
+{
+    namespace
+    {
+        TdfBlock parseWithTdfParser(const std::string& input)
+        {
+            TdfParser<ConstUtf8Iterator, TdfBlock> parser(new SimpleTdfAdapter);
+            return parser.parse(cUtf8Begin(input), cUtf8End(input));
+        }
+
+        TdfBlock parseWithTdfDocument(const std::string& input)
+        {
+            SimpleTdfAdapter adapter;
+            return adaptTdfDocument(parseTdfDocument(input), adapter);
+        }
+
+        /** Records every callback, to check the order they arrive in. */
+        class RecordingTdfAdapter : public TdfAdapter<std::vector<std::string>>
+        {
+        private:
+            std::vector<std::string> events;
+
+        public:
+            void onStart() override
+            {
+                events.clear();
+            }
+
+            void onProperty(const std::string& name, const std::string& value) override
+            {
+                events.push_back(name + "=" + value);
+            }
+
+            void onStartBlock(const std::string& name) override
+            {
+                events.push_back("[" + name + "]");
+            }
+
+            void onEndBlock() override
+            {
+                events.push_back("end");
+            }
+
+            std::vector<std::string> onDone() override
+            {
+                return events;
+            }
+        };
+    }
+
+    TEST_CASE("parseTdfDocument")
+    {
+        SECTION("produces the same result as TdfParser")
+        {
+            std::vector<std::string> inputs{
+                "",
+                "[Foo]\n{\n    Bar=1;\n    Baz=2;\n    Alice=Bob;\n}\n",
+                "[Foo]\r\n{\r\n    Bar = 1; // one\r\n\r\n    // two\r\n    Baz = 2;\r\n}\r\n",
+                "[Fo/*ooooo*/o]\n{\n    Ali/*ii*/ce = Bo/*ooo*/b;\n    Bar = 1; /* x */\n}\n",
+                "[   Foo Bar Baz   ]\n{\n    Item One = The First Item;\n    Item Two =     123  456  ;\n}\n",
+                "[Foo]\n{\n    help=;\n}\n",
+                "[Foo]\n{\n    The\n    Thing=Great;\n    The\r\n    Other\rThing=Good;\n}\n",
+                "[Foo]\n{\n    width=494;\n    WIDTH=640;\n}\n[foo]\n{\n    height=480;\n}\n",
+                "[A]\n{\n    x=1;\n    [B]\n    {\n        y=2;\n        [C] { z=3; }\n    }\n    w=4;\n    [b]\n    {\n        y=5;\n    }\n}\n",
+                "[A]{x=a//comment; still comment\n;}",
+                "[A]{x=multi\r\nline\rvalue;}",
+                "[A]{x=caf\xc3\xa9; \xc3\xa9t\xc3\xa9=summer;}",
+            };
+
+            for (const auto& input : inputs)
+            {
+                REQUIRE(parseWithTdfDocument(input) == parseWithTdfParser(input));
+            }
+        }
+
+        SECTION("rejects the same malformed input as TdfParser")
+        {
+            std::vector<std::string> inputs{
+                "Foo",
+                "[Foo",
+                "[Foo]",
+                "[Foo]\n{\n    Bar=1;\n",
+                "[Foo]\n{\n    Bar;\n}\n",
+                "[Foo]\n{\n    =1;\n}\n",
+                "[Foo]\n{\n    Bar=1\n}\n",
+                "[Foo]\n{\n    Bar=1; /* never closed\n}\n",
+                "[A]{url=http://example.com;}\n", // the rest of the line is a comment
+            };
+
+            for (const auto& input : inputs)
+            {
+                REQUIRE_THROWS(parseWithTdfParser(input));
+                REQUIRE_THROWS(parseTdfDocument(input));
+            }
+        }
+
+        SECTION("finds values and blocks ignoring case")
+        {
+            auto doc = parseTdfDocument("[UnitInfo]\n{\n    UnitName=ARMCOM;\n    maxdamage=100;\n    MaxDamage=200;\n    [Weapons] { w1=LASER; }\n}\n");
+
+            const auto* info = doc.findBlock(doc.root(), "UNITINFO");
+            REQUIRE(info != nullptr);
+            REQUIRE(info->name == "UnitInfo");
+
+            REQUIRE(doc.findValue(*info, "unitname") == std::optional<std::string_view>("ARMCOM"));
+            REQUIRE(doc.findValue(*info, "maxDamage") == std::optional<std::string_view>("200"));
+            REQUIRE(!doc.findValue(*info, "turnrate"));
+
+            const auto* weapons = doc.findBlock(*info, "weapons");
+            REQUIRE(weapons != nullptr);
+            REQUIRE(doc.findValue(*weapons, "W1") == std::optional<std::string_view>("LASER"));
+            REQUIRE(doc.findBlock(*info, "Sounds") == nullptr);
+        }
+
+        SECTION("keeps properties and children in source order")
+        {
+            auto doc = parseTdfDocument("[A]{x=1;[B]{}y=2;[C]{}z=3;}");
+            const auto& a = *doc.findBlock(doc.root(), "A");
+
+            std::vector<std::string_view> names;
+            for (const auto& p : doc.getProperties(a))
+            {
+                names.push_back(p.name);
+            }
+            std::vector<std::string_view> expectedNames{"x", "y", "z"};
+            REQUIRE(names == expectedNames);
+
+            std::vector<std::string_view> blockNames;
+            for (const auto& b : doc.getChildren(a))
+            {
+                blockNames.push_back(b.name);
+            }
+            std::vector<std::string_view> expectedBlockNames{"B", "C"};
+            REQUIRE(blockNames == expectedBlockNames);
+        }
+
+        SECTION("replays properties and blocks through an adapter in source order")
+        {
+            std::string input = "[A]{[B]{v=0;}x=1;[C]{[D]{}w=2;}y=2;z=3;[E]{}}";
+
+            TdfParser<ConstUtf8Iterator, std::vector<std::string>> parser(new RecordingTdfAdapter);
+            auto expected = parser.parse(cUtf8Begin(input), cUtf8End(input));
+
+            RecordingTdfAdapter adapter;
+            REQUIRE(adaptTdfDocument(parseTdfDocument(input), adapter) == expected);
+        }
+
+        SECTION("does not depend on the input outliving the document")
+        {
+            auto input = std::make_unique<std::string>("[A]{x=1;}");
+            auto doc = parseTdfDocument(*input);
+            input.reset();
+            auto moved = std::move(doc);
+            REQUIRE(moved.findValue(*moved.findBlock(moved.root(), "a"), "X") == std::optional<std::string_view>("1"));
+        }
+    }
+}
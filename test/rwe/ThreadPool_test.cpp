@@ -0,0 +1,61 @@
+#include <atomic>
+#include <catch.hpp>
+#include <rwe/ThreadPool.h>
+
+namespace rwe
+{
+    TEST_CASE("ThreadPool")
+    {
+        ThreadPool pool(4);
+
+        SECTION("returns task results through the future")
+        {
+            auto future = pool.submit([]() { return 42; });
+            REQUIRE(future.get() == 42);
+        }
+
+        SECTION("runs every submitted task")
+        {
+            std::atomic<int> counter{0};
+            std::vector<std::future<void>> futures;
+            for (int i = 0; i < 1000; ++i)
+            {
+                futures.push_back(pool.submit([&counter]() { ++counter; }));
+            }
+
+            for (auto& f : futures)
+            {
+                f.get();
+            }
+
+            REQUIRE(counter == 1000);
+        }
+
+        SECTION("rethrows task exceptions from the future")
+        {
+            auto future = pool.submit([]() -> int { throw std::runtime_error("oops"); });
+            REQUIRE_THROWS(future.get());
+        }
+
+        SECTION("keeps working after a task throws")
+        {
+            auto bad = pool.submit([]() { throw std::runtime_error("oops"); });
+            auto good = pool.submit([]() { return 7; });
+            REQUIRE_THROWS(bad.get());
+            REQUIRE(good.get() == 7);
+        }
+    }
+
+    TEST_CASE("ThreadPool destructor finishes queued tasks")
+    {
+        std::atomic<int> counter{0};
+        {
+            ThreadPool pool(2);
+            for (int i = 0; i < 100; ++i)
+            {
+                pool.submit([&counter]() { ++counter; });
+            }
+        }
+        REQUIRE(counter == 100);
+    }
+}
@@ -0,0 +1,56 @@
+#include <catch.hpp>
+#include <rwe/UnitDatabaseLoader.h>
+
+namespace rwe
+{
+    namespace
+    {
+        /** Holds one unit, whose FBI file is not named after it. */
+        class MismatchedUnitFileSystem final : public AbstractVirtualFileSystem
+        {
+        public:
+            std::optional<std::vector<char>> readFile(const std::string& filename) const override
+            {
+                std::string contents;
+                if (filename == "units/ARMCOM2.FBI")
+                {
+                    contents = "[UNITINFO]\n{\nUnitName=ARMCOM;\nObjectname=X;\nSoundCategory=Y;\nMaxDamage=3000;\n}\n";
+                }
+                else if (filename != "gamedata/SOUND.TDF" && filename != "gamedata/MOVEINFO.TDF")
+                {
+                    return std::nullopt;
+                }
+
+                return std::vector<char>(contents.begin(), contents.end());
+            }
+
+            std::vector<std::string> getFileNames(const std::string& directory, const std::string&) override
+            {
+                if (directory == "units")
+                {
+                    return std::vector<std::string>{"ARMCOM2.FBI"};
+                }
+
+                return std::vector<std::string>();
+            }
+
+            std::vector<std::string> getFileNamesRecursive(const std::string&, const std::string&) override
+            {
+                return std::vector<std::string>();
+            }
+        };
+    }
+
+    TEST_CASE("UnitDatabaseLoader")
+    {
+        SECTION("keys units by FBI file name, not by the name inside the FBI")
+        {
+            MismatchedUnitFileSystem vfs;
+            ThreadPool pool(1);
+            auto db = UnitDatabaseLoader(&vfs, nullptr, &pool, nullptr).createUnitDatabase();
+
+            REQUIRE(db.getUnitInfo("ARMCOM2").unitName == "ARMCOM");
+            REQUIRE_THROWS_AS(db.getUnitInfo("ARMCOM"), const std::runtime_error&);
+        }
+    }
+}
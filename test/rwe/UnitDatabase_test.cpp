@@ -0,0 +1,162 @@
+#include <atomic>
+#include <catch.hpp>
+#include <mutex>
+#include <rwe/UnitDatabase.h>
+#include <thread>
+
+namespace rwe
+{
+    namespace
+    {
+        /** Serves FBI files from memory and records every read. */
+        class CountingFileSystem final : public AbstractVirtualFileSystem
+        {
+        private:
+            mutable std::mutex mutex;
+            mutable std::vector<std::string> reads;
+            mutable std::vector<std::thread::id> readThreads;
+
+        public:
+            std::optional<std::vector<char>> readFile(const std::string& filename) const override
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    reads.push_back(filename);
+                    readThreads.push_back(std::this_thread::get_id());
+                }
+
+                if (filename == "guis/ARMCOM1.gui")
+                {
+                    // A panel, a unit and a button to page between menus.
+                    std::string gui = "[GADGET0]{[COMMON]{id=0;name=ARMCOM1;}}\n"
+                                      "[GADGET1]{[COMMON]{id=1;name=ARMPW;}}\n"
+                                      "[GADGET2]{[COMMON]{id=1;name=NEXT;}}\n";
+                    return std::vector<char>(gui.begin(), gui.end());
+                }
+
+                if (filename == "guis/CORCOM1.gui")
+                {
+                    std::string gui = "[GADGET0]{[COMMON]{id=1;";
+                    return std::vector<char>(gui.begin(), gui.end());
+                }
+
+                if (filename != "units/ARMCOM.FBI" && filename != "units/ARMPW.FBI")
+                {
+                    return std::nullopt;
+                }
+
+                std::string fbi = "[UNITINFO]\n{\nUnitName=" + filename.substr(6, filename.size() - 10) + ";\nObjectname=X;\nSoundCategory=Y;\nMaxDamage=3000;\n}\n";
+                return std::vector<char>(fbi.begin(), fbi.end());
+            }
+
+            std::vector<std::string> getFileNames(const std::string&, const std::string&) override
+            {
+                return std::vector<std::string>();
+            }
+
+            std::vector<std::string> getFileNamesRecursive(const std::string&, const std::string&) override
+            {
+                return std::vector<std::string>();
+            }
+
+            std::vector<std::string> getReads() const
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return reads;
+            }
+
+            std::vector<std::thread::id> getReadThreads() const
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return readThreads;
+            }
+        };
+    }
+
+    TEST_CASE("UnitDatabase")
+    {
+        CountingFileSystem vfs;
+        ThreadPool pool(2);
+        UnitDatabase db(&vfs, &pool);
+        db.addLazyUnitInfo("ARMCOM", "units/ARMCOM.FBI");
+        db.addLazyUnitInfo("ARMPW", "units/ARMPW.FBI");
+        db.addLazyUnitInfo("CORCOM", "units/CORCOM.FBI");
+
+        SECTION("does not read lazy entries up front")
+        {
+            REQUIRE(vfs.getReads().empty());
+        }
+
+        SECTION("loads an entry on first access, once")
+        {
+            const auto& info = db.getUnitInfo("armcom");
+            REQUIRE(info.unitName == "ARMCOM");
+            REQUIRE(info.maxDamage == 3000);
+            REQUIRE(vfs.getReads() == std::vector<std::string>{"units/ARMCOM.FBI"});
+            REQUIRE(vfs.getReadThreads()[0] == std::this_thread::get_id());
+
+            REQUIRE(&db.getUnitInfo("ARMCOM") == &info);
+            REQUIRE(vfs.getReads().size() == 1);
+        }
+
+        SECTION("serves prefetched entries without reloading them")
+        {
+            db.prefetchUnit("ARMCOM");
+            db.prefetchUnit("ARMCOM");
+
+            REQUIRE(db.getUnitInfo("ARMCOM").unitName == "ARMCOM");
+            REQUIRE(db.getUnitInfo("ARMCOM").unitName == "ARMCOM");
+
+            REQUIRE(vfs.getReads() == std::vector<std::string>{"units/ARMCOM.FBI"});
+            REQUIRE(vfs.getReadThreads()[0] != std::this_thread::get_id());
+        }
+
+        SECTION("prefetches the units on a unit's build menus")
+        {
+            db.prefetchBuildOptions("ARMCOM");
+
+            REQUIRE(db.getUnitInfo("ARMPW").unitName == "ARMPW");
+
+            auto reads = vfs.getReads();
+            REQUIRE((reads == std::vector<std::string>{"guis/ARMCOM1.gui", "guis/ARMCOM2.gui", "units/ARMPW.FBI"}));
+            REQUIRE(vfs.getReadThreads()[2] != std::this_thread::get_id());
+        }
+
+        SECTION("ignores build menus that cannot be parsed")
+        {
+            db.prefetchBuildOptions("CORCOM");
+            REQUIRE(vfs.getReads() == std::vector<std::string>{"guis/CORCOM1.gui"});
+        }
+
+        SECTION("reports entries that fail to load when they are accessed")
+        {
+            db.prefetchUnit("CORCOM");
+            REQUIRE_THROWS_AS(db.getUnitInfo("CORCOM"), const std::runtime_error&);
+        }
+
+        SECTION("refuses unknown units")
+        {
+            REQUIRE_THROWS_AS(db.getUnitInfo("ARMFAV"), const std::runtime_error&);
+            db.prefetchUnit("ARMFAV");
+            REQUIRE(vfs.getReads().empty());
+        }
+
+        SECTION("calls a unit's load function once, when the unit is first needed")
+        {
+            std::atomic<int> calls(0);
+            db.addLazyUnitInfo("ARMFAV", [&calls]() {
+                ++calls;
+                UnitFbi fbi{};
+                fbi.unitName = "ARMFAV";
+                return fbi;
+            });
+            REQUIRE(calls == 0);
+
+            db.prefetchUnit("ARMFAV");
+            REQUIRE(db.getUnitInfo("ARMFAV").unitName == "ARMFAV");
+            REQUIRE(db.getUnitInfo("ARMFAV").unitName == "ARMFAV");
+            REQUIRE(calls == 1);
+            REQUIRE(vfs.getReads().empty());
+        }
+    }
+}
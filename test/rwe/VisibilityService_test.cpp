@@ -0,0 +1,154 @@
+#include <catch.hpp>
+#include <rwe/VisibilityService.h>
+
+namespace rwe
+{
+    namespace
+    {
+        /**
+         * Creates a flat map with a wall along one column of visibility cells.
+         */
+        MapTerrain makeWalledTerrain(std::size_t widthInTiles, std::size_t heightInTiles, int wallCellX, unsigned char wallHeight)
+        {
+            Grid<unsigned char> heights(widthInTiles * 2, heightInTiles * 2, 0);
+            for (std::size_t y = 0; y < heights.getHeight(); ++y)
+            {
+                for (int i = 0; i < VisibilityService::CellSizeInHeightmapCells; ++i)
+                {
+                    heights.set((wallCellX * VisibilityService::CellSizeInHeightmapCells) + i, y, wallHeight);
+                }
+            }
+
+            return MapTerrain(
+                std::vector<TextureRegion>(),
+                Grid<std::size_t>(widthInTiles, heightInTiles),
+                std::move(heights),
+                0.0f);
+        }
+
+        Vector3f visibilityCellCenter(const MapTerrain& terrain, int x, int y)
+        {
+            return terrain.heightmapIndexToWorldCorner(
+                (x * VisibilityService::CellSizeInHeightmapCells) + 1,
+                (y * VisibilityService::CellSizeInHeightmapCells) + 1);
+        }
+    }
+
+    TEST_CASE("computeHorizonTable")
+    {
+        SECTION("every cell in the square appears once, after its parent")
+        {
+            auto table = computeHorizonTable(7);
+            REQUIRE(table.entries.size() == (15 * 15) - 1);
+
+            for (std::size_t i = 0; i < table.entries.size(); ++i)
+            {
+                const auto& e = table.entries[i];
+                auto ring = std::max(std::abs(e.dx), std::abs(e.dy));
+                if (ring == 1)
+                {
+                    REQUIRE(e.parent == -1);
+                }
+                else
+                {
+                    REQUIRE(e.parent >= 0);
+                    REQUIRE(static_cast<std::size_t>(e.parent) < i);
+                    const auto& p = table.entries[e.parent];
+                    REQUIRE(std::max(std::abs(p.dx), std::abs(p.dy)) == ring - 1);
+                }
+            }
+        }
+
+        SECTION("marks cells outside the circle as out of range")
+        {
+            auto table = computeHorizonTable(3);
+            for (const auto& e : table.entries)
+            {
+                REQUIRE(e.inRange == ((e.dx * e.dx) + (e.dy * e.dy) <= 9));
+            }
+        }
+    }
+
+    TEST_CASE("VisibilityService")
+    {
+        auto terrain = makeWalledTerrain(32, 32, 20, 200);
+        VisibilityService service(&terrain);
+        REQUIRE(service.getWidth() == 32);
+        REQUIRE(service.getHeight() == 32);
+
+        PlayerId player(0);
+        PlayerId otherPlayer(1);
+        UnitId unit(1);
+
+        auto position = visibilityCellCenter(terrain, 10, 16);
+        service.updateUnit(unit, player, position, 10.0f, 320.0f, 640.0f);
+
+        SECTION("sees nearby cells")
+        {
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 10, 16)));
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 15, 16)));
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 19, 16)));
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 14, 12)));
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 0, 16)));
+        }
+
+        SECTION("sees the top of the wall but not behind it")
+        {
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 20, 16)));
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, 21, 16)));
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, 25, 16)));
+        }
+
+        SECTION("does not see beyond its sight distance")
+        {
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, 10, 31)));
+        }
+
+        SECTION("radar is not blocked by terrain")
+        {
+            REQUIRE(service.isOnRadar(player, visibilityCellCenter(terrain, 25, 16)));
+            REQUIRE(!service.isOnRadar(player, visibilityCellCenter(terrain, 31, 31)));
+        }
+
+        SECTION("other players see nothing")
+        {
+            REQUIRE(!service.isVisible(otherPlayer, visibilityCellCenter(terrain, 10, 16)));
+            REQUIRE(!service.isOnRadar(otherPlayer, visibilityCellCenter(terrain, 10, 16)));
+        }
+
+        SECTION("positions off the map are never visible")
+        {
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, -1, 16)));
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, 10, 32)));
+        }
+
+        SECTION("moving the unit updates coverage")
+        {
+            service.updateUnit(unit, player, visibilityCellCenter(terrain, 25, 16), 10.0f, 320.0f, 640.0f);
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 25, 16)));
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, 10, 16)));
+            REQUIRE(!service.isOnRadar(player, visibilityCellCenter(terrain, 0, 16)));
+        }
+
+        SECTION("overlapping units are counted separately")
+        {
+            UnitId secondUnit(2);
+            service.updateUnit(secondUnit, player, visibilityCellCenter(terrain, 12, 16), 10.0f, 320.0f, 640.0f);
+            service.removeUnit(unit);
+            REQUIRE(service.isVisible(player, visibilityCellCenter(terrain, 12, 16)));
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, 0, 16)));
+
+            service.removeUnit(secondUnit);
+            REQUIRE(!service.isVisible(player, visibilityCellCenter(terrain, 12, 16)));
+            REQUIRE(!service.isOnRadar(player, visibilityCellCenter(terrain, 12, 16)));
+        }
+
+        SECTION("units without sight see nothing")
+        {
+            UnitId blindUnit(2);
+            service.updateUnit(blindUnit, otherPlayer, position, 10.0f, 0.0f, 0.0f);
+            REQUIRE(!service.isVisible(otherPlayer, position));
+            REQUIRE(!service.isOnRadar(otherPlayer, position));
+        }
+    }
+}
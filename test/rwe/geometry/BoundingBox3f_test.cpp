@@ -56,6 +56,53 @@ namespace rwe
         }
     }
 
+    TEST_CASE("BoundingBox3f::intersectLine")
+    {
+        BoundingBox3f box(Vector3f(0.0f, 0.0f, 0.0f), Vector3f(1.0f, 1.0f, 1.0f));
+
+        SECTION("finds the fraction of the segment at which it enters the box")
+        {
+            Line3f line(Vector3f(-5.0f, 0.0f, 0.0f), Vector3f(5.0f, 0.0f, 0.0f));
+            auto intersect = box.intersectLine(line);
+            REQUIRE(intersect);
+            REQUIRE(*intersect == Approx(0.4f));
+        }
+
+        SECTION("hits a box the segment passes all the way through")
+        {
+            Line3f line(Vector3f(0.5f, 3.0f, 0.5f), Vector3f(0.5f, -3.0f, 0.5f));
+            auto intersect = box.intersectLine(line);
+            REQUIRE(intersect);
+            REQUIRE(*intersect == Approx(1.0f / 3.0f));
+        }
+
+        SECTION("returns 0 when the segment starts inside the box")
+        {
+            Line3f line(Vector3f(0.5f, 0.5f, 0.5f), Vector3f(5.0f, 0.5f, 0.5f));
+            auto intersect = box.intersectLine(line);
+            REQUIRE(intersect);
+            REQUIRE(*intersect == 0.0f);
+        }
+
+        SECTION("misses when the segment stops short of the box")
+        {
+            Line3f line(Vector3f(-5.0f, 0.0f, 0.0f), Vector3f(-2.0f, 0.0f, 0.0f));
+            REQUIRE(!box.intersectLine(line));
+        }
+
+        SECTION("misses when the segment passes beside the box")
+        {
+            Line3f line(Vector3f(-5.0f, 1.5f, 0.0f), Vector3f(5.0f, 1.5f, 0.0f));
+            REQUIRE(!box.intersectLine(line));
+        }
+
+        SECTION("misses when the segment starts beyond the box")
+        {
+            Line3f line(Vector3f(2.0f, 0.0f, 0.0f), Vector3f(5.0f, 0.0f, 0.0f));
+            REQUIRE(!box.intersectLine(line));
+        }
+    }
+
     TEST_CASE("BoundingBox3f.distanceSquared")
     {
         SECTION("returns 0 inside the box")
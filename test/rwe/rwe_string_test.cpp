@@ -78,6 +78,78 @@ namespace rwe
         }
     }
 
+    TEST_CASE("equalsIgnoreCase")
+    {
+        SECTION("compares strings ignoring ASCII case")
+        {
+            REQUIRE(equalsIgnoreCase("Foo bAr", "FOO BAR"));
+            REQUIRE(equalsIgnoreCase("", ""));
+            REQUIRE(!equalsIgnoreCase("Foo", "Fooo"));
+            REQUIRE(!equalsIgnoreCase("Foo", "Bar"));
+        }
+
+        SECTION("agrees with toUpper")
+        {
+            std::string a("armcom.FBI [x]");
+            std::string b("ARMCOM.fbi [X]");
+            REQUIRE(equalsIgnoreCase(a, b) == (toUpper(a) == toUpper(b)));
+        }
+    }
+
+    TEST_CASE("startsWithIgnoreCase")
+    {
+        SECTION("checks the prefix ignoring ASCII case")
+        {
+            REQUIRE(startsWithIgnoreCase("armcom", "ARM"));
+            REQUIRE(!startsWithIgnoreCase("corcom", "ARM"));
+        }
+
+        SECTION("returns false when the prefix is longer than the string")
+        {
+            REQUIRE(!startsWithIgnoreCase("ar", "ARM"));
+        }
+    }
+
+    TEST_CASE("endsWithIgnoreCase")
+    {
+        SECTION("checks the suffix ignoring ASCII case")
+        {
+            REQUIRE(endsWithIgnoreCase("ARMCOM.fbi", ".FBI"));
+            REQUIRE(!endsWithIgnoreCase("ARMCOM.cob", ".FBI"));
+        }
+
+        SECTION("returns false when the suffix is longer than the string")
+        {
+            REQUIRE(!endsWithIgnoreCase("BI", ".FBI"));
+        }
+    }
+
+    TEST_CASE("CaseInsensitiveMap")
+    {
+        CaseInsensitiveMap<int> map;
+        map.insert({"ArmCom", 1});
+
+        SECTION("finds keys regardless of case")
+        {
+            REQUIRE(map.find("ARMCOM") != map.end());
+            REQUIRE(map.find("armcom")->second == 1);
+            REQUIRE(map.find("corcom") == map.end());
+        }
+
+        SECTION("hashes keys the same regardless of case")
+        {
+            CaseInsensitiveHash hash;
+            REQUIRE(hash("ArmCom") == hash("ARMCOM"));
+        }
+
+        SECTION("treats keys differing only in case as the same key")
+        {
+            map.insert_or_assign("ARMCOM", 2);
+            REQUIRE(map.size() == 1);
+            REQUIRE(map.find("armcom")->second == 2);
+        }
+    }
+
     TEST_CASE("utf8Trim")
     {
         SECTION("trims leading and trailing spaces")
@@ -0,0 +1,177 @@
+#include <boost/filesystem.hpp>
+#include <catch.hpp>
+#include <cstring>
+#include <fstream>
+#include <rwe/vfs/HpiFileSystem.h>
+#include <thread>
+
+namespace rwe
+{
+    namespace
+    {
+        template <typename T>
+        void appendRaw(std::vector<char>& buffer, const T& value)
+        {
+            auto p = reinterpret_cast<const char*>(&value);
+            buffer.insert(buffer.end(), p, p + sizeof(T));
+        }
+
+        template <typename T>
+        void writeRaw(std::vector<char>& buffer, std::size_t offset, const T& value)
+        {
+            std::memcpy(buffer.data() + offset, &value, sizeof(T));
+        }
+
+        /**
+         * Builds an unencrypted HPI archive containing the given files
+         * in the root directory, each stored as a single uncompressed chunk.
+         */
+        std::vector<char> buildHpi(const std::vector<std::pair<std::string, std::vector<char>>>& files)
+        {
+            std::vector<char> buffer;
+            appendRaw(buffer, HpiVersion{HpiMagicNumber, HpiVersionNumber});
+
+            auto headerOffset = buffer.size();
+            appendRaw(buffer, HpiHeader{0, 0, 0});
+
+            auto directoryStart = static_cast<uint32_t>(buffer.size());
+            auto entryListOffset = static_cast<uint32_t>(directoryStart + sizeof(HpiDirectoryData));
+            appendRaw(buffer, HpiDirectoryData{static_cast<uint32_t>(files.size()), entryListOffset});
+
+            std::vector<std::size_t> entryOffsets;
+            for (std::size_t i = 0; i < files.size(); ++i)
+            {
+                entryOffsets.push_back(buffer.size());
+                appendRaw(buffer, HpiDirectoryEntry{0, 0, 0});
+            }
+
+            std::vector<std::size_t> fileDataOffsets;
+            for (std::size_t i = 0; i < files.size(); ++i)
+            {
+                auto nameOffset = static_cast<uint32_t>(buffer.size());
+                buffer.insert(buffer.end(), files[i].first.begin(), files[i].first.end());
+                buffer.push_back('\0');
+
+                auto dataOffset = static_cast<uint32_t>(buffer.size());
+                fileDataOffsets.push_back(dataOffset);
+                appendRaw(buffer, HpiFileData{0, static_cast<uint32_t>(files[i].second.size()), 0});
+
+                writeRaw(buffer, entryOffsets[i], HpiDirectoryEntry{nameOffset, dataOffset, 0});
+            }
+
+            writeRaw(buffer, headerOffset, HpiHeader{static_cast<uint32_t>(buffer.size()), 0, directoryStart});
+
+            for (std::size_t i = 0; i < files.size(); ++i)
+            {
+                const auto& data = files[i].second;
+                auto contentOffset = static_cast<uint32_t>(buffer.size());
+
+                uint32_t checksum = 0;
+                for (auto c : data)
+                {
+                    checksum += static_cast<unsigned char>(c);
+                }
+
+                auto size = static_cast<uint32_t>(data.size());
+                appendRaw(buffer, static_cast<uint32_t>(sizeof(HpiChunk) + size));
+                appendRaw(buffer, HpiChunk{HpiChunkMagicNumber, 2, 0, 0, size, size, checksum});
+                buffer.insert(buffer.end(), data.begin(), data.end());
+
+                writeRaw(buffer, fileDataOffsets[i], HpiFileData{contentOffset, size, 0});
+            }
+
+            return buffer;
+        }
+
+        std::vector<char> makeFileContents(std::size_t seed, std::size_t size)
+        {
+            std::vector<char> v(size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                v[i] = static_cast<char>((seed * 31 + i * 7) & 0xff);
+            }
+            return v;
+        }
+    }
+
+    TEST_CASE("HpiFileSystem")
+    {
+        std::vector<std::pair<std::string, std::vector<char>>> files{
+            {"ALPHA.TXT", makeFileContents(1, 100)},
+            {"bravo.fbi", makeFileContents(2, 4000)},
+            {"Charlie.cob", makeFileContents(3, 60000)},
+            {"delta.tdf", makeFileContents(4, 1)},
+        };
+
+        auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rwe-%%%%-%%%%.hpi");
+        {
+            auto hpiData = buildHpi(files);
+            std::ofstream out(path.string(), std::ios::binary);
+            out.write(hpiData.data(), hpiData.size());
+        }
+
+        {
+            HpiFileSystem fs(path.string());
+
+            SECTION("readFile")
+            {
+                SECTION("reads files")
+                {
+                    for (const auto& f : files)
+                    {
+                        auto data = fs.readFile(f.first);
+                        REQUIRE(data);
+                        REQUIRE(*data == f.second);
+                    }
+                }
+
+                SECTION("ignores case")
+                {
+                    auto data = fs.readFile("charlie.COB");
+                    REQUIRE(data);
+                    REQUIRE(*data == files[2].second);
+                }
+
+                SECTION("returns none if the file does not exist")
+                {
+                    REQUIRE(!fs.readFile("echo.txt"));
+                }
+
+                SECTION("is safe to call concurrently")
+                {
+                    const unsigned int threadCount = 8;
+                    const unsigned int iterations = 50;
+
+                    std::vector<unsigned int> failures(threadCount, 0);
+                    std::vector<std::thread> threads;
+                    for (unsigned int t = 0; t < threadCount; ++t)
+                    {
+                        threads.emplace_back([&fs, &files, &failures, t]() {
+                            for (unsigned int i = 0; i < iterations; ++i)
+                            {
+                                const auto& f = files[(t + i) % files.size()];
+                                auto data = fs.readFile(f.first);
+                                if (!data || *data != f.second)
+                                {
+                                    ++failures[t];
+                                }
+                            }
+                        });
+                    }
+
+                    for (auto& thread : threads)
+                    {
+                        thread.join();
+                    }
+
+                    for (auto count : failures)
+                    {
+                        REQUIRE(count == 0);
+                    }
+                }
+            }
+        }
+
+        boost::filesystem::remove(path);
+    }
+}